@@ -1,6 +1,19 @@
 #include <string>
+#include <algorithm>
 #include <codecvt>
+#include <cstring>
 #include <locale>
+#include <zlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "SlippiGame.h"
 
@@ -181,6 +194,40 @@ namespace Slippi {
     game->framesByIndex[frameCount] = frame;
   }
 
+  // Decodes the fields of a pre frame update that follow the frame number, port and follower flag
+  void decodePreFrameUpdate(uint8_t* a, uint32_t maxSize, PlayerFrameData* p) {
+    int idx = 6;
+
+    //Load random seed for player frame update
+    p->randomSeed = readWord(a, idx, maxSize, 0);
+
+    //Load player data
+    p->animation = readHalf(a, idx, maxSize, 0);
+    p->locationX = readFloat(a, idx, maxSize, 0);
+    p->locationY = readFloat(a, idx, maxSize, 0);
+    p->facingDirection = readFloat(a, idx, maxSize, 0);
+
+    //Controller information
+    p->joystickX = readFloat(a, idx, maxSize, 0);
+    p->joystickY = readFloat(a, idx, maxSize, 0);
+    p->cstickX = readFloat(a, idx, maxSize, 0);
+    p->cstickY = readFloat(a, idx, maxSize, 0);
+    p->trigger = readFloat(a, idx, maxSize, 0);
+    p->buttons = readWord(a, idx, maxSize, 0);
+
+    //Raw controller information
+    p->physicalButtons = readHalf(a, idx, maxSize, 0);
+    p->lTrigger = readFloat(a, idx, maxSize, 0);
+    p->rTrigger = readFloat(a, idx, maxSize, 0);
+
+    p->joystickXRaw = readByte(a, idx, maxSize, 0);
+
+    uint32_t noPercent = 0xFFFFFFFF;
+    p->percent = readFloat(a, idx, maxSize, *(float*)(&noPercent));
+
+    p->joystickYRaw = readByte(a, idx, maxSize, 0);
+  }
+
   void handlePreFrameUpdate(Game* game, uint32_t maxSize) {
     int idx = 0;
 
@@ -200,39 +247,11 @@ namespace Slippi {
 
     frame->frame = frameCount;
 
-    PlayerFrameData p;
-
     uint8_t playerSlot = readByte(data, idx, maxSize, 0);
     uint8_t isFollower = readByte(data, idx, maxSize, 0);
 
-    //Load random seed for player frame update
-    p.randomSeed = readWord(data, idx, maxSize, 0);
-
-    //Load player data
-    p.animation = readHalf(data, idx, maxSize, 0);
-    p.locationX = readFloat(data, idx, maxSize, 0);
-    p.locationY = readFloat(data, idx, maxSize, 0);
-    p.facingDirection = readFloat(data, idx, maxSize, 0);
-
-    //Controller information
-    p.joystickX = readFloat(data, idx, maxSize, 0);
-    p.joystickY = readFloat(data, idx, maxSize, 0);
-    p.cstickX = readFloat(data, idx, maxSize, 0);
-    p.cstickY = readFloat(data, idx, maxSize, 0);
-    p.trigger = readFloat(data, idx, maxSize, 0);
-    p.buttons = readWord(data, idx, maxSize, 0);
-
-    //Raw controller information
-    p.physicalButtons = readHalf(data, idx, maxSize, 0);
-    p.lTrigger = readFloat(data, idx, maxSize, 0);
-    p.rTrigger = readFloat(data, idx, maxSize, 0);
-
-    p.joystickXRaw = readByte(data, idx, maxSize, 0);
-
-    uint32_t noPercent = 0xFFFFFFFF;
-    p.percent = readFloat(data, idx, maxSize, *(float*)(&noPercent));
-
-    p.joystickYRaw = readByte(data, idx, maxSize, 0);
+    PlayerFrameData p;
+    decodePreFrameUpdate(data, maxSize, &p);
 
     // Add player data to frame
     std::unordered_map<uint8_t, PlayerFrameData>* target;
@@ -309,6 +328,117 @@ namespace Slippi {
     game->winCondition = readByte(data, idx, maxSize, 0);
   }
 
+  //**********************************************************************
+  //*                     Mapped Mode Event Handlers
+  //**********************************************************************
+  // These only record where the frame updates live in the file, the player data is decoded by
+  // SlippiGame::GetPlayerFrame when it is asked for
+  FrameIndexEntry* findIndexedFrame(Game* game, int32_t frameCount) {
+    int64_t slot = (int64_t)frameCount - GAME_FIRST_FRAME;
+    if (slot < 0 || slot >= (int64_t)game->framePosByNumber.size() || game->framePosByNumber[slot] < 0) {
+      return nullptr;
+    }
+
+    return &game->frameIndex[game->framePosByNumber[slot]];
+  }
+
+  FrameIndexEntry* addIndexedFrame(Game* game, int32_t frameCount) {
+    FrameIndexEntry entry;
+    entry.frame = frameCount;
+    entry.numSinceStart = (uint32_t)game->frameIndex.size();
+    game->frameIndex.push_back(entry);
+
+    // Frames before the first one can't be looked up by number, same as in buffered mode they can
+    // still be reached by position
+    int64_t slot = (int64_t)frameCount - GAME_FIRST_FRAME;
+    if (slot >= 0) {
+      if (slot >= (int64_t)game->framePosByNumber.size()) {
+        game->framePosByNumber.resize(slot + 1, -1);
+      }
+      game->framePosByNumber[slot] = entry.numSinceStart;
+    }
+
+    return &game->frameIndex.back();
+  }
+
+  void handleFrameStartIndexed(Game* game, uint32_t maxSize) {
+    int idx = 0;
+
+    int32_t frameCount = readWord(data, idx, maxSize, 0);
+    game->frameCount = frameCount;
+
+    // For games with rollback the same frame may be replayed multiple times, every replay gets
+    // its own entry and lookups by number find the latest one
+    FrameIndexEntry* frame = addIndexedFrame(game, frameCount);
+    frame->randomSeedExists = true;
+    frame->randomSeed = readWord(data, idx, maxSize, 0);
+  }
+
+  void handlePreFrameUpdateIndexed(Game* game, uint32_t maxSize, uint32_t offset) {
+    int idx = 0;
+
+    int32_t frameCount = readWord(data, idx, maxSize, 0);
+    game->frameCount = frameCount;
+
+    FrameIndexEntry* frame;
+    if (findIndexedFrame(game, frameCount)) {
+      // If this frame already exists, get the current frame
+      frame = &game->frameIndex.back();
+    }
+    else {
+      frame = addIndexedFrame(game, frameCount);
+    }
+
+    uint8_t playerSlot = readByte(data, idx, maxSize, 0);
+    uint8_t isFollower = readByte(data, idx, maxSize, 0);
+    if (playerSlot < 4) {
+      frame->preFrameOffsets[playerSlot * 2 + (isFollower ? 1 : 0)] = offset;
+    }
+  }
+
+  void handlePostFrameUpdateIndexed(Game* game, uint32_t maxSize, uint32_t offset) {
+    int idx = 0;
+
+    int32_t frameCount = readWord(data, idx, maxSize, 0);
+    if (!findIndexedFrame(game, frameCount)) {
+      return;
+    }
+
+    // As soon as a post frame update happens, we know we have received all the inputs
+    FrameIndexEntry* frame = &game->frameIndex.back();
+    frame->inputsFullyFetched = true;
+
+    uint8_t playerSlot = readByte(data, idx, maxSize, 0);
+    uint8_t isFollower = readByte(data, idx, maxSize, 0);
+    if (playerSlot >= 4) {
+      return;
+    }
+
+    frame->postFrameOffsets[playerSlot * 2 + (isFollower ? 1 : 0)] = offset;
+
+    if (frameCount != GAME_FIRST_FRAME) {
+      return;
+    }
+
+    // Check if a player started as sheik and update
+    uint8_t internalCharacterId = readByte(data, idx, maxSize, 0);
+    if (internalCharacterId == GAME_SHEIK_INTERNAL_ID) {
+      game->settings.players[playerSlot].characterId = GAME_SHEIK_EXTERNAL_ID;
+    }
+
+    // Set settings loaded if this is the last character
+    uint8_t lastPlayerIndex = 0;
+    for (uint8_t port = 0; port < 4; port++) {
+      if (frame->HasPlayer(port, false)) {
+        lastPlayerIndex = port;
+      }
+    }
+
+    if (playerSlot >= lastPlayerIndex) {
+      game->areSettingsLoaded = true;
+    }
+  }
+
   // This function gets the position where the raw data starts
   int getRawDataPosition(std::ifstream* f) {
     char buffer[2];
@@ -373,12 +503,42 @@ namespace Slippi {
     return messageSizes;
   }
 
+  bool isCompressedHeader(const uint8_t* header) {
+    static const uint8_t compressedHeader[] = { '{', 'U', 4, 'r', 'a', 'w', 'z', '[' };
+    return memcmp(header, compressedHeader, sizeof(compressedHeader)) == 0;
+  }
+
+  // Reads the payload sizes event at the start of the event stream
+  bool parseMessageSizes(const uint8_t* buf, size_t len, std::unordered_map<uint8_t, uint32_t>& messageSizes) {
+    if (len < 2 || buf[0] != EVENT_PAYLOAD_SIZES || len < (size_t)buf[1] + 1) {
+      return false;
+    }
+
+    uint8_t messageSizesSize = buf[1];
+    messageSizes = { { EVENT_PAYLOAD_SIZES, messageSizesSize } };
+    for (size_t i = 2; i + 2 < (size_t)messageSizesSize + 1; i += 3) {
+      messageSizes[buf[i]] = buf[i + 1] << 8 | buf[i + 2];
+    }
+
+    return true;
+  }
+
   void SlippiGame::processData() {
     if (isProcessingComplete) {
       // If we have finished processing this file, return
       return;
     }
 
+    if (mode == ParseMode::Mapped) {
+      processMappedData();
+      return;
+    }
+
+    if (isCompressed) {
+      processCompressedData();
+      return;
+    }
+
     // This function will process as much data as possible
     int startPos = (int)file->tellg();
     file->seekg(startPos);
@@ -390,6 +550,18 @@ namespace Slippi {
         return;
       }
 
+      // The header of a compressed replay is always written in one go
+      uint8_t header[16];
+      if (len >= (int)sizeof(header)) {
+        file->seekg(0);
+        file->read((char*)header, sizeof(header));
+        if (isCompressedHeader(header)) {
+          isCompressed = true;
+          processCompressedData();
+          return;
+        }
+      }
+
       int rawDataPos = getRawDataPosition(file.get());
       int rawDataLen = len - rawDataPos;
       if (rawDataLen < 2) {
@@ -431,24 +603,80 @@ namespace Slippi {
     std::vector<char> newData(sizeToRead);
     file->read(&newData[0], sizeToRead);
 
+    int processed = processEvents((uint8_t*)&newData[0], sizeToRead);
+    if (processed < sizeToRead) {
+      // Will be processed after getting more data (hopefully)
+      file->seekg(processed - sizeToRead, std::ios::cur);
+    }
+  }
+
+  void SlippiGame::processCompressedData() {
+    // Only whole blocks are handled, a partially written one is read again on the next call
+    int startPos = std::max((int)file->tellg(), 16);
+    file->seekg(0, std::ios::end);
+    int endPos = (int)file->tellg();
+    if (endPos - startPos < COMPRESSED_BLOCK_HEADER_SIZE) {
+      file->seekg(startPos);
+      return;
+    }
+
+    std::vector<uint8_t> newData(endPos - startPos);
+    file->seekg(startPos);
+    file->read((char*)&newData[0], newData.size());
+
+    size_t pos = 0;
+    while (!isProcessingComplete) {
+      if (pos < newData.size() && newData[pos] == 'U') {
+        // Start of the ubjson metadata
+        isProcessingComplete = true;
+        break;
+      }
+
+      CompressedBlock block;
+      if (!readCompressedBlock(&newData[0], newData.size(), pos, block)) {
+        break;
+      }
+
+      uint8_t* blockData = &newData[block.fileOffset];
+      block.fileOffset += startPos;
+      blocks.push_back(block);
+      if (!inflateBlock(blockData, block)) {
+        isProcessingComplete = true;
+        break;
+      }
+
+      bufferedBlock = blocks.size() - 1;
+      if (blocks.size() == 1 && !parseMessageSizes(&blockBuffer[0], blockBuffer.size(), asmEvents)) {
+        isProcessingComplete = true;
+        break;
+      }
+
+      processEvents(&blockBuffer[0], (int)blockBuffer.size());
+      pos = block.fileOffset - startPos + block.storedSize;
+    }
+
+    file->seekg(startPos + pos);
+  }
+
+  // Handles the events in buf and returns how many bytes were processed. Stops early at an event
+  // that isn't complete yet or at the end of the event stream.
+  int SlippiGame::processEvents(uint8_t* buf, int size) {
     int newDataPos = 0;
-    while (newDataPos < sizeToRead) {
-      auto command = newData[newDataPos];
+    while (newDataPos < size) {
+      auto command = buf[newDataPos];
       auto payloadSize = asmEvents[command];
 
       //char buff[100];
       //snprintf(buff, sizeof(buff), "%x", command);
       //log << "Command: " << buff << " | Payload Size: " << payloadSize << "\n";
 
-      auto remainingLen = sizeToRead - newDataPos;
+      auto remainingLen = size - newDataPos;
       if (remainingLen < ((int)payloadSize + 1)) {
         // Here we don't have enough data to read the whole payload
-        // Will be processed after getting more data (hopefully)
-        file->seekg(-remainingLen, std::ios::cur);
-        return;
+        return newDataPos;
       }
 
-      data = (uint8_t*)&newData[newDataPos + 1];
+      data = &buf[newDataPos + 1];
 
       uint8_t isSplitComplete = false;
       uint32_t outerPayloadSize = payloadSize;
@@ -506,19 +734,303 @@ namespace Slippi {
         // ubjson file format
         //log.close();
         isProcessingComplete = true;
-        file->seekg(-remainingLen, std::ios::cur);
-        return;
+        return newDataPos;
       }
 
       payloadSize = isSplitComplete ? outerPayloadSize : payloadSize;
       newDataPos += payloadSize + 1;
     }
+
+    return newDataPos;
+  }
+
+  void SlippiGame::processMappedData() {
+    // Unlike the buffered mode nothing is copied out of the file, the events are handled right
+    // where they sit in the mapping
+    size_t len = mappedFile.Refresh();
+    uint8_t* base = mappedFile.Data();
+
+    if (mappedPos == 0) {
+      if (len < 2) {
+        // If we can't read message sizes payload size yet, return
+        return;
+      }
+
+      if (len >= 16 && isCompressedHeader(base)) {
+        isCompressed = true;
+        mappedPos = 16;
+      }
+      else {
+        // Same rules as getRawDataPosition
+        size_t rawDataPos = base[0] == '{' ? 15 : 0;
+        if (len < rawDataPos + 2 || !parseMessageSizes(base + rawDataPos, len - rawDataPos, messageSizes)) {
+          // If we haven't received the full payload sizes message, return
+          return;
+        }
+
+        mappedPos = rawDataPos;
+      }
+    }
+
+    if (!isCompressed) {
+      processMappedEvents(base, len, mappedPos, 0);
+      return;
+    }
+
+    // Every block is inflated once to index it. Offsets point into the uncompressed event stream
+    // and GetPlayerFrame inflates the block they fall into again when it needs it.
+    while (!isProcessingComplete) {
+      if (mappedPos < len && base[mappedPos] == 'U') {
+        // Start of the ubjson metadata
+        isProcessingComplete = true;
+        return;
+      }
+
+      CompressedBlock block;
+      if (!readCompressedBlock(base, len, mappedPos, block)) {
+        return;
+      }
+
+      blocks.push_back(block);
+      if (!inflateBlock(base + block.fileOffset, block)) {
+        isProcessingComplete = true;
+        return;
+      }
+
+      bufferedBlock = blocks.size() - 1;
+      if (blocks.size() == 1 && !parseMessageSizes(&blockBuffer[0], blockBuffer.size(), messageSizes)) {
+        isProcessingComplete = true;
+        return;
+      }
+
+      size_t pos = 0;
+      processMappedEvents(&blockBuffer[0], blockBuffer.size(), pos, block.rawOffset);
+      mappedPos = block.fileOffset + block.storedSize;
+    }
+  }
+
+  void SlippiGame::processMappedEvents(uint8_t* buf, size_t len, size_t& pos, uint32_t streamOffset) {
+    while (pos < len) {
+      uint8_t command = buf[pos];
+      auto sizeIt = messageSizes.find(command);
+      uint32_t payloadSize = sizeIt == messageSizes.end() ? 0 : sizeIt->second;
+
+      if (len - pos < payloadSize + 1) {
+        // Here we don't have enough data to read the whole payload
+        // Will be processed after getting more data (hopefully)
+        return;
+      }
+
+      uint32_t payloadOffset = streamOffset + (uint32_t)pos + 1;
+      data = buf + pos + 1;
+
+      uint8_t isSplitComplete = false;
+      uint32_t outerPayloadSize = payloadSize;
+
+      // Handle a split message, combining in until we possess the entire message
+      if (command == EVENT_SPLIT_MESSAGE) {
+        if (shouldResetSplitMessageBuf)
+        {
+          splitMessageBuf.clear();
+          shouldResetSplitMessageBuf = false;
+        }
+
+        int _ = 0;
+        uint16_t blockSize = readHalf(&data[SPLIT_MESSAGE_INTERNAL_DATA_LEN], _, payloadSize, 0);
+        splitMessageBuf.insert(splitMessageBuf.end(), data, data + blockSize);
+
+        isSplitComplete = data[SPLIT_MESSAGE_INTERNAL_DATA_LEN + 3];
+        if (isSplitComplete)
+        {
+          // Transform this message into a different message. The combined message does not live
+          // in the file, so there is no offset to record for it
+          command = data[SPLIT_MESSAGE_INTERNAL_DATA_LEN + 2];
+          data = &splitMessageBuf[0];
+          payloadSize = splitMessageBuf.size();
+          payloadOffset = 0;
+          shouldResetSplitMessageBuf = true;
+        }
+      }
+
+      switch (command) {
+      case EVENT_GAME_INIT:
+        handleGameInit(game.get(), payloadSize);
+        break;
+      case EVENT_GECKO_LIST:
+        handleGeckoList(game.get(), payloadSize);
+        break;
+      case EVENT_FRAME_START:
+        handleFrameStartIndexed(game.get(), payloadSize);
+        break;
+      case EVENT_PRE_FRAME_UPDATE:
+        handlePreFrameUpdateIndexed(game.get(), payloadSize, payloadOffset);
+        break;
+      case EVENT_POST_FRAME_UPDATE:
+        handlePostFrameUpdateIndexed(game.get(), payloadSize, payloadOffset);
+        break;
+      case EVENT_FRAME_END:
+        handleFrameEnd(game.get(), payloadSize);
+        break;
+      case EVENT_GAME_END:
+        handleGameEnd(game.get(), payloadSize);
+        isProcessingComplete = true;
+        break;
+      case 0x55:
+        // Start of the ubjson metadata, see processData
+        isProcessingComplete = true;
+        return;
+      }
+
+      payloadSize = isSplitComplete ? outerPayloadSize : payloadSize;
+      pos += payloadSize + 1;
+    }
+  }
+
+  // Reads the header of the block at pos. Returns false if the block isn't fully there yet or is
+  // invalid, processing stops for good in the latter case.
+  bool SlippiGame::readCompressedBlock(uint8_t* base, size_t len, size_t pos, CompressedBlock& block) {
+    if (pos + COMPRESSED_BLOCK_HEADER_SIZE > len) {
+      return false;
+    }
+
+    int idx = 0;
+    uint8_t* header = base + pos;
+    block.storedSize = readWord(header, idx, COMPRESSED_BLOCK_HEADER_SIZE, 0);
+    block.rawSize = readWord(header, idx, COMPRESSED_BLOCK_HEADER_SIZE, 0);
+    block.firstFrame = readWord(header, idx, COMPRESSED_BLOCK_HEADER_SIZE, 0);
+    block.fileOffset = pos + COMPRESSED_BLOCK_HEADER_SIZE;
+    block.rawOffset = blocks.empty() ? 0 : blocks.back().rawOffset + blocks.back().rawSize;
+
+    if (block.rawSize == 0 || block.rawSize > COMPRESSED_BLOCK_MAX_RAW_SIZE || block.storedSize > block.rawSize) {
+      isProcessingComplete = true;
+      return false;
+    }
+
+    return block.fileOffset + block.storedSize <= len;
+  }
+
+  bool SlippiGame::inflateBlock(const uint8_t* src, const CompressedBlock& block) {
+    bufferedBlock = -1;
+    blockBuffer.resize(block.rawSize);
+
+    // Blocks that didn't get any smaller are stored as they are
+    if (block.storedSize == block.rawSize) {
+      memcpy(&blockBuffer[0], src, block.rawSize);
+      return true;
+    }
+
+    uLongf rawSize = block.rawSize;
+    return uncompress(&blockBuffer[0], &rawSize, src, block.storedSize) == Z_OK && rawSize == block.rawSize;
+  }
+
+  // Returns the event stream at the given offset, which is a file offset for regular replays
+  uint8_t* SlippiGame::streamData(uint32_t offset) {
+    if (!isCompressed) {
+      return mappedFile.Data() + offset;
+    }
+
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), offset,
+                               [](uint32_t o, const CompressedBlock& block) { return o < block.rawOffset; });
+    if (it == blocks.begin()) {
+      return nullptr;
+    }
+
+    int64_t index = (it - blocks.begin()) - 1;
+    const CompressedBlock& block = blocks[index];
+    if (index != bufferedBlock) {
+      if (!inflateBlock(mappedFile.Data() + block.fileOffset, block)) {
+        return nullptr;
+      }
+      bufferedBlock = index;
+    }
+
+    return &blockBuffer[offset - block.rawOffset];
+  }
+
+  //**********************************************************************
+  //*                      CompressedBlockWriter
+  //**********************************************************************
+  CompressedBlockWriter::CompressedBlockWriter(uint32_t framesPerBlock)
+    : framesPerBlock(std::max<uint32_t>(framesPerBlock, 1)) {
+  }
+
+  void CompressedBlockWriter::AddEvent(const uint8_t* event, size_t size, std::vector<uint8_t>& out) {
+    if (size == 0) {
+      return;
+    }
+
+    // Blocks are cut in front of frame start events so the updates of a frame always end up in the
+    // same block. Rollbacks may take a block a few frames back, that's fine.
+    if (event[0] == EVENT_FRAME_START && size >= 5) {
+      int32_t frame = event[1] << 24 | event[2] << 16 | event[3] << 8 | event[4];
+      if (!seenFrame || frame >= nextBlockFrame || blockEndRequested) {
+        flushBlock(out);
+        seenFrame = true;
+        blockEndRequested = false;
+        blockFirstFrame = frame;
+        nextBlockFrame = frame + (int32_t)framesPerBlock;
+      }
+      lastFrame = frame;
+    }
+
+    if (pending.size() + size > COMPRESSED_BLOCK_MAX_RAW_SIZE) {
+      flushBlock(out);
+      blockFirstFrame = lastFrame;
+    }
+
+    pending.insert(pending.end(), event, event + size);
+
+    // Nothing but the metadata follows the game end, don't leave it for Finish
+    if (event[0] == EVENT_GAME_END) {
+      flushBlock(out);
+    }
+  }
+
+  void CompressedBlockWriter::Finish(std::vector<uint8_t>& out) {
+    flushBlock(out);
+  }
+
+  void CompressedBlockWriter::flushBlock(std::vector<uint8_t>& out) {
+    if (pending.empty()) {
+      return;
+    }
+
+    uLongf storedSize = compressBound((uLong)pending.size());
+    compressed.resize(storedSize);
+    const uint8_t* stored = &compressed[0];
+    if (compress2(&compressed[0], &storedSize, &pending[0], (uLong)pending.size(), Z_DEFAULT_COMPRESSION) != Z_OK ||
+        storedSize >= pending.size()) {
+      // The reader tells these apart by the sizes being equal
+      stored = &pending[0];
+      storedSize = (uLongf)pending.size();
+    }
+
+    blockIndex.push_back((int32_t)streamSize);
+    blockIndex.push_back(blockFirstFrame);
+
+    uint32_t header[] = { (uint32_t)storedSize, (uint32_t)pending.size(), (uint32_t)blockFirstFrame };
+    for (uint32_t word : header) {
+      out.insert(out.end(), { (uint8_t)(word >> 24), (uint8_t)(word >> 16), (uint8_t)(word >> 8), (uint8_t)word });
+    }
+    out.insert(out.end(), stored, stored + storedSize);
+
+    streamSize += COMPRESSED_BLOCK_HEADER_SIZE + (uint32_t)storedSize;
+    pending.clear();
   }
 
-  std::unique_ptr<SlippiGame> SlippiGame::FromFile(std::string path) {
+  std::unique_ptr<SlippiGame> SlippiGame::FromFile(std::string path, ParseMode mode) {
     auto result = std::make_unique<SlippiGame>();
     result->game = std::make_unique<Game>();
     result->path = path;
+    result->mode = mode;
+
+    if (mode == ParseMode::Mapped) {
+      if (!result->mappedFile.Open(path)) {
+        return nullptr;
+      }
+
+      return result;
+    }
 
 #ifdef _WIN32
     // On Windows, we need to convert paths to std::wstring to deal with UTF-8
@@ -551,6 +1063,11 @@ namespace Slippi {
     return isProcessingComplete;
   }
 
+  bool SlippiGame::IsCompressed() {
+    processData();
+    return isCompressed;
+  }
+
   bool SlippiGame::AreSettingsLoaded() {
     processData();
     return game->areSettingsLoaded;
@@ -558,6 +1075,10 @@ namespace Slippi {
 
   bool SlippiGame::DoesFrameExist(int32_t frame) {
     processData();
+    if (mode == ParseMode::Mapped) {
+      return findIndexedFrame(game.get(), frame) != nullptr;
+    }
+
     return (bool)game->framesByIndex.count(frame);
   }
 
@@ -574,6 +1095,157 @@ namespace Slippi {
     return std::string(version);
   }
 
+  const FrameIndexEntry* SlippiGame::GetFrameEntry(int32_t frame) {
+    return findIndexedFrame(game.get(), frame);
+  }
+
+  const FrameIndexEntry* SlippiGame::GetFrameEntryAt(uint32_t pos) {
+    if (pos >= game->frameIndex.size()) {
+      return nullptr;
+    }
+
+    return &game->frameIndex[pos];
+  }
+
+  bool SlippiGame::GetPlayerFrame(const FrameIndexEntry* entry, uint8_t port, bool isFollower, PlayerFrameData* out) {
+    if (!entry || !entry->HasPlayer(port, isFollower)) {
+      return false;
+    }
+
+    int slot = port * 2 + (isFollower ? 1 : 0);
+    uint8_t* pre = streamData(entry->preFrameOffsets[slot]);
+    if (!pre) {
+      return false;
+    }
+    decodePreFrameUpdate(pre, messageSizes[EVENT_PRE_FRAME_UPDATE], out);
+
+    // The character can change mid frame (zelda/sheik), the post frame update has the final one
+    out->internalCharacterId = 0;
+    uint8_t* post = entry->postFrameOffsets[slot] ? streamData(entry->postFrameOffsets[slot]) : nullptr;
+    if (post) {
+      int idx = 6;
+      out->internalCharacterId = readByte(post, idx, messageSizes[EVENT_POST_FRAME_UPDATE], 0);
+    }
+
+    return true;
+  }
+
+  void PlayerColumns::resize(size_t count) {
+    present.resize(count);
+    randomSeed.resize(count);
+    internalCharacterId.resize(count);
+    animation.resize(count);
+    locationX.resize(count);
+    locationY.resize(count);
+    facingDirection.resize(count);
+    percent.resize(count);
+    joystickX.resize(count);
+    joystickY.resize(count);
+    cstickX.resize(count);
+    cstickY.resize(count);
+    trigger.resize(count);
+    buttons.resize(count);
+    joystickXRaw.resize(count);
+    joystickYRaw.resize(count);
+  }
+
+  void SlippiGame::decodeFrameStorePlayer(const FrameIndexEntry& entry, size_t pos, int slot) {
+    PlayerColumns& columns = frameStore.players[slot];
+    PlayerFrameData p;
+    if (!GetPlayerFrame(&entry, (uint8_t)(slot / 2), (slot % 2) != 0, &p)) {
+      columns.present[pos] = 0;
+      return;
+    }
+
+    columns.present[pos] = 1;
+    columns.randomSeed[pos] = p.randomSeed;
+    columns.internalCharacterId[pos] = p.internalCharacterId;
+    columns.animation[pos] = p.animation;
+    columns.locationX[pos] = p.locationX;
+    columns.locationY[pos] = p.locationY;
+    columns.facingDirection[pos] = p.facingDirection;
+    columns.percent[pos] = p.percent;
+    columns.joystickX[pos] = p.joystickX;
+    columns.joystickY[pos] = p.joystickY;
+    columns.cstickX[pos] = p.cstickX;
+    columns.cstickY[pos] = p.cstickY;
+    columns.trigger[pos] = p.trigger;
+    columns.buttons[pos] = p.buttons;
+    columns.joystickXRaw[pos] = p.joystickXRaw;
+    columns.joystickYRaw[pos] = p.joystickYRaw;
+  }
+
+  const FrameStore& SlippiGame::GetFrameStore() {
+    processData();
+
+    FrameStore& store = frameStore;
+    size_t count = game->frameIndex.size();
+    size_t decoded = store.Size();
+    if (count != decoded) {
+      store.frame.resize(count);
+      store.randomSeedExists.resize(count);
+      store.randomSeed.resize(count);
+      store.inputsFullyFetched.resize(count);
+      for (auto& columns : store.players) {
+        columns.resize(count);
+      }
+    }
+
+    // Decoded positions that can still change only have the players decoded again whose updates
+    // were added or replaced since
+    for (size_t pos = store.checkedFrom; pos < decoded; pos++) {
+      const FrameIndexEntry& entry = game->frameIndex[pos];
+      FrameIndexEntry& last = store.decodedEntries[pos - store.checkedFrom];
+      store.randomSeedExists[pos] = entry.randomSeedExists;
+      store.randomSeed[pos] = entry.randomSeed;
+      store.inputsFullyFetched[pos] = entry.inputsFullyFetched;
+      for (int slot = 0; slot < FrameStore::SLOT_COUNT; slot++) {
+        if (entry.preFrameOffsets[slot] != last.preFrameOffsets[slot] ||
+            entry.postFrameOffsets[slot] != last.postFrameOffsets[slot]) {
+          decodeFrameStorePlayer(entry, pos, slot);
+        }
+      }
+      last = entry;
+    }
+
+    for (size_t pos = decoded; pos < count; pos++) {
+      const FrameIndexEntry& entry = game->frameIndex[pos];
+      store.frame[pos] = entry.frame;
+      store.randomSeedExists[pos] = entry.randomSeedExists;
+      store.randomSeed[pos] = entry.randomSeed;
+      store.inputsFullyFetched[pos] = entry.inputsFullyFetched;
+
+      // Walking the positions in order leaves every frame number on its latest position
+      int64_t frameSlot = (int64_t)entry.frame - GAME_FIRST_FRAME;
+      if (frameSlot >= 0) {
+        if (frameSlot >= (int64_t)store.posByFrame.size()) {
+          store.posByFrame.resize(frameSlot + 1, -1);
+        }
+        store.posByFrame[frameSlot] = (int32_t)pos;
+      }
+
+      for (int slot = 0; slot < FrameStore::SLOT_COUNT; slot++) {
+        if (entry.preFrameOffsets[slot] != 0) {
+          decodeFrameStorePlayer(entry, pos, slot);
+        }
+      }
+    }
+
+    // Keep the entries of the latest two positions until processing is complete
+    size_t checkFrom = isProcessingComplete ? count : (count > 2 ? count - 2 : 0);
+    while (store.checkedFrom < checkFrom && !store.decodedEntries.empty()) {
+      store.decodedEntries.pop_front();
+      store.checkedFrom++;
+    }
+    if (store.decodedEntries.empty()) {
+      store.checkedFrom = checkFrom;
+    }
+    for (size_t pos = store.checkedFrom + store.decodedEntries.size(); pos < count; pos++) {
+      store.decodedEntries.push_back(game->frameIndex[pos]);
+    }
+    return store;
+  }
+
   FrameData* SlippiGame::GetFrame(int32_t frame) {
     // Get the frame we want
     return game->framesByIndex.at(frame);
@@ -610,4 +1282,101 @@ namespace Slippi {
   uint8_t SlippiGame::GetGameEndMethod() {
       return game->winCondition;
   }
+
+  //**********************************************************************
+  //*                            MappedFile
+  //**********************************************************************
+  MappedFile::~MappedFile() {
+    unmap();
+#ifdef _WIN32
+    if (handle) {
+      CloseHandle(handle);
+    }
+#else
+    if (fd >= 0) {
+      close(fd);
+    }
+#endif
+  }
+
+  bool MappedFile::Open(const std::string& path) {
+#ifdef _WIN32
+    // On Windows, we need to convert paths to std::wstring to deal with UTF-8. The replay may still
+    // be written to while we read it
+    std::wstring convertedPath = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(path);
+    HANDLE file = CreateFileW(convertedPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    handle = file;
+#else
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+#endif
+
+    Refresh();
+    return true;
+  }
+
+  size_t MappedFile::Refresh() {
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || (size_t)fileSize.QuadPart <= size) {
+      return size;
+    }
+
+    // The old view stays in place until the new one is mapped, readers keep going if this fails
+    HANDLE newMapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!newMapping) {
+      return size;
+    }
+
+    void* view = MapViewOfFile(newMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+      CloseHandle(newMapping);
+      return size;
+    }
+
+    unmap();
+    mapping = newMapping;
+    base = (uint8_t*)view;
+    size = (size_t)fileSize.QuadPart;
+#else
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size <= size) {
+      return size;
+    }
+
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+      return size;
+    }
+
+    unmap();
+    base = (uint8_t*)view;
+    size = (size_t)st.st_size;
+#endif
+
+    return size;
+  }
+
+  void MappedFile::unmap() {
+    if (!base) {
+      return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(base, size);
+#endif
+
+    base = nullptr;
+    size = 0;
+  }
 }
@@ -3,6 +3,7 @@
 #include <string>
 #include <array>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
@@ -31,6 +32,13 @@ namespace Slippi {
 
   const uint32_t SPLIT_MESSAGE_INTERNAL_DATA_LEN = 512;
 
+  // Compressed replays use a "rawz" element where regular ones have "raw". It holds the event
+  // stream as a series of blocks that each start on an event boundary and can be inflated on their
+  // own. Every block starts with its stored size, raw size and the first frame it holds (big endian
+  // 32 bit values) followed by the zlib data, or the raw events if they didn't compress.
+  const uint8_t COMPRESSED_BLOCK_HEADER_SIZE = 12;
+  const uint32_t COMPRESSED_BLOCK_MAX_RAW_SIZE = 0x100000;
+
   static uint8_t* data;
 
   typedef struct {
@@ -76,6 +84,82 @@ namespace Slippi {
     std::unordered_map<uint8_t, PlayerFrameData> followers;
   } FrameData;
 
+  // Compact per frame record used by the mapped parse mode. Player data is not decoded up front,
+  // only the file offsets of the update payloads are kept and decoded on access
+  typedef struct FrameIndexEntry {
+    int32_t frame;
+    uint32_t numSinceStart;
+    bool randomSeedExists = false;
+    uint32_t randomSeed = 0;
+    bool inputsFullyFetched = false;
+    // Indexed by port * 2 + isFollower, 0 if there was no update
+    std::array<uint32_t, 8> preFrameOffsets = {};
+    std::array<uint32_t, 8> postFrameOffsets = {};
+
+    bool HasPlayer(uint8_t port, bool isFollower) const {
+      return port < 4 && preFrameOffsets[port * 2 + (isFollower ? 1 : 0)] != 0;
+    }
+  } FrameIndexEntry;
+
+  // Column per field for one player slot, indexed by frame position
+  struct PlayerColumns {
+    std::vector<uint8_t> present;
+    std::vector<uint32_t> randomSeed;
+    std::vector<uint8_t> internalCharacterId;
+    std::vector<uint16_t> animation;
+    std::vector<float> locationX;
+    std::vector<float> locationY;
+    std::vector<float> facingDirection;
+    std::vector<float> percent;
+    std::vector<float> joystickX;
+    std::vector<float> joystickY;
+    std::vector<float> cstickX;
+    std::vector<float> cstickY;
+    std::vector<float> trigger;
+    std::vector<uint32_t> buttons;
+    std::vector<uint8_t> joystickXRaw;
+    std::vector<uint8_t> joystickYRaw;
+
+    void resize(size_t count);
+  };
+
+  // Structure of arrays copy of the mapped frame index. Positions are in the order frames were
+  // recorded, same as FrameIndexEntry::numSinceStart, and a frame number maps to its latest
+  // position with a single array lookup. Meant for code that reads every frame, like playback.
+  class FrameStore
+  {
+  public:
+    // Player slots are indexed by port * 2 + isFollower
+    static const int SLOT_COUNT = 8;
+
+    size_t Size() const { return frame.size(); }
+    // Latest position of a frame, -1 if it does not exist (yet)
+    int32_t PosOfFrame(int32_t frameNumber) const {
+      int64_t slot = (int64_t)frameNumber - GAME_FIRST_FRAME;
+      if (slot < 0 || slot >= (int64_t)posByFrame.size()) {
+        return -1;
+      }
+      return posByFrame[slot];
+    }
+    static int Slot(uint8_t port, bool isFollower) { return port * 2 + (isFollower ? 1 : 0); }
+
+    std::vector<int32_t> frame;
+    std::vector<uint8_t> randomSeedExists;
+    std::vector<uint32_t> randomSeed;
+    std::vector<uint8_t> inputsFullyFetched;
+    std::array<PlayerColumns, SLOT_COUNT> players;
+
+  private:
+    friend class SlippiGame;
+
+    std::vector<int32_t> posByFrame;
+    // Entries as they were decoded, for the positions from checkedFrom on. Frames only get more
+    // player data while they are the latest one, the one before it is kept too in case its data
+    // was split across reads of a growing file. Positions before checkedFrom can't change anymore.
+    std::deque<FrameIndexEntry> decodedEntries;
+    size_t checkedFrom = 0;
+  };
+
   typedef struct {
     //Static data
     uint8_t characterId;
@@ -104,6 +188,11 @@ namespace Slippi {
     std::array<uint8_t, 4> version;
     std::unordered_map<int32_t, FrameData*> framesByIndex;
     std::vector<std::unique_ptr<FrameData>> frames;
+
+    // Mapped mode only. A deque so entries stay put while more frames get parsed
+    std::deque<FrameIndexEntry> frameIndex;
+    std::vector<int32_t> framePosByNumber; // Latest position of each frame, -1 if missing
+
     GameSettings settings;
     bool areSettingsLoaded = false;
 
@@ -124,10 +213,85 @@ namespace Slippi {
     { EVENT_FRAME_START, 8 }
   };
 
+  // One block of a compressed replay
+  struct CompressedBlock {
+    size_t fileOffset; // Of the block data, after the header
+    uint32_t storedSize;
+    uint32_t rawSize;
+    int32_t firstFrame;
+    uint32_t rawOffset; // Position of the block in the uncompressed event stream
+  };
+
+  // Builds the rawz stream of a compressed replay from the events of a game, one at a time
+  class CompressedBlockWriter
+  {
+  public:
+    explicit CompressedBlockWriter(uint32_t framesPerBlock);
+    // Adds an event (command byte and payload). Whenever a block is completed it is appended to out
+    void AddEvent(const uint8_t* event, size_t size, std::vector<uint8_t>& out);
+    // Cuts the current block at the next frame start even if it has fewer than framesPerBlock
+    // frames, so readers of a growing file don't fall too far behind
+    void EndBlockAtNextFrame() { blockEndRequested = true; }
+    // Appends whatever is left as the last block
+    void Finish(std::vector<uint8_t>& out);
+    // Bytes of the stream written to out so far
+    uint32_t StreamSize() const { return streamSize; }
+    // Stream offset and first frame of every block, for the replay metadata
+    const std::vector<int32_t>& BlockIndex() const { return blockIndex; }
+  private:
+    void flushBlock(std::vector<uint8_t>& out);
+
+    uint32_t framesPerBlock;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> compressed;
+    std::vector<int32_t> blockIndex;
+    uint32_t streamSize = 0;
+    // The first block only holds the events from before the first frame
+    bool seenFrame = false;
+    bool blockEndRequested = false;
+    int32_t blockFirstFrame = GAME_FIRST_FRAME - 1;
+    int32_t nextBlockFrame = GAME_FIRST_FRAME;
+    int32_t lastFrame = GAME_FIRST_FRAME - 1;
+  };
+
+  enum class ParseMode {
+    // Reads the file through a stream and decodes every frame into a FrameData
+    Buffered,
+    // Maps the file and only builds a FrameIndexEntry per frame. GetFrame and GetFrameAt are not
+    // available, use GetFrameEntry, GetFrameEntryAt and GetPlayerFrame instead
+    Mapped,
+  };
+
+  // Read-only mapping of a replay file that may still be growing
+  class MappedFile
+  {
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+    bool Open(const std::string& path);
+    // Maps whatever was added to the file since the last call, returns the mapped size
+    size_t Refresh();
+    uint8_t* Data() const { return base; }
+    size_t Size() const { return size; }
+  private:
+    void unmap();
+
+    uint8_t* base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* handle = nullptr;
+    void* mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+  };
+
   class SlippiGame
   {
   public:
-    static std::unique_ptr<SlippiGame> FromFile(std::string path);
+    static std::unique_ptr<SlippiGame> FromFile(std::string path, ParseMode mode = ParseMode::Buffered);
     bool AreSettingsLoaded();
     bool DoesFrameExist(int32_t frame);
     std::array<uint8_t, 4> GetVersion();
@@ -140,7 +304,20 @@ namespace Slippi {
     uint8_t GetGameEndMethod();
     bool DoesPlayerExist(int8_t port);
     bool IsProcessingComplete();
+    // True for replays with a compressed event stream. Both parse modes read them, the mapped mode
+    // only keeps one inflated block around at a time
+    bool IsCompressed();
+
+    // Mapped mode accessors. The returned entries stay valid for the lifetime of the game
+    const FrameIndexEntry* GetFrameEntry(int32_t frame);
+    const FrameIndexEntry* GetFrameEntryAt(uint32_t pos);
+    bool GetPlayerFrame(const FrameIndexEntry* entry, uint8_t port, bool isFollower, PlayerFrameData* out);
+    // Brings the frame store up to date with everything parsed so far and returns it. Mapped
+    // mode only
+    const FrameStore& GetFrameStore();
   private:
+    void decodeFrameStorePlayer(const FrameIndexEntry& entry, size_t pos, int slot);
+
     std::unique_ptr<Game> game;
     std::unique_ptr<std::ifstream> file;
     std::vector<uint8_t> rawData;
@@ -149,7 +326,26 @@ namespace Slippi {
     std::vector<uint8_t> splitMessageBuf;
     bool shouldResetSplitMessageBuf = false;
 
+    ParseMode mode = ParseMode::Buffered;
+    MappedFile mappedFile;
+    size_t mappedPos = 0;
+    std::unordered_map<uint8_t, uint32_t> messageSizes;
+    FrameStore frameStore;
+
+    // Compressed replays only
+    bool isCompressed = false;
+    std::vector<CompressedBlock> blocks;
+    std::vector<uint8_t> blockBuffer;
+    int64_t bufferedBlock = -1;
+
     bool isProcessingComplete = false;
     void processData();
+    void processCompressedData();
+    int processEvents(uint8_t* buf, int size);
+    void processMappedData();
+    void processMappedEvents(uint8_t* buf, size_t len, size_t& pos, uint32_t streamOffset);
+    bool readCompressedBlock(uint8_t* base, size_t len, size_t pos, CompressedBlock& block);
+    bool inflateBlock(const uint8_t* src, const CompressedBlock& block);
+    uint8_t* streamData(uint32_t offset);
   };
 }
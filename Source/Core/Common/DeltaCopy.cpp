@@ -0,0 +1,115 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "Common/CPUDetect.h"
+#include "Common/DeltaCopy.h"
+#include "Common/Intrinsics.h"
+
+namespace Common
+{
+// Compares and copies the trailing partial chunk, shared by every implementation
+static size_t DeltaCopyTail(u8* dst, const u8* src, size_t size)
+{
+	if (size == 0 || memcmp(dst, src, size) == 0)
+		return 0;
+
+	memcpy(dst, src, size);
+	return size;
+}
+
+size_t DeltaCopyGeneric(u8* dst, const u8* src, size_t size)
+{
+	size_t written = 0;
+	size_t offset = 0;
+	for (; offset + DELTA_COPY_CHUNK_SIZE <= size; offset += DELTA_COPY_CHUNK_SIZE)
+	{
+		u64 a[DELTA_COPY_CHUNK_SIZE / 8];
+		u64 b[DELTA_COPY_CHUNK_SIZE / 8];
+		memcpy(a, dst + offset, sizeof(a));
+		memcpy(b, src + offset, sizeof(b));
+
+		u64 diff = 0;
+		for (int i = 0; i < DELTA_COPY_CHUNK_SIZE / 8; i++)
+			diff |= a[i] ^ b[i];
+
+		if (diff)
+		{
+			memcpy(dst + offset, src + offset, DELTA_COPY_CHUNK_SIZE);
+			written += DELTA_COPY_CHUNK_SIZE;
+		}
+	}
+
+	return written + DeltaCopyTail(dst + offset, src + offset, size - offset);
+}
+
+#ifdef _M_X86
+size_t DeltaCopySSE2(u8* dst, const u8* src, size_t size)
+{
+	size_t written = 0;
+	size_t offset = 0;
+	for (; offset + DELTA_COPY_CHUNK_SIZE <= size; offset += DELTA_COPY_CHUNK_SIZE)
+	{
+		__m128i s0 = _mm_loadu_si128((const __m128i*)(src + offset));
+		__m128i s1 = _mm_loadu_si128((const __m128i*)(src + offset + 16));
+		__m128i s2 = _mm_loadu_si128((const __m128i*)(src + offset + 32));
+		__m128i s3 = _mm_loadu_si128((const __m128i*)(src + offset + 48));
+		__m128i d0 = _mm_loadu_si128((const __m128i*)(dst + offset));
+		__m128i d1 = _mm_loadu_si128((const __m128i*)(dst + offset + 16));
+		__m128i d2 = _mm_loadu_si128((const __m128i*)(dst + offset + 32));
+		__m128i d3 = _mm_loadu_si128((const __m128i*)(dst + offset + 48));
+
+		__m128i eq = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(s0, d0), _mm_cmpeq_epi8(s1, d1)),
+		                           _mm_and_si128(_mm_cmpeq_epi8(s2, d2), _mm_cmpeq_epi8(s3, d3)));
+		if (_mm_movemask_epi8(eq) == 0xFFFF)
+			continue;
+
+		_mm_storeu_si128((__m128i*)(dst + offset), s0);
+		_mm_storeu_si128((__m128i*)(dst + offset + 16), s1);
+		_mm_storeu_si128((__m128i*)(dst + offset + 32), s2);
+		_mm_storeu_si128((__m128i*)(dst + offset + 48), s3);
+		written += DELTA_COPY_CHUNK_SIZE;
+	}
+
+	return written + DeltaCopyTail(dst + offset, src + offset, size - offset);
+}
+
+FUNCTION_TARGET_AVX2 size_t DeltaCopyAVX2(u8* dst, const u8* src, size_t size)
+{
+	size_t written = 0;
+	size_t offset = 0;
+	for (; offset + DELTA_COPY_CHUNK_SIZE <= size; offset += DELTA_COPY_CHUNK_SIZE)
+	{
+		__m256i s0 = _mm256_loadu_si256((const __m256i*)(src + offset));
+		__m256i s1 = _mm256_loadu_si256((const __m256i*)(src + offset + 32));
+		__m256i d0 = _mm256_loadu_si256((const __m256i*)(dst + offset));
+		__m256i d1 = _mm256_loadu_si256((const __m256i*)(dst + offset + 32));
+
+		__m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(s0, d0), _mm256_cmpeq_epi8(s1, d1));
+		if (_mm256_movemask_epi8(eq) == -1)
+			continue;
+
+		_mm256_storeu_si256((__m256i*)(dst + offset), s0);
+		_mm256_storeu_si256((__m256i*)(dst + offset + 32), s1);
+		written += DELTA_COPY_CHUNK_SIZE;
+	}
+
+	// Avoid the AVX-SSE transition penalty in whatever runs next
+	_mm256_zeroupper();
+
+	return written + DeltaCopyTail(dst + offset, src + offset, size - offset);
+}
+#endif
+
+size_t DeltaCopy(u8* dst, const u8* src, size_t size)
+{
+#ifdef _M_X86
+	static const auto impl = cpu_info.bAVX2 ? &DeltaCopyAVX2 : &DeltaCopySSE2;
+	return impl(dst, src, size);
+#else
+	return DeltaCopyGeneric(dst, src, size);
+#endif
+}
+}
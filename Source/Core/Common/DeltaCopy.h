@@ -0,0 +1,29 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+enum
+{
+	DELTA_COPY_CHUNK_SIZE = 64,
+};
+
+// Copies size bytes from src to dst one 64 byte chunk at a time, skipping chunks whose contents
+// already match. Untouched destination cache lines stay clean and write-tracked pages are not
+// faulted in. Returns the number of bytes actually written.
+size_t DeltaCopy(u8* dst, const u8* src, size_t size);
+
+// Implementations exposed for testing and benchmarking, DeltaCopy picks the best one available
+size_t DeltaCopyGeneric(u8* dst, const u8* src, size_t size);
+#ifdef _M_X86
+size_t DeltaCopySSE2(u8* dst, const u8* src, size_t size);
+size_t DeltaCopyAVX2(u8* dst, const u8* src, size_t size);
+#endif
+}
@@ -43,6 +43,10 @@
 #include <sys/param.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/falloc.h>
+#endif
+
 #ifndef S_ISDIR
 #define S_ISDIR(m) (((m)&S_IFMT) == S_IFDIR)
 #endif
@@ -1104,4 +1108,34 @@ bool IOFile::Resize(u64 size)
 	return m_good;
 }
 
+bool IOFile::Reserve(u64 size)
+{
+	if (!IsOpen())
+		return false;
+
+#ifdef _WIN32
+	FILE_ALLOCATION_INFO info;
+	info.AllocationSize.QuadPart = size;
+	HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file)));
+	return SetFileInformationByHandle(handle, FileAllocationInfo, &info, sizeof(info)) != 0;
+#elif defined(__APPLE__)
+	// F_PREALLOCATE only ever adds space past what is already allocated
+	fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, 0, 0};
+	struct stat st;
+	if (fstat(fileno(m_file), &st) != 0 || (u64)st.st_blocks * 512 >= size)
+		return true;
+	store.fst_length = size - (u64)st.st_blocks * 512;
+	if (fcntl(fileno(m_file), F_PREALLOCATE, &store) == -1)
+	{
+		store.fst_flags = F_ALLOCATEALL;
+		return fcntl(fileno(m_file), F_PREALLOCATE, &store) != -1;
+	}
+	return true;
+#elif defined(__linux__)
+	return fallocate(fileno(m_file), FALLOC_FL_KEEP_SIZE, 0, size) == 0;
+#else
+	return false;
+#endif
+}
+
 } // namespace File
@@ -232,6 +232,10 @@ class IOFile : public NonCopyable
 	u64 Tell() const;
 	u64 GetSize();
 	bool Resize(u64 size);
+	// Asks the file system to allocate space for the first size bytes without changing the file
+	// size, so the file can grow into it without fragmenting. Best effort, a failure leaves the
+	// file untouched.
+	bool Reserve(u64 size);
 	bool Flush();
 
 	// clear error state
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <iterator>
 #include <string>
 
 #include "Common/GL/GLInterface/GLX.h"
@@ -120,6 +121,8 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 	{
 		ctx = glXCreateContextAttribs(dpy, fbconfig, 0, True, context_attribs);
 		XSync(dpy, False);
+		if (ctx && !s_glxError)
+			m_attribs.assign(std::begin(context_attribs), std::end(context_attribs));
 	}
 	if (core && (!ctx || s_glxError))
 	{
@@ -135,6 +138,8 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 		s_glxError = false;
 		ctx = glXCreateContextAttribs(dpy, fbconfig, 0, True, context_attribs_33);
 		XSync(dpy, False);
+		if (ctx && !s_glxError)
+			m_attribs.assign(std::begin(context_attribs_33), std::end(context_attribs_33));
 	}
 	if (!ctx || s_glxError)
 	{
@@ -175,8 +180,46 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 	return true;
 }
 
+bool cInterfaceGLX::Create(cInterfaceBase* main_context)
+{
+	cInterfaceGLX* glx_context = static_cast<cInterfaceGLX*>(main_context);
+	if (glx_context->m_attribs.empty())
+		return false;
+
+	dpy = glx_context->dpy;
+	fbconfig = glx_context->fbconfig;
+	m_attribs = glx_context->m_attribs;
+	m_is_shared = true;
+	// Never drawn to, core contexts can be made current without a drawable
+	win = None;
+
+	s_glxError = false;
+	XErrorHandler oldHandler = XSetErrorHandler(&ctxErrorHandler);
+	ctx = glXCreateContextAttribs(dpy, fbconfig, glx_context->ctx, True, m_attribs.data());
+	XSync(dpy, False);
+	XSetErrorHandler(oldHandler);
+	if (!ctx || s_glxError)
+	{
+		ERROR_LOG(VIDEO, "Unable to create a shared GL context.");
+		ctx = nullptr;
+		return false;
+	}
+	return true;
+}
+
+std::unique_ptr<cInterfaceBase> cInterfaceGLX::CreateSharedContext()
+{
+	std::unique_ptr<cInterfaceGLX> context = std::make_unique<cInterfaceGLX>();
+	if (!context->Create(this))
+		return nullptr;
+	return std::move(context);
+}
+
 bool cInterfaceGLX::MakeCurrent()
 {
+	if (m_is_shared)
+		return glXMakeContextCurrent(dpy, None, None, ctx);
+
 	bool success = glXMakeCurrent(dpy, win, ctx);
 	if (success)
 	{
@@ -195,6 +238,15 @@ bool cInterfaceGLX::ClearCurrent()
 // Close backend
 void cInterfaceGLX::Shutdown()
 {
+	if (m_is_shared)
+	{
+		// The display and the window belong to the main context
+		if (ctx)
+			glXDestroyContext(dpy, ctx);
+		ctx = nullptr;
+		return;
+	}
+
 	XWindow.DestroyXWindow();
 	if (ctx)
 	{
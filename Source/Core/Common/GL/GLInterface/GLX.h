@@ -5,7 +5,9 @@
 #pragma once
 
 #include <GL/glx.h>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/GL/GLInterface/X11_Util.h"
 #include "Common/GL/GLInterfaceBase.h"
@@ -18,6 +20,9 @@ private:
 	Window win;
 	GLXContext ctx;
 	GLXFBConfig fbconfig;
+	// Attributes the context was created with, empty for a legacy context. Shared contexts are only
+	// made for core contexts, which can be made current without a drawable.
+	std::vector<int> m_attribs;
 
 public:
 	friend class cX11Window;
@@ -25,6 +30,8 @@ public:
 	void Swap() override;
 	void* GetFuncAddress(const std::string& name) override;
 	bool Create(void* window_handle, bool core) override;
+	bool Create(cInterfaceBase* main_context) override;
+	std::unique_ptr<cInterfaceBase> CreateSharedContext() override;
 	bool MakeCurrent() override;
 	bool ClearCurrent() override;
 	void Shutdown() override;
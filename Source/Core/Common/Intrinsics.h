@@ -28,4 +28,14 @@
 # endif
 #endif
 
+// Allows the use of instruction set extensions above the compile-time baseline in individual
+// functions. Callers have to check cpu_info before calling them.
+#if defined(_MSC_VER)
+#define FUNCTION_TARGET_SSE41
+#define FUNCTION_TARGET_AVX2
+#else
+#define FUNCTION_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define FUNCTION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
 #endif // _M_X86
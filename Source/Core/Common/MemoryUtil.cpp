@@ -224,6 +224,24 @@ void* AllocateMemoryPages(size_t size)
 	return ptr;
 }
 
+void* AllocatePrefaultedMemoryPages(size_t size)
+{
+	void* ptr = AllocateMemoryPages(size);
+	if (ptr == nullptr)
+		return nullptr;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	// Only a hint, transparent huge pages may be disabled system-wide
+	madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+
+	volatile u8* bytes = static_cast<u8*>(ptr);
+	for (size_t offset = 0; offset < size; offset += 0x1000)
+		bytes[offset] = 0;
+
+	return ptr;
+}
+
 void* AllocateAlignedMemory(size_t size, size_t alignment)
 {
 #ifdef _WIN32
@@ -384,4 +402,15 @@ size_t MemPhysical()
 #endif
 }
 
+size_t MemPageSize()
+{
+#ifdef _WIN32
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	return sysInfo.dwPageSize;
+#else
+	return (size_t)getpagesize();
+#endif
+}
+
 }  // namespace Common
@@ -11,6 +11,9 @@ namespace Common
 {
 void* AllocateExecutableMemory(size_t size, bool low = true);
 void* AllocateMemoryPages(size_t size);
+// Same as AllocateMemoryPages, but asks for huge pages where the OS supports it and touches every
+// page up front so that first use never page faults. Free with FreeMemoryPages.
+void* AllocatePrefaultedMemoryPages(size_t size);
 void FreeMemoryPages(void* ptr, size_t size);
 void* AllocateAlignedMemory(size_t size, size_t alignment);
 void FreeAlignedMemory(void* ptr);
@@ -19,6 +22,8 @@ void WriteProtectMemory(void* ptr, size_t size, bool executable = false);
 void UnWriteProtectMemory(void* ptr, size_t size, bool allowExecute = false);
 std::string MemUsage();
 size_t MemPhysical();
+// Granularity of WriteProtectMemory and UnWriteProtectMemory
+size_t MemPageSize();
 
 template <typename T>
 class SimpleBuf
@@ -0,0 +1,110 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// A lock-free byte ring for exactly one producer and one consumer thread. Unlike FifoQueue nothing
+// is allocated per element, the producer copies straight into storage that is allocated once.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+class SPSCRingBuffer
+{
+public:
+	// capacity is rounded up to a power of two
+	explicit SPSCRingBuffer(size_t capacity)
+	{
+		m_capacity = 1;
+		while (m_capacity < capacity)
+			m_capacity <<= 1;
+		m_data = std::make_unique<u8[]>(m_capacity);
+	}
+
+	size_t Capacity() const { return m_capacity; }
+
+	// Producer side. Copies both spans back to back and publishes them at once, so the consumer
+	// never sees one without the other. Returns false without writing anything if they don't fit.
+	bool Push(const void *first, size_t first_size, const void *second = nullptr, size_t second_size = 0)
+	{
+		const u64 write = m_write.load(std::memory_order_relaxed);
+		const u64 read = m_read.load(std::memory_order_acquire);
+		if (first_size + second_size > m_capacity - (size_t)(write - read))
+			return false;
+
+		CopyIn(write, first, first_size);
+		CopyIn(write + first_size, second, second_size);
+		m_write.store(write + first_size + second_size, std::memory_order_release);
+		return true;
+	}
+
+	// Producer side
+	size_t FreeSpace() const
+	{
+		return m_capacity - (size_t)(m_write.load(std::memory_order_relaxed) - m_read.load(std::memory_order_acquire));
+	}
+
+	// Consumer side
+	size_t Available() const
+	{
+		return (size_t)(m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_relaxed));
+	}
+
+	// Consumer side. Copies size bytes from the front without consuming them.
+	bool Peek(void *dst, size_t size) const
+	{
+		if (Available() < size)
+			return false;
+
+		CopyOut(m_read.load(std::memory_order_relaxed), dst, size);
+		return true;
+	}
+
+	// Consumer side
+	bool Pop(void *dst, size_t size)
+	{
+		if (!Peek(dst, size))
+			return false;
+
+		m_read.store(m_read.load(std::memory_order_relaxed) + size, std::memory_order_release);
+		return true;
+	}
+
+private:
+	void CopyIn(u64 pos, const void *src, size_t size)
+	{
+		const size_t offset = (size_t)(pos & (m_capacity - 1));
+		const size_t head = std::min(size, m_capacity - offset);
+		if (head)
+			std::memcpy(&m_data[offset], src, head);
+		if (size > head)
+			std::memcpy(&m_data[0], static_cast<const u8 *>(src) + head, size - head);
+	}
+
+	void CopyOut(u64 pos, void *dst, size_t size) const
+	{
+		const size_t offset = (size_t)(pos & (m_capacity - 1));
+		const size_t head = std::min(size, m_capacity - offset);
+		if (head)
+			std::memcpy(dst, &m_data[offset], head);
+		if (size > head)
+			std::memcpy(static_cast<u8 *>(dst) + head, &m_data[0], size - head);
+	}
+
+	std::unique_ptr<u8[]> m_data;
+	size_t m_capacity;
+
+	// Running byte counts that never wrap in practice, kept on separate cache lines so the two
+	// threads don't fight over them
+	alignas(64) std::atomic<u64> m_write{0};
+	alignas(64) std::atomic<u64> m_read{0};
+};
+} // namespace Common
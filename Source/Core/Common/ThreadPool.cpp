@@ -6,14 +6,14 @@
 #endif
 using namespace Common;
 
-ThreadPool::ThreadPool(): m_workflag(0), m_workercount(0), m_workers(16)
+ThreadPool::ThreadPool(): m_workers(16), m_workflag(0), m_workercount(0)
 {
 	m_working.store(true);
 	int workers = cpu_info.logical_cpu_count - 1;
 	workers = workers < 1 ? 1 : workers;
-	for (size_t i = 0; i < workers; i++)
+	for (int i = 0; i < workers; i++)
 	{
-		std::thread* current = new std::thread(&ThreadPool::Workloop, std::ref(*this), i);
+		std::thread* current = new std::thread(&ThreadPool::Workloop, std::ref(*this), static_cast<size_t>(i));
 		m_workerThreads.push_back(std::unique_ptr<std::thread>(current));
 #ifdef _WIN32
 		SetThreadPriority(current->native_handle(), THREAD_MODE_BACKGROUND_BEGIN);
@@ -78,7 +78,7 @@ void ThreadPool::Workloop(ThreadPool &state, size_t ID)
 	u32 rest_time = 1;
 	while (state.m_working.load())
 	{
-		if (state.m_workflag.load() > ID)
+		if (state.m_workflag.load() > static_cast<s32>(ID))
 		{
 			bool worked = false;
 			u32 count = state.m_workercount.load();
@@ -99,7 +99,7 @@ void ThreadPool::Workloop(ThreadPool &state, size_t ID)
 				Common::YieldCPU();
 				continue;
 			}
-			else if (state.m_workflag.load() > ID)
+			else if (state.m_workflag.load() > static_cast<s32>(ID))
 			{
 				state.m_workflag.fetch_sub(1);
 			}
@@ -153,4 +153,89 @@ void AsyncWorker::ExecuteAsync(std::function<void()> &&func)
 	ThreadPool::NotifyWorkPending();
 }
 
+WorkerGroup::WorkerGroup(size_t threadCount): m_func(nullptr), m_count(0), m_next(0), m_done(0)
+{
+	m_running.store(true);
+	for (size_t i = 0; i < threadCount; i++)
+		m_wake.push_back(std::make_unique<Event>());
+	for (size_t i = 0; i < threadCount; i++)
+		m_threads.emplace_back(&WorkerGroup::WorkerLoop, this, i);
+}
+
+WorkerGroup::~WorkerGroup()
+{
+	m_running.store(false);
+	for (auto& wake : m_wake)
+		wake->Set();
+	for (auto& thread : m_threads)
+		thread.join();
+}
+
+size_t WorkerGroup::GetParallelism() const
+{
+	return m_threads.size() + 1;
+}
+
+// Slice index that marks a job as not claimable while Run() sets it up
+static const u64 SLICES_CLOSED = 0xFFFFFFFF;
+
+void WorkerGroup::RunSlices()
+{
+	u64 next = m_next.load();
+	while (true)
+	{
+		if ((next & SLICES_CLOSED) == SLICES_CLOSED)
+			return;
+		// The count is read after the generation it goes with, Run() closes the job before changing it
+		const size_t count = m_count.load();
+		const size_t i = static_cast<size_t>(next & SLICES_CLOSED);
+		if (i >= count)
+			return;
+		if (!m_next.compare_exchange_weak(next, next + 1))
+			continue;
+
+		// Run() can't return, nor start another job, before this slice is done
+		(*m_func)(i);
+		m_done.fetch_add(1);
+		next = m_next.load();
+	}
+}
+
+void WorkerGroup::WorkerLoop(size_t ID)
+{
+	Common::SetCurrentThreadName("Worker group thread");
+	while (true)
+	{
+		m_wake[ID]->Wait();
+		if (!m_running.load())
+			return;
+
+		RunSlices();
+	}
+}
 
+void WorkerGroup::Run(size_t count, const std::function<void(size_t)>& func)
+{
+	if (m_threads.empty() || count < 2)
+	{
+		for (size_t i = 0; i < count; i++)
+			func(i);
+		return;
+	}
+
+	const u64 generation = (m_next.load() >> 32) + 1;
+	m_next.store(generation << 32 | SLICES_CLOSED);
+	m_func = &func;
+	m_count.store(count);
+	m_done.store(0);
+	m_next.store(generation << 32);
+	for (auto& wake : m_wake)
+		wake->Set();
+
+	RunSlices();
+
+	// Only the slices workers are still running are left. They are short, and this is usually the
+	// CPU thread, so spin rather than risk sleeping for a whole scheduler tick.
+	while (m_done.load() < count)
+		Common::YieldCPU();
+}
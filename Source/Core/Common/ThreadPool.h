@@ -35,6 +35,7 @@
 #include <memory>
 #include <vector>
 
+#include "Common/Event.h"
 #include "Common/Thread.h"
 
 namespace Common
@@ -228,17 +229,17 @@ private:
 	std::atomic<size_t>  m_head;
 public:
 	CircularQueue(size_t capacity):
+		m_capacity(capacity),
 		m_tail(0),
-		m_head(0),
-		m_capacity(capacity)
+		m_head(0)
 	{
 		m_container.resize(capacity);
 	}
 
 	CircularQueue():
+		m_capacity(128),
 		m_tail(0),
-		m_head(0),
-		m_capacity(128)
+		m_head(0)
 	{
 		m_container.resize(m_capacity);
 	}
@@ -386,9 +387,9 @@ private:
 	Container m_inner;
 public:
 	ManyToManyQueue():
-		m_inner(),
 		m_dequeueLock(),
-		m_equeueLock()
+		m_equeueLock(),
+		m_inner()
 	{
 
 	}
@@ -471,4 +472,34 @@ public:
 	bool NextTask() override;
 	static void ExecuteAsync(std::function<void()> &&func);
 };
+
+// Fixed group of persistent threads that runs a job split into slices together with the calling
+// thread. Run() only returns once every slice is done, so callers keep the ordering of a serial
+// loop. Meant for short latency sensitive jobs, where waiting for the polling ThreadPool to pick
+// up work would cost more than the work itself.
+class WorkerGroup
+{
+private:
+	std::vector<std::thread> m_threads;
+	std::vector<std::unique_ptr<Event>> m_wake;
+	const std::function<void(size_t)>* m_func;
+	std::atomic<size_t> m_count;
+	// Generation of the job in the upper half, next slice in the lower half. A slice is only claimed
+	// while the generation is unchanged, so a worker that wakes up late never runs a slice of a job
+	// that is already done, or takes the next job for the one it was woken for.
+	std::atomic<u64> m_next;
+	std::atomic<size_t> m_done;
+	std::atomic<bool> m_running;
+	void WorkerLoop(size_t ID);
+	void RunSlices();
+	WorkerGroup(WorkerGroup const&);
+	void operator=(WorkerGroup const&);
+public:
+	explicit WorkerGroup(size_t threadCount);
+	~WorkerGroup();
+	// Number of threads taking part in Run(), including the caller
+	size_t GetParallelism() const;
+	// Calls func(i) for every i in [0, count) spread across the group and the calling thread
+	void Run(size_t count, const std::function<void(size_t)>& func);
+};
 }
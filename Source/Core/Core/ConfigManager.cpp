@@ -259,6 +259,7 @@ void SConfig::SaveCoreSettings(IniFile &ini)
 	core->Set("TimingVariance", iTimingVariance);
 	core->Set("CPUCore", iCPUCore);
 	core->Set("Fastmem", bFastmem);
+	core->Set("JITSuperblocks", bJITSuperblocks);
 	core->Set("CPUThread", bCPUThread);
 	core->Set("DSPHLE", bDSPHLE);
 	core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
@@ -291,10 +292,17 @@ void SConfig::SaveCoreSettings(IniFile &ini)
 	core->Set("SlippiNetplayPort", m_slippiNetplayPort);
 	core->Set("SlippiForceLanIp", m_slippiForceLanIp);
 	core->Set("SlippiLanIp", m_slippiLanIp);
+	core->Set("SlippiIncrementalSavestates", m_slippiIncrementalSavestates);
+	core->Set("SlippiSkipResimulatedDraws", m_slippiSkipResimulatedDraws);
+	core->Set("SlippiBenchmarkResimulatedDraws", m_slippiBenchmarkResimulatedDraws);
 	core->Set("SlippiReplayMonthFolders", m_slippiReplayMonthFolders);
+	core->Set("SlippiCompressReplays", m_slippiCompressReplays);
 	core->Set("SlippiReplayDir", m_strSlippiReplayDir);
 	core->Set("SlippiReplayRegenerateDir", m_strSlippiRegenerateReplayDir);
 	core->Set("SlippiPlaybackDisplayFrameIndex", m_slippiEnableFrameIndex);
+	core->Set("SlippiSeekStateInterval", m_slippiSeekStateInterval);
+	core->Set("SlippiSeekKeyframeInterval", m_slippiSeekKeyframeInterval);
+	core->Set("SlippiSeekStateBudgetMB", m_slippiSeekStateBudgetMB);
 	core->Set("BlockingPipes", m_blockingPipes);
 	core->Set("MemcardAPath", m_strMemoryCardA);
 	core->Set("MemcardBPath", m_strMemoryCardB);
@@ -609,6 +617,7 @@ void SConfig::LoadCoreSettings(IniFile &ini)
 	core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
 	core->Get("Fastmem", &bFastmem, true);
+	core->Get("JITSuperblocks", &bJITSuperblocks, false);
 	core->Get("DSPHLE", &bDSPHLE, true);
 	core->Get("TimingVariance", &iTimingVariance, 8);
 	core->Get("CPUThread", &bCPUThread, true);
@@ -636,7 +645,11 @@ void SConfig::LoadCoreSettings(IniFile &ini)
 	core->Get("SlippiNetplayPort", &m_slippiNetplayPort, 2626);
 	core->Get("SlippiForceLanIp", &m_slippiForceLanIp, false);
 	core->Get("SlippiLanIp", &m_slippiLanIp, "");
+	core->Get("SlippiIncrementalSavestates", &m_slippiIncrementalSavestates, true);
+	core->Get("SlippiSkipResimulatedDraws", &m_slippiSkipResimulatedDraws, false);
+	core->Get("SlippiBenchmarkResimulatedDraws", &m_slippiBenchmarkResimulatedDraws, false);
 	core->Get("SlippiReplayMonthFolders", &m_slippiReplayMonthFolders, false);
+	core->Get("SlippiCompressReplays", &m_slippiCompressReplays, false);
 	std::string default_replay_dir = File::GetHomeDirectory() + DIR_SEP + "Slippi";
 	core->Get("SlippiReplayDir", &m_strSlippiReplayDir, default_replay_dir);
 	if (m_strSlippiReplayDir.empty())
@@ -646,6 +659,9 @@ void SConfig::LoadCoreSettings(IniFile &ini)
 	if (m_strSlippiRegenerateReplayDir.empty())
 		m_strSlippiRegenerateReplayDir = default_regenerate_dir;
 	core->Get("SlippiPlaybackDisplayFrameIndex", &m_slippiEnableFrameIndex, false);
+	core->Get("SlippiSeekStateInterval", &m_slippiSeekStateInterval, 900);
+	core->Get("SlippiSeekKeyframeInterval", &m_slippiSeekKeyframeInterval, 8);
+	core->Get("SlippiSeekStateBudgetMB", &m_slippiSeekStateBudgetMB, 512);
 	core->Get("BlockingPipes", &m_blockingPipes, false);
 	core->Get("MemcardAPath", &m_strMemoryCardA);
 	core->Get("MemcardBPath", &m_strMemoryCardB);
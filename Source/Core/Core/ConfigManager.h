@@ -131,6 +131,7 @@ struct SConfig : NonCopyable
 	bool bJITILOutputIR = false;
 
 	bool bFastmem;
+	bool bJITSuperblocks = false;
 	bool bFPRF = false;
 	bool bAccurateNaNs = false;
 
@@ -162,18 +163,25 @@ struct SConfig : NonCopyable
 	bool m_slippiRegenerateReplays = false;
 	int m_slippiEnableQuickChat = SLIPPI_CHAT_ON;
 	bool m_slippiReplayMonthFolders = false;
+	bool m_slippiCompressReplays = false;
 	std::string m_strSlippiReplayDir;
 	std::string m_strSlippiRegenerateReplayDir;
 	bool m_slippiForceNetplayPort = false;
 	int m_slippiNetplayPort;
 	bool m_slippiForceLanIp = false;
 	std::string m_slippiLanIp = "";
+	bool m_slippiIncrementalSavestates = true;
+	bool m_slippiSkipResimulatedDraws = false;
+	bool m_slippiBenchmarkResimulatedDraws = false;
 	bool m_meleeUserIniBootstrapped = false;
 	bool m_blockingPipes = false;
 	bool m_coutEnabled = false;
 
 	// Slippi Playback
 	bool m_slippiEnableFrameIndex = false;
+	int m_slippiSeekStateInterval = 900;
+	int m_slippiSeekKeyframeInterval = 8;
+	int m_slippiSeekStateBudgetMB = 512;
 
 	bool bDPL2Decoder = false;
 	bool bTimeStretching = false;
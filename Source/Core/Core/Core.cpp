@@ -63,6 +63,7 @@
 #include "Core/PatchEngine.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "Core/Slippi/SlippiNetplay.h"
 #include "Core/Slippi/SlippiPlayback.h"
 #include "Core/Slippi/SlippiReplayComm.h"
@@ -414,10 +415,13 @@ static void CpuThread()
 #ifdef USE_MEMORYWATCHER
 	MemoryWatcher::Init();
 #endif
+	SamplingProfiler::Init();
 
 	// Enter CPU run loop. When we leave it - we are done.
 	CPU::Run();
 
+	SamplingProfiler::Shutdown();
+
 	s_is_started = false;
 
 	if (!_CoreParameter.bCPUThread)
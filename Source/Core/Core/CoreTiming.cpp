@@ -20,6 +20,7 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/VideoBackendBase.h"
@@ -339,6 +340,9 @@ void Advance()
 
 	s_is_global_timer_sane = true;
 
+	// The profiler samples here instead of from an event of its own, which would change the slices
+	SamplingProfiler::Poll();
+
 	while (!s_event_queue.empty() && s_event_queue.front().time <= g_global_timer)
 	{
 		Event evt = std::move(s_event_queue.front());
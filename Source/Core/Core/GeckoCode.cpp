@@ -381,4 +381,24 @@ std::vector<u8> GenerateGct()
 	return res;
 }
 
+std::vector<GctEntry> GetGctLayout()
+{
+	std::vector<GctEntry> layout;
+	std::lock_guard<std::mutex> lk(active_codes_lock);
+
+	// Past the header, in the order GenerateGct writes the codes
+	u32 offset = 8;
+	for (const GeckoCode &active_code : active_codes)
+	{
+		if ((active_code.enabled && !IsDisabledMeleeCode(active_code)) || IsEnabledMeleeCode(active_code))
+		{
+			const u32 size = static_cast<u32>(active_code.codes.size()) * 8;
+			layout.push_back({offset, size, active_code.name});
+			offset += size;
+		}
+	}
+
+	return layout;
+}
+
 } // namespace Gecko
@@ -39,10 +39,19 @@ public:
 	bool Exist(u32 address, u32 data) const;
 };
 
+// Where a code is in the GCT that GenerateGct makes
+struct GctEntry
+{
+	u32 offset;
+	u32 size;
+	std::string name;
+};
+
 void SetActiveCodes(const std::vector<GeckoCode>& gcodes);
 bool RunActiveCodes();
 void RunCodeHandler();
 u32 GetGctLength();
 std::vector<u8> GenerateGct();
+std::vector<GctEntry> GetGctLayout();
 
 } // namespace Gecko
@@ -9,6 +9,9 @@
 #include "Core/Slippi/SlippiReplayComm.h"
 #include <SlippiLib/SlippiGame.h>
 
+#include <cinttypes>
+#include <future>
+#include <open-vcdiff/src/google/vcencoder.h>
 #include <semver/include/semver200.h>
 #include <utility> // std::move
 
@@ -20,9 +23,11 @@
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "Core/HW/Memmap.h"
 
 #include "AudioCommon/AudioCommon.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/OnScreenDisplay.h"
 
 #include "Core/Core.h"
@@ -36,6 +41,7 @@
 #include "Core/GeckoCode.h"
 // #include "Core/PatchEngine.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 
 // Not clean but idk a better way atm
 #include "DolphinWX/Frame.h"
@@ -47,6 +53,15 @@
 #define FRAME_INTERVAL 900
 #define SLEEP_TIME_MS 8
 #define WRITE_FILE_SLEEP_TIME_MS 85
+// Payload bytes queued before the write thread is woken up early
+#define WRITE_FILE_WAKE_BYTES 0x10000
+#define WRITE_FILE_RING_SIZE 0x100000
+// How far ahead of the data the replay file gets space allocated
+#define WRITE_FILE_RESERVE_BYTES 0x200000
+// Frames per block of a compressed replay, this is what playback has to inflate to get at a frame
+#define REPLAY_BLOCK_FRAMES 300
+// Longest a compressed replay holds events back from the file, for readers of a game in progress
+#define REPLAY_BLOCK_MAX_MS 1000
 
 // #define LOCAL_TESTING
 // #define CREATE_DIFF_FILES
@@ -300,10 +315,11 @@ CEXISlippi::~CEXISlippi()
 	// Closes file gracefully to prevent file corruption when emulation
 	// suddenly stops. This would happen often on netplay when the opponent
 	// would close the emulation before the file successfully finished writing
-	writeToFileAsync(&empty[0], 0, "close");
+	writeToFileAsync(&empty[0], 0, WRITE_OP_CLOSE);
 	writeThreadRunning = false;
 	if (m_fileWriteThread.joinable())
 	{
+		fileWriteEvent.Set();
 		m_fileWriteThread.join();
 	}
 	m_slippiserver->endGame(true);
@@ -325,6 +341,8 @@ CEXISlippi::~CEXISlippi()
 	// Kill threads to prevent cleanup crash
 	g_playbackStatus->resetPlayback();
 
+	logResimulationStats();
+
 	// Instruct the Rust EXI device to shut down/drop everything.
 	slprs_exi_device_destroy(slprs_exi_device_ptr);
 
@@ -478,11 +496,23 @@ std::vector<u8> CEXISlippi::generateMetadata()
 	metadata.insert(metadata.end(),
 	                {'U', 8, 'p', 'l', 'a', 'y', 'e', 'd', 'O', 'n', 'S', 'U', 7, 'd', 'o', 'l', 'p', 'h', 'i', 'n'});
 
+	// Stream offset and first frame of every block of a compressed replay, so a reader can jump
+	// to a frame without walking the stream
+	if (replayBlockWriter)
+	{
+		const std::vector<s32> &blockIndex = replayBlockWriter->BlockIndex();
+		metadata.insert(metadata.end(),
+		                {'U', 10, 'b', 'l', 'o', 'c', 'k', 'I', 'n', 'd', 'e', 'x', '[', '$', 'l', '#', 'l'});
+		appendWordToBuffer(&metadata, (u32)blockIndex.size());
+		for (s32 value : blockIndex)
+			appendWordToBuffer(&metadata, (u32)value);
+	}
+
 	metadata.push_back('}');
 	return metadata;
 }
 
-void CEXISlippi::writeToFileAsync(u8 *payload, u32 length, std::string fileOption)
+void CEXISlippi::writeToFileAsync(u8 *payload, u32 length, WriteOp op)
 {
 #ifndef IS_PLAYBACK
 	bool shouldSaveReplays = SConfig::GetInstance().m_slippiSaveReplays;
@@ -495,9 +525,10 @@ void CEXISlippi::writeToFileAsync(u8 *payload, u32 length, std::string fileOptio
 		return;
 	}
 
-	if (fileOption == "create" && !writeThreadRunning)
+	if (op == WRITE_OP_CREATE && !writeThreadRunning)
 	{
 		WARN_LOG(SLIPPI, "Creating file write thread...");
+		fileWriteRing = std::make_unique<Common::SPSCRingBuffer>(WRITE_FILE_RING_SIZE);
 		writeThreadRunning = true;
 		m_fileWriteThread = std::thread(&CEXISlippi::FileWriteThread, this);
 	}
@@ -507,56 +538,88 @@ void CEXISlippi::writeToFileAsync(u8 *payload, u32 length, std::string fileOptio
 		return;
 	}
 
-	std::vector<u8> payloadData;
-	payloadData.insert(payloadData.end(), payload, payload + length);
+	WriteRecordHeader header = {length, op};
+	if (sizeof(header) + length > fileWriteRing->Capacity())
+	{
+		ERROR_LOG(SLIPPI, "Payload of %u bytes does not fit in the file write ring, dropping it", length);
+		return;
+	}
 
-	auto writeMsg = std::make_unique<WriteMessage>();
-	writeMsg->data = payloadData;
-	writeMsg->operation = fileOption;
+	// The ring only fills up if the disk can't keep up at all. Wait for the write thread in that case
+	// rather than leave a hole in the replay.
+	while (!fileWriteRing->Push(&header, sizeof(header), payload, length))
+	{
+		fileWriteEvent.Set();
+		Common::YieldCPU();
+	}
 
-	fileWriteQueue.Push(std::move(writeMsg));
+	// Most payloads are left for the write thread to pick up on its next interval so they get written
+	// together, only wake it early once a good amount has piled up or the file changes
+	unsignaledWriteBytes += length;
+	if (op != WRITE_OP_DATA || unsignaledWriteBytes >= WRITE_FILE_WAKE_BYTES)
+	{
+		unsignaledWriteBytes = 0;
+		fileWriteEvent.Set();
+	}
 }
 
 void CEXISlippi::FileWriteThread(void)
 {
-	while (writeThreadRunning || !fileWriteQueue.Empty())
+	Common::SetCurrentThreadName("Slippi replay writer");
+
+	while (true)
 	{
-		// Process all messages
-		while (!fileWriteQueue.Empty())
-		{
-			writeToFile(std::move(fileWriteQueue.Front()));
-			fileWriteQueue.Pop();
+		fileWriteEvent.WaitFor(std::chrono::milliseconds(WRITE_FILE_SLEEP_TIME_MS));
+
+		// Checked before draining, anything pushed before the flag was cleared is still picked up
+		bool stopping = !writeThreadRunning;
 
-			Common::SleepCurrentThread(0);
+		WriteRecordHeader header;
+		while (fileWriteRing->Pop(&header, sizeof(header)))
+		{
+			// The payload is pushed together with its header so it is always there
+			fileWriteRecord.resize(header.length);
+			fileWriteRing->Pop(fileWriteRecord.data(), header.length);
+			writeToFile(header.op, fileWriteRecord.data(), header.length);
 		}
 
-		Common::SleepCurrentThread(WRITE_FILE_SLEEP_TIME_MS);
+		flushFileWriteBuffer();
+
+		if (stopping)
+		{
+			break;
+		}
 	}
 }
 
-void CEXISlippi::writeToFile(std::unique_ptr<WriteMessage> msg)
+void CEXISlippi::writeToFile(WriteOp op, u8 *payload, u32 length)
 {
-	if (!msg)
+	if (op == WRITE_OP_CREATE)
 	{
-		ERROR_LOG(SLIPPI, "Unexpected error: write message is falsy.");
-		return;
-	}
-
-	u8 *payload = msg->data.data();
-	u32 length = (u32)msg->data.size();
-	std::string fileOption = msg->operation;
+		// Whatever is left belongs to the previous file
+		flushFileWriteBuffer();
 
-	std::vector<u8> dataToWrite;
-	if (fileOption == "create")
-	{
 		// If the game sends over option 1 that means a file should be created
 		createNewFile();
+		fileWriteOffset = 0;
+		fileReservedSize = 0;
 
 		// Start ubjson file and prepare the "raw" element that game
 		// data output will be dumped into. The size of the raw output will
-		// be initialized to 0 until all of the data has been received
-		std::vector<u8> headerBytes({'{', 'U', 3, 'r', 'a', 'w', '[', '$', 'U', '#', 'l', 0, 0, 0, 0});
-		dataToWrite.insert(dataToWrite.end(), headerBytes.begin(), headerBytes.end());
+		// be initialized to 0 until all of the data has been received.
+		// Compressed replays put the blocks of the event stream in "rawz" instead
+		if (SConfig::GetInstance().m_slippiCompressReplays)
+		{
+			replayBlockWriter = std::make_unique<Slippi::CompressedBlockWriter>(REPLAY_BLOCK_FRAMES);
+			replayBlockStartMs = Common::Timer::GetTimeMs();
+			fileWriteBuffer.insert(fileWriteBuffer.end(),
+			                       {'{', 'U', 4, 'r', 'a', 'w', 'z', '[', '$', 'U', '#', 'l', 0, 0, 0, 0});
+		}
+		else
+		{
+			replayBlockWriter.reset();
+			fileWriteBuffer.insert(fileWriteBuffer.end(), {'{', 'U', 3, 'r', 'a', 'w', '[', '$', 'U', '#', 'l', 0, 0, 0, 0});
+		}
 
 		// Used to keep track of how many bytes have been written to the file
 		writtenByteCount = 0;
@@ -583,6 +646,7 @@ void CEXISlippi::writeToFile(std::unique_ptr<WriteMessage> msg)
 	// If no file, do nothing
 	if (!m_file)
 	{
+		fileWriteBuffer.clear();
 		return;
 	}
 
@@ -590,42 +654,93 @@ void CEXISlippi::writeToFile(std::unique_ptr<WriteMessage> msg)
 	updateMetadataFields(payload, length);
 
 	// Add the payload to data to write
-	dataToWrite.insert(dataToWrite.end(), payload, payload + length);
-	writtenByteCount += length;
+	if (replayBlockWriter)
+	{
+		u32 nowMs = Common::Timer::GetTimeMs();
+		if (nowMs - replayBlockStartMs >= REPLAY_BLOCK_MAX_MS)
+		{
+			replayBlockWriter->EndBlockAtNextFrame();
+			replayBlockStartMs = nowMs;
+		}
+
+		replayBlockWriter->AddEvent(payload, length, fileWriteBuffer);
+		writtenByteCount = replayBlockWriter->StreamSize();
+	}
+	else
+	{
+		fileWriteBuffer.insert(fileWriteBuffer.end(), payload, payload + length);
+		writtenByteCount += length;
+	}
 
 	// If we are going to close the file, generate data to complete the UBJSON file
-	if (fileOption == "close")
+	if (op == WRITE_OP_CLOSE)
 	{
+		if (replayBlockWriter)
+		{
+			replayBlockWriter->Finish(fileWriteBuffer);
+			writtenByteCount = replayBlockWriter->StreamSize();
+		}
+
 		// This option indicates we are done sending over body
 		std::vector<u8> closingBytes = generateMetadata();
 		closingBytes.push_back('}');
-		dataToWrite.insert(dataToWrite.end(), closingBytes.begin(), closingBytes.end());
+		fileWriteBuffer.insert(fileWriteBuffer.end(), closingBytes.begin(), closingBytes.end());
 
 		// Reset display names and connect codes retrieved from netplay client
 		slippi_names.clear();
 		slippi_connect_codes.clear();
-	}
 
-	// Write data to file
-	bool result = m_file.WriteBytes(&dataToWrite[0], dataToWrite.size());
-	if (!result)
-	{
-		ERROR_LOG(EXPANSIONINTERFACE, "Failed to write data to file.");
-	}
+		flushFileWriteBuffer();
 
-	// If file should be closed, close it
-	if (fileOption == "close")
-	{
 		// Write the number of bytes for the raw output
 		std::vector<u8> sizeBytes = uint32ToVector(writtenByteCount);
-		m_file.Seek(11, 0);
+		m_file.Seek(replayBlockWriter ? 12 : 11, 0);
 		m_file.WriteBytes(&sizeBytes[0], sizeBytes.size());
 
+		// Hand back the space that was reserved past the end of the replay
+		if (fileReservedSize > fileWriteOffset)
+		{
+			m_file.Resize(fileWriteOffset);
+		}
+
 		// Close file
 		closeFile();
+		replayBlockWriter.reset();
 	}
 }
 
+void CEXISlippi::flushFileWriteBuffer()
+{
+	if (fileWriteBuffer.empty() || !m_file)
+	{
+		fileWriteBuffer.clear();
+		return;
+	}
+
+	// Keep space allocated ahead of the data so the file doesn't fragment as it grows a few kilobytes
+	// at a time. The visible size stays the same for anything reading the replay while it's written.
+	u64 end = fileWriteOffset + fileWriteBuffer.size();
+	if (end > fileReservedSize)
+	{
+		fileReservedSize = end + WRITE_FILE_RESERVE_BYTES;
+		if (!m_file.Reserve(fileReservedSize))
+		{
+			// Not supported by the file system, don't try again for this file
+			fileReservedSize = UINT64_MAX;
+		}
+	}
+
+	if (!m_file.WriteBytes(fileWriteBuffer.data(), fileWriteBuffer.size()))
+	{
+		ERROR_LOG(EXPANSIONINTERFACE, "Failed to write data to file.");
+	}
+
+	// Anything following the replay as it's written should see it without waiting on the stdio buffer
+	m_file.Flush();
+	fileWriteOffset = end;
+	fileWriteBuffer.clear();
+}
+
 void CEXISlippi::createNewFile()
 {
 	if (m_file)
@@ -859,23 +974,12 @@ void CEXISlippi::prepareGameInfo(u8 *payload)
 	if (replayCommSettings.rollbackDisplayMethod != "off")
 	{
 		// Prepare savestates
-		availableSavestates.clear();
-		activeSavestates.clear();
-
-		// Prepare savestates for online play
-		for (int i = 0; i < ROLLBACK_MAX_FRAMES; i++)
-		{
-			availableSavestates.push_back(std::make_unique<SlippiSavestate>());
-		}
+		savestatePool.Reset(ROLLBACK_MAX_FRAMES);
 	}
 	else
 	{
-		// Prepare savestates
-		availableSavestates.clear();
-		activeSavestates.clear();
-
-		// Add savestate for testing
-		availableSavestates.push_back(std::make_unique<SlippiSavestate>());
+		// Prepare savestate for testing
+		savestatePool.Reset(1);
 	}
 
 	// Reset playback frame to begining
@@ -963,25 +1067,21 @@ void CEXISlippi::prepareGeckoList()
 	geckoList.insert(geckoList.end(), {0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
 }
 
-void CEXISlippi::prepareCharacterFrameData(Slippi::FrameData *frame, u8 port, u8 isFollower)
+void CEXISlippi::prepareCharacterFrameData(const Slippi::FrameStore &frames, s32 pos, u8 port, u8 isFollower)
 {
-	std::unordered_map<uint8_t, Slippi::PlayerFrameData> source;
-	source = isFollower ? frame->followers : frame->players;
-
 	// This must be updated if new data is added
 	int characterDataLen = 50;
 
+	const Slippi::PlayerColumns &data = frames.players[Slippi::FrameStore::Slot(port, isFollower != 0)];
+
 	// Check if player exists
-	if (!source.count(port))
+	if (!data.present[pos])
 	{
 		// If player does not exist, insert blank section
 		m_read_queue.insert(m_read_queue.end(), characterDataLen, 0);
 		return;
 	}
 
-	// Get data for this player
-	Slippi::PlayerFrameData data = source[port];
-
 	// log << frameIndex << "\t" << port << "\t" << data.locationX << "\t" << data.locationY << "\t" <<
 	// data.animation
 	// << "\n";
@@ -990,31 +1090,30 @@ void CEXISlippi::prepareCharacterFrameData(Slippi::FrameData *frame, u8 port, u8
 	// data.locationY);
 
 	// Add all of the inputs in order
-	appendWordToBuffer(&m_read_queue, data.randomSeed);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.joystickX);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.joystickY);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.cstickX);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.cstickY);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.trigger);
-	appendWordToBuffer(&m_read_queue, data.buttons);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.locationX);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.locationY);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.facingDirection);
-	appendWordToBuffer(&m_read_queue, (u32)data.animation);
-	m_read_queue.push_back(data.joystickXRaw);
-	m_read_queue.push_back(data.joystickYRaw);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&data.percent);
+	appendWordToBuffer(&m_read_queue, data.randomSeed[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.joystickX[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.joystickY[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.cstickX[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.cstickY[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.trigger[pos]);
+	appendWordToBuffer(&m_read_queue, data.buttons[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.locationX[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.locationY[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.facingDirection[pos]);
+	appendWordToBuffer(&m_read_queue, (u32)data.animation[pos]);
+	m_read_queue.push_back(data.joystickXRaw[pos]);
+	m_read_queue.push_back(data.joystickYRaw[pos]);
+	appendWordToBuffer(&m_read_queue, *(u32 *)&data.percent[pos]);
 	// NOTE TO DEV: If you add data here, make sure to increase the size above
 }
 
 bool CEXISlippi::checkFrameFullyFetched(s32 frameIndex)
 {
-	auto doesFrameExist = m_current_game->DoesFrameExist(frameIndex);
-	if (!doesFrameExist)
+	const Slippi::FrameStore &frames = m_current_game->GetFrameStore();
+	s32 pos = frames.PosOfFrame(frameIndex);
+	if (pos < 0)
 		return false;
 
-	Slippi::FrameData *frame = m_current_game->GetFrame(frameIndex);
-
 	version::Semver200_version lastFinalizedVersion("3.7.0");
 	version::Semver200_version currentVersion(m_current_game->GetVersionString());
 
@@ -1028,7 +1127,7 @@ bool CEXISlippi::checkFrameFullyFetched(s32 frameIndex)
 
 	// This flag is set to true after a post frame update has been received. At that point
 	// we know we have received all of the input data for the frame
-	return frame->inputsFullyFetched && frameIsFinalized;
+	return frames.inputsFullyFetched[pos] && frameIsFinalized;
 }
 
 void CEXISlippi::prepareFrameData(u8 *payload)
@@ -1077,7 +1176,8 @@ void CEXISlippi::prepareFrameData(u8 *payload)
 	// next frame has been found to ensure we have actually received all of the
 	// data from this frame. Don't wait until next frame is processing is complete
 	// (this is the last frame, in that case)
-	auto isFrameFound = m_current_game->DoesFrameExist(frameIndex);
+	const Slippi::FrameStore &frames = m_current_game->GetFrameStore();
+	auto isFrameFound = frames.PosOfFrame(frameIndex) >= 0;
 	g_playbackStatus->latestFrame = m_current_game->GetLatestIndex();
 	auto isFrameComplete = checkFrameFullyFetched(frameIndex);
 	auto isFrameReady = isFrameFound && (isProcessingComplete || isFrameComplete);
@@ -1099,15 +1199,15 @@ void CEXISlippi::prepareFrameData(u8 *payload)
 	auto commSettings = g_replayComm->getSettings();
 	if (commSettings.rollbackDisplayMethod == "normal")
 	{
-		auto nextFrame = m_current_game->GetFrameAt(frameSeqIdx);
-		bool shouldHardFFW = nextFrame && nextFrame->frame <= g_playbackStatus->currentPlaybackFrame;
+		bool hasNextFrame = frameSeqIdx < frames.Size();
+		bool shouldHardFFW = hasNextFrame && frames.frame[frameSeqIdx] <= g_playbackStatus->currentPlaybackFrame;
 		g_playbackStatus->setHardFFW(shouldHardFFW);
 
-		if (nextFrame)
+		if (hasNextFrame)
 		{
 			// This feels jank but without this g_playbackStatus ends up getting updated to
 			// a value beyond the frame that actually gets played causes too much FFW
-			frameIndex = nextFrame->frame;
+			frameIndex = frames.frame[frameSeqIdx];
 		}
 	}
 
@@ -1185,15 +1285,14 @@ void CEXISlippi::prepareFrameData(u8 *payload)
 	m_read_queue.push_back(requestResultCode);
 
 	// Get frame
-	Slippi::FrameData *frame = m_current_game->GetFrame(frameIndex);
+	s32 pos = frames.PosOfFrame(frameIndex);
 	if (commSettings.rollbackDisplayMethod != "off")
 	{
-		auto previousFrame = m_current_game->GetFrameAt(frameSeqIdx - 1);
-		frame = m_current_game->GetFrameAt(frameSeqIdx);
+		pos = frameSeqIdx;
 
-		*(s32 *)(&playbackSavestatePayload[0]) = Common::swap32(frame->frame);
+		*(s32 *)(&playbackSavestatePayload[0]) = Common::swap32(frames.frame[pos]);
 
-		if (previousFrame && frame->frame <= previousFrame->frame)
+		if (pos > 0 && frames.frame[pos] <= frames.frame[pos - 1])
 		{
 			// Here we should load a savestate
 			handleLoadSavestate(&playbackSavestatePayload[0]);
@@ -1209,22 +1308,22 @@ void CEXISlippi::prepareFrameData(u8 *payload)
 	// TODO: maybe handle other modes too?
 	if (commSettings.mode == "normal" || commSettings.mode == "queue")
 	{
-		g_playbackStatus->prepareSlippiPlayback(frame->frame);
+		g_playbackStatus->prepareSlippiPlayback(frames.frame[pos]);
 	}
 
 	// Push RB code
 	m_read_queue.push_back(rollbackCode);
 
 	// Add frame rng seed to be restored at priority 0
-	u8 rngResult = frame->randomSeedExists ? 1 : 0;
+	u8 rngResult = frames.randomSeedExists[pos] ? 1 : 0;
 	m_read_queue.push_back(rngResult);
-	appendWordToBuffer(&m_read_queue, *(u32 *)&frame->randomSeed);
+	appendWordToBuffer(&m_read_queue, frames.randomSeed[pos]);
 
 	// Add frame data for every character
 	for (u8 port = 0; port < 4; port++)
 	{
-		prepareCharacterFrameData(frame, port, 0);
-		prepareCharacterFrameData(frame, port, 1);
+		prepareCharacterFrameData(frames, pos, port, 0);
+		prepareCharacterFrameData(frames, pos, port, 1);
 	}
 }
 
@@ -1245,18 +1344,16 @@ void CEXISlippi::prepareIsStockSteal(u8 *payload)
 
 	// I'm not sure checking for the frame should be necessary. Theoretically this
 	// should get called after the frame request so the frame should already exist
-	auto isFrameFound = m_current_game->DoesFrameExist(frameIndex);
-	if (!isFrameFound)
+	const Slippi::FrameStore &frames = m_current_game->GetFrameStore();
+	s32 pos = frames.PosOfFrame(frameIndex);
+	if (pos < 0 || playerIndex >= 4)
 	{
 		m_read_queue.push_back(0);
 		return;
 	}
 
 	// Load the data from this frame into the read buffer
-	Slippi::FrameData *frame = m_current_game->GetFrame(frameIndex);
-	auto players = frame->players;
-
-	u8 playerIsBack = players.count(playerIndex) ? 1 : 0;
+	u8 playerIsBack = frames.players[Slippi::FrameStore::Slot(playerIndex, false)].present[pos];
 	m_read_queue.push_back(playerIsBack);
 }
 
@@ -1335,14 +1432,16 @@ void CEXISlippi::handleOnlineInputs(u8 *payload)
 
 	if (frame == 1)
 	{
-		availableSavestates.clear();
-		activeSavestates.clear();
-
 		// Prepare savestates for online play
-		for (int i = 0; i < ROLLBACK_MAX_FRAMES; i++)
-		{
-			availableSavestates.push_back(std::make_unique<SlippiSavestate>());
-		}
+		savestatePool.Reset(ROLLBACK_MAX_FRAMES);
+
+		logResimulationStats();
+		resimulation.Reset(SConfig::GetInstance().m_slippiSkipResimulatedDraws,
+		                   SConfig::GetInstance().m_slippiBenchmarkResimulatedDraws);
+		Fifo::ResimulationStats gpuStats = Fifo::GetResimulationStats();
+		skippedDrawsAtStart = gpuStats.skipped_draws;
+		skippedCopiesAtStart = gpuStats.skipped_copies;
+		skippedXfbCopiesAtStart = gpuStats.skipped_xfb_copies;
 
 		// Reset stall counter
 		isConnectionStalled = false;
@@ -1364,6 +1463,9 @@ void CEXISlippi::handleOnlineInputs(u8 *payload)
 			slippi_netplay->StartSlippiGame();
 	}
 
+	resimulation.NewFrame(frame, Common::Timer::GetTimeUs());
+	updateResimulation();
+
 	if (isDisconnected())
 	{
 		m_read_queue.push_back(3); // Indicate we disconnected
@@ -1716,36 +1818,10 @@ void CEXISlippi::handleCaptureSavestate(u8 *payload)
 
 	s32 frame = payload[0] << 24 | payload[1] << 16 | payload[2] << 8 | payload[3];
 
-	// u64 startTime = Common::Timer::GetTimeUs();
-
-	// Grab an available savestate
-	std::unique_ptr<SlippiSavestate> ss;
-	if (!availableSavestates.empty())
-	{
-		ss = std::move(availableSavestates.back());
-		availableSavestates.pop_back();
-	}
-	else
-	{
-		// If there were no available savestates, use the oldest one
-		auto it = activeSavestates.begin();
-		ss = std::move(it->second);
-		activeSavestates.erase(it->first);
-	}
-
-	// If there is already a savestate for this frame, remove it and add it to available
-	if (activeSavestates.count(frame))
-	{
-		availableSavestates.push_back(std::move(activeSavestates[frame]));
-		activeSavestates.erase(frame);
-	}
-
-	ss->Capture();
-	activeSavestates[frame] = std::move(ss);
+	savestatePool.Capture(frame);
 
-	// u32 timeDiff = (u32)(Common::Timer::GetTimeUs() - startTime);
-	// INFO_LOG(SLIPPI_ONLINE, "SLIPPI ONLINE: Captured savestate for frame %d in: %f ms", frame,
-	//         ((double)timeDiff) / 1000);
+	resimulation.CaptureState(frame, Common::Timer::GetTimeUs());
+	updateResimulation();
 }
 
 void CEXISlippi::handleLoadSavestate(u8 *payload)
@@ -1753,41 +1829,65 @@ void CEXISlippi::handleLoadSavestate(u8 *payload)
 	s32 frame = payload[0] << 24 | payload[1] << 16 | payload[2] << 8 | payload[3];
 	u32 *preserveArr = (u32 *)(&payload[4]);
 
-	if (!activeSavestates.count(frame))
-	{
-		// This savestate does not exist... uhhh? What do we do?
-		ERROR_LOG(SLIPPI_ONLINE, "SLIPPI ONLINE: Savestate for frame %d does not exist.", frame);
-		return;
-	}
-
-	// u64 startTime = Common::Timer::GetTimeUs();
-
-	// Fetch preservation blocks
-	std::vector<SlippiSavestate::PreserveBlock> blocks;
-
 	// Get preservation blocks
+	preserveBlocks.clear();
 	int idx = 0;
 	while (Common::swap32(preserveArr[idx]) != 0)
 	{
 		SlippiSavestate::PreserveBlock p = {Common::swap32(preserveArr[idx]), Common::swap32(preserveArr[idx + 1])};
-		blocks.push_back(p);
+		preserveBlocks.push_back(p);
 		idx += 2;
 	}
 
 	// Load savestate
-	activeSavestates[frame]->Load(blocks);
-
-	// Move all active savestates to available
-	for (auto it = activeSavestates.begin(); it != activeSavestates.end(); ++it)
+	u64 loadStartUs = Common::Timer::GetTimeUs();
+	if (!savestatePool.Load(frame, preserveBlocks))
 	{
-		availableSavestates.push_back(std::move(it->second));
+		// This savestate does not exist... uhhh? What do we do?
+		ERROR_LOG(SLIPPI_ONLINE, "SLIPPI ONLINE: Savestate for frame %d does not exist.", frame);
+		return;
 	}
 
-	activeSavestates.clear();
+	// The frames from here up to the latest one are run again
+	resimulation.LoadState(frame, loadStartUs);
+	updateResimulation();
+}
+
+void CEXISlippi::updateResimulation()
+{
+	Fifo::SetResimulating(resimulation.IsSkippingDraws());
+	SamplingProfiler::SetResimulating(resimulation.IsResimulating());
+}
+
+void CEXISlippi::logResimulationStats()
+{
+	SlippiResimulation::Stats stats = resimulation.GetStats();
+	if (stats.rollbacks == 0)
+		return;
+
+	Fifo::ResimulationStats gpuStats = Fifo::GetResimulationStats();
+	INFO_LOG(SLIPPI_ONLINE,
+	         "Resimulation: %" PRIu64 " rollbacks, %" PRIu64 " frames, %.1fus per frame, slowest rollback %" PRIu64
+	         "us. Skipped %" PRIu64 " draws, %" PRIu64 " EFB copies and %" PRIu64 " XFB copies",
+	         stats.rollbacks, stats.frames, (double)stats.hostTimeUs / stats.frames, stats.maxRollbackUs,
+	         gpuStats.skipped_draws - skippedDrawsAtStart, gpuStats.skipped_copies - skippedCopiesAtStart,
+	         gpuStats.skipped_xfb_copies - skippedXfbCopiesAtStart);
+
+	if (!SConfig::GetInstance().m_slippiBenchmarkResimulatedDraws)
+		return;
+
+	// Every other rollback skipped its draws, so both sides ran the same game
+	SlippiResimulation::Stats skipped = resimulation.GetStats(true);
+	SlippiResimulation::Stats drawn = resimulation.GetStats(false);
+	if (skipped.frames == 0 || drawn.frames == 0)
+		return;
 
-	// u32 timeDiff = (u32)(Common::Timer::GetTimeUs() - startTime);
-	// INFO_LOG(SLIPPI_ONLINE, "SLIPPI ONLINE: Loaded savestate for frame %d in: %f ms", frame, ((double)timeDiff) /
-	// 1000);
+	double skippedUs = (double)skipped.hostTimeUs / skipped.frames;
+	double drawnUs = (double)drawn.hostTimeUs / drawn.frames;
+	INFO_LOG(SLIPPI_ONLINE,
+	         "Resimulation benchmark: %.1fus per frame drawn (%" PRIu64 " frames), %.1fus per frame skipped (%" PRIu64
+	         " frames), %.1f%% faster",
+	         drawnUs, drawn.frames, skippedUs, skipped.frames, (drawnUs - skippedUs) * 100.0 / drawnUs);
 }
 
 void CEXISlippi::startFindMatch(u8 *payload)
@@ -3157,7 +3257,7 @@ void CEXISlippi::DMAWrite(u32 _uAddr, u32 _uSize)
 		time(&gameStartTime); // Store game start time
 		u8 receiveCommandsLen = memPtr[1];
 		configureCommands(&memPtr[1], receiveCommandsLen);
-		writeToFileAsync(&memPtr[0], receiveCommandsLen + 1, "create");
+		writeToFileAsync(&memPtr[0], receiveCommandsLen + 1, WRITE_OP_CREATE);
 		bufLoc += receiveCommandsLen + 1;
 		g_needInputForFrame = true;
 
@@ -3194,7 +3294,7 @@ void CEXISlippi::DMAWrite(u32 _uAddr, u32 _uSize)
 		switch (byte)
 		{
 		case CMD_RECEIVE_GAME_END:
-			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, "close");
+			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, WRITE_OP_CLOSE);
 			m_slippiserver->write(&memPtr[bufLoc], payloadLen + 1);
 			m_slippiserver->endGame();
 			slprs_exi_device_reporter_push_replay_data(slprs_exi_device_ptr, &memPtr[bufLoc], payloadLen + 1);
@@ -3208,7 +3308,7 @@ void CEXISlippi::DMAWrite(u32 _uAddr, u32 _uSize)
 			break;
 		case CMD_FRAME_BOOKEND:
 			g_needInputForFrame = true;
-			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, "");
+			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, WRITE_OP_DATA);
 			m_slippiserver->write(&memPtr[bufLoc], payloadLen + 1);
 			slprs_exi_device_reporter_push_replay_data(slprs_exi_device_ptr, &memPtr[bufLoc], payloadLen + 1);
 			break;
@@ -3324,7 +3424,7 @@ void CEXISlippi::DMAWrite(u32 _uAddr, u32 _uSize)
 			break;
 		}
 		default:
-			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, "");
+			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, WRITE_OP_DATA);
 			m_slippiserver->write(&memPtr[bufLoc], payloadLen + 1);
 			slprs_exi_device_reporter_push_replay_data(slprs_exi_device_ptr, &memPtr[bufLoc], payloadLen + 1);
 			break;
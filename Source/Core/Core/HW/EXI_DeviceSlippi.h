@@ -5,9 +5,12 @@
 #pragma once
 
 #include <SlippiLib/SlippiGame.h>
+#include <atomic>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/FileUtil.h"
+#include "Common/SPSCRingBuffer.h"
 #include "Core/HW/EXI_Device.h"
 #include "Core/Slippi/SlippiDirectCodes.h"
 #include "Core/Slippi/SlippiExiTypes.h"
@@ -15,7 +18,9 @@
 #include "Core/Slippi/SlippiMatchmaking.h"
 #include "Core/Slippi/SlippiNetplay.h"
 #include "Core/Slippi/SlippiReplayComm.h"
+#include "Core/Slippi/SlippiResimulation.h"
 #include "Core/Slippi/SlippiSavestate.h"
+#include "Core/Slippi/SlippiSavestatePool.h"
 #include "Core/Slippi/SlippiSpectate.h"
 #include "Core/Slippi/SlippiUser.h"
 
@@ -158,10 +163,18 @@ class CEXISlippi : public IEXIDevice
 	    {CMD_PREMADE_TEXT_LOAD, 0x2},
 	};
 
-	struct WriteMessage
+	enum WriteOp : u8
 	{
-		std::vector<u8> data;
-		std::string operation;
+		WRITE_OP_DATA,
+		WRITE_OP_CREATE,
+		WRITE_OP_CLOSE,
+	};
+
+	// Precedes every payload in the file write ring
+	struct WriteRecordHeader
+	{
+		u32 length;
+		WriteOp op;
 	};
 
 	// A pointer to a "shadow" EXI Device that lives on the Rust side of things.
@@ -182,8 +195,9 @@ class CEXISlippi : public IEXIDevice
 
 	void updateMetadataFields(u8 *payload, u32 length);
 	void configureCommands(u8 *payload, u8 length);
-	void writeToFileAsync(u8 *payload, u32 length, std::string fileOption);
-	void writeToFile(std::unique_ptr<WriteMessage> msg);
+	void writeToFileAsync(u8 *payload, u32 length, WriteOp op);
+	void writeToFile(WriteOp op, u8 *payload, u32 length);
+	void flushFileWriteBuffer();
 	std::vector<u8> generateMetadata();
 	void createNewFile();
 	void closeFile();
@@ -204,6 +218,8 @@ class CEXISlippi : public IEXIDevice
 	void handleSendInputs(s32 frame, u8 delay, s32 checksumFrame, u32 checksum, u8 *inputs);
 	void handleCaptureSavestate(u8 *payload);
 	void handleLoadSavestate(u8 *payload);
+	void updateResimulation();
+	void logResimulationStats();
 	void handleNameEntryLoad(u8 *payload);
 	void startFindMatch(u8 *payload);
 	void prepareOnlineMatchState();
@@ -226,7 +242,7 @@ class CEXISlippi : public IEXIDevice
 	// replay playback stuff
 	void prepareGameInfo(u8 *payload);
 	void prepareGeckoList();
-	void prepareCharacterFrameData(Slippi::FrameData *frame, u8 port, u8 isFollower);
+	void prepareCharacterFrameData(const Slippi::FrameStore &frames, s32 pos, u8 port, u8 isFollower);
 	void prepareFrameData(u8 *payload);
 	void prepareIsStockSteal(u8 *payload);
 	void prepareIsFileReady();
@@ -249,8 +265,19 @@ class CEXISlippi : public IEXIDevice
 
 	void FileWriteThread(void);
 
-	Common::FifoQueue<std::unique_ptr<WriteMessage>, false> fileWriteQueue;
-	bool writeThreadRunning = false;
+	// Payloads go from the emulation thread to the write thread through the ring without any
+	// allocations. The write thread gathers them into fileWriteBuffer and writes that out in one go.
+	std::unique_ptr<Common::SPSCRingBuffer> fileWriteRing;
+	Common::Event fileWriteEvent;
+	u32 unsignaledWriteBytes = 0;
+	std::vector<u8> fileWriteRecord;
+	std::vector<u8> fileWriteBuffer;
+	u64 fileWriteOffset = 0;
+	// Set while writing a compressed replay
+	std::unique_ptr<Slippi::CompressedBlockWriter> replayBlockWriter;
+	u32 replayBlockStartMs = 0;
+	u64 fileReservedSize = 0;
+	std::atomic<bool> writeThreadRunning{false};
 	std::thread m_fileWriteThread;
 
 	std::unordered_map<u8, std::string> getNetplayNames();
@@ -311,8 +338,14 @@ class CEXISlippi : public IEXIDevice
 	std::unique_ptr<SlippiDirectCodes> directCodes;
 	std::unique_ptr<SlippiDirectCodes> teamsCodes;
 
-	std::map<s32, std::unique_ptr<SlippiSavestate>> activeSavestates;
-	std::deque<std::unique_ptr<SlippiSavestate>> availableSavestates;
+	SlippiSavestatePool savestatePool;
+	std::vector<SlippiSavestate::PreserveBlock> preserveBlocks;
+
+	SlippiResimulation resimulation;
+	// What the GPU had skipped when the game started
+	u64 skippedDrawsAtStart = 0;
+	u64 skippedCopiesAtStart = 0;
+	u64 skippedXfbCopiesAtStart = 0;
 
 	std::vector<u16> allowedStages;
 };
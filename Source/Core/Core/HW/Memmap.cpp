@@ -7,6 +7,9 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <memory>
 
@@ -15,6 +18,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/DSP.h"
@@ -27,6 +31,7 @@
 #include "Core/HW/SI.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/HW/WII_IPC.h"
+#include "Core/MemTools.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "VideoCommon/CommandProcessor.h"
@@ -213,6 +218,7 @@ void DoState(PointerWrap& p)
 
 void Shutdown()
 {
+	DisableDirtyPageTracking();
 	m_IsInitialized = false;
 	u32 flags = 0;
 	if (SConfig::GetInstance().bWii)
@@ -246,6 +252,228 @@ bool AreMemoryBreakpointsActivated()
 #endif
 }
 
+// Dirty page tracking
+// ----------------
+enum DirtyPageState : u8
+{
+	PAGE_UNTRACKED = 0,
+	PAGE_PROTECTED,
+	PAGE_WRITTEN,
+};
+
+static bool s_dirty_tracking_enabled = false;
+static std::atomic<u32> s_dirty_epoch{0};
+static std::array<std::atomic<u8>, DIRTY_PAGE_COUNT> s_page_state;
+static std::array<std::atomic<u32>, DIRTY_PAGE_COUNT> s_page_epoch;
+// Pages written during the current epoch. Sized for every page so the fault handler never
+// allocates.
+static std::array<u32, DIRTY_PAGE_COUNT> s_written_pages;
+static u32 s_written_page_count = 0;
+// Guards the written page list and the state changes that go with it. Faults come from any thread
+// that writes RAM (the GPU thread zeroing EFB copy targets, DMA from the DSP thread), and one that
+// lands while the epoch advances must end up either in the closed epoch or in the list of the new
+// one. Taken inside the fault handler, so it is a spin lock.
+static std::atomic_flag s_dirty_lock = ATOMIC_FLAG_INIT;
+
+static void LockDirtyPages()
+{
+	while (s_dirty_lock.test_and_set(std::memory_order_acquire))
+	{
+	}
+}
+
+static void UnlockDirtyPages()
+{
+	s_dirty_lock.clear(std::memory_order_release);
+}
+// Every distinct host mapping of RAM (the physical view plus the logical mirrors).
+static std::array<u8*, 4> s_ram_views;
+static int s_num_ram_views = 0;
+
+static void SetPagesWritable(u32 first_page, u32 num_pages, bool writable)
+{
+	for (int i = 0; i < s_num_ram_views; i++)
+	{
+		u8* ptr = s_ram_views[i] + (first_page << DIRTY_PAGE_SHIFT);
+		size_t size = num_pages << DIRTY_PAGE_SHIFT;
+		if (writable)
+			Common::UnWriteProtectMemory(ptr, size);
+		else
+			Common::WriteProtectMemory(ptr, size);
+	}
+}
+
+bool EnableDirtyPageTracking(const std::vector<DirtyTrackRange>& ranges)
+{
+	if (s_dirty_tracking_enabled)
+		DisableDirtyPageTracking();
+
+	if (!m_IsInitialized || !SConfig::GetInstance().bFastmem || !EMM::IsHandlerProcessWide())
+		return false;
+
+	// Pages are protected one at a time, which only lines up with the tracking granularity on
+	// hosts with 4 KiB pages
+	if (Common::MemPageSize() != DIRTY_PAGE_SIZE)
+	{
+		INFO_LOG(MEMMAP, "Dirty page tracking needs 4 KiB host pages, not %zu bytes", Common::MemPageSize());
+		return false;
+	}
+
+	// RAM views are the first four entries of the view table. On 32-bit the mirrors share the
+	// same pointer, so only keep distinct ones.
+	s_num_ram_views = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		u8* ptr = static_cast<u8*>(views[i].view_ptr);
+		if (!ptr || std::find(s_ram_views.begin(), s_ram_views.begin() + s_num_ram_views, ptr) !=
+		                s_ram_views.begin() + s_num_ram_views)
+			continue;
+		s_ram_views[s_num_ram_views++] = ptr;
+	}
+
+	// Epochs keep counting up across tracking sessions, so an epoch recorded in an earlier session
+	// can never be mistaken for one of this session
+	const u32 first_epoch = s_dirty_epoch + 1;
+	s_dirty_epoch = first_epoch;
+	s_written_page_count = 0;
+	for (const DirtyTrackRange& range : ranges)
+	{
+		if (range.size == 0)
+			continue;
+
+		u32 start = range.address & RAM_MASK;
+		u32 first_page = start >> DIRTY_PAGE_SHIFT;
+		u32 last_page = std::min<u32>((start + range.size - 1) >> DIRTY_PAGE_SHIFT, DIRTY_PAGE_COUNT - 1);
+		for (u32 page = first_page; page <= last_page; page++)
+		{
+			s_page_epoch[page] = first_epoch;
+			s_page_state[page] = PAGE_PROTECTED;
+		}
+	}
+
+	// Protect runs of tracked pages with as few calls as possible
+	for (u32 page = 0; page < DIRTY_PAGE_COUNT;)
+	{
+		if (s_page_state[page] != PAGE_PROTECTED)
+		{
+			page++;
+			continue;
+		}
+
+		u32 run_end = page;
+		while (run_end < DIRTY_PAGE_COUNT && s_page_state[run_end] == PAGE_PROTECTED)
+			run_end++;
+		SetPagesWritable(page, run_end - page, false);
+		page = run_end;
+	}
+
+	s_dirty_tracking_enabled = true;
+	INFO_LOG(MEMMAP, "Dirty page tracking enabled");
+	return true;
+}
+
+void DisableDirtyPageTracking()
+{
+	if (!s_dirty_tracking_enabled)
+		return;
+
+	LockDirtyPages();
+	s_dirty_tracking_enabled = false;
+	// Everything counts as written from here on, for readers that still saw tracking enabled
+	const u32 last_epoch = ++s_dirty_epoch;
+	for (u32 page = 0; page < DIRTY_PAGE_COUNT; page++)
+		s_page_epoch[page] = last_epoch;
+	SetPagesWritable(0, DIRTY_PAGE_COUNT, true);
+	for (u32 page = 0; page < DIRTY_PAGE_COUNT; page++)
+		s_page_state[page] = PAGE_UNTRACKED;
+	s_written_page_count = 0;
+	UnlockDirtyPages();
+	INFO_LOG(MEMMAP, "Dirty page tracking disabled");
+}
+
+bool IsDirtyPageTrackingEnabled()
+{
+	return s_dirty_tracking_enabled;
+}
+
+u32 GetDirtyPageEpoch()
+{
+	return s_dirty_epoch;
+}
+
+u32 AdvanceDirtyPageEpoch()
+{
+	if (!s_dirty_tracking_enabled)
+		return 0;
+
+	// The protection has to be back in place before the epoch advances and the state flips, and
+	// the list can only be emptied along with the flip. Writes from other threads in the meantime
+	// fault and wait for the lock, then get tagged with the new epoch.
+	LockDirtyPages();
+	u32 count = s_written_page_count;
+	std::sort(s_written_pages.begin(), s_written_pages.begin() + count);
+
+	for (u32 i = 0; i < count;)
+	{
+		u32 run_start = s_written_pages[i];
+		u32 run_length = 1;
+		while (i + run_length < count && s_written_pages[i + run_length] == run_start + run_length)
+			run_length++;
+
+		SetPagesWritable(run_start, run_length, false);
+		i += run_length;
+	}
+
+	u32 closed_epoch = s_dirty_epoch++;
+	for (u32 i = 0; i < count; i++)
+		s_page_state[s_written_pages[i]] = PAGE_PROTECTED;
+	s_written_page_count = 0;
+	UnlockDirtyPages();
+
+	return closed_epoch;
+}
+
+bool WasPageWrittenSince(u32 address, u32 epoch)
+{
+	u32 page = (address & RAM_MASK) >> DIRTY_PAGE_SHIFT;
+	if (!s_dirty_tracking_enabled || s_page_state[page] == PAGE_UNTRACKED)
+		return true;
+
+	return s_page_epoch[page] > epoch;
+}
+
+bool HandleDirtyPageFault(uintptr_t host_address)
+{
+	if (!s_dirty_tracking_enabled)
+		return false;
+
+	for (int i = 0; i < s_num_ram_views; i++)
+	{
+		uintptr_t view = reinterpret_cast<uintptr_t>(s_ram_views[i]);
+		if (host_address < view || host_address >= view + RAM_SIZE)
+			continue;
+
+		u32 page = static_cast<u32>(host_address - view) >> DIRTY_PAGE_SHIFT;
+		LockDirtyPages();
+		const u8 state = s_page_state[page];
+		if (state == PAGE_PROTECTED)
+		{
+			s_page_state[page] = PAGE_WRITTEN;
+			s_page_epoch[page] = s_dirty_epoch.load();
+			s_written_pages[s_written_page_count++] = page;
+			SetPagesWritable(page, 1, true);
+		}
+		// A page that is already written was unprotected by another thread, and tracking that got
+		// disabled in the meantime unprotected everything. Either way, just retry the access.
+		const bool retry = state != PAGE_UNTRACKED || !s_dirty_tracking_enabled;
+		UnlockDirtyPages();
+
+		return retry;
+	}
+
+	return false;
+}
+
 static inline u8* GetPointerForRange(u32 address, size_t size)
 {
 	// Make sure we don't have a range spanning 2 separate banks
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
@@ -99,6 +100,39 @@ void Write_U64(const u64 var, const u32 address);
 void Write_U32_Swap(const u32 var, const u32 address);
 void Write_U64_Swap(const u64 var, const u32 address);
 
+// Dirty page tracking for main RAM. Tracked pages are write-protected in every view of RAM and
+// the first write to one of them after the epoch advances is caught by the fault handler, which
+// tags the page with the current epoch and lifts the protection again. This lets callers that
+// periodically snapshot RAM (e.g. rollback savestates) copy only the pages that actually changed.
+// Requires fastmem, since the fault handler is only installed in that case.
+enum
+{
+	DIRTY_PAGE_SHIFT = 12,
+	DIRTY_PAGE_SIZE = 1 << DIRTY_PAGE_SHIFT,
+	DIRTY_PAGE_COUNT = RAM_SIZE >> DIRTY_PAGE_SHIFT,
+};
+
+struct DirtyTrackRange
+{
+	u32 address;
+	u32 size;
+};
+
+bool EnableDirtyPageTracking(const std::vector<DirtyTrackRange>& ranges);
+void DisableDirtyPageTracking();
+bool IsDirtyPageTrackingEnabled();
+// Epoch that writes are currently being tagged with. Epochs start at 1 and only ever grow, also
+// across tracking sessions.
+u32 GetDirtyPageEpoch();
+// Closes the current epoch: pages written during it are write-protected again and subsequent
+// writes are tagged with the next epoch. Returns the epoch that was closed.
+u32 AdvanceDirtyPageEpoch();
+// Returns true if the page containing address was written after the given epoch was closed.
+// Untracked pages always report true.
+bool WasPageWrittenSince(u32 address, u32 epoch);
+// Called by the fault handler, returns true if the fault was a write to a tracked page.
+bool HandleDirtyPageFault(uintptr_t host_address);
+
 // Templated functions for byteswapped copies.
 template <typename T>
 void CopyFromEmuSwapped(T* data, u32 address, size_t size)
@@ -44,6 +44,11 @@ LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
 		uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
 		CONTEXT* ctx = pPtrs->ContextRecord;
 
+		if (accessType == 1 && Memory::HandleDirtyPageFault(badAddress))
+		{
+			return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
+		}
+
 		if (JitInterface::HandleFault(badAddress, ctx))
 		{
 			return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
@@ -98,6 +103,11 @@ void UninstallExceptionHandler()
 {
 }
 
+bool IsHandlerProcessWide()
+{
+	return true;
+}
+
 #elif defined(__APPLE__) && !defined(USE_SIGACTION_ON_APPLE)
 
 static void CheckKR(const char* name, kern_return_t kr)
@@ -171,7 +181,8 @@ static void ExceptionThread(mach_port_t port)
 
 		x86_thread_state64_t* state = (x86_thread_state64_t*)msg_in.old_state;
 
-		bool ok = JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
+		bool ok = Memory::HandleDirtyPageFault((uintptr_t)msg_in.code[1]) ||
+		          JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
 
 		// Set up the reply.
 		msg_out.Head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(msg_in.Head.msgh_bits), 0);
@@ -230,6 +241,12 @@ void UninstallExceptionHandler()
 {
 }
 
+bool IsHandlerProcessWide()
+{
+	// The exception port is only registered for the CPU thread
+	return false;
+}
+
 #elif defined(_POSIX_VERSION) && !defined(_M_GENERIC)
 
 static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
@@ -254,6 +271,10 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
 #else
 	mcontext_t* ctx = &context->uc_mcontext;
 #endif
+	// Check write-tracked RAM pages first so these are not mistaken for fastmem misses
+	if (Memory::HandleDirtyPageFault(bad_address))
+		return;
+
 	// assume it's not a write
 	if (!JitInterface::HandleFault(bad_address,
 #ifdef __APPLE__
@@ -303,6 +324,11 @@ void UninstallExceptionHandler()
 		free(old_stack.ss_sp);
 	}
 }
+
+bool IsHandlerProcessWide()
+{
+	return true;
+}
 #else  // _M_GENERIC or unsupported platform
 
 void InstallExceptionHandler()
@@ -311,6 +337,10 @@ void InstallExceptionHandler()
 void UninstallExceptionHandler()
 {
 }
+bool IsHandlerProcessWide()
+{
+	return false;
+}
 
 #endif
 
@@ -9,5 +9,7 @@ namespace EMM
 
 void InstallExceptionHandler();
 void UninstallExceptionHandler();
+// Whether faults raised on any host thread reach the handler, not just the CPU thread
+bool IsHandlerProcessWide();
 
 }
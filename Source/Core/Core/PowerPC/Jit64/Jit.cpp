@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <map>
 #include <string>
 
@@ -10,7 +11,9 @@
 #include <windows.h>
 #endif
 
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/x64ABI.h"
@@ -224,6 +227,15 @@ void Jit64::Init()
 	m_enable_blr_optimization = jo.enableBlocklink && SConfig::GetInstance().bFastmem && !SConfig::GetInstance().bEnableDebugging;
 	m_cleanup_after_stackfault = false;
 
+	// Superblocks run the code of several instructions' worth of branches as one, which breakpoints
+	// and single stepping don't expect.
+	m_enable_superblocks = SConfig::GetInstance().bJITSuperblocks && !SConfig::GetInstance().bEnableDebugging &&
+		!SConfig::GetInstance().bJITBranchOff;
+	m_superblocks.clear();
+	analyzer.SetFollowPredicate([this](u32 destination, bool conditional) {
+		return FollowBranch(destination, conditional);
+	});
+
 	m_stack = nullptr;
 	if (m_enable_blr_optimization)
 		AllocStack();
@@ -240,10 +252,26 @@ void Jit64::Init()
 	code_block.m_gpa = &js.gpa;
 	code_block.m_fpa = &js.fpa;
 	EnableOptimization();
+
+	// Where blocks end depends on these, the analyzer breaks them at pages with the MMU on
+	const SConfig& config = SConfig::GetInstance();
+	if (!config.GetGameID().empty() && !config.bEnableDebugging && !config.bJITNoBlockCache)
+	{
+		const u64 block_config = static_cast<u64>(code_buffer.GetSize()) << 32 | (config.bMMU ? 1 : 0) |
+			(jo.memcheck ? 2 : 0) | (jo.fastmem ? 4 : 0) | (jo.enableBlocklink ? 8 : 0);
+		m_block_store.Load(File::GetUserPath(D_CACHE_IDX) + "JitBlocks" DIR_SEP + config.GetGameID() + ".bin",
+			block_config);
+	}
+	else
+	{
+		m_block_store.Clear();
+	}
 }
 
 void Jit64::ClearCache()
 {
+	// The run counts superblocks are chosen by go with the blocks
+	m_superblocks.clear();
 	blocks.Clear();
 	trampolines.ClearCodeSpace();
 	farcode.ClearCodeSpace();
@@ -254,6 +282,10 @@ void Jit64::ClearCache()
 
 void Jit64::Shutdown()
 {
+	m_block_store.Save();
+	m_block_store.Clear();
+	m_superblocks.clear();
+
 	FreeStack();
 	FreeCodeSpace();
 
@@ -334,24 +366,24 @@ static void ImHere()
 	been_here[PC] = 1;
 }
 
-bool Jit64::Cleanup()
+bool Jit64::Cleanup(BitSet32 registersInUse)
 {
 	bool did_something = false;
 
 	if (jo.optimizeGatherPipe && js.fifoBytesThisBlock > 0)
 	{
-		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_PushRegistersAndAdjustStack(registersInUse, 0);
 		ABI_CallFunction((void *)&GPFifo::FastCheckGatherPipe);
-		ABI_PopRegistersAndAdjustStack({}, 0);
+		ABI_PopRegistersAndAdjustStack(registersInUse, 0);
 		did_something = true;
 	}
 
 	// SPEED HACK: MMCR0/MMCR1 should be checked at run-time, not at compile time.
 	if (MMCR0.Hex || MMCR1.Hex)
 	{
-		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_PushRegistersAndAdjustStack(registersInUse, 0);
 		ABI_CallFunctionCCC((void *)&PowerPC::UpdatePerformanceMonitor, js.downcountAmount, js.numLoadStoreInst, js.numFloatingPointInst);
-		ABI_PopRegistersAndAdjustStack({}, 0);
+		ABI_PopRegistersAndAdjustStack(registersInUse, 0);
 		did_something = true;
 	}
 
@@ -473,6 +505,27 @@ void Jit64::WriteRfiExitDestInRSCRATCH()
 	JMP(asm_routines.dispatcher, true);
 }
 
+void Jit64::WriteFollowedBranch(u32 destination)
+{
+	// A superblock does what the exit of the block it followed a branch out of would: the gather
+	// pipe and performance monitor are updated and the downcount checked, so events and fifo bursts
+	// happen at the same instructions as with the blocks linked. The registers stay loaded here.
+	Cleanup(CallerSavedRegistersInUse());
+	SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
+	js.downcountAmount = 0;
+	js.fifoBytesThisBlock = 0;
+	js.numLoadStoreInst = 0;
+	js.numFloatingPointInst = 0;
+	FixupBranch timing = J_CC(CC_BE, true);
+	SwitchToFarCode();
+	SetJumpTarget(timing);
+	gpr.Flush(FLUSH_MAINTAIN_STATE);
+	fpr.Flush(FLUSH_MAINTAIN_STATE);
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	JMP(asm_routines.doTiming, true);
+	SwitchToNearCode();
+}
+
 void Jit64::WriteExceptionExit()
 {
 	Cleanup();
@@ -551,6 +604,15 @@ void Jit64::Jit(u32 em_address)
 		ClearCache();
 	}
 
+	// Compile the blocks of earlier sessions the game has loaded the code of by now, this may well
+	// include the one asked for
+	if (m_block_store.HasPending())
+	{
+		m_block_store.Prewarm([this](const JitBlockStore::Entry& entry) { return PrewarmBlock(entry); });
+		if (blocks.GetBlockNumberFromStartAddress(em_address) >= 0)
+			return;
+	}
+
 	int blockSize = code_buffer.GetSize();
 
 	if (SConfig::GetInstance().bEnableDebugging)
@@ -577,12 +639,18 @@ void Jit64::Jit(u32 em_address)
 		}
 	}
 
+	// Hot blocks are compiled as superblocks, following the branches they take
+	const bool superblock = m_enable_superblocks && m_superblocks.count(em_address) != 0;
+	if (superblock)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE);
+
 	// Analyze the block, collect all instructions it is made of (including inlining,
 	// if that is enabled), reorder instructions for optimal performance, and join joinable instructions.
 	u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, blockSize);
 
 	if (code_block.m_memory_exception)
 	{
+		analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE);
 		// Address of instruction could not be translated
 		NPC = nextPC;
 		PowerPC::ppcState.Exceptions |= EXCEPTION_ISI;
@@ -594,6 +662,68 @@ void Jit64::Jit(u32 em_address)
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
 	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b, nextPC));
+	analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE);
+
+	// Superblocks depend on which blocks were hot, the next session finds its own
+	if (!superblock)
+		m_block_store.Record(code_buffer, code_block.m_num_instructions);
+}
+
+bool Jit64::FollowBranch(u32 destination, bool conditional)
+{
+	// Hot code of its own is better linked to than copied, and the code hooked or patched into
+	// has to start a block
+	if (m_superblocks.count(destination) || HLE::GetFunctionIndex(destination) ||
+		PatchEngine::GetSpeedhackCycles(destination))
+	{
+		return false;
+	}
+	if (!conditional)
+		return true;
+
+	// A conditional branch is followed into blocks that ran at least half as often as it takes
+	// to become hot, where the branch goes most of the time in hot code
+	const int block_num = blocks.GetBlockNumberFromStartAddress(destination);
+	return block_num >= 0 && blocks.GetBlock(block_num)->runCount >= HOT_BLOCK_RUNS / 2;
+}
+
+void Jit64::PromoteToSuperblock(u32 address)
+{
+	Jit64* jit64 = static_cast<Jit64*>(jit);
+	const int block_num = jit64->blocks.GetBlockNumberFromStartAddress(address);
+	if (block_num < 0)
+		return;
+	jit64->m_superblocks.insert(address);
+	jit64->blocks.InvalidateBlock(block_num);
+}
+
+JitBlockStore::PrewarmResult Jit64::PrewarmBlock(const JitBlockStore::Entry& entry)
+{
+	if (IsAlmostFull() || farcode.IsAlmostFull() || trampolines.IsAlmostFull() || blocks.IsFull())
+		return JitBlockStore::PrewarmResult::Stop;
+
+	// Most blocks that do not match are in code the game has not loaded yet, which the first
+	// instruction tells without analyzing the whole block. The game has not run the code yet, so
+	// reading it must not load it into the emulated instruction cache.
+	const PowerPC::TryReadInstResult first = PowerPC::TryPeekInstruction(entry.address);
+	if (!first.valid || first.hex != entry.first_instruction)
+		return JitBlockStore::PrewarmResult::Mismatch;
+	if (blocks.GetBlockNumberFromStartAddress(entry.address) >= 0)
+		return JitBlockStore::PrewarmResult::Compiled;
+
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_PEEK);
+	u32 nextPC = analyzer.Analyze(entry.address, &code_block, &code_buffer, code_buffer.GetSize());
+	analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_PEEK);
+	if (code_block.m_memory_exception ||
+		JitBlockStore::HashBlock(code_buffer, code_block.m_num_instructions) != entry.hash)
+	{
+		return JitBlockStore::PrewarmResult::Mismatch;
+	}
+
+	int block_num = blocks.AllocateBlock(entry.address);
+	JitBlock *b = blocks.GetBlock(block_num);
+	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(entry.address, &code_buffer, b, nextPC));
+	return JitBlockStore::PrewarmResult::Compiled;
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b, u32 nextPC)
@@ -620,6 +750,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	const u8 *normalEntry = GetCodePtr();
 	b->normalEntry = normalEntry;
+	b->followedRuns.clear();
 
 	if (ImHereDebug)
 	{
@@ -639,6 +770,26 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		// get start tic
 		PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
 	}
+	// Count the runs of the block, which is compiled again as a superblock once it is hot. Nothing
+	// has run yet when it goes back to the dispatcher for that. The flags are the C call's by then,
+	// so it skips the downcount check, which was made before the block was entered.
+	if (m_enable_superblocks && !analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE))
+	{
+		MOV(64, R(RSCRATCH), Imm64((u64)&b->runCount));
+		// The profiler counts the runs already
+		if (!Profiler::g_ProfileBlocks)
+			ADD(32, MatR(RSCRATCH), Imm8(1));
+		CMP(32, MatR(RSCRATCH), Imm32(HOT_BLOCK_RUNS));
+		FixupBranch hot = J_CC(CC_E, true);
+		SwitchToFarCode();
+		SetJumpTarget(hot);
+		MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_CallFunctionC((void *)&PromoteToSuperblock, js.blockStart);
+		ABI_PopRegistersAndAdjustStack({}, 0);
+		JMP(asm_routines.dispatcherNoCheck, true);
+		SwitchToNearCode();
+	}
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
 	// should help logged stack-traces become more accurate
 	MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
@@ -919,6 +1070,30 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	b->codeSize = (u32)(GetCodePtr() - start);
 	b->originalSize = code_block.m_num_instructions;
 
+	// A superblock is made of runs of consecutive instructions, each starting after a followed
+	// branch. Instructions are only reordered within a run.
+	if (analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE))
+	{
+		bool first_run = true;
+		u32 run_start = ops[0].address;
+		u32 run_end = ops[0].address;
+		for (u32 i = 0; i < code_block.m_num_instructions; i++)
+		{
+			run_start = std::min(run_start, ops[i].address);
+			run_end = std::max(run_end, ops[i].address);
+			if (!ops[i].isFollowedBranch && i + 1 < code_block.m_num_instructions)
+				continue;
+
+			if (first_run)
+				b->originalSize = (run_end - run_start) / 4 + 1;
+			else
+				b->followedRuns.emplace_back(run_start, (run_end - run_start) / 4 + 1);
+			first_run = false;
+			if (i + 1 < code_block.m_num_instructions)
+				run_start = run_end = ops[i + 1].address;
+		}
+	}
+
 #ifdef JIT_LOG_X86
 	LogGeneratedX86(code_block.m_num_instructions, code_buf, start, b);
 #endif
@@ -18,12 +18,15 @@
 // ----------
 #pragma once
 
+#include <unordered_set>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitBlockStore.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 
 class Jit64 : public Jitx86Base
@@ -44,6 +47,18 @@ private:
 	bool m_cleanup_after_stackfault;
 	u8* m_stack;
 
+	// Blocks compiled in earlier sessions of the game, see JitBlockStore
+	JitBlockStore m_block_store;
+	JitBlockStore::PrewarmResult PrewarmBlock(const JitBlockStore::Entry& entry);
+
+	// Blocks count their runs, and the ones that run often are compiled again as superblocks,
+	// following the branches they take (see PPCAnalyzer::OPTION_TRACE)
+	static const int HOT_BLOCK_RUNS = 1000;
+	bool m_enable_superblocks;
+	std::unordered_set<u32> m_superblocks;
+	bool FollowBranch(u32 destination, bool conditional);
+	static void PromoteToSuperblock(u32 address);
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -96,7 +111,8 @@ public:
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInRSCRATCH();
-	bool Cleanup();
+	void WriteFollowedBranch(u32 destination);
+	bool Cleanup(BitSet32 registersInUse = {});
 
 	void GenerateConstantOverflow(bool overflow);
 	void GenerateConstantOverflow(s64 val);
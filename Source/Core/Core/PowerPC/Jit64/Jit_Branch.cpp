@@ -73,6 +73,8 @@ void Jit64::bx(UGeckoInstruction inst)
 	// Because PPCAnalyst::Flatten() merged the blocks.
 	if (!js.isLastInstruction)
 	{
+		if (js.op->isFollowedBranch)
+			WriteFollowedBranch(js.op->branchTo);
 		return;
 	}
 
@@ -135,6 +137,25 @@ void Jit64::bcx(UGeckoInstruction inst)
 	else
 		destination = js.compilerPC + SignExt16(inst.BD << 2);
 
+	if (js.op->isFollowedBranch)
+	{
+		// The superblock goes on at the branch target, not branching leaves it through a side exit
+		if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0 || (inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+		{
+			SwitchToFarCode();
+			if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+				SetJumpTarget(pConditionDontBranch);
+			if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+				SetJumpTarget(pCTRDontBranch);
+			gpr.Flush(FLUSH_MAINTAIN_STATE);
+			fpr.Flush(FLUSH_MAINTAIN_STATE);
+			WriteExit(js.compilerPC + 4);
+			SwitchToNearCode();
+		}
+		WriteFollowedBranch(destination);
+		return;
+	}
+
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
 	WriteExit(destination, inst.LK, js.compilerPC + 4);
@@ -226,6 +247,25 @@ void Jit64::bclrx(UGeckoInstruction inst)
 			!(inst.BO_2 & BO_BRANCH_IF_TRUE));
 	}
 
+	if (js.op->isFollowedBranch)
+	{
+		// The superblock followed the call this returns from, it goes on at the return address as
+		// long as LR still holds it
+		MOV(32, R(RSCRATCH), PPCSTATE_LR);
+		CMP(32, R(RSCRATCH), Imm32(js.op->branchTo));
+		FixupBranch pReturnElsewhere = J_CC(CC_NE, true);
+		SwitchToFarCode();
+		SetJumpTarget(pReturnElsewhere);
+		AND(32, R(RSCRATCH), Imm32(0xFFFFFFFC));
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
+		// The call was not made on the host stack, so this can't return through it
+		WriteExitDestInRSCRATCH();
+		SwitchToNearCode();
+		WriteFollowedBranch(js.op->branchTo);
+		return;
+	}
+
 	// This below line can be used to prove that blr "eats flags" in practice.
 	// This observation could let us do some useful optimizations.
 #ifdef ACID_TEST
@@ -411,6 +411,19 @@ void Jit64::DoMergedBranchCondition()
 	else  // SO bit, do not branch (we don't emulate SO for cmp).
 		pDontBranch = J(true);
 
+	if (js.op[1].isFollowedBranch)
+	{
+		// The superblock goes on at the branch target, not branching leaves it through a side exit
+		SwitchToFarCode();
+		SetJumpTarget(pDontBranch);
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
+		WriteExit(nextPC + 4);
+		SwitchToNearCode();
+		WriteFollowedBranch(js.op[1].branchTo);
+		return;
+	}
+
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
 
@@ -447,6 +460,22 @@ void Jit64::DoMergedBranchImmediate(s64 val)
 	else  // SO bit, do not branch (we don't emulate SO for cmp).
 		branch = false;
 
+	if (js.op[1].isFollowedBranch)
+	{
+		// Only the side exit is left when it doesn't branch, the superblock goes on otherwise
+		if (branch)
+		{
+			WriteFollowedBranch(js.op[1].branchTo);
+		}
+		else
+		{
+			gpr.Flush();
+			fpr.Flush();
+			WriteExit(nextPC + 4);
+		}
+		return;
+	}
+
 	if (branch)
 	{
 		gpr.Flush();
@@ -0,0 +1,208 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include <xxhash.h>
+
+#include "Common/FileUtil.h"
+#include "Common/Timer.h"
+#include "Common/Logging/Log.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/JitCommon/JitBlockStore.h"
+
+namespace
+{
+constexpr u32 FILE_MAGIC = 0x534B4C42; // "BLKS"
+constexpr u32 FILE_VERSION = 1;
+// Blocks of code the game stopped using, or that a Gecko code no longer patches, go after this
+constexpr u32 MAX_IDLE_SESSIONS = 8;
+// As many as the block cache holds
+constexpr size_t MAX_ENTRIES = 0x20000;
+// A game is done loading its code long before this many passes
+constexpr u32 MAX_ATTEMPTS = 60;
+// The first pass runs as the game boots, before it draws anything, and compiles whatever the
+// executable already holds. Later passes run while the game is played, so they are kept far below a
+// frame and come once a frame at most while they keep finding blocks to compile.
+constexpr u64 BOOT_PASS_BUDGET_US = 1000000;
+constexpr u64 PASS_BUDGET_US = 500;
+constexpr u64 BUSY_PASS_INTERVAL_US = 16000;
+constexpr u64 IDLE_PASS_INTERVAL_US = 1000000;
+
+struct FileHeader
+{
+	u32 magic;
+	u32 version;
+	u64 config;
+	u32 count;
+	u32 pad;
+};
+
+struct FileEntry
+{
+	u32 address;
+	u32 first_instruction;
+	u64 hash;
+	u32 idle_sessions;
+	u32 pad;
+};
+}
+
+void JitBlockStore::Load(const std::string& path, u64 config)
+{
+	Clear();
+	m_path = path;
+	m_config = config;
+
+	File::IOFile file(path, "rb");
+	if (!file)
+		return;
+
+	FileHeader header;
+	if (!file.ReadArray(&header, 1) || header.magic != FILE_MAGIC || header.version != FILE_VERSION ||
+		header.config != m_config || header.count > MAX_ENTRIES)
+	{
+		INFO_LOG(DYNA_REC, "Ignoring JIT blocks saved in %s for another version or settings", path.c_str());
+		return;
+	}
+
+	std::vector<FileEntry> entries(header.count);
+	if (!file.ReadArray(entries.data(), entries.size()))
+	{
+		WARN_LOG(DYNA_REC, "Could not read the JIT blocks saved in %s", path.c_str());
+		return;
+	}
+
+	for (const FileEntry& entry : entries)
+	{
+		// Counted as idle until the block is compiled again
+		if (entry.idle_sessions + 1 >= MAX_IDLE_SESSIONS ||
+			!m_index.emplace(std::make_pair(entry.address, entry.hash), m_entries.size()).second)
+		{
+			continue;
+		}
+		m_pending.push_back(m_entries.size());
+		m_entries.push_back({entry.address, entry.first_instruction, entry.hash, entry.idle_sessions + 1, 0});
+	}
+	m_num_loaded = m_entries.size();
+	NOTICE_LOG(DYNA_REC, "Loaded %zu JIT blocks to compile ahead of time from %s", m_num_loaded, path.c_str());
+}
+
+void JitBlockStore::Save()
+{
+	if (m_path.empty())
+		return;
+
+	if (m_num_loaded)
+	{
+		NOTICE_LOG(DYNA_REC, "Compiled %zu of %zu saved JIT blocks ahead of time",
+			m_num_prewarmed, m_num_loaded);
+	}
+
+	// The blocks in use go first if there are too many
+	std::vector<Entry> entries(m_entries);
+	std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.idle_sessions < b.idle_sessions;
+	});
+	if (entries.size() > MAX_ENTRIES)
+		entries.resize(MAX_ENTRIES);
+
+	std::vector<FileEntry> file_entries;
+	file_entries.reserve(entries.size());
+	for (const Entry& entry : entries)
+		file_entries.push_back({entry.address, entry.first_instruction, entry.hash, entry.idle_sessions, 0});
+
+	// Written under another name first, so a crash never leaves half a file behind
+	const std::string temp_path = m_path + ".tmp";
+	File::CreateFullPath(m_path);
+	File::IOFile file(temp_path, "wb");
+	const FileHeader header = {FILE_MAGIC, FILE_VERSION, m_config, static_cast<u32>(file_entries.size()), 0};
+	const bool good = file.WriteArray(&header, 1) && file.WriteArray(file_entries.data(), file_entries.size());
+	file.Close();
+
+	if (!good || !File::Rename(temp_path, m_path))
+	{
+		WARN_LOG(DYNA_REC, "Could not save the JIT blocks to %s", m_path.c_str());
+		File::Delete(temp_path);
+	}
+}
+
+void JitBlockStore::Clear()
+{
+	m_path.clear();
+	m_entries.clear();
+	m_index.clear();
+	m_pending.clear();
+	m_next_pass_us = 0;
+	m_num_loaded = 0;
+	m_num_prewarmed = 0;
+}
+
+u64 JitBlockStore::HashBlock(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions)
+{
+	// Addresses are in, the analyzer follows branches, so the same instructions can make up
+	// another block elsewhere
+	XXH64_state_t state;
+	XXH64_reset(&state, 0);
+	for (u32 i = 0; i < num_instructions; i++)
+	{
+		const PPCAnalyst::CodeOp& op = buffer.codebuffer[i];
+		const u32 words[2] = {op.address, op.inst.hex};
+		XXH64_update(&state, words, sizeof(words));
+	}
+	return XXH64_digest(&state);
+}
+
+void JitBlockStore::Record(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions)
+{
+	if (m_path.empty())
+		return;
+
+	const u32 address = buffer.codebuffer[0].address;
+	const u32 first_instruction = buffer.codebuffer[0].inst.hex;
+	const u64 hash = HashBlock(buffer, num_instructions);
+	auto inserted = m_index.emplace(std::make_pair(address, hash), m_entries.size());
+	if (inserted.second)
+		m_entries.push_back({address, first_instruction, hash, 0, 0});
+	else
+		m_entries[inserted.first->second].idle_sessions = 0;
+}
+
+void JitBlockStore::Prewarm(const CompileFunction& compile)
+{
+	const u64 start = Common::Timer::GetTimeUs();
+	if (start < m_next_pass_us)
+		return;
+	const u64 budget = m_next_pass_us == 0 ? BOOT_PASS_BUDGET_US : PASS_BUDGET_US;
+
+	// Each block is offered once a pass
+	size_t remaining = m_pending.size();
+	size_t compiled = 0;
+	while (remaining-- && Common::Timer::GetTimeUs() - start < budget)
+	{
+		const size_t index = m_pending.front();
+		m_pending.pop_front();
+		Entry& entry = m_entries[index];
+		switch (compile(entry))
+		{
+		case PrewarmResult::Compiled:
+			entry.idle_sessions = 0;
+			compiled++;
+			break;
+		case PrewarmResult::Mismatch:
+			if (++entry.attempts < MAX_ATTEMPTS)
+				m_pending.push_back(index);
+			break;
+		case PrewarmResult::Stop:
+			WARN_LOG(DYNA_REC, "Out of JIT code space, not compiling the other %zu saved blocks ahead of time",
+				m_pending.size() + 1);
+			m_pending.clear();
+			remaining = 0;
+			break;
+		}
+	}
+
+	m_num_prewarmed += compiled;
+	m_next_pass_us = Common::Timer::GetTimeUs() + (compiled ? BUSY_PASS_INTERVAL_US : IDLE_PASS_INTERVAL_US);
+}
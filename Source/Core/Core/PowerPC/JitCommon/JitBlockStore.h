@@ -0,0 +1,76 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace PPCAnalyst
+{
+class CodeBuffer;
+}
+
+// Remembers which guest blocks the JIT compiled for a game, so that the next session can compile
+// them before the game first runs them instead of in the middle of a match.
+// Only the guest side is kept: the host code of a block calls into the emulator and refers to
+// its data, which moves from one run to the next, while compiling a block from the guest code
+// takes a few microseconds once it is known where the blocks are.
+// Blocks are keyed by their address and a hash of the instructions the analyzer put in them, so a
+// block is only compiled ahead of time while the guest code at its address is the same.
+class JitBlockStore
+{
+public:
+	struct Entry
+	{
+		u32 address;
+		u32 first_instruction; // checked before analyzing the whole block
+		u64 hash; // see HashBlock
+		u32 idle_sessions; // sessions in a row the block was not compiled in
+		u32 attempts; // passes the guest code did not match in, this session only
+	};
+
+	enum class PrewarmResult
+	{
+		Compiled,
+		Mismatch, // the game has not loaded this code, or not yet
+		Stop, // out of space for compiled code
+	};
+	using CompileFunction = std::function<PrewarmResult(const Entry&)>;
+
+	// Reads the blocks saved for path, unless they were saved under another config. config covers
+	// the JIT settings that change where blocks end.
+	void Load(const std::string& path, u64 config);
+	// Writes back every block compiled this session, and those from earlier sessions that have not
+	// been idle for too long
+	void Save();
+	void Clear();
+
+	static u64 HashBlock(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions);
+	// Adds the block just analyzed into buffer, blocks compiled by Prewarm are kept already
+	void Record(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions);
+
+	bool HasPending() const { return !m_pending.empty(); }
+	// Offers the blocks not compiled yet to compile. The first pass of a session runs at boot and
+	// may take up to a second, later ones take half a millisecond at most. Blocks whose guest code
+	// did not match are offered again in later passes, which are spaced out so that they do not
+	// slow the game down while it loads its code.
+	void Prewarm(const CompileFunction& compile);
+
+private:
+	std::string m_path;
+	u64 m_config = 0;
+	std::vector<Entry> m_entries;
+	std::map<std::pair<u32, u64>, size_t> m_index; // address and hash to m_entries
+	std::deque<size_t> m_pending; // into m_entries
+	u64 m_next_pass_us = 0;
+	size_t m_num_loaded = 0;
+	size_t m_num_prewarmed = 0;
+};
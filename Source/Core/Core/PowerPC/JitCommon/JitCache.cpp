@@ -10,11 +10,11 @@
 // locating performance issues.
 
 #include <cstring>
-#include <map>
 #include <utility>
 
 #include "Common/CommonTypes.h"
 #include "Common/JitRegister.h"
+#include "Common/MathUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/PowerPC/JitInterface.h"
@@ -27,6 +27,136 @@
 
 using namespace Gen;
 
+u32 JitBlockListMap::Find(u32 key) const
+{
+	if (m_slots.empty())
+		return NONE;
+
+	// Never more than half full, so there is always a free slot to stop at
+	const u32 mask = static_cast<u32>(m_slots.size()) - 1;
+	for (u32 slot = Hash(key);; slot = (slot + 1) & mask)
+	{
+		const Slot& s = m_slots[slot];
+		if (s.head == NONE)
+			return NONE;
+		if (s.head != ERASED && s.key == key)
+			return slot;
+	}
+}
+
+void JitBlockListMap::Add(u32 key, int block_num)
+{
+	u32 slot = Find(key);
+	if (slot == NONE)
+	{
+		if ((m_used_slots + 1) * 2 > m_slots.size())
+		{
+			u32 size = 64;
+			while ((m_num_keys + 1) * 4 > size)
+				size *= 2;
+			Rehash(size);
+		}
+
+		const u32 mask = static_cast<u32>(m_slots.size()) - 1;
+		slot = Hash(key);
+		while (m_slots[slot].head != NONE && m_slots[slot].head != ERASED)
+			slot = (slot + 1) & mask;
+		if (m_slots[slot].head == NONE)
+			m_used_slots++;
+		m_slots[slot] = {key, NONE};
+		m_num_keys++;
+	}
+
+	u32 node = m_free_node;
+	if (node != NONE)
+	{
+		m_free_node = m_nodes[node].next;
+	}
+	else
+	{
+		node = static_cast<u32>(m_nodes.size());
+		m_nodes.emplace_back();
+	}
+	m_nodes[node] = {block_num, m_slots[slot].head};
+	m_slots[slot].head = node;
+}
+
+void JitBlockListMap::Remove(u32 key, int block_num)
+{
+	const u32 slot = Find(key);
+	if (slot == NONE)
+		return;
+
+	for (u32* link = &m_slots[slot].head; *link != NONE; link = &m_nodes[*link].next)
+	{
+		const u32 node = *link;
+		if (m_nodes[node].block_num == block_num)
+		{
+			*link = m_nodes[node].next;
+			m_nodes[node].next = m_free_node;
+			m_free_node = node;
+			break;
+		}
+	}
+
+	// The slot of a key without blocks is a free slot to Find
+	if (m_slots[slot].head == NONE)
+	{
+		m_slots[slot].head = ERASED;
+		m_num_keys--;
+	}
+}
+
+void JitBlockListMap::Erase(u32 key)
+{
+	const u32 slot = Find(key);
+	if (slot != NONE)
+		EraseSlot(slot);
+}
+
+void JitBlockListMap::EraseSlot(u32 slot)
+{
+	u32 node = m_slots[slot].head;
+	while (node != NONE)
+	{
+		const u32 next = m_nodes[node].next;
+		m_nodes[node].next = m_free_node;
+		m_free_node = node;
+		node = next;
+	}
+	m_slots[slot].head = ERASED;
+	m_num_keys--;
+}
+
+void JitBlockListMap::Clear()
+{
+	m_slots.clear();
+	m_nodes.clear();
+	m_shift = 32;
+	m_used_slots = 0;
+	m_num_keys = 0;
+	m_free_node = NONE;
+}
+
+void JitBlockListMap::Rehash(u32 size)
+{
+	std::vector<Slot> old_slots(size, Slot{0, NONE});
+	m_slots.swap(old_slots);
+	m_shift = 32 - IntLog2(size);
+	m_used_slots = m_num_keys;
+
+	const u32 mask = size - 1;
+	for (const Slot& s : old_slots)
+	{
+		if (s.head == NONE || s.head == ERASED)
+			continue;
+		u32 slot = Hash(s.key);
+		while (m_slots[slot].head != NONE)
+			slot = (slot + 1) & mask;
+		m_slots[slot] = s;
+	}
+}
+
 bool JitBaseBlockCache::IsFull() const
 {
 	return GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
@@ -74,8 +204,8 @@ void JitBaseBlockCache::Clear()
 	{
 		DestroyBlock(i, false);
 	}
-	links_to.clear();
-	block_map.clear();
+	links_to.Clear();
+	block_pages.Clear();
 
 	valid_block.ClearAll();
 
@@ -99,11 +229,22 @@ int JitBaseBlockCache::GetNumBlocks() const
 	return num_blocks;
 }
 
+// Calls func with the physical address and number of instructions of each run of code the block
+// was compiled from
+template <typename Func>
+void JitBaseBlockCache::ForEachRun(const JitBlock& b, Func func)
+{
+	func(b.originalAddress & 0x1FFFFFFF, b.originalSize);
+	for (const auto& run : b.followedRuns)
+		func(run.first & 0x1FFFFFFF, run.second);
+}
+
 int JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
 	JitBlock &b = blocks[num_blocks];
 	b.invalid = false;
 	b.originalAddress = em_address;
+	b.followedRuns.clear();
 	b.linkData.clear();
 	num_blocks++; //commit the current block
 	return num_blocks - 1;
@@ -116,19 +257,19 @@ void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8 *
 
 	std::memcpy(GetICachePtr(b.originalAddress), &block_num, sizeof(u32));
 
-	// Convert the logical address to a physical address for the block map
-	u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-
-	for (u32 block = pAddr / 32; block <= (pAddr + (b.originalSize - 1) * 4) / 32; ++block)
-		valid_block.Set(block);
+	ForEachRun(b, [&](u32 pAddr, u32 size) {
+		for (u32 block = pAddr / 32; block <= (pAddr + (size - 1) * 4) / 32; ++block)
+			valid_block.Set(block);
 
-	block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+		for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (pAddr + (size - 1) * 4) >> BLOCK_PAGE_SHIFT; ++page)
+			block_pages.Add(page, block_num);
+	});
 
 	if (block_link)
 	{
 		for (const auto& e : b.linkData)
 		{
-			links_to.emplace(e.exitAddress, block_num);
+			links_to.Add(e.exitAddress, block_num);
 		}
 
 		LinkBlock(block_num);
@@ -209,38 +350,23 @@ void JitBaseBlockCache::LinkBlock(int i)
 {
 	LinkBlockExits(i);
 	JitBlock &b = blocks[i];
-	// equal_range(b) returns pair<iterator,iterator> representing the range
-	// of element with key b
-	auto ppp = links_to.equal_range(b.originalAddress);
-
-	if (ppp.first == ppp.second)
-		return;
-
-	for (auto iter = ppp.first; iter != ppp.second; ++iter)
-	{
-		// PanicAlert("Linking block %i to block %i", iter->second, i);
-		LinkBlockExits(iter->second);
-	}
+	links_to.ForEach(b.originalAddress, [this](int source) {
+		LinkBlockExits(source);
+	});
 }
 
 void JitBaseBlockCache::UnlinkBlock(int i)
 {
 	JitBlock &b = blocks[i];
-	auto ppp = links_to.equal_range(b.originalAddress);
-
-	if (ppp.first == ppp.second)
-		return;
-
-	for (auto iter = ppp.first; iter != ppp.second; ++iter)
-	{
-		JitBlock &sourceBlock = blocks[iter->second];
+	links_to.ForEach(b.originalAddress, [&](int source) {
+		JitBlock &sourceBlock = blocks[source];
 		for (auto& e : sourceBlock.linkData)
 		{
 			if (e.exitAddress == b.originalAddress)
 				e.linkStatus = false;
 		}
-	}
-	links_to.erase(b.originalAddress);
+	});
+	links_to.Erase(b.originalAddress);
 }
 
 void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -268,6 +394,19 @@ void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
 	WriteDestroyBlock(b.checkedEntry, b.originalAddress);
 }
 
+void JitBaseBlockCache::InvalidateBlock(int block_num)
+{
+	// A block found through several of its pages is destroyed the first time
+	if (blocks[block_num].invalid)
+		return;
+
+	ForEachRun(blocks[block_num], [&](u32 pAddr, u32 size) {
+		for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (pAddr + (size - 1) * 4) >> BLOCK_PAGE_SHIFT; ++page)
+			block_pages.Remove(page, block_num);
+	});
+	DestroyBlock(block_num, true);
+}
+
 void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length, bool forced)
 {
 	// Convert the logical address to a physical address for the block map
@@ -284,23 +423,27 @@ void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length, bool for
 	}
 
 	// destroy JIT blocks
-	// !! this works correctly under assumption that any two overlapping blocks end at the same address
-	if (destroy_block)
+	if (destroy_block && length)
 	{
-		std::map<std::pair<u32, u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-		while (it2 != block_map.end() && it2->first.second < pAddr + length)
+		// Collected first, destroying a block takes it off the lists of the pages it spans. A block
+		// spanning several of the pages is found once for each.
+		const u32 pEnd = pAddr + length;
+		blocks_to_destroy.clear();
+		for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (pEnd - 1) >> BLOCK_PAGE_SHIFT; ++page)
 		{
-			JitBlock &b = blocks[it2->second];
-			std::memcpy(GetICachePtr(b.originalAddress), &JIT_ICACHE_INVALID_WORD, sizeof(u32));
-
-			DestroyBlock(it2->second, true);
-			++it2;
-		}
-		if (it1 != it2)
-		{
-			block_map.erase(it1, it2);
+			block_pages.ForEach(page, [&](int block_num) {
+				bool overlaps = false;
+				ForEachRun(blocks[block_num], [&](u32 start, u32 size) {
+					overlaps |= start < pEnd && start + 4 * size > pAddr;
+				});
+				if (overlaps)
+					blocks_to_destroy.push_back(block_num);
+			});
 		}
 
+		for (int block_num : blocks_to_destroy)
+			InvalidateBlock(block_num);
+
 		// If the code was actually modified, we need to clear the relevant entries from the
 		// FIFO write address cache, so we don't end up with FIFO checks in places they shouldn't
 		// be (this can clobber flags, and thus break any optimization that relies on flags
@@ -6,8 +6,8 @@
 
 #include <array>
 #include <bitset>
-#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -31,7 +31,10 @@ struct JitBlock
 	u32 originalAddress;
 	u32 codeSize;
 	u32 originalSize;
-	int runCount;  // for profiling.
+	// Superblocks go on into the code of the branches they follow, these are the address and
+	// number of instructions of each run of code after the first
+	std::vector<std::pair<u32, u32>> followedRuns;
+	int runCount;  // for profiling, and for finding hot blocks.
 
 	bool invalid;
 
@@ -92,6 +95,60 @@ public:
 	}
 };
 
+// Maps a key to a list of block numbers, like a std::multimap<u32, int> without a heap node per
+// entry: the keys are in one open addressing table and the lists in one pool of nodes, which
+// keeps linking and invalidating blocks in a few cache lines.
+class JitBlockListMap final
+{
+public:
+	void Add(u32 key, int block_num);
+	// Removes one entry of block_num from the list of key
+	void Remove(u32 key, int block_num);
+	void Erase(u32 key);
+	void Clear();
+
+	template <typename Func>
+	void ForEach(u32 key, Func func) const
+	{
+		const u32 slot = Find(key);
+		if (slot == NONE)
+			return;
+		for (u32 node = m_slots[slot].head; node != NONE; node = m_nodes[node].next)
+			func(m_nodes[node].block_num);
+	}
+
+private:
+	enum : u32
+	{
+		NONE = 0xFFFFFFFF,
+		ERASED = 0xFFFFFFFE,
+	};
+
+	struct Slot
+	{
+		u32 key;
+		u32 head; // first node, NONE if the slot was never used, ERASED if its key was erased
+	};
+
+	struct Node
+	{
+		int block_num;
+		u32 next;
+	};
+
+	u32 Hash(u32 key) const { return (key * 0x9E3779B1u) >> m_shift; }
+	u32 Find(u32 key) const;
+	void Rehash(u32 size);
+	void EraseSlot(u32 slot);
+
+	std::vector<Slot> m_slots;
+	std::vector<Node> m_nodes;
+	u32 m_shift = 32;
+	u32 m_used_slots = 0; // erased ones too, until the next rehash
+	u32 m_num_keys = 0;
+	u32 m_free_node = NONE;
+};
+
 class JitBaseBlockCache
 {
 	enum
@@ -99,11 +156,16 @@ class JitBaseBlockCache
 		MAX_NUM_BLOCKS = 65536 * 2,
 	};
 
+	// Blocks are found for invalidation through the pages they span. Small pages keep the lists
+	// short, a block is rarely more than a few pages long.
+	static const u32 BLOCK_PAGE_SHIFT = 8;
+
 	std::array<const u8*, MAX_NUM_BLOCKS> blockCodePointers;
 	std::array<JitBlock, MAX_NUM_BLOCKS> blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32, u32>, u32> block_map; // (end_addr, start_addr) -> number
+	JitBlockListMap links_to; // exit address -> blocks exiting there
+	JitBlockListMap block_pages; // physical page -> blocks in it
+	std::vector<int> blocks_to_destroy;
 	ValidBlockBitSet valid_block;
 
 	bool m_initialized;
@@ -114,6 +176,8 @@ class JitBaseBlockCache
 
 	u8* GetICachePtr(u32 addr);
 	void DestroyBlock(int block_num, bool invalidate);
+	template <typename Func>
+	static void ForEachRun(const JitBlock& b, Func func);
 
 	// Virtual for overloaded
 	virtual void WriteLinkBlock(u8* location, const JitBlock& block) = 0;
@@ -151,8 +215,9 @@ public:
 
 	CompiledCode GetCompiledCodeFromBlock(int block_num);
 
-	// DOES NOT WORK CORRECTLY WITH INLINING
 	void InvalidateICache(u32 address, const u32 length, bool forced);
+	// Takes one block out of the cache, for it to be compiled again the next time it runs
+	void InvalidateBlock(int block_num);
 
 	u32* GetBlockBitSet() const
 	{
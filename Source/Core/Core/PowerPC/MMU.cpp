@@ -394,7 +394,7 @@ u32 Read_Opcode(u32 address)
 	return result.hex;
 }
 
-TryReadInstResult TryReadInstruction(u32 address)
+static TryReadInstResult TryReadInstruction(u32 address, bool peek)
 {
 	bool from_bat = true;
 	if (UReg_MSR(MSR).IR)
@@ -402,6 +402,10 @@ TryReadInstResult TryReadInstruction(u32 address)
 		// TODO: Use real translation.
 		if (SConfig::GetInstance().bMMU && (address & Memory::ADDR_MASK_MEM1))
 		{
+			// Translating updates the TLB
+			if (peek)
+				return TryReadInstResult{ false, false, 0 };
+
 			u32 tlb_addr = TranslateAddress<FLAG_OPCODE>(address);
 			if (tlb_addr == 0)
 			{
@@ -441,10 +445,21 @@ TryReadInstResult TryReadInstruction(u32 address)
 			ERROR_LOG(MEMMAP, "Strange program counter with address translation off: 0x%08x", address);
 	}
 
-	u32 hex = PowerPC::ppcState.iCache.ReadInstruction(address);
+	u32 hex = peek ? PowerPC::ppcState.iCache.PeekInstruction(address) :
+		PowerPC::ppcState.iCache.ReadInstruction(address);
 	return TryReadInstResult{ true, from_bat, hex };
 }
 
+TryReadInstResult TryReadInstruction(u32 address)
+{
+	return TryReadInstruction(address, false);
+}
+
+TryReadInstResult TryPeekInstruction(u32 address)
+{
+	return TryReadInstruction(address, true);
+}
+
 u32 HostRead_Instruction(const u32 address)
 {
 	UGeckoInstruction inst = HostRead_U32(address);
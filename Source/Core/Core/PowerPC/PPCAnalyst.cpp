@@ -33,6 +33,9 @@ namespace PPCAnalyst
 static const int CODEBUFFER_SIZE = 32000;
 // 0 does not perform block merging
 static const u32 FUNCTION_FOLLOWING_THRESHOLD = 16;
+// Branches a superblock follows at most, and how deep it goes into the calls it follows
+static const u32 TRACE_FOLLOWING_THRESHOLD = 8;
+static const u32 TRACE_CALL_DEPTH = 4;
 
 CodeBuffer::CodeBuffer(int size)
 {
@@ -650,10 +653,14 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	u32 numFollows = 0;
 	u32 num_inst = 0;
 	bool prev_inst_from_bat = true;
+	bool followed_branch = false;
+	u32 trace_returns[TRACE_CALL_DEPTH];
+	u32 num_trace_returns = 0;
 
 	for (u32 i = 0; i < blockSize; ++i)
 	{
-		auto result = PowerPC::TryReadInstruction(address);
+		auto result = HasOption(OPTION_PEEK) ? PowerPC::TryPeekInstruction(address) :
+			PowerPC::TryReadInstruction(address);
 		if (!result.valid)
 		{
 			if (i == 0)
@@ -670,6 +677,9 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		{
 			break;
 		}
+		// Likewise, superblocks only follow branches within BAT mapped code
+		if (followed_branch && !result.from_bat)
+			break;
 		prev_inst_from_bat = result.from_bat;
 
 		num_inst++;
@@ -690,6 +700,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		u32 destination = 0;
 
 		bool conditional_continue = false;
+		bool conditional_follow = false;
 
 		// Do we inline leaf functions?
 		if (HasOption(OPTION_LEAF_INLINE))
@@ -738,6 +749,51 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 				follow = false;
 		}
 
+		if (HasOption(OPTION_TRACE) && result.from_bat && numFollows < TRACE_FOLLOWING_THRESHOLD)
+		{
+			if (inst.OPCD == 18 && (!inst.LK || num_trace_returns < TRACE_CALL_DEPTH))
+			{
+				// bx
+				if (inst.AA)
+					destination = SignExt26(inst.LI << 2);
+				else
+					destination = address + SignExt26(inst.LI << 2);
+				follow = true;
+			}
+			else if (inst.OPCD == 16 && !inst.LK)
+			{
+				// bcx, followed where it is expected to branch to
+				if (inst.AA)
+					destination = SignExt16(inst.BD << 2);
+				else
+					destination = address + SignExt16(inst.BD << 2);
+				follow = true;
+				conditional_follow = (inst.BO & BO_DONT_DECREMENT_FLAG) == 0 ||
+					(inst.BO & BO_DONT_CHECK_CONDITION) == 0;
+			}
+			else if (inst.OPCD == 19 && inst.SUBOP10 == 16 && !inst.LK &&
+				(inst.BO & BO_DONT_DECREMENT_FLAG) && (inst.BO & BO_DONT_CHECK_CONDITION) &&
+				num_trace_returns > 0)
+			{
+				// blr from a call the block followed. The JIT checks LR still holds the return
+				// address, the callee may have stored another one.
+				destination = trace_returns[--num_trace_returns];
+				follow = true;
+			}
+
+			// Loops are left to block linking, the block would otherwise have to keep its registers
+			// the same way around them
+			for (u32 j = 0; follow && j <= i; j++)
+			{
+				if (code[j].address == destination)
+					follow = false;
+			}
+			if (follow && m_follow_predicate)
+				follow = m_follow_predicate(destination, conditional_follow);
+			if (follow && inst.OPCD == 18 && inst.LK)
+				trace_returns[num_trace_returns++] = address + 4;
+		}
+
 		if (HasOption(OPTION_CONDITIONAL_CONTINUE))
 		{
 			if (inst.OPCD == 16 &&
@@ -776,18 +832,20 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 				break;
 			}
 		}
-		// XXX: We don't support inlining yet.
-#if 0
 		else
 		{
 			numFollows++;
 			// We don't "code[i].skip = true" here
 			// because bx may store a certain value to the link register.
 			// Instead, we skip a part of bx in Jit**::bx().
+			code[i].isFollowedBranch = true;
+			code[i].branchTo = destination;
+			// Only the conditional branches and the returns can still leave the block
+			if (inst.OPCD == 18 || (inst.OPCD == 16 && !conditional_follow))
+				code[i].canEndBlock = false;
 			address = destination;
-			merged_addresses[size_of_merged_addresses++] = address;
+			followed_branch = true;
 		}
-#endif
 	}
 
 	block->m_num_instructions = num_inst;
@@ -6,8 +6,10 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -25,7 +27,7 @@ struct CodeOp //16B
 	UGeckoInstruction inst;
 	GekkoOPInfo * opinfo;
 	u32 address;
-	u32 branchTo; //if 0, not a branch
+	u32 branchTo; // where a followed branch goes, the address of the next instruction
 	int branchToIndex; //index of target block
 	BitSet32 regsOut;
 	BitSet32 regsIn;
@@ -43,6 +45,7 @@ struct CodeOp //16B
 	bool outputCA;
 	bool canEndBlock;
 	bool skip;  // followed BL-s for example
+	bool isFollowedBranch; // the block goes on at branchTo rather than ending or branching out
 	// which registers are still needed after this instruction in this block
 	BitSet32 fprInUse;
 	BitSet32 gprInUse;
@@ -221,8 +224,20 @@ public:
 
 		// Reorder cror instructions next to their associated fcmp.
 		OPTION_CROR_MERGE = (1 << 6),
+
+		// Follow branches into the code that runs after them, for superblocks of hot code.
+		// Unconditional branches and calls are followed, as are the returns of the calls followed,
+		// and conditional branches the follow predicate expects to be taken. Returns and
+		// conditional branches leave the block when they go the other way.
+		// Requires JIT support to be enabled.
+		OPTION_TRACE = (1 << 7),
+
+		// Read the instructions with TryPeekInstruction, for code the game has not run yet
+		OPTION_PEEK = (1 << 8),
 	};
 
+	// Tells whether a branch to destination should be followed, conditional or not
+	using FollowPredicate = std::function<bool(u32 destination, bool conditional)>;
 
 	PPCAnalyzer() : m_options(0) {}
 
@@ -231,7 +246,12 @@ public:
 	void ClearOption(AnalystOption option) { m_options &= ~(option); }
 	bool HasOption(AnalystOption option) const { return !!(m_options & option); }
 
+	void SetFollowPredicate(FollowPredicate predicate) { m_follow_predicate = std::move(predicate); }
+
 	u32 Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize);
+
+private:
+	FollowPredicate m_follow_predicate;
 };
 
 void LogFunctionCall(u32 addr);
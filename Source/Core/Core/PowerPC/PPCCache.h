@@ -33,6 +33,8 @@ struct InstructionCache
 
 	InstructionCache();
 	u32 ReadInstruction(u32 addr);
+	// What ReadInstruction would return, without loading the line or touching the replacement state
+	u32 PeekInstruction(u32 addr) const;
 	void Invalidate(u32 addr);
 	void Init();
 	void Reset();
@@ -0,0 +1,465 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Logging/Log.h"
+#include "Core/GeckoCode.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/SamplingProfiler.h"
+
+namespace SamplingProfiler
+{
+// Enough to tell the callers of a routine apart, well below the cost of the emulation
+static const u32 SAMPLES_PER_SECOND = 4000;
+static const u64 NANOSECONDS_PER_SAMPLE = 1000000000 / SAMPLES_PER_SECOND;
+static const u32 MAX_STACK_DEPTH = 64;
+static const u32 CODE_HANDLER_START = 0x80001800;
+static const u32 CODE_HANDLER_END = 0x80003000;
+static const char RESIMULATED_FRAME[] = "[resimulated]";
+
+static std::mutex s_control_mutex;
+static bool s_initialized;
+static std::atomic<bool> s_running{false};
+static std::atomic<bool> s_sample_due{false};
+static std::atomic<bool> s_resimulating{false};
+
+static std::thread s_timer_thread;
+static std::mutex s_timer_mutex;
+static std::condition_variable s_timer_cv;
+static bool s_timer_quit;
+
+static std::mutex s_samples_mutex;
+static Profile s_profile;
+static Stack s_stack;
+
+// Asks for a sample every so often. When the CPU thread doesn't get to the request in time, as when
+// it waits on the GPU, the requests in between fold into one.
+static void TimerThread()
+{
+	Common::SetCurrentThreadName("Sampling profiler");
+	const auto interval = std::chrono::nanoseconds(NANOSECONDS_PER_SAMPLE);
+	auto next = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lk(s_timer_mutex);
+	while (!s_timer_quit)
+	{
+		next += interval;
+		if (s_timer_cv.wait_until(lk, next, [] { return s_timer_quit; }))
+			break;
+		s_sample_due.store(true, std::memory_order_relaxed);
+	}
+}
+
+// Both called with s_control_mutex held
+static void StartTimer()
+{
+	if (s_timer_thread.joinable())
+		return;
+	s_timer_quit = false;
+	s_timer_thread = std::thread(TimerThread);
+}
+
+static void StopTimer()
+{
+	if (!s_timer_thread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lk(s_timer_mutex);
+		s_timer_quit = true;
+	}
+	s_timer_cv.notify_one();
+	s_timer_thread.join();
+	s_sample_due = false;
+}
+
+static void TakeSample()
+{
+	s_stack.clear();
+	s_stack.push_back(PC);
+	s_stack.push_back(LR);
+
+	// Each frame starts with the back chain, the callee keeps its return address in the word after
+	u32 frame = 0;
+	if (PowerPC::HostIsRAMAddress(GPR(1)))
+		frame = PowerPC::HostRead_U32(GPR(1));
+	while (s_stack.size() < MAX_STACK_DEPTH && frame && PowerPC::HostIsRAMAddress(frame) &&
+		PowerPC::HostIsRAMAddress(frame + 4))
+	{
+		const u32 return_address = PowerPC::HostRead_U32(frame + 4);
+		if (!return_address)
+			break;
+		s_stack.push_back(return_address);
+
+		// The stack grows down, anything else is the end of it or garbage
+		const u32 next = PowerPC::HostRead_U32(frame);
+		if (next <= frame)
+			break;
+		frame = next;
+	}
+
+	std::lock_guard<std::mutex> lk(s_samples_mutex);
+	if (s_resimulating.load(std::memory_order_relaxed))
+		s_profile.resimulated[s_stack]++;
+	else
+		s_profile.stacks[s_stack]++;
+}
+
+void Poll()
+{
+	if (!s_sample_due.load(std::memory_order_relaxed))
+		return;
+	s_sample_due.store(false, std::memory_order_relaxed);
+	TakeSample();
+}
+
+void SetResimulating(bool resimulating)
+{
+	s_resimulating.store(resimulating, std::memory_order_relaxed);
+}
+
+void Init()
+{
+	std::lock_guard<std::mutex> lk(s_control_mutex);
+	s_initialized = true;
+	s_sample_due = false;
+	s_resimulating = false;
+	if (s_running)
+		StartTimer();
+}
+
+void Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_control_mutex);
+	s_initialized = false;
+	StopTimer();
+	s_resimulating = false;
+}
+
+void Start()
+{
+	std::lock_guard<std::mutex> lk(s_control_mutex);
+	{
+		std::lock_guard<std::mutex> samples_lk(s_samples_mutex);
+		s_profile = Profile();
+	}
+	s_running = true;
+	if (s_initialized)
+		StartTimer();
+}
+
+void Stop()
+{
+	std::lock_guard<std::mutex> lk(s_control_mutex);
+	s_running = false;
+	StopTimer();
+}
+
+bool IsRunning()
+{
+	return s_running;
+}
+
+// Innermost first, with return addresses turned into the calls they return from
+static std::vector<u32> GetFrames(const Stack& stack, const Symbolizer& symbolize)
+{
+	std::vector<u32> frames;
+	if (stack.empty())
+		return frames;
+	frames.push_back(stack[0]);
+
+	// LR is only the caller of a leaf routine, or of one that has not saved it yet. Otherwise it is
+	// left over from a call the routine made, or the same as the first return address on the stack.
+	if (stack.size() > 1 && stack[1])
+	{
+		const u32 first_return = stack.size() > 2 ? stack[2] : 0;
+		if (stack[1] != first_return && symbolize(stack[1] - 4) != symbolize(stack[0]))
+			frames.push_back(stack[1] - 4);
+	}
+	for (size_t i = 2; i < stack.size(); i++)
+		frames.push_back(stack[i] - 4);
+	return frames;
+}
+
+// Looks every address up once
+static Symbolizer Cached(const Symbolizer& symbolize)
+{
+	auto cache = std::make_shared<std::map<u32, std::string>>();
+	return [cache, symbolize](u32 address) {
+		auto it = cache->find(address);
+		if (it == cache->end())
+			it = cache->emplace(address, symbolize(address)).first;
+		return it->second;
+	};
+}
+
+static void Fold(const Stacks& stacks, const Symbolizer& names, const std::string& root,
+	std::map<std::string, u64>* folded)
+{
+	for (const auto& stack : stacks)
+	{
+		const std::vector<u32> frames = GetFrames(stack.first, names);
+		std::string line = root;
+		for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+		{
+			// Frames are separated by semicolons and the count by the last space
+			std::string name = names(*it);
+			std::replace(name.begin(), name.end(), ';', ':');
+			std::replace(name.begin(), name.end(), ' ', '_');
+			if (!line.empty())
+				line += ';';
+			line += name;
+		}
+		(*folded)[line] += stack.second;
+	}
+}
+
+std::string ToFolded(const Profile& profile, const Symbolizer& symbolize)
+{
+	const Symbolizer names = Cached(symbolize);
+	std::map<std::string, u64> folded;
+	Fold(profile.stacks, names, "", &folded);
+	// Under a frame of their own, so the flame graph shows what rollbacks cost next to the rest
+	Fold(profile.resimulated, names, RESIMULATED_FRAME, &folded);
+
+	std::string result;
+	for (const auto& line : folded)
+		result += StringFromFormat("%s %llu\n", line.first.c_str(), static_cast<unsigned long long>(line.second));
+	return result;
+}
+
+namespace
+{
+// Just enough of the protobuf wire format for the pprof messages
+class ProtoWriter
+{
+public:
+	void Varint(u32 field, u64 value)
+	{
+		Key(field, 0);
+		Raw(value);
+	}
+
+	void Bytes(u32 field, const std::string& bytes)
+	{
+		Key(field, 2);
+		Raw(bytes.size());
+		m_data += bytes;
+	}
+
+	void Message(u32 field, const ProtoWriter& message) { Bytes(field, message.m_data); }
+
+	void Packed(u32 field, const std::vector<u64>& values)
+	{
+		ProtoWriter packed;
+		for (u64 value : values)
+			packed.Raw(value);
+		Bytes(field, packed.m_data);
+	}
+
+	const std::string& GetData() const { return m_data; }
+
+private:
+	void Key(u32 field, u32 wire_type) { Raw(field << 3 | wire_type); }
+
+	void Raw(u64 value)
+	{
+		while (value >= 0x80)
+		{
+			m_data += static_cast<char>(value | 0x80);
+			value >>= 7;
+		}
+		m_data += static_cast<char>(value);
+	}
+
+	std::string m_data;
+};
+
+class StringTable
+{
+public:
+	StringTable() { Get(""); }
+
+	u64 Get(const std::string& string)
+	{
+		auto inserted = m_indices.emplace(string, m_strings.size());
+		if (inserted.second)
+			m_strings.push_back(string);
+		return inserted.first->second;
+	}
+
+	const std::vector<std::string>& GetStrings() const { return m_strings; }
+
+private:
+	std::map<std::string, u64> m_indices;
+	std::vector<std::string> m_strings;
+};
+
+// Field numbers from profile.proto
+enum ProfileField : u32
+{
+	PROFILE_SAMPLE_TYPE = 1,
+	PROFILE_SAMPLE = 2,
+	PROFILE_LOCATION = 4,
+	PROFILE_FUNCTION = 5,
+	PROFILE_STRING_TABLE = 6,
+	PROFILE_PERIOD_TYPE = 11,
+	PROFILE_PERIOD = 12,
+};
+}
+
+static ProtoWriter ValueType(StringTable* strings, const std::string& type, const std::string& unit)
+{
+	ProtoWriter value_type;
+	value_type.Varint(1, strings->Get(type));
+	value_type.Varint(2, strings->Get(unit));
+	return value_type;
+}
+
+std::string ToPprof(const Profile& samples, const Symbolizer& symbolize, u64 nanoseconds_per_sample)
+{
+	const Symbolizer names = Cached(symbolize);
+	StringTable strings;
+	ProtoWriter profile;
+	profile.Message(PROFILE_SAMPLE_TYPE, ValueType(&strings, "samples", "count"));
+	profile.Message(PROFILE_SAMPLE_TYPE, ValueType(&strings, "time", "nanoseconds"));
+	profile.Message(PROFILE_PERIOD_TYPE, ValueType(&strings, "time", "nanoseconds"));
+	profile.Varint(PROFILE_PERIOD, nanoseconds_per_sample);
+
+	// Resimulated samples carry a label, for pprof -tagfocus and -tagignore
+	ProtoWriter resimulated_label;
+	resimulated_label.Varint(1, strings.Get("rollback"));
+	resimulated_label.Varint(2, strings.Get("resimulated"));
+
+	// Ids start at 1, 0 means none
+	std::map<u32, u64> locations;
+	std::map<std::string, u64> functions;
+	auto add_samples = [&](const Stacks& stacks, bool resimulated) {
+		for (const auto& stack : stacks)
+		{
+			std::vector<u64> location_ids;
+			for (u32 address : GetFrames(stack.first, names))
+			{
+				auto location = locations.find(address);
+				if (location == locations.end())
+				{
+					const std::string name = names(address);
+					auto function = functions.emplace(name, functions.size() + 1);
+					if (function.second)
+					{
+						ProtoWriter message;
+						message.Varint(1, function.first->second);
+						message.Varint(2, strings.Get(name));
+						message.Varint(3, strings.Get(name));
+						profile.Message(PROFILE_FUNCTION, message);
+					}
+
+					location = locations.emplace(address, locations.size() + 1).first;
+					ProtoWriter line;
+					line.Varint(1, function.first->second);
+					ProtoWriter message;
+					message.Varint(1, location->second);
+					message.Varint(3, address);
+					message.Message(4, line);
+					profile.Message(PROFILE_LOCATION, message);
+				}
+				location_ids.push_back(location->second);
+			}
+
+			ProtoWriter sample;
+			sample.Packed(1, location_ids);
+			sample.Packed(2, {stack.second, stack.second * nanoseconds_per_sample});
+			if (resimulated)
+				sample.Message(3, resimulated_label);
+			profile.Message(PROFILE_SAMPLE, sample);
+		}
+	};
+	add_samples(samples.stacks, false);
+	add_samples(samples.resimulated, true);
+
+	for (const std::string& string : strings.GetStrings())
+		profile.Bytes(PROFILE_STRING_TABLE, string);
+	return profile.GetData();
+}
+
+// Where the codes of the active GCT ended up in MEM1, 0 if they are not there
+static u32 FindGct(const std::vector<u8>& gct)
+{
+	// Only the header and the first line are compared, the code handler patches C2 codes as it
+	// runs them
+	const size_t compared = 16;
+	if (!Memory::m_pRAM || gct.size() <= compared)
+		return 0;
+
+	for (u32 offset = 0; offset + gct.size() <= Memory::REALRAM_SIZE; offset += 4)
+	{
+		if (!std::memcmp(Memory::m_pRAM + offset, gct.data(), compared))
+			return 0x80000000 | offset;
+	}
+	return 0;
+}
+
+static Symbolizer GetGuestSymbolizer()
+{
+	const std::vector<u8> gct = Gecko::GenerateGct();
+	const u32 gct_address = FindGct(gct);
+	const std::vector<Gecko::GctEntry> layout = Gecko::GetGctLayout();
+	return [gct_address, layout](u32 address) -> std::string {
+		const Symbol* symbol = g_symbolDB.GetSymbolFromAddr(address);
+		if (symbol)
+			return symbol->name;
+
+		if (gct_address && address >= gct_address)
+		{
+			for (const Gecko::GctEntry& entry : layout)
+			{
+				if (address - gct_address >= entry.offset && address - gct_address < entry.offset + entry.size)
+					return "Gecko: " + entry.name;
+			}
+		}
+
+		if (address >= CODE_HANDLER_START && address < CODE_HANDLER_END)
+			return "Gecko code handler";
+		return StringFromFormat("0x%08x", address);
+	};
+}
+
+static bool WriteProfile(const std::string& filename, const std::string& contents)
+{
+	File::CreateFullPath(filename);
+	if (!File::WriteStringToFile(contents, filename))
+	{
+		ERROR_LOG(POWERPC, "Could not write the sampled profile to %s", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool WriteFolded(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lk(s_samples_mutex);
+	if (s_profile.stacks.empty() && s_profile.resimulated.empty())
+		return false;
+	return WriteProfile(filename, ToFolded(s_profile, GetGuestSymbolizer()));
+}
+
+bool WritePprof(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lk(s_samples_mutex);
+	if (s_profile.stacks.empty() && s_profile.resimulated.empty())
+		return false;
+	return WriteProfile(filename, ToPprof(s_profile, GetGuestSymbolizer(), NANOSECONDS_PER_SAMPLE));
+}
+}
@@ -0,0 +1,56 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Samples the guest PC and call stack every so often in host time, for finding where the game
+// spends its time without the cost of profiling every JIT block. The samples are written out with
+// the addresses named after the symbol map and the active Gecko codes, either folded for
+// flamegraph.pl or in the pprof protobuf format.
+namespace SamplingProfiler
+{
+// PC, LR, then the return addresses found walking the stack frames
+using Stack = std::vector<u32>;
+// Times each stack was sampled
+using Stacks = std::map<Stack, u64>;
+using Symbolizer = std::function<std::string(u32 address)>;
+
+struct Profile
+{
+	Stacks stacks;
+	// Sampled while a rollback ran frames again
+	Stacks resimulated;
+};
+
+// Called on the CPU thread at boot and shutdown, like the other timed events
+void Init();
+void Shutdown();
+
+// Samples from now on, dropping what was sampled before. A host thread asks for the samples and the
+// CPU thread takes them when CoreTiming next advances, so the guest runs the same with and
+// without sampling, in netplay too.
+void Start();
+void Stop();
+bool IsRunning();
+
+// Called by CoreTiming on the CPU thread between slices
+void Poll();
+
+// Tags the samples taken from now on as resimulated or not, called on the CPU thread
+void SetResimulating(bool resimulating);
+
+// Written while the emulation is paused, the symbols are looked up in guest memory
+bool WriteFolded(const std::string& filename);
+bool WritePprof(const std::string& filename);
+
+std::string ToFolded(const Profile& profile, const Symbolizer& symbolize);
+std::string ToPprof(const Profile& profile, const Symbolizer& symbolize, u64 nanoseconds_per_sample);
+}
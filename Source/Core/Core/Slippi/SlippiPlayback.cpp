@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 #include <mutex>
 
@@ -16,7 +17,6 @@
 #include "SlippiPlayback.h"
 #include <VideoCommon/OnScreenDisplay.h>
 
-#define FRAME_INTERVAL 900
 #define SLEEP_TIME_MS 8
 
 std::unique_ptr<SlippiPlaybackStatus> g_playbackStatus;
@@ -24,12 +24,8 @@ extern std::unique_ptr<SlippiReplayComm> g_replayComm;
 
 static std::mutex mtx;
 static std::mutex seekMtx;
-static std::mutex diffMtx;
-static std::unique_lock<std::mutex> processingLock(diffMtx);
 static std::condition_variable condVar;
 static std::condition_variable cv_waitingForTargetFrame;
-static std::condition_variable cv_processingDiff;
-static std::atomic<int> numDiffsProcessing(0);
 
 s32 emod(s32 a, s32 b)
 {
@@ -38,21 +34,6 @@ s32 emod(s32 a, s32 b)
 	return r >= 0 ? r : r + std::abs(b);
 }
 
-std::string processDiff(std::vector<u8> iState, std::vector<u8> cState)
-{
-	INFO_LOG(SLIPPI, "Processing diff");
-	numDiffsProcessing += 1;
-	cv_processingDiff.notify_one();
-	std::string diff = std::string();
-	open_vcdiff::VCDiffEncoder encoder((char *)iState.data(), iState.size());
-	encoder.Encode((char *)cState.data(), cState.size(), &diff);
-
-	INFO_LOG(SLIPPI, "done processing");
-	numDiffsProcessing -= 1;
-	cv_processingDiff.notify_one();
-	return diff;
-}
-
 SlippiPlaybackStatus::SlippiPlaybackStatus()
 {
 	shouldJumpBack = false;
@@ -68,6 +49,11 @@ SlippiPlaybackStatus::SlippiPlaybackStatus()
 	prevOCEnable = SConfig::GetInstance().m_OCEnable;
 	prevOCFactor = SConfig::GetInstance().m_OCFactor;
 
+	stateInterval = std::max(SConfig::GetInstance().m_slippiSeekStateInterval, 60);
+	seekStates = std::make_unique<SlippiSeekStateStore>(
+	    std::max(SConfig::GetInstance().m_slippiSeekKeyframeInterval, 1),
+	    (size_t)std::max(SConfig::GetInstance().m_slippiSeekStateBudgetMB, 16) * 1024 * 1024);
+
 	// Only generate these if this is a playback configuration. Should this class get initialized at all?
 	#ifdef IS_PLAYBACK
 	generateDenylist();
@@ -90,17 +76,10 @@ void SlippiPlaybackStatus::startThreads()
 	}
 }
 
-void SlippiPlaybackStatus::prepareSlippiPlayback(s32 &frameIndex)
+void SlippiPlaybackStatus::prepareSlippiPlayback(s32 frameIndex)
 {
-	// block if there's too many diffs being processed
-	while (shouldRunThreads && numDiffsProcessing > 3)
-	{
-		INFO_LOG(SLIPPI, "Processing too many diffs, blocking main process");
-		cv_processingDiff.wait(processingLock);
-	}
-
 	// Unblock thread to save a state every interval
-	if (shouldRunThreads && ((currentPlaybackFrame + 122) % FRAME_INTERVAL == 0))
+	if (shouldRunThreads && ((currentPlaybackFrame - Slippi::PLAYBACK_FIRST_SAVE) % stateInterval == 0))
 		condVar.notify_one();
 
 	if (SConfig::GetInstance().m_slippiEnableFrameIndex)
@@ -144,8 +123,7 @@ void SlippiPlaybackStatus::resetPlayback()
 			m_seekThread.detach();
 
 		condVar.notify_one(); // Will allow thread to kill itself
-		futureDiffs.clear();
-		futureDiffs.rehash(0);
+		seekStates->Clear();
 	}
 
 	shouldJumpBack = false;
@@ -173,7 +151,7 @@ void SlippiPlaybackStatus::SavestateThread()
 	{
 		// Wait to hit one of the intervals
 		// Possible while rewinding that we hit this wait again.
-		while (shouldRunThreads && (currentPlaybackFrame - Slippi::PLAYBACK_FIRST_SAVE) % FRAME_INTERVAL != 0)
+		while (shouldRunThreads && (currentPlaybackFrame - Slippi::PLAYBACK_FIRST_SAVE) % stateInterval != 0)
 			condVar.wait(intervalLock);
 
 		if (!shouldRunThreads)
@@ -184,7 +162,7 @@ void SlippiPlaybackStatus::SavestateThread()
 			continue;
 
 		bool isStartFrame = fixedFrameNumber == Slippi::PLAYBACK_FIRST_SAVE;
-		bool hasStateBeenProcessed = futureDiffs.count(fixedFrameNumber) > 0;
+		bool hasStateBeenProcessed = seekStates->Contains(fixedFrameNumber);
 
 		if (!inSlippiPlayback && isStartFrame)
 		{
@@ -194,10 +172,17 @@ void SlippiPlaybackStatus::SavestateThread()
 		else if (SConfig::GetInstance().m_InterfaceSeekbar && !SConfig::GetInstance().m_CLIHideSeekbar &&
 		         !hasStateBeenProcessed && !isStartFrame)
 		{
-			INFO_LOG(SLIPPI, "saving diff at frame: %d", fixedFrameNumber);
-			State::SaveToBuffer(cState);
-
-			futureDiffs[fixedFrameNumber] = std::async(processDiff, iState, cState);
+			if (seekStates->ShouldSkipState())
+			{
+				WARN_LOG(SLIPPI, "Seek state encoder is behind, skipping state at frame: %d", fixedFrameNumber);
+			}
+			else
+			{
+				INFO_LOG(SLIPPI, "saving state at frame: %d", fixedFrameNumber);
+				std::vector<u8> state = seekStates->AcquireBuffer();
+				State::SaveToBuffer(state);
+				seekStates->Submit(fixedFrameNumber, std::move(state));
+			}
 		}
 		Common::SleepCurrentThread(SLEEP_TIME_MS);
 	}
@@ -242,7 +227,7 @@ void SlippiPlaybackStatus::SeekThread()
 				targetFrameNum = latestFrame;
 			}
 
-			s32 closestStateFrame = targetFrameNum - emod(targetFrameNum - Slippi::PLAYBACK_FIRST_SAVE, FRAME_INTERVAL);
+			s32 closestStateFrame = targetFrameNum - emod(targetFrameNum - Slippi::PLAYBACK_FIRST_SAVE, stateInterval);
 
 			// Somtimes prepareSlippiPlayback sets currentPlaybackFrame = targetFrameNum so check if target is <=
 			bool isLoadingStateOptimal =
@@ -256,25 +241,25 @@ void SlippiPlaybackStatus::SeekThread()
 				}
 				else
 				{
-					// If this diff has been processed, load it
-					if (futureDiffs.count(closestStateFrame) > 0)
+					// If this state has been saved, load it
+					if (seekStates->Contains(closestStateFrame))
 					{
 						loadState(closestStateFrame);
 					}
 					else if (targetFrameNum < currentPlaybackFrame)
 					{
-						s32 closestActualStateFrame = closestStateFrame - FRAME_INTERVAL;
+						s32 closestActualStateFrame = closestStateFrame - stateInterval;
 						while (closestActualStateFrame > Slippi::PLAYBACK_FIRST_SAVE &&
-						       futureDiffs.count(closestActualStateFrame) == 0)
-							closestActualStateFrame -= FRAME_INTERVAL;
+						       !seekStates->Contains(closestActualStateFrame))
+							closestActualStateFrame -= stateInterval;
 						loadState(closestActualStateFrame);
 					}
 					else if (targetFrameNum > currentPlaybackFrame)
 					{
-						s32 closestActualStateFrame = closestStateFrame - FRAME_INTERVAL;
+						s32 closestActualStateFrame = closestStateFrame - stateInterval;
 						while (closestActualStateFrame > currentPlaybackFrame &&
-						       futureDiffs.count(closestActualStateFrame) == 0)
-							closestActualStateFrame -= FRAME_INTERVAL;
+						       !seekStates->Contains(closestActualStateFrame))
+							closestActualStateFrame -= stateInterval;
 
 						// only load a savestate if we find one past our current frame since we are seeking forwards
 						if (closestActualStateFrame > currentPlaybackFrame)
@@ -329,12 +314,13 @@ void SlippiPlaybackStatus::loadState(s32 closestStateFrame)
 {
 	if (closestStateFrame == Slippi::PLAYBACK_FIRST_SAVE)
 		State::LoadFromBuffer(iState);
+	else if (seekStates->Load(closestStateFrame, loadBuffer))
+		State::LoadFromBuffer(loadBuffer);
 	else
 	{
-		std::string stateString;
-		decoder.Decode((char *)iState.data(), iState.size(), futureDiffs[closestStateFrame].get(), &stateString);
-		std::vector<u8> stateToLoad(stateString.begin(), stateString.end());
-		State::LoadFromBuffer(stateToLoad);
+		// The state was dropped to stay in the memory budget, replay from the start instead
+		WARN_LOG(SLIPPI, "Seek state for frame %d is gone, loading initial state", closestStateFrame);
+		State::LoadFromBuffer(iState);
 	}
 }
 
@@ -2,13 +2,13 @@
 
 #include <SlippiLib/SlippiGame.h>
 #include <climits>
-#include <future>
-#include <open-vcdiff/src/google/vcdecoder.h>
-#include <open-vcdiff/src/google/vcencoder.h>
+#include <thread>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Core/Slippi/SlippiSeekStateStore.h"
 
 class SlippiPlaybackStatus
 {
@@ -36,7 +36,7 @@ class SlippiPlaybackStatus
 	void startThreads(void);
 	void resetPlayback(void);
 	bool shouldFFWFrame(int32_t frameIndex) const;
-	void prepareSlippiPlayback(s32 &frameIndex);
+	void prepareSlippiPlayback(s32 frameIndex);
 	void setHardFFW(bool enable);
 	std::unordered_map<u32, bool> getDenylist();
 	std::vector<u8> getLegacyCodelist();
@@ -50,14 +50,11 @@ class SlippiPlaybackStatus
 	void generateDenylist();
 	void generateLegacyCodelist();
 
-	std::unordered_map<int32_t, std::shared_future<std::string>>
-	    futureDiffs;        // State diffs keyed by frameIndex, processed async
-	std::vector<u8> iState; // The initial state
-	std::vector<u8> cState; // The current (latest) state
+	s32 stateInterval;                                // Frames between seek states
+	std::unique_ptr<SlippiSeekStateStore> seekStates; // Seek states keyed by frameIndex, encoded async
+	std::vector<u8> iState;                           // The initial state
+	std::vector<u8> loadBuffer;                       // Seek state being loaded
 
 	std::unordered_map<u32, bool> denylist;
 	std::vector<u8> legacyCodelist;
-
-	open_vcdiff::VCDiffDecoder decoder;
-	open_vcdiff::VCDiffEncoder *encoder = NULL;
 };
@@ -106,7 +106,7 @@ std::unique_ptr<Slippi::SlippiGame> SlippiReplayComm::loadGame()
 {
 	auto replayFilePath = getReplayPath();
 	INFO_LOG(EXPANSIONINTERFACE, "Attempting to load replay file %s", replayFilePath.c_str());
-	auto result = Slippi::SlippiGame::FromFile(replayFilePath);
+	auto result = Slippi::SlippiGame::FromFile(replayFilePath, Slippi::ParseMode::Mapped);
 	if (result)
 	{
 		// If we successfully loaded a SlippiGame, indicate as such so
@@ -0,0 +1,61 @@
+#include "SlippiResimulation.h"
+#include <algorithm>
+
+void SlippiResimulation::Reset(bool skipDraws, bool compareSkipping)
+{
+	latestFrame = 0;
+	resimulating = false;
+	this->skipDraws = skipDraws;
+	this->compareSkipping = compareSkipping;
+	stats[0] = Stats();
+	stats[1] = Stats();
+}
+
+SlippiResimulation::Stats SlippiResimulation::GetStats() const
+{
+	Stats total;
+	total.rollbacks = stats[0].rollbacks + stats[1].rollbacks;
+	total.frames = stats[0].frames + stats[1].frames;
+	total.hostTimeUs = stats[0].hostTimeUs + stats[1].hostTimeUs;
+	total.maxRollbackUs = std::max(stats[0].maxRollbackUs, stats[1].maxRollbackUs);
+	return total;
+}
+
+void SlippiResimulation::NewFrame(s32 frame, u64 timeUs)
+{
+	// Should the capture of the last frame have been missed
+	if (resimulating)
+		finish(timeUs);
+
+	latestFrame = frame;
+}
+
+void SlippiResimulation::LoadState(s32 frame, u64 timeUs)
+{
+	if (resimulating)
+		finish(timeUs);
+
+	if (frame >= latestFrame)
+		return;
+
+	resimulating = true;
+	startTimeUs = timeUs;
+	// A comparison alternates, starting with a rollback that draws
+	skippingDraws = compareSkipping ? GetStats().rollbacks % 2 == 1 : skipDraws;
+	stats[skippingDraws].rollbacks++;
+	stats[skippingDraws].frames += latestFrame - frame;
+}
+
+void SlippiResimulation::CaptureState(s32 frame, u64 timeUs)
+{
+	if (resimulating && frame >= latestFrame)
+		finish(timeUs);
+}
+
+void SlippiResimulation::finish(u64 timeUs)
+{
+	u64 elapsedUs = timeUs - startTimeUs;
+	stats[skippingDraws].hostTimeUs += elapsedUs;
+	stats[skippingDraws].maxRollbackUs = std::max(stats[skippingDraws].maxRollbackUs, elapsedUs);
+	resimulating = false;
+}
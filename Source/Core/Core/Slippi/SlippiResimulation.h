@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Follows the frames the game runs again after a rollback loads an older savestate. Those frames
+// only matter for the game state they leave behind, nothing they draw is shown, so the GPU can skip
+// their draws while IsResimulating() is true. Also measures the host time each rollback takes.
+//
+// To benchmark the skipping, every other rollback can be made to draw its frames. The rollbacks of
+// one game then give the host time per frame with and without skipping, on the same workload.
+//
+// The game captures a savestate at the start of every frame it runs, including the frames it runs
+// again. Resimulation ends when it captures the frame it was at when it rolled back.
+class SlippiResimulation
+{
+  public:
+	struct Stats
+	{
+		u64 rollbacks = 0;
+		u64 frames = 0;
+		// From loading the savestate until the last resimulated frame is done
+		u64 hostTimeUs = 0;
+		u64 maxRollbackUs = 0;
+	};
+
+	// skipDraws is the setting, compareSkipping overrides it to alternate between rollbacks
+	void Reset(bool skipDraws = false, bool compareSkipping = false);
+
+	// The game asks for the inputs of a frame it runs for the first time
+	void NewFrame(s32 frame, u64 timeUs);
+	void LoadState(s32 frame, u64 timeUs);
+	void CaptureState(s32 frame, u64 timeUs);
+
+	bool IsResimulating() const { return resimulating; }
+	bool IsSkippingDraws() const { return resimulating && skippingDraws; }
+	// Of all rollbacks
+	Stats GetStats() const;
+	// Of the rollbacks that skipped their draws, or of the ones that didn't
+	Stats GetStats(bool skippedDraws) const { return stats[skippedDraws]; }
+
+  private:
+	void finish(u64 timeUs);
+
+	s32 latestFrame = 0;
+	bool resimulating = false;
+	bool skipDraws = false;
+	bool compareSkipping = false;
+	bool skippingDraws = false;
+	u64 startTimeUs = 0;
+	Stats stats[2];
+};
@@ -1,6 +1,10 @@
 #include "SlippiSavestate.h"
+#include "Common/Align.h"
 #include "Common/CommonFuncs.h"
+#include "Common/DeltaCopy.h"
 #include "Common/MemoryUtil.h"
+#include "Common/ThreadPool.h"
+#include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DVDInterface.h"
@@ -12,18 +16,48 @@
 #include "Core/HW/SI.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include <algorithm>
 #include <vector>
 
 bool SlippiSavestate::shouldForceInit;
+int SlippiSavestate::instanceCount = 0;
 
 SlippiSavestate::SlippiSavestate()
 {
 	initBackupLocs();
 
+	// Allocate every location out of one block that is faulted in right away so that the first
+	// capture of a match does not page fault its way through several MB
 	for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
 	{
 		auto size = it->endAddress - it->startAddress;
-		it->data = static_cast<u8 *>(Common::AllocateAlignedMemory(size, 64));
+		backupBufferSize += Common::AlignUp(size, 64);
+	}
+
+	backupBuffer = static_cast<u8 *>(Common::AllocatePrefaultedMemoryPages(backupBufferSize));
+
+	size_t offset = 0;
+	for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
+	{
+		auto size = it->endAddress - it->startAddress;
+		it->data = backupBuffer + offset;
+		offset += Common::AlignUp(size, 64);
+	}
+
+	initSlices();
+
+	preservationBuffer.resize(PRESERVATION_BUFFER_SIZE);
+
+	// All savestates share the same backup locations, so the first one to be created sets up
+	// tracking for them and the last one to be destroyed tears it down
+	if (instanceCount++ == 0 && SConfig::GetInstance().m_slippiIncrementalSavestates)
+	{
+		std::vector<Memory::DirtyTrackRange> ranges;
+		for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
+			ranges.push_back({it->startAddress, it->endAddress - it->startAddress});
+
+		if (!Memory::EnableDirtyPageTracking(ranges))
+			WARN_LOG(SLIPPI_ONLINE, "Dirty page tracking unavailable, savestates will copy all regions");
 	}
 
 	// u8 *ptr = nullptr;
@@ -36,10 +70,10 @@ SlippiSavestate::SlippiSavestate()
 
 SlippiSavestate::~SlippiSavestate()
 {
-	for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
-	{
-		Common::FreeAlignedMemory(it->data);
-	}
+	Common::FreeMemoryPages(backupBuffer, backupBufferSize);
+
+	if (--instanceCount == 0)
+		Memory::DisableDirtyPageTracking();
 }
 
 bool cmpFn(SlippiSavestate::PreserveBlock pb1, SlippiSavestate::PreserveBlock pb2)
@@ -179,6 +213,20 @@ void SlippiSavestate::initBackupLocs()
 	processedLocs.insert(processedLocs.end(), backupLocs.begin(), backupLocs.end());
 }
 
+void SlippiSavestate::initSlices()
+{
+	for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
+	{
+		u32 addr = it->startAddress;
+		while (addr < it->endAddress)
+		{
+			u32 sliceEnd = std::min((addr & ~(SLICE_SIZE - 1)) + SLICE_SIZE, it->endAddress);
+			slices.push_back({addr, sliceEnd, it->data + (addr - it->startAddress)});
+			addr = sliceEnd;
+		}
+	}
+}
+
 void SlippiSavestate::getDolphinState(PointerWrap &p)
 {
 	// p.DoArray(Memory::m_pRAM, Memory::RAM_SIZE);
@@ -201,22 +249,67 @@ void SlippiSavestate::getDolphinState(PointerWrap &p)
 	// p.DoMarker("AudioInterface");
 }
 
-void SlippiSavestate::Capture()
+void SlippiSavestate::copyChangedPages(const ssBackupLoc &loc, bool toEmu)
 {
-	// First copy memory
-	for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
+	// Walk the region page by page and copy runs of pages written since this state was captured
+	u32 addr = loc.startAddress;
+	while (addr < loc.endAddress)
 	{
-		auto size = it->endAddress - it->startAddress;
-		Memory::CopyFromEmu(it->data, it->startAddress, size);
+		u32 pageEnd = std::min((addr | (Memory::DIRTY_PAGE_SIZE - 1)) + 1, loc.endAddress);
+		if (!Memory::WasPageWrittenSince(addr, capturedEpoch))
+		{
+			addr = pageEnd;
+			continue;
+		}
+
+		u32 runStart = addr;
+		addr = pageEnd;
+		while (addr < loc.endAddress && Memory::WasPageWrittenSince(addr, capturedEpoch))
+			addr = std::min(addr + Memory::DIRTY_PAGE_SIZE, loc.endAddress);
+
+		u8 *data = loc.data + (runStart - loc.startAddress);
+		if (toEmu)
+			Common::DeltaCopy(Memory::GetPointer(runStart), data, addr - runStart);
+		else
+			Memory::CopyFromEmu(data, runStart, addr - runStart);
+	}
+}
+
+void SlippiSavestate::forEachSlice(Common::WorkerGroup *workers,
+                                   const std::function<void(const ssBackupLoc &)> &func)
+{
+	if (!workers)
+	{
+		for (auto it = slices.begin(); it != slices.end(); ++it)
+			func(*it);
+		return;
 	}
 
+	workers->Run(slices.size(), [&](size_t i) { func(slices[i]); });
+}
+
+void SlippiSavestate::Capture(Common::WorkerGroup *workers)
+{
+	// First copy memory. With dirty page tracking only the pages written since this state was last
+	// captured need to be copied, everything else in the backup is still current
+	bool incremental = Memory::IsDirtyPageTrackingEnabled() && capturedEpoch != 0;
+	forEachSlice(workers, [&](const ssBackupLoc &slice) {
+		if (incremental)
+			copyChangedPages(slice, false);
+		else
+			Memory::CopyFromEmu(slice.data, slice.startAddress, slice.endAddress - slice.startAddress);
+	});
+
+	// Only after every slice is copied, otherwise writes racing the copies could be missed
+	capturedEpoch = Memory::AdvanceDirtyPageEpoch();
+
 	//// Second copy dolphin states
 	// u8 *ptr = &dolphinSsBackup[0];
 	// PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
 	// getDolphinState(p);
 }
 
-void SlippiSavestate::Load(std::vector<PreserveBlock> blocks)
+void SlippiSavestate::Load(const std::vector<PreserveBlock> &blocks, Common::WorkerGroup *workers)
 {
 	// static std::vector<PreserveBlock> interruptStuff = {
 	//    {0x804BF9D2, 4},
@@ -231,32 +324,44 @@ void SlippiSavestate::Load(std::vector<PreserveBlock> blocks)
 	// }
 
 	// Back up
+	size_t preservationSize = 0;
 	for (auto it = blocks.begin(); it != blocks.end(); ++it)
-	{
-		if (!preservationMap.count(*it))
-		{
-			// TODO: Clear preservation map when game ends
-			preservationMap[*it] = std::vector<u8>(it->length);
-		}
+		preservationSize += it->length;
 
-		Memory::CopyFromEmu(&preservationMap[*it][0], it->address, it->length);
-	}
+	// Only grows if the game asks to preserve more than ever before
+	if (preservationSize > preservationBuffer.size())
+		preservationBuffer.resize(preservationSize);
 
-	// Restore memory blocks
-	for (auto it = backupLocs.begin(); it != backupLocs.end(); ++it)
+	size_t preservationOffset = 0;
+	for (auto it = blocks.begin(); it != blocks.end(); ++it)
 	{
-		auto size = it->endAddress - it->startAddress;
-		Memory::CopyToEmu(it->startAddress, it->data, size);
+		Memory::CopyFromEmu(&preservationBuffer[preservationOffset], it->address, it->length);
+		preservationOffset += it->length;
 	}
 
+	// Restore memory blocks. Pages not written since the capture still hold the captured data. Within
+	// the rest only 64 byte chunks that actually differ are written back, which keeps the other cache
+	// lines clean and leaves pages whose contents came back to the captured values write-protected.
+	// The restored pages get tagged with the current epoch by the restore writes themselves
+	bool incremental = Memory::IsDirtyPageTrackingEnabled() && capturedEpoch != 0;
+	forEachSlice(workers, [&](const ssBackupLoc &slice) {
+		if (incremental)
+			copyChangedPages(slice, true);
+		else
+			Common::DeltaCopy(Memory::GetPointer(slice.startAddress), slice.data,
+			                  slice.endAddress - slice.startAddress);
+	});
+
 	//// Restore audio
 	// u8 *ptr = &dolphinSsBackup[0];
 	// PointerWrap p(&ptr, PointerWrap::MODE_READ);
 	// getDolphinState(p);
 
 	// Restore
+	preservationOffset = 0;
 	for (auto it = blocks.begin(); it != blocks.end(); ++it)
 	{
-		Memory::CopyToEmu(it->address, &preservationMap[*it][0], it->length);
+		Memory::CopyToEmu(it->address, &preservationBuffer[preservationOffset], it->length);
+		preservationOffset += it->length;
 	}
 }
@@ -2,10 +2,16 @@
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
-#include <unordered_map>
+#include <functional>
+#include <vector>
 
 class PointerWrap;
 
+namespace Common
+{
+class WorkerGroup;
+}
+
 class SlippiSavestate
 {
   public:
@@ -20,8 +26,10 @@ class SlippiSavestate
 	SlippiSavestate();
 	~SlippiSavestate();
 
-	void Capture();
-	void Load(std::vector<PreserveBlock> blocks);
+	// When a worker group is passed the copies are split across its threads. Both only return once
+	// every copy is done.
+	void Capture(Common::WorkerGroup *workers = nullptr);
+	void Load(const std::vector<PreserveBlock> &blocks, Common::WorkerGroup *workers = nullptr);
 
 	static bool shouldForceInit;
 
@@ -36,7 +44,26 @@ class SlippiSavestate
 	// These are the game locations to back up and restore
 	std::vector<ssBackupLoc> backupLocs = {};
 
+	// Single allocation holding the data of every backup location
+	u8 *backupBuffer = nullptr;
+	size_t backupBufferSize = 0;
+
+	// The backup locations cut into pieces of at most SLICE_SIZE bytes, which are the units of work
+	// handed to the worker threads. Slices start on SLICE_SIZE boundaries so no dirty page is ever
+	// shared by two slices.
+	static const u32 SLICE_SIZE = 0x40000;
+	std::vector<ssBackupLoc> slices = {};
+
 	void initBackupLocs();
+	void initSlices();
+
+	// Dirty page epoch this state was captured in, 0 if it has never been captured. When dirty page
+	// tracking is active only pages written after this epoch differ between RAM and the backup.
+	u32 capturedEpoch = 0;
+	static int instanceCount;
+
+	void copyChangedPages(const ssBackupLoc &loc, bool toEmu);
+	void forEachSlice(Common::WorkerGroup *workers, const std::function<void(const ssBackupLoc &)> &func);
 
 	typedef struct
 	{
@@ -44,15 +71,10 @@ class SlippiSavestate
 		u32 value;
 	} ssBackupStaticToHeapPtr;
 
-	struct preserve_hash_fn
-	{
-		std::size_t operator()(const PreserveBlock &node) const
-		{
-			return node.address ^ node.length; // TODO: This is probably a bad hash
-		}
-	};
-
-	std::unordered_map<PreserveBlock, std::vector<u8>, preserve_hash_fn> preservationMap;
+	// Scratch space for the preserved blocks while a state is loaded. Sized up front so loading
+	// does not have to allocate.
+	static const size_t PRESERVATION_BUFFER_SIZE = 0x10000;
+	std::vector<u8> preservationBuffer;
 
 	std::vector<u8> dolphinSsBackup;
 
@@ -0,0 +1,183 @@
+#include "SlippiSavestatePool.h"
+#include "Common/CPUDetect.h"
+#include "Common/Logging/Log.h"
+#include "Common/Timer.h"
+#include <algorithm>
+#include <cinttypes>
+
+SlippiSavestatePool::~SlippiSavestatePool()
+{
+	LogStats();
+	Clear();
+}
+
+void SlippiSavestatePool::Reset(size_t slotCount)
+{
+	LogStats();
+
+	stats = Stats();
+	captureLatency.Reset();
+	loadLatency.Reset();
+
+	// The backup regions only change when a new ISO is loaded, in every other case the buffers from
+	// the previous match can be reused as they are
+	if (slots.size() != slotCount || SlippiSavestate::shouldForceInit)
+	{
+		Clear();
+
+		slots.resize(slotCount);
+		for (auto it = slots.begin(); it != slots.end(); ++it)
+			it->state = std::make_unique<SlippiSavestate>();
+	}
+
+	for (auto it = slots.begin(); it != slots.end(); ++it)
+	{
+		it->frame = 0;
+		it->active = false;
+	}
+
+	// The CPU and GPU threads are already busy, use what's left of the machine up to the point where
+	// memory bandwidth stops scaling
+	if (!workers)
+	{
+		int threadCount = std::min(std::max(cpu_info.num_cores - 2, 0), 3);
+		workers = std::make_unique<Common::WorkerGroup>(threadCount);
+		INFO_LOG(SLIPPI_ONLINE, "Savestate pool using %d worker threads", threadCount);
+	}
+}
+
+void SlippiSavestatePool::Clear()
+{
+	slots.clear();
+}
+
+SlippiSavestatePool::Slot *SlippiSavestatePool::findSlot(s32 frame)
+{
+	for (auto it = slots.begin(); it != slots.end(); ++it)
+	{
+		if (it->active && it->frame == frame)
+			return &*it;
+	}
+
+	return nullptr;
+}
+
+void SlippiSavestatePool::Capture(s32 frame)
+{
+	if (slots.empty())
+		return;
+
+	u64 startTime = Common::Timer::GetTimeUs();
+
+	// Recapture over an existing state for this frame, otherwise take a free slot and if there are
+	// none left overwrite the oldest frame
+	Slot *slot = findSlot(frame);
+	if (!slot)
+	{
+		for (auto it = slots.begin(); it != slots.end(); ++it)
+		{
+			if (!it->active)
+			{
+				slot = &*it;
+				break;
+			}
+		}
+	}
+
+	if (!slot)
+	{
+		slot = &*std::min_element(slots.begin(), slots.end(),
+		                          [](const Slot &a, const Slot &b) { return a.frame < b.frame; });
+		stats.slotReuses++;
+	}
+
+	slot->state->Capture(workers.get());
+	slot->frame = frame;
+	slot->active = true;
+
+	captureLatency.Add(Common::Timer::GetTimeUs() - startTime);
+}
+
+bool SlippiSavestatePool::Load(s32 frame, const std::vector<SlippiSavestate::PreserveBlock> &blocks)
+{
+	Slot *slot = findSlot(frame);
+	if (!slot)
+	{
+		stats.missingLoads++;
+		return false;
+	}
+
+	u64 startTime = Common::Timer::GetTimeUs();
+
+	slot->state->Load(blocks, workers.get());
+
+	// Every state after the loaded one is from a timeline that no longer exists
+	for (auto it = slots.begin(); it != slots.end(); ++it)
+		it->active = false;
+
+	loadLatency.Add(Common::Timer::GetTimeUs() - startTime);
+	return true;
+}
+
+SlippiSavestatePool::Stats SlippiSavestatePool::GetStats() const
+{
+	Stats result = stats;
+	result.capture = captureLatency.Get();
+	result.load = loadLatency.Get();
+	return result;
+}
+
+void SlippiSavestatePool::LogStats() const
+{
+	Stats s = GetStats();
+	if (s.capture.count == 0)
+		return;
+
+	INFO_LOG(SLIPPI_ONLINE,
+	         "Savestate pool: %zu slots, %" PRIu64 " slot reuses, %" PRIu64 " missing loads. Capture (%" PRIu64
+	         "): p50 %uus p90 %uus p99 %uus max %uus. Load (%" PRIu64 "): p50 %uus p90 %uus p99 %uus max %uus",
+	         slots.size(), s.slotReuses, s.missingLoads, s.capture.count, s.capture.p50Us,
+	         s.capture.p90Us, s.capture.p99Us, s.capture.maxUs, s.load.count, s.load.p50Us, s.load.p90Us,
+	         s.load.p99Us, s.load.maxUs);
+}
+
+void SlippiSavestatePool::LatencyHistogram::Reset()
+{
+	buckets.fill(0);
+	count = 0;
+	maxUs = 0;
+}
+
+void SlippiSavestatePool::LatencyHistogram::Add(u64 us)
+{
+	buckets[std::min<u64>(us, BUCKET_COUNT - 1)]++;
+	maxUs = std::max(maxUs, static_cast<u32>(std::min<u64>(us, UINT32_MAX)));
+	count++;
+}
+
+u32 SlippiSavestatePool::LatencyHistogram::percentile(u64 rank) const
+{
+	u64 seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		seen += buckets[i];
+		if (seen > rank)
+			return static_cast<u32>(i);
+	}
+
+	return maxUs;
+}
+
+SlippiSavestatePool::LatencyStats SlippiSavestatePool::LatencyHistogram::Get() const
+{
+	LatencyStats result;
+	result.count = count;
+	if (count == 0)
+		return result;
+
+	result.p50Us = percentile(count * 50 / 100);
+	result.p90Us = percentile(count * 90 / 100);
+	result.p99Us = percentile(count * 99 / 100);
+	result.maxUs = maxUs;
+	return result;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
+#include "Core/Slippi/SlippiSavestate.h"
+
+// Fixed ring of savestate slots used for rollback. All slots are allocated and faulted in when the
+// pool is reset at match start, after that capturing and loading states never touches the allocator.
+// Copies are spread over a small group of worker threads that lives as long as the pool.
+class SlippiSavestatePool
+{
+  public:
+	struct LatencyStats
+	{
+		u64 count = 0;
+		u32 p50Us = 0;
+		u32 p90Us = 0;
+		u32 p99Us = 0;
+		u32 maxUs = 0;
+	};
+
+	struct Stats
+	{
+		// Captures that had to overwrite a state that was still active
+		u64 slotReuses = 0;
+		// Loads of a frame that had no state
+		u64 missingLoads = 0;
+		LatencyStats capture;
+		LatencyStats load;
+	};
+
+	~SlippiSavestatePool();
+
+	// Sizes the pool for slotCount states. Slots are kept from the previous match when possible.
+	void Reset(size_t slotCount);
+	void Clear();
+
+	void Capture(s32 frame);
+	bool Load(s32 frame, const std::vector<SlippiSavestate::PreserveBlock> &blocks);
+
+	Stats GetStats() const;
+	void LogStats() const;
+
+  private:
+	struct Slot
+	{
+		std::unique_ptr<SlippiSavestate> state;
+		s32 frame;
+		bool active;
+	};
+
+	// Per microsecond histogram, anything slower lands in the last bucket
+	class LatencyHistogram
+	{
+	  public:
+		void Reset();
+		void Add(u64 us);
+		LatencyStats Get() const;
+
+	  private:
+		u32 percentile(u64 rank) const;
+
+		static const size_t BUCKET_COUNT = 20000;
+		std::array<u32, BUCKET_COUNT> buckets = {};
+		u64 count = 0;
+		u32 maxUs = 0;
+	};
+
+	Slot *findSlot(s32 frame);
+
+	std::vector<Slot> slots;
+	std::unique_ptr<Common::WorkerGroup> workers;
+	Stats stats;
+	LatencyHistogram captureLatency;
+	LatencyHistogram loadLatency;
+};
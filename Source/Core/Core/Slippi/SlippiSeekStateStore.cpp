@@ -0,0 +1,322 @@
+#include "SlippiSeekStateStore.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+#include <algorithm>
+#include <cstring>
+#include <lzo/lzo1x.h>
+
+// Worst case LZO output for an incompressible block
+static const size_t MAX_COMPRESSED_BLOCK_SIZE = 0x10000 + 0x10000 / 16 + 64 + 3;
+
+SlippiSeekStateStore::SlippiSeekStateStore(u32 keyframeInterval, size_t memoryBudget)
+    : keyframeInterval(std::max<u32>(keyframeInterval, 1)), memoryBudget(memoryBudget)
+{
+	encodeScratch.resize(MAX_COMPRESSED_BLOCK_SIZE);
+	compressWorkMem.resize(LZO1X_1_MEM_COMPRESS);
+	thread = std::thread(&SlippiSeekStateStore::encoderThread, this);
+}
+
+SlippiSeekStateStore::~SlippiSeekStateStore()
+{
+	{
+		std::lock_guard<std::mutex> lk(mtx);
+		running = false;
+	}
+	pendingCv.notify_one();
+	thread.join();
+}
+
+std::vector<u8> SlippiSeekStateStore::AcquireBuffer()
+{
+	std::lock_guard<std::mutex> lk(mtx);
+	if (freeBuffers.empty())
+		return std::vector<u8>();
+
+	std::vector<u8> buffer = std::move(freeBuffers.back());
+	freeBuffers.pop_back();
+	return buffer;
+}
+
+bool SlippiSeekStateStore::ShouldSkipState()
+{
+	std::lock_guard<std::mutex> lk(mtx);
+	if (pending.size() < MAX_PENDING)
+		return false;
+
+	stats.droppedStates++;
+	return true;
+}
+
+void SlippiSeekStateStore::Submit(s32 frame, std::vector<u8> &&state)
+{
+	{
+		std::lock_guard<std::mutex> lk(mtx);
+		if (pending.size() >= MAX_PENDING)
+		{
+			stats.droppedStates++;
+			freeBuffers.push_back(std::move(state));
+			return;
+		}
+
+		pending.push_back({frame, std::move(state)});
+	}
+	pendingCv.notify_one();
+}
+
+bool SlippiSeekStateStore::Contains(s32 frame)
+{
+	std::lock_guard<std::mutex> lk(mtx);
+	if (entries.count(frame))
+		return true;
+
+	return std::any_of(pending.begin(), pending.end(), [frame](const Pending &p) { return p.frame == frame; });
+}
+
+bool SlippiSeekStateStore::Load(s32 frame, std::vector<u8> &out)
+{
+	// Collect the chain from the requested state back to its keyframe. The entries are immutable
+	// once stored, so they can be decoded without holding the lock.
+	std::vector<std::shared_ptr<const Entry>> chain;
+	{
+		std::unique_lock<std::mutex> lk(mtx);
+		encodedCv.wait(lk, [&] {
+			return std::none_of(pending.begin(), pending.end(), [frame](const Pending &p) { return p.frame == frame; });
+		});
+
+		s32 cur = frame;
+		while (true)
+		{
+			auto it = entries.find(cur);
+			if (it == entries.end())
+				return false;
+
+			chain.push_back(it->second);
+			if (it->second->keyframe)
+				break;
+			cur = it->second->baseFrame;
+		}
+	}
+
+	std::vector<u8> scratch(BLOCK_SIZE);
+	out.resize(chain.back()->rawSize);
+	for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+	{
+		if (!applyEntry(**it, out, scratch))
+		{
+			ERROR_LOG(SLIPPI, "Failed to decode seek state for frame %d", frame);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SlippiSeekStateStore::Clear()
+{
+	std::lock_guard<std::mutex> lk(mtx);
+	for (auto it = pending.begin(); it != pending.end(); ++it)
+	{
+		// The front state may already be in the encoder's hands
+		if (!it->state.empty())
+			freeBuffers.push_back(std::move(it->state));
+	}
+	pending.clear();
+	entries.clear();
+	generation++;
+
+	INFO_LOG(SLIPPI, "Seek states cleared. %zu keyframes, %zu deltas, %zu of %zu bytes, %llu dropped, %llu evicted",
+	         stats.keyframes, stats.deltas, stats.storedBytes, stats.rawBytes,
+	         (unsigned long long)stats.droppedStates, (unsigned long long)stats.evictedStates);
+	stats = Stats();
+	encodedCv.notify_all();
+}
+
+SlippiSeekStateStore::Stats SlippiSeekStateStore::GetStats()
+{
+	std::lock_guard<std::mutex> lk(mtx);
+	return stats;
+}
+
+void SlippiSeekStateStore::encoderThread()
+{
+	Common::SetCurrentThreadName("Seek state encoder");
+
+	std::unique_lock<std::mutex> lk(mtx);
+	while (true)
+	{
+		pendingCv.wait(lk, [&] { return !running || !pending.empty(); });
+		if (!running)
+			break;
+
+		// Leave the state in the queue while it is encoded so Contains and Load can see it
+		s32 frame = pending.front().frame;
+		std::vector<u8> state = std::move(pending.front().state);
+		u32 stateGeneration = generation;
+		lk.unlock();
+
+		// Chains only ever run forward, a state from before the last one (after seeking back past a
+		// dropped state) starts a new chain
+		bool keyframe = prevGeneration != stateGeneration || prevState.empty() || prevState.size() != state.size() ||
+		                frame <= prevFrame || chainLength >= keyframeInterval;
+		std::shared_ptr<Entry> entry = encode(frame, state, keyframe);
+
+		lk.lock();
+		// Clear drops everything queued before it, including the state that was just encoded
+		if (stateGeneration == generation)
+		{
+			pending.pop_front();
+			insert(frame, std::move(entry));
+
+			chainLength = keyframe ? 1 : chainLength + 1;
+			prevFrame = frame;
+			prevChainFrame = keyframe ? frame : prevChainFrame;
+			prevGeneration = stateGeneration;
+			if (!prevState.empty())
+				freeBuffers.push_back(std::move(prevState));
+			prevState = std::move(state);
+		}
+		else
+		{
+			freeBuffers.push_back(std::move(state));
+		}
+
+		encodedCv.notify_all();
+	}
+}
+
+std::shared_ptr<SlippiSeekStateStore::Entry> SlippiSeekStateStore::encode(s32 frame, const std::vector<u8> &state,
+                                                                         bool keyframe)
+{
+	auto entry = std::make_shared<Entry>();
+	entry->keyframe = keyframe;
+	entry->baseFrame = keyframe ? frame : prevFrame;
+	entry->chainFrame = keyframe ? frame : prevChainFrame;
+	entry->rawSize = state.size();
+
+	std::vector<u8> xorBlock(keyframe ? 0 : BLOCK_SIZE);
+	for (size_t offset = 0; offset < state.size(); offset += BLOCK_SIZE)
+	{
+		u32 size = (u32)std::min<size_t>(BLOCK_SIZE, state.size() - offset);
+		const u8 *src = &state[offset];
+
+		Block block = {(u32)entry->payload.size(), 0, BLOCK_UNCHANGED};
+		if (!keyframe)
+		{
+			// Most of a state stays the same between seek points, skip those blocks outright
+			const u8 *prev = &prevState[offset];
+			if (memcmp(src, prev, size) == 0)
+			{
+				entry->blocks.push_back(block);
+				continue;
+			}
+
+			for (u32 i = 0; i < size; i++)
+				xorBlock[i] = src[i] ^ prev[i];
+			src = xorBlock.data();
+		}
+
+		lzo_uint outLen = 0;
+		if (lzo1x_1_compress(src, size, encodeScratch.data(), &outLen, compressWorkMem.data()) == LZO_E_OK &&
+		    outLen < size)
+		{
+			block.type = BLOCK_LZO;
+			block.size = (u32)outLen;
+			entry->payload.insert(entry->payload.end(), encodeScratch.begin(), encodeScratch.begin() + outLen);
+		}
+		else
+		{
+			block.type = BLOCK_RAW;
+			block.size = size;
+			entry->payload.insert(entry->payload.end(), src, src + size);
+		}
+
+		entry->blocks.push_back(block);
+	}
+
+	entry->payload.shrink_to_fit();
+	return entry;
+}
+
+void SlippiSeekStateStore::insert(s32 frame, std::shared_ptr<const Entry> entry)
+{
+	if (entry->keyframe)
+		stats.keyframes++;
+	else
+		stats.deltas++;
+	stats.storedBytes += entry->payload.size();
+	stats.rawBytes += entry->rawSize;
+
+	// Never throw away the chain the encoder is building on
+	s32 currentChain = entry->chainFrame;
+	entries[frame] = std::move(entry);
+
+	while (stats.storedBytes > memoryBudget)
+	{
+		s32 oldestChain = entries.begin()->second->chainFrame;
+		if (oldestChain == currentChain)
+			break;
+
+		evictChain(oldestChain);
+	}
+}
+
+void SlippiSeekStateStore::evictChain(s32 chainFrame)
+{
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (it->second->chainFrame != chainFrame)
+		{
+			++it;
+			continue;
+		}
+
+		if (it->second->keyframe)
+			stats.keyframes--;
+		else
+			stats.deltas--;
+		stats.storedBytes -= it->second->payload.size();
+		stats.rawBytes -= it->second->rawSize;
+		stats.evictedStates++;
+		it = entries.erase(it);
+	}
+
+	WARN_LOG(SLIPPI, "Seek state memory budget reached, dropped chain starting at frame %d", chainFrame);
+}
+
+bool SlippiSeekStateStore::applyEntry(const Entry &entry, std::vector<u8> &out, std::vector<u8> &scratch)
+{
+	if (entry.rawSize != out.size())
+		return false;
+
+	// Keyframe blocks are written as they are, delta blocks are XORed onto the previous state
+	size_t offset = 0;
+	for (auto it = entry.blocks.begin(); it != entry.blocks.end(); ++it, offset += BLOCK_SIZE)
+	{
+		if (it->type == BLOCK_UNCHANGED)
+			continue;
+
+		size_t size = std::min<size_t>(BLOCK_SIZE, out.size() - offset);
+		const u8 *data = &entry.payload[it->offset];
+		if (it->type == BLOCK_LZO)
+		{
+			u8 *dst = entry.keyframe ? &out[offset] : scratch.data();
+			lzo_uint outLen = size;
+			if (lzo1x_decompress_safe(data, it->size, dst, &outLen, nullptr) != LZO_E_OK || outLen != size)
+				return false;
+			if (entry.keyframe)
+				continue;
+			data = scratch.data();
+		}
+		else if (entry.keyframe)
+		{
+			memcpy(&out[offset], data, size);
+			continue;
+		}
+
+		u8 *dst = &out[offset];
+		for (size_t i = 0; i < size; i++)
+			dst[i] ^= data[i];
+	}
+
+	return true;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Holds the savestates the replay seekbar jumps to. States are stored as chains: every few states a
+// keyframe is compressed on its own, the states in between only keep the blocks that changed since
+// the previous state, XORed against it and compressed. Encoding happens on a dedicated thread that
+// takes ownership of the submitted buffers, so nothing is copied on the way in.
+class SlippiSeekStateStore
+{
+  public:
+	struct Stats
+	{
+		size_t keyframes = 0;
+		size_t deltas = 0;
+		size_t storedBytes = 0;
+		size_t rawBytes = 0;
+		u64 droppedStates = 0;
+		u64 evictedStates = 0;
+	};
+
+	// keyframeInterval is the length of a chain including its keyframe. Once the encoded states take
+	// more than memoryBudget bytes the oldest chains are dropped.
+	SlippiSeekStateStore(u32 keyframeInterval, size_t memoryBudget);
+	~SlippiSeekStateStore();
+
+	// Returns a buffer to save the next state into. Buffers handed back by the encoder are reused so
+	// their allocations stick around between states.
+	std::vector<u8> AcquireBuffer();
+
+	// True while the encoder is still behind on earlier states. The caller is expected to skip the
+	// state then rather than hold up playback, it is counted as dropped.
+	bool ShouldSkipState();
+
+	// Queues a state for encoding, the store takes over the buffer
+	void Submit(s32 frame, std::vector<u8> &&state);
+
+	// True if the frame is stored or still waiting to be encoded
+	bool Contains(s32 frame);
+
+	// Rebuilds the state of a frame into out. Waits for the frame if it is still being encoded.
+	bool Load(s32 frame, std::vector<u8> &out);
+
+	void Clear();
+	Stats GetStats();
+
+  private:
+	static const u32 BLOCK_SIZE = 0x10000;
+	static const size_t MAX_PENDING = 2;
+
+	enum BlockType : u8
+	{
+		BLOCK_UNCHANGED,
+		BLOCK_RAW,
+		BLOCK_LZO,
+	};
+
+	struct Block
+	{
+		u32 offset;
+		u32 size;
+		BlockType type;
+	};
+
+	struct Entry
+	{
+		bool keyframe;
+		// State the delta applies to, unused for keyframes
+		s32 baseFrame;
+		// Keyframe the chain starts at, a chain is evicted as a whole
+		s32 chainFrame;
+		size_t rawSize;
+		std::vector<Block> blocks;
+		std::vector<u8> payload;
+	};
+
+	struct Pending
+	{
+		s32 frame;
+		std::vector<u8> state;
+	};
+
+	void encoderThread();
+	std::shared_ptr<Entry> encode(s32 frame, const std::vector<u8> &state, bool keyframe);
+	void insert(s32 frame, std::shared_ptr<const Entry> entry);
+	void evictChain(s32 chainFrame);
+	static bool applyEntry(const Entry &entry, std::vector<u8> &out, std::vector<u8> &scratch);
+
+	const u32 keyframeInterval;
+	const size_t memoryBudget;
+
+	std::mutex mtx;
+	std::condition_variable pendingCv;
+	std::condition_variable encodedCv;
+	std::deque<Pending> pending;
+	std::vector<std::vector<u8>> freeBuffers;
+	std::map<s32, std::shared_ptr<const Entry>> entries;
+	// Bumped by Clear so the encoder can tell that the state it just finished belongs to an old chain
+	u32 generation = 0;
+	bool running = true;
+	Stats stats;
+
+	// Only touched by the encoder thread
+	std::vector<u8> prevState;
+	s32 prevFrame = 0;
+	s32 prevChainFrame = 0;
+	u32 prevGeneration = 0;
+	u32 chainLength = 0;
+	std::vector<u8> encodeScratch;
+	std::vector<u8> compressWorkMem;
+
+	std::thread thread;
+};
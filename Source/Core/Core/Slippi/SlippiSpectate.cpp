@@ -20,6 +20,31 @@ SlippiSpectateServer *SlippiSpectateServer::getInstance()
 	return &instance;
 }
 
+// Room for a few seconds of game data in case the server thread falls behind
+static const size_t EVENT_RING_SIZE = 0x400000;
+
+// Keeps an ENet packet alive until it is released, on top of the references
+//  ENet takes for every peer it is queued on
+static ENetPacket *holdPacket(ENetPacket *packet)
+{
+	packet->referenceCount++;
+	return packet;
+}
+
+static void releasePacket(ENetPacket *packet)
+{
+	if (packet && --packet->referenceCount == 0)
+	{
+		enet_packet_destroy(packet);
+	}
+}
+
+static ENetPacket *createPacket(const json &message)
+{
+	std::string buffer = message.dump();
+	return holdPacket(enet_packet_create(buffer.data(), buffer.length(), ENET_PACKET_FLAG_RELIABLE));
+}
+
 // CALLED FROM DOLPHIN MAIN THREAD
 void SlippiSpectateServer::write(u8 *payload, u32 length)
 {
@@ -27,8 +52,7 @@ void SlippiSpectateServer::write(u8 *payload, u32 length)
 	{
 		return;
 	}
-	std::string str_payload((char *)payload, length);
-	m_event_queue.Push(str_payload);
+	pushRecord(QUEUE_EVENT, payload, length);
 }
 
 // CALLED FROM DOLPHIN MAIN THREAD
@@ -39,9 +63,7 @@ void SlippiSpectateServer::startGame()
 		return;
 	}
 
-	json start_game_message;
-	start_game_message["type"] = "start_game";
-	m_event_queue.Push(start_game_message.dump());
+	pushRecord(QUEUE_START_GAME, nullptr, 0);
 }
 
 // CALLED FROM DOLPHIN MAIN THREAD
@@ -51,23 +73,52 @@ void SlippiSpectateServer::endGame(bool dolphin_closed)
 	{
 		return;
 	}
-	json end_game_message;
-	end_game_message["type"] = "end_game";
-	end_game_message["dolphin_closed"] = dolphin_closed;
-	m_event_queue.Push(end_game_message.dump());
+	u8 closed = dolphin_closed;
+	pushRecord(QUEUE_END_GAME, &closed, 1);
+}
+
+// CALLED FROM DOLPHIN MAIN THREAD
+void SlippiSpectateServer::pushRecord(QueueRecordType type, const u8 *payload, u32 length)
+{
+	// The ring only exists if the server was started
+	if (!m_event_ring)
+	{
+		return;
+	}
+
+	// Never hold up the game for spectators. The ring only fills up if the
+	//  server thread is stuck or gone. Whatever doesn't fit is counted, and the
+	//  server is told about the gap ahead of the next record that makes it in
+	if (m_dropped_records > 0)
+	{
+		QueueRecordHeader dropped = {sizeof(m_dropped_records), QUEUE_DROPPED};
+		if (!m_event_ring->Push(&dropped, sizeof(dropped), &m_dropped_records, sizeof(m_dropped_records)))
+		{
+			m_dropped_records++;
+			return;
+		}
+		m_dropped_records = 0;
+	}
+
+	QueueRecordHeader header = {length, type};
+	if (!m_event_ring->Push(&header, sizeof(header), payload, length) && m_dropped_records++ == 0)
+	{
+		WARN_LOG(SLIPPI, "Spectator server is not keeping up, dropping game events");
+	}
 }
 
 // CALLED FROM SERVER THREAD
 void SlippiSpectateServer::writeEvents(u16 peer_id)
 {
+	SlippiSocket &socket = *m_sockets[peer_id];
+
 	// Send menu events
-	if (!m_in_game && (m_sockets[peer_id]->m_menu_cursor != m_menu_cursor))
+	if (!m_in_game && m_menu_packet && (socket.m_menu_cursor != m_menu_cursor))
 	{
-		ENetPacket *packet = enet_packet_create(m_menu_event.data(), m_menu_event.length(), ENET_PACKET_FLAG_RELIABLE);
 		// Batch for sending
-		enet_peer_send(m_sockets[peer_id]->m_peer, 0, packet);
+		enet_peer_send(socket.m_peer, 0, m_menu_packet);
 		// Record for the peer that it was sent
-		m_sockets[peer_id]->m_menu_cursor = m_menu_cursor;
+		socket.m_menu_cursor = m_menu_cursor;
 	}
 
 	// Send game events
@@ -76,55 +127,173 @@ void SlippiSpectateServer::writeEvents(u16 peer_id)
 	// If the client's cursor is beyond the end of the event buffer, then
 	//  it's probably left over from an old game. (Or is invalid anyway)
 	//  So reset it back to 0
-	if (m_sockets[peer_id]->m_cursor > m_event_buffer.size())
+	if (socket.m_cursor > m_event_buffer.size())
 	{
-		m_sockets[peer_id]->m_cursor = 0;
+		socket.m_cursor = 0;
 	}
 
-	for (u64 i = m_sockets[peer_id]->m_cursor; i < m_event_buffer.size(); i++)
+	// Every peer is sent the same packets, nothing gets copied per peer
+	while (socket.m_cursor < m_event_buffer.size())
 	{
-		ENetPacket *packet =
-		    enet_packet_create(m_event_buffer[i].data(), m_event_buffer[i].size(), ENET_PACKET_FLAG_RELIABLE);
-		// Batch for sending
-		enet_peer_send(m_sockets[peer_id]->m_peer, 0, packet);
-		m_sockets[peer_id]->m_cursor++;
+		ENetPacket *batch = getBatch(socket.m_cursor);
+		if (batch)
+		{
+			enet_peer_send(socket.m_peer, 0, batch);
+			socket.m_cursor += CATCH_UP_BATCH_EVENTS;
+			continue;
+		}
+
+		enet_peer_send(socket.m_peer, 0, m_event_buffer[socket.m_cursor].packet);
+		socket.m_cursor++;
+	}
+}
+
+// CALLED FROM SERVER THREAD
+ENetPacket *SlippiSpectateServer::getBatch(u64 index)
+{
+	// Batches start at fixed positions so peers catching up at the same time
+	//  share them. The start of game event at 0 is never part of one
+	if (index == 0 || (index - 1) % CATCH_UP_BATCH_EVENTS != 0 ||
+	    index + CATCH_UP_BATCH_EVENTS > m_event_buffer.size())
+	{
+		return nullptr;
+	}
+
+	size_t slot = (size_t)((index - 1) / CATCH_UP_BATCH_EVENTS);
+	if (slot < m_batches.size() && m_batches[slot])
+	{
+		return m_batches[slot];
+	}
+
+	const GameEvent &first = m_event_buffer[index];
+	const GameEvent &last = m_event_buffer[index + CATCH_UP_BATCH_EVENTS - 1];
+	for (u64 i = index; i < index + CATCH_UP_BATCH_EVENTS; i++)
+	{
+		if (!m_event_buffer[i].is_game_event)
+		{
+			return nullptr;
+		}
+	}
+
+	// The game events are back to back in the game data, so the batch is just
+	//  one game event with all of their data
+	json batch;
+	batch["payload"] = base64::Base64::Encode(
+	    std::string((const char *)&m_game_data[first.data_offset], last.data_offset + last.data_length - first.data_offset));
+	batch["type"] = "game_event";
+	batch["cursor"] = (u32)first.cursor;
+	batch["next_cursor"] = (u32)last.cursor + 1;
+
+	if (slot >= m_batches.size())
+	{
+		m_batches.resize(slot + 1, nullptr);
+	}
+	m_batches[slot] = createPacket(batch);
+	return m_batches[slot];
+}
+
+// CALLED FROM SERVER THREAD
+void SlippiSpectateServer::addEvent(const json &message, bool is_game_event, size_t data_offset, size_t data_length)
+{
+	GameEvent event;
+	event.packet = createPacket(message);
+	event.cursor = m_event_buffer.size() + m_cursor_offset;
+	event.is_game_event = is_game_event;
+	event.data_offset = (u32)data_offset;
+	event.data_length = (u32)data_length;
+	m_event_buffer.push_back(event);
+}
+
+// CALLED FROM SERVER THREAD
+void SlippiSpectateServer::endGameEvents(bool dolphin_closed)
+{
+	json json_message;
+	json_message["type"] = "end_game";
+	json_message["dolphin_closed"] = dolphin_closed;
+	u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
+	json_message["cursor"] = cursor;
+	json_message["next_cursor"] = cursor + 1;
+	m_menu_cursor = 0;
+	addEvent(json_message, false, 0, 0);
+	m_cursor_offset += m_event_buffer.size();
+	releasePacket(m_menu_packet);
+	m_menu_packet = nullptr;
+	m_in_game = false;
+}
+
+// CALLED FROM SERVER THREAD
+void SlippiSpectateServer::clearEvents()
+{
+	// Peers that still have packets queued keep them alive until they are sent
+	for (GameEvent &event : m_event_buffer)
+	{
+		releasePacket(event.packet);
+	}
+	for (ENetPacket *batch : m_batches)
+	{
+		releasePacket(batch);
 	}
+	m_event_buffer.clear();
+	m_batches.clear();
+	m_game_data.clear();
+	m_event_concat_start = 0;
 }
 
 // CALLED FROM SERVER THREAD
 void SlippiSpectateServer::popEvents()
 {
-	// Loop through the event queue and keep popping off events and handling them
-	while (!m_event_queue.Empty())
+	// Loop through the event ring and keep popping off events and handling them
+	QueueRecordHeader header;
+	while (m_event_ring->Pop(&header, sizeof(header)))
 	{
-		std::string event;
-		m_event_queue.Pop(event);
 		// These two are meta-events, used to signify the start/end of a game
-		json json_message = json::parse(event, nullptr, false);
-		if (!json_message.is_discarded() && (json_message.find("type") != json_message.end()))
+		if (header.type == QUEUE_END_GAME)
 		{
-			if (json_message["type"] == "end_game")
+			u8 dolphin_closed = 0;
+			m_event_ring->Pop(&dolphin_closed, header.length);
+
+			// A game that was cut short by a resync has been ended already
+			if (m_in_game || !m_resyncing)
 			{
-				u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
-				json_message["cursor"] = cursor;
-				json_message["next_cursor"] = cursor + 1;
-				m_menu_cursor = 0;
-				m_event_buffer.push_back(json_message.dump());
-				m_cursor_offset += m_event_buffer.size();
-				m_menu_event.clear();
-				m_in_game = false;
-				continue;
+				endGameEvents(dolphin_closed != 0);
 			}
-			if (json_message["type"] == "start_game")
+			m_resyncing = false;
+			continue;
+		}
+		if (header.type == QUEUE_DROPPED)
+		{
+			u32 dropped = 0;
+			m_event_ring->Pop(&dropped, header.length);
+			WARN_LOG(SLIPPI, "Spectator server lost %u game events, spectators pick up again at the next game", dropped);
+
+			// Spectators are told the game is over rather than being sent one
+			//  with holes in it
+			if (m_in_game)
 			{
-				m_event_buffer.clear();
-				u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
-				m_in_game = true;
-				json_message["cursor"] = cursor;
-				json_message["next_cursor"] = cursor + 1;
-				m_event_buffer.push_back(json_message.dump());
-				continue;
+				endGameEvents(false);
 			}
+			m_resyncing = true;
+			continue;
+		}
+		if (header.type == QUEUE_START_GAME)
+		{
+			m_resyncing = false;
+			clearEvents();
+			json json_message;
+			json_message["type"] = "start_game";
+			u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
+			m_in_game = true;
+			json_message["cursor"] = cursor;
+			json_message["next_cursor"] = cursor + 1;
+			addEvent(json_message, false, 0, 0);
+			continue;
+		}
+
+		if (m_resyncing)
+		{
+			m_pop_buffer.resize(header.length);
+			m_event_ring->Pop(m_pop_buffer.data(), header.length);
+			continue;
 		}
 
 		// Make json wrapper for game event
@@ -132,15 +301,26 @@ void SlippiSpectateServer::popEvents()
 
 		if (!m_in_game)
 		{
-			game_event["payload"] = base64::Base64::Encode(event);
+			m_pop_buffer.resize(header.length);
+			m_event_ring->Pop(m_pop_buffer.data(), header.length);
+			game_event["payload"] = base64::Base64::Encode(std::string((const char *)m_pop_buffer.data(), header.length));
 			m_menu_cursor += 1;
 			game_event["type"] = "menu_event";
-			m_menu_event = game_event.dump();
+			releasePacket(m_menu_packet);
+			m_menu_packet = createPacket(game_event);
+			continue;
+		}
+
+		// Game data goes straight from the ring into the history
+		size_t offset = m_game_data.size();
+		m_game_data.resize(offset + header.length);
+		m_event_ring->Pop(m_game_data.data() + offset, header.length);
+		if (header.length == 0)
+		{
 			continue;
 		}
 
-		u8 command = (u8)event[0];
-		m_event_concat = m_event_concat + event;
+		u8 command = m_game_data[offset];
 
 		static std::unordered_map<u8, bool> sendEvents = {
 		    {0x36, true}, // GAME_INIT
@@ -151,14 +331,16 @@ void SlippiSpectateServer::popEvents()
 
 		if (sendEvents.count(command))
 		{
+			size_t length = m_game_data.size() - m_event_concat_start;
 			u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
-			game_event["payload"] = base64::Base64::Encode(m_event_concat);
+			game_event["payload"] =
+			    base64::Base64::Encode(std::string((const char *)&m_game_data[m_event_concat_start], length));
 			game_event["type"] = "game_event";
 			game_event["cursor"] = cursor;
 			game_event["next_cursor"] = cursor + 1;
-			m_event_buffer.push_back(game_event.dump());
+			addEvent(game_event, true, m_event_concat_start, length);
 
-			m_event_concat = "";
+			m_event_concat_start = m_game_data.size();
 		}
 	}
 }
@@ -173,8 +355,8 @@ SlippiSpectateServer::SlippiSpectateServer()
 
 	m_in_game = false;
 	m_menu_cursor = 0;
-	m_menu_event.clear();
 	m_cursor_offset = 0;
+	m_event_ring = std::make_unique<Common::SPSCRingBuffer>(EVENT_RING_SIZE);
 
 	// Spawn thread for socket listener
 	m_stop_socket_thread = false;
@@ -307,6 +489,9 @@ void SlippiSpectateServer::SlippicommSocketThread(void)
 		// If we're told to stop, then quit
 		if (m_stop_socket_thread)
 		{
+			clearEvents();
+			releasePacket(m_menu_packet);
+			m_menu_packet = nullptr;
 			enet_host_destroy(server);
 			enet_deinitialize();
 			return;
@@ -3,9 +3,11 @@
 #include <atomic>
 #include <chrono>
 #include <map>
+#include <memory>
 #include <thread>
+#include <vector>
 
-#include "Common/FifoQueue.h"
+#include "Common/SPSCRingBuffer.h"
 #include "nlohmann/json.hpp"
 #include <enet/enet.h>
 using json = nlohmann::json;
@@ -19,7 +21,10 @@ using json = nlohmann::json;
 typedef int SOCKET;
 #endif
 
-#define MAX_CLIENTS 4
+#define MAX_CLIENTS 32
+
+// Spectators that fell behind get this many game events per packet
+#define CATCH_UP_BATCH_EVENTS 32
 
 #define HANDSHAKE_MSG_BUF_SIZE 128
 #define HANDSHAKE_TYPE 1
@@ -64,12 +69,42 @@ class SlippiSpectateServer
 	void operator=(SlippiSpectateServer const &) = delete;
 
   private:
+	enum QueueRecordType : u8
+	{
+		QUEUE_EVENT,
+		QUEUE_START_GAME,
+		// Carries one byte, whether dolphin is closing
+		QUEUE_END_GAME,
+		// Carries a u32, how many records didn't fit in the ring before this one
+		QUEUE_DROPPED,
+	};
+
+	struct QueueRecordHeader
+	{
+		u32 length;
+		QueueRecordType type;
+	};
+
+	// An entry of the game event history. Its packet is created once and the
+	//  same one is handed to every peer, ENet frees it once the last peer is done
+	//  with it and the server has let go of it
+	struct GameEvent
+	{
+		ENetPacket *packet;
+		u64 cursor;
+		// The raw game data of the event in m_game_data. Start and end of game
+		//  events don't have any and can't be batched
+		bool is_game_event;
+		u32 data_offset;
+		u32 data_length;
+	};
+
 	// ACCESSED FROM BOTH DOLPHIN AND SERVER THREADS
-	// This is a lockless queue that bridges the gap between the main
+	// This is a lockless ring that bridges the gap between the main
 	//  dolphin thread and the spectator server thread. The purpose here
-	//  is to avoid blocking (even if just for a brief mutex) on the main
-	//  dolphin thread.
-	Common::FifoQueue<std::string> m_event_queue;
+	//  is to avoid blocking (even if just for a brief mutex) or allocating
+	//  on the main dolphin thread.
+	std::unique_ptr<Common::SPSCRingBuffer> m_event_ring;
 	// Bool gets flipped by the destrctor to tell the server thread to shut down
 	//  bools are probably atomic by default, but just for safety...
 	std::atomic<bool> m_stop_socket_thread;
@@ -77,9 +112,16 @@ class SlippiSpectateServer
 	// ONLY ACCESSED FROM SERVER THREAD
 	bool m_in_game;
 	std::map<u16, std::shared_ptr<SlippiSocket>> m_sockets;
-	std::string m_event_concat = "";
-	std::vector<std::string> m_event_buffer;
-	std::string m_menu_event;
+	// Raw data of the current game. Only ever appended to until the next game starts
+	std::vector<u8> m_game_data;
+	// Start of the data that isn't part of a game event yet
+	size_t m_event_concat_start = 0;
+	std::vector<GameEvent> m_event_buffer;
+	// Batch packets for lagging peers, entry k holds the events starting at
+	//  1 + k * CATCH_UP_BATCH_EVENTS. Shared between peers the same way
+	std::vector<ENetPacket *> m_batches;
+	ENetPacket *m_menu_packet = nullptr;
+	std::vector<u8> m_pop_buffer;
 	// In order to emulate Wii behavior, the cursor position should be strictly
 	//  increasing. But internally, we need to index arrays by the cursor value.
 	//  To solve this, we keep an "offset" value that is added to all outgoing
@@ -88,6 +130,13 @@ class SlippiSpectateServer
 	//  How many menu events have we sent so far? (Reset between matches)
 	//    Is used to know when a client hasn't been sent a menu event
 	u64 m_menu_cursor;
+	// Set when records were lost, game events are thrown away until the next
+	//  game starts since spectators can't be sent a game with holes in it
+	bool m_resyncing = false;
+
+	// ONLY ACCESSED FROM DOLPHIN THREAD
+	// Records that didn't fit in the ring since the server was last told about it
+	u32 m_dropped_records = 0;
 
 	std::thread m_socketThread;
 
@@ -105,4 +154,14 @@ class SlippiSpectateServer
 	void writeEvents(u16 peer_id);
 	// Pop events
 	void popEvents();
+	// Returns the shared batch packet starting at the given event, or nullptr if
+	//  there is none
+	ENetPacket *getBatch(u64 index);
+	void addEvent(const json &message, bool is_game_event, size_t data_offset, size_t data_length);
+	// Adds the end of game event and leaves the game
+	void endGameEvents(bool dolphin_closed);
+	void clearEvents();
+
+	// CALLED FROM DOLPHIN MAIN THREAD
+	void pushRecord(QueueRecordType type, const u8 *payload, u32 length);
 };
@@ -32,6 +32,7 @@
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "Core/PowerPC/SignatureDB.h"
 
 #include "DolphinWX/Debugger/BreakpointWindow.h"
@@ -156,6 +157,26 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
 			}
 		}
 		break;
+	case IDM_SAMPLE_PROFILE:
+		if (GetParentMenuBar()->IsChecked(IDM_SAMPLE_PROFILE))
+		{
+			SamplingProfiler::Start();
+		}
+		else
+		{
+			SamplingProfiler::Stop();
+
+			// The symbols of Gecko codes are found in guest memory
+			bool was_unpaused = Core::PauseAndLock(true);
+			std::string path = File::GetUserPath(D_DUMP_IDX) + "Debug/";
+			if (SamplingProfiler::WriteFolded(path + "profile.folded") &&
+				SamplingProfiler::WritePprof(path + "profile.pb"))
+			{
+				Core::DisplayMessage("Wrote profile.folded and profile.pb to " + path, 5000);
+			}
+			Core::PauseAndLock(false, was_unpaused);
+		}
+		break;
 	}
 }
 
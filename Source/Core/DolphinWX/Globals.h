@@ -236,6 +236,7 @@ enum
 	// Profiler
 	IDM_PROFILE_BLOCKS,
 	IDM_WRITE_PROFILE,
+	IDM_SAMPLE_PROFILE,
 	// --------------------------------------------------------------
 
 	// --------------------------------------------------------------
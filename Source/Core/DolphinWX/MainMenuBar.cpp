@@ -477,6 +477,8 @@ wxMenu* MainMenuBar::CreateProfilerMenu() const
 	profiler_menu->AppendCheckItem(IDM_PROFILE_BLOCKS, _("&Profile Blocks"));
 	profiler_menu->AppendSeparator();
 	profiler_menu->Append(IDM_WRITE_PROFILE, _("&Write to profile.txt, Show"));
+	profiler_menu->AppendSeparator();
+	profiler_menu->AppendCheckItem(IDM_SAMPLE_PROFILE, _("&Sample Call Stacks"));
 
 	return profiler_menu;
 }
@@ -363,8 +363,11 @@ class PlatformX11 : public Platform
 };
 #endif
 
-static Platform* GetPlatform()
+static Platform* GetPlatform(const std::string& video_backend)
 {
+	// The null backend never opens a window, so it doesn't need a display either
+	if (video_backend == "Null")
+		return new Platform();
 #if defined(USE_EGL) && defined(USE_HEADLESS)
 	return new Platform();
 #elif HAVE_X11
@@ -376,17 +379,27 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
 	int ch, help = 0;
+	bool uncapped = false;
+	std::string video_backend;
 	struct option longopts[] = { { "exec", no_argument, nullptr, 'e' },
+	{ "video_backend", required_argument, nullptr, 'b' },
+	{ "uncapped", no_argument, nullptr, 'u' },
 	{ "help", no_argument, nullptr, 'h' },
 	{ "version", no_argument, nullptr, 'v' },
 	{ nullptr, 0, nullptr, 0 } };
 
-	while ((ch = getopt_long(argc, argv, "eh?v", longopts, 0)) != -1)
+	while ((ch = getopt_long(argc, argv, "eb:uh?v", longopts, 0)) != -1)
 	{
 		switch (ch)
 		{
 		case 'e':
 			break;
+		case 'b':
+			video_backend = optarg;
+			break;
+		case 'u':
+			uncapped = true;
+			break;
 		case 'h':
 		case '?':
 			help = 1;
@@ -401,14 +414,17 @@ int main(int argc, char* argv[])
 	{
 		fprintf(stderr, "%s\n\n", scm_rev_str.c_str());
 		fprintf(stderr, "A multi-platform GameCube/Wii emulator\n\n");
-		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v]\n", argv[0]);
-		fprintf(stderr, "  -e, --exec     Load the specified file\n");
-		fprintf(stderr, "  -h, --help     Show this help message\n");
-		fprintf(stderr, "  -v, --version  Print version and exit\n");
+		fprintf(stderr, "Usage: %s [-e <file>] [-b <backend>] [-u] [-h] [-v]\n", argv[0]);
+		fprintf(stderr, "  -e, --exec           Load the specified file\n");
+		fprintf(stderr, "  -b, --video_backend  Use the specified video backend, \"Null\" runs\n"
+		                "                       without a window or GPU\n");
+		fprintf(stderr, "  -u, --uncapped       Run as fast as possible instead of at full speed\n");
+		fprintf(stderr, "  -h, --help           Show this help message\n");
+		fprintf(stderr, "  -v, --version        Print version and exit\n");
 		return 1;
 	}
 
-	platform = GetPlatform();
+	platform = GetPlatform(video_backend);
 	if (!platform)
 	{
 		fprintf(stderr, "No platform found\n");
@@ -418,6 +434,18 @@ int main(int argc, char* argv[])
 	UICommon::SetUserDirectory("");  // Auto-detect user folder
 	UICommon::Init();
 
+	// Only for this run, the saved settings are put back before shutting down
+	SConfig& config = SConfig::GetInstance();
+	const std::string saved_video_backend = config.m_strVideoBackend;
+	const float saved_emulation_speed = config.m_EmulationSpeed;
+	if (!video_backend.empty())
+	{
+		config.m_strVideoBackend = video_backend;
+		VideoBackendBase::ActivateBackend(video_backend);
+	}
+	if (uncapped)
+		config.m_EmulationSpeed = 0.0f;
+
 	Core::SetOnStoppedCallback([]() { s_running.Clear(); });
 	platform->Init();
 
@@ -449,6 +477,8 @@ int main(int argc, char* argv[])
 
 	Core::Shutdown();
 	platform->Shutdown();
+	config.m_strVideoBackend = saved_video_backend;
+	config.m_EmulationSpeed = saved_emulation_speed;
 	UICommon::Shutdown();
 
 	delete platform;
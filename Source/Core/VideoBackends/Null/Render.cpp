@@ -0,0 +1,115 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "VideoBackends/Null/Render.h"
+
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+Renderer::Plane::Plane()
+	: values(EFB_WIDTH * EFB_HEIGHT), generations(EFB_WIDTH * EFB_HEIGHT)
+{
+}
+
+u32 Renderer::Plane::Read(u32 x, u32 y) const
+{
+	if (x >= EFB_WIDTH || y >= EFB_HEIGHT)
+		return 0;
+	u32 i = y * EFB_WIDTH + x;
+	return generations[i] == generation ? values[i] : clear_value;
+}
+
+void Renderer::Plane::Write(u32 x, u32 y, u32 value)
+{
+	if (x >= EFB_WIDTH || y >= EFB_HEIGHT)
+		return;
+	u32 i = y * EFB_WIDTH + x;
+	values[i] = value;
+	generations[i] = generation;
+}
+
+void Renderer::Plane::Clear(const EFBRectangle& rc, u32 value)
+{
+	int left = std::max(rc.left, 0);
+	int top = std::max(rc.top, 0);
+	int right = std::min(rc.right, (int)EFB_WIDTH);
+	int bottom = std::min(rc.bottom, (int)EFB_HEIGHT);
+	if (left == 0 && top == 0 && right == (int)EFB_WIDTH && bottom == (int)EFB_HEIGHT)
+	{
+		generation++;
+		clear_value = value;
+		return;
+	}
+	for (int y = top; y < bottom; y++)
+		for (int x = left; x < right; x++)
+			Write(x, y, value);
+}
+
+Renderer::Renderer()
+{
+	m_target_width = EFB_WIDTH;
+	m_target_height = EFB_HEIGHT;
+	m_backbuffer_width = EFB_WIDTH;
+	m_backbuffer_height = EFB_HEIGHT;
+}
+
+Renderer::~Renderer()
+{
+}
+
+u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
+{
+	switch (type)
+	{
+	case EFBAccessType::PeekColor:
+		return m_color.Read(x, y);
+	case EFBAccessType::PeekZ:
+		return m_depth.Read(x, y);
+	case EFBAccessType::PokeColor:
+		m_color.Write(x, y, poke_data);
+		break;
+	case EFBAccessType::PokeZ:
+		m_depth.Write(x, y, poke_data);
+		break;
+	}
+	return 0;
+}
+
+void Renderer::PokeEFB(EFBAccessType type, const EfbPokeData* points, size_t num_points)
+{
+	Plane& plane = type == EFBAccessType::PokeColor ? m_color : m_depth;
+	for (size_t i = 0; i < num_points; i++)
+		plane.Write(points[i].x, points[i].y, points[i].data);
+}
+
+TargetRectangle Renderer::ConvertEFBRectangle(const EFBRectangle& rc)
+{
+	TargetRectangle result;
+	result.left = rc.left;
+	result.top = rc.top;
+	result.right = rc.right;
+	result.bottom = rc.bottom;
+	return result;
+}
+
+void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, u64 ticks, float Gamma)
+{
+	UpdateActiveConfig();
+}
+
+void Renderer::ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaEnable, bool zEnable, u32 color, u32 z)
+{
+	if (colorEnable || alphaEnable)
+	{
+		// Channels that aren't cleared keep their last clear value
+		u32 mask = (colorEnable ? 0x00FFFFFF : 0) | (alphaEnable ? 0xFF000000 : 0);
+		m_color.Clear(rc, (color & mask) | (m_color.clear_value & ~mask));
+	}
+	if (zEnable)
+		m_depth.Clear(rc, z & 0xFFFFFF);
+}
+}
@@ -0,0 +1,53 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "VideoCommon/RenderBase.h"
+
+namespace Null
+{
+class Renderer : public ::Renderer
+{
+public:
+	Renderer();
+	~Renderer() override;
+
+	void RenderText(const std::string& str, int left, int top, u32 color) override {}
+	u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) override;
+	void PokeEFB(EFBAccessType type, const EfbPokeData* points, size_t num_points) override;
+
+	u16 BBoxRead(int index) override { return m_bbox[index]; }
+	void BBoxWrite(int index, u16 value) override { m_bbox[index] = value; }
+
+	TargetRectangle ConvertEFBRectangle(const EFBRectangle& rc) override;
+
+	void SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, u64 ticks, float Gamma) override;
+
+	void ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaEnable, bool zEnable, u32 color, u32 z) override;
+	void ReinterpretPixelData(unsigned int convtype) override {}
+
+private:
+	// Nothing is rasterized, but a peek still returns what the game last poked or cleared there.
+	// A full clear only bumps the generation, pixels written in an older one read as the clear value.
+	struct Plane
+	{
+		std::vector<u32> values;
+		std::vector<u32> generations;
+		u32 generation = 1;
+		u32 clear_value = 0;
+
+		Plane();
+		u32 Read(u32 x, u32 y) const;
+		void Write(u32 x, u32 y, u32 value);
+		void Clear(const EFBRectangle& rc, u32 value);
+	};
+
+	Plane m_color;
+	Plane m_depth;
+	u16 m_bbox[4] = {};
+};
+}
@@ -0,0 +1,77 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/TextureCacheBase.h"
+
+namespace Null
+{
+// Textures are still looked up and hashed by the base class, but never uploaded anywhere
+class TextureCache : public TextureCacheBase
+{
+public:
+	PC_TexFormat GetNativeTextureFormat(const s32 texformat,
+		const TlutFormat tlutfmt, u32 width, u32 height) override
+	{
+		return PC_TexFormat::PC_TEX_FMT_RGBA32;
+	}
+	bool CompileShaders() override
+	{
+		return true;
+	}
+	void DeleteShaders() override
+	{}
+	bool Palettize(TCacheEntryBase* entry, const TCacheEntryBase* base_entry) override
+	{
+		return true;
+	}
+	void CopyEFB(u8* dst, const EFBCopyFormat& format, u32 native_width, u32 bytes_per_row,
+		u32 num_blocks_y, u32 memory_stride, bool is_depth_copy,
+		const EFBRectangle& src_rect, bool scale_by_half) override
+	{}
+	void LoadLut(u32 lutFmt, void* addr, u32 size) override
+	{}
+
+private:
+	struct TCacheEntry : TCacheEntryBase
+	{
+		TCacheEntry(const TCacheEntryConfig& _config) : TCacheEntryBase(_config)
+		{}
+		~TCacheEntry()
+		{}
+
+		void Load(const u8* src, u32 width, u32 height,
+			u32 expanded_width, u32 level) override
+		{}
+		bool SupportsMaterialMap() const override
+		{
+			return false;
+		}
+		void FromRenderTarget(bool is_depth_copy, const EFBRectangle& srcRect,
+			bool scaleByHalf, unsigned int cbufid, const float *colmat, u32 width, u32 height) override
+		{}
+		void CopyRectangleFromTexture(
+			const TCacheEntryBase* source,
+			const MathUtil::Rectangle<int>& srcrect,
+			const MathUtil::Rectangle<int>& dstrect) override
+		{}
+		void Bind(u32 stage) override
+		{}
+		bool Save(const std::string& filename, u32 level) override
+		{
+			return false;
+		}
+		uintptr_t GetInternalObject() override
+		{
+			return 0;
+		}
+	};
+
+	TCacheEntryBase* CreateTexture(const TCacheEntryConfig& config) override
+	{
+		return new TCacheEntry(config);
+	}
+};
+}
@@ -0,0 +1,29 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace Null
+{
+// Runs the whole GPU command stream (FIFO, register state, vertex loading, EFB copies, PE
+// interrupts) without drawing anything, so it needs neither a GPU nor a window. Meant for
+// processing replays as fast as the CPU emulation allows.
+class VideoBackend : public VideoBackendBase
+{
+	bool Initialize(void* window_handle) override;
+	void Shutdown() override;
+
+	std::string GetName() const override { return "Null"; }
+	std::string GetDisplayName() const override { return "Null (no output)"; }
+	void Video_Prepare() override;
+	void Video_Cleanup() override;
+
+	void InitBackendInfo() override;
+
+	void PrepareWindow(void* window_handle) override {}
+	unsigned int PeekMessages() override { return 0; }
+};
+}
@@ -2,12 +2,23 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common/Align.h"
+#include "Common/CPUDetect.h"
 #include "Common/Common.h"
+#include "Common/GL/GLInterfaceBase.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
 
 #include "Core/Host.h"
 #include "Core/ConfigManager.h"
@@ -33,7 +44,7 @@ u32 ProgramShaderCache::s_g_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static std::unique_ptr<StreamBuffer> s_buffer;
-static int num_failures = 0;
+static std::atomic<int> num_failures{0};
 
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
 static GLuint CurrentProgram = 0;
@@ -43,6 +54,74 @@ std::array<SHADERUID, PIXEL_SHADER_RENDER_MODE::PSRM_DEPTH_ONLY + 1> ProgramShad
 
 static char s_glsl_header[2048] = "";
 
+// Compiles and links programs, or loads them from their binaries, on worker threads with GL
+// contexts sharing objects with the main one. Only the render thread touches the program cache,
+// the workers hand finished programs back to it through GetResults.
+class BackgroundProgramCompiler
+{
+public:
+	struct Job
+	{
+		ProgramShaderCache::PCacheEntry* entry;
+		SHADERUID uid;
+		GLenum binary_format;
+		std::vector<u8> binary; // empty to build the program from its shader code
+	};
+
+	struct Result
+	{
+		ProgramShaderCache::PCacheEntry* entry;
+		GLuint program; // 0 if it could not be built
+		bool from_binary;
+	};
+
+	~BackgroundProgramCompiler();
+
+	// False if the GL interface has no shared contexts to offer
+	bool Start(int threads);
+	// Drops the queued jobs and waits for the running ones
+	void Stop();
+
+	void Queue(Job&& job);
+	// Takes a job back that no worker started yet
+	bool Take(const ProgramShaderCache::PCacheEntry* entry, Job* job);
+	bool HasResults() const { return m_has_results.load(std::memory_order_acquire); }
+	void GetResults(std::vector<Result>* results);
+	// Waits for a result, false if there is nothing left to wait for
+	bool WaitForResult();
+	size_t GetOutstandingCount();
+
+	static Result Run(const Job& job);
+
+private:
+	void WorkerThread(cInterfaceBase* context);
+
+	std::vector<std::unique_ptr<cInterfaceBase>> m_contexts;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_job_added;
+	std::condition_variable m_result_added;
+	std::deque<Job> m_jobs;
+	std::vector<Result> m_results;
+	std::atomic<bool> m_has_results{false};
+	size_t m_running = 0;
+	bool m_exit = false;
+};
+
+static std::unique_ptr<BackgroundProgramCompiler> s_compiler;
+
+// How long the first draw waited and how often drawing waited on a program since, logged on shutdown
+static struct
+{
+	u32 init_start_ms;
+	bool first_draw_seen;
+	u32 loaded_in_background;
+	u32 built_in_background;
+	u32 built_while_drawing;
+	u32 waited_for_background;
+	u64 drawing_stall_us;
+} s_program_stats;
+
 static std::string GetGLSLVersionString()
 {
 	GLSL_VERSION v = g_ogl_config.eSupportedGLSLVersion;
@@ -214,33 +293,32 @@ GLuint ProgramShaderCache::GetCurrentProgram()
 	return CurrentProgram;
 }
 
-SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
+// Generates the shader code of uid and links it into shader.
+// Runs on the render thread and on the background compilers at the same time,
+// so each build writes into buffers of its own instead of the generators' static ones.
+static bool BuildProgram(SHADER& shader, const SHADERUID& uid)
 {
-	PIXEL_SHADER_RENDER_MODE render_mode = (PIXEL_SHADER_RENDER_MODE)uid.puid.GetUidData().render_mode;
-	// Check if shader is already in cache
-	PCacheEntry& newentry = pshaders->GetOrAdd(uid);
-	if (newentry.shader.glprogid)
-	{
-		last_entry[render_mode] = &newentry;
-		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
-		return &last_entry[render_mode]->shader;
-	}
-	// Make an entry in the table
-	last_entry[render_mode] = &newentry;
-	newentry.in_cache = 0;
-
+	std::vector<char> vbuffer(VERTEXSHADERGEN_BUFFERSIZE);
+	std::vector<char> pbuffer(PIXELSHADERGEN_BUFFERSIZE);
+	std::vector<char> gbuffer;
 	ShaderCode vcode;
 	ShaderCode pcode;
 	ShaderCode gcode;
+	vcode.SetBuffer(vbuffer.data());
+	pcode.SetBuffer(pbuffer.data());
 	GenerateVertexShaderCodeGL(vcode, uid.vuid.GetUidData());
 	GeneratePixelShaderCodeGL(pcode, uid.puid.GetUidData());
 	if (g_ActiveConfig.backend_info.bSupportsGeometryShaders && !uid.guid.GetUidData().IsPassthrough())
+	{
+		gbuffer.resize(GEOMETRYSHADERGEN_BUFFERSIZE);
+		gcode.SetBuffer(gbuffer.data());
 		GenerateGeometryShaderCode(gcode, uid.guid.GetUidData(), API_OPENGL);
+	}
 
 #if defined(_DEBUG) || defined(DEBUGFAST)
 	if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
 	{
-		static int counter = 0;
+		static std::atomic<int> counter{0};
 		std::string filename = StringFromFormat("%svs_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
 		SaveData(filename, vcode.GetBuffer());
 
@@ -255,11 +333,255 @@ SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
 	}
 #endif
 
-	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
+	return ProgramShaderCache::CompileShader(shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer());
+}
+
+static GLuint LoadProgramBinary(GLenum format, const u8* binary, GLint size)
+{
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, format, binary, size);
+
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+BackgroundProgramCompiler::~BackgroundProgramCompiler()
+{
+	Stop();
+}
+
+bool BackgroundProgramCompiler::Start(int threads)
+{
+	for (int i = 0; i < threads; i++)
+	{
+		std::unique_ptr<cInterfaceBase> context = GLInterface->CreateSharedContext();
+		if (!context)
+			break;
+		m_contexts.push_back(std::move(context));
+	}
+	if (m_contexts.empty())
+		return false;
+
+	for (auto& context : m_contexts)
+		m_threads.emplace_back(&BackgroundProgramCompiler::WorkerThread, this, context.get());
+	INFO_LOG(VIDEO, "Building programs on %zu background threads", m_threads.size());
+	return true;
+}
+
+void BackgroundProgramCompiler::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_exit = true;
+		m_jobs.clear();
+	}
+	m_job_added.notify_all();
+	for (std::thread& thread : m_threads)
+		thread.join();
+	m_threads.clear();
+	m_contexts.clear();
+}
+
+void BackgroundProgramCompiler::Queue(Job&& job)
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_jobs.push_back(std::move(job));
+	}
+	m_job_added.notify_one();
+}
+
+bool BackgroundProgramCompiler::Take(const ProgramShaderCache::PCacheEntry* entry, Job* job)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [entry](const Job& queued) {
+		return queued.entry == entry;
+	});
+	if (it == m_jobs.end())
+		return false;
+	*job = std::move(*it);
+	m_jobs.erase(it);
+	return true;
+}
+
+void BackgroundProgramCompiler::GetResults(std::vector<Result>* results)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	results->swap(m_results);
+	m_results.clear();
+	m_has_results.store(false, std::memory_order_relaxed);
+}
+
+bool BackgroundProgramCompiler::WaitForResult()
+{
+	std::unique_lock<std::mutex> lk(m_mutex);
+	m_result_added.wait(lk, [this] {
+		return !m_results.empty() || (m_jobs.empty() && m_running == 0);
+	});
+	return !m_results.empty();
+}
+
+size_t BackgroundProgramCompiler::GetOutstandingCount()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	return m_jobs.size() + m_running;
+}
+
+BackgroundProgramCompiler::Result BackgroundProgramCompiler::Run(const Job& job)
+{
+	if (!job.binary.empty())
+	{
+		GLuint program = LoadProgramBinary(job.binary_format, job.binary.data(), static_cast<GLint>(job.binary.size()));
+		if (program)
+			return {job.entry, program, true};
+		// Left by another driver version, built again from the shader code
+	}
+
+	SHADER shader;
+	if (!BuildProgram(shader, job.uid))
+		return {job.entry, 0, false};
+	return {job.entry, shader.glprogid, false};
+}
+
+void BackgroundProgramCompiler::WorkerThread(cInterfaceBase* context)
+{
+	Common::SetCurrentThreadName("Program compiler");
+
+	// Without a context jobs are handed back unbuilt, the render thread builds them when it needs them
+	const bool current = context->MakeCurrent();
+	if (!current)
+		ERROR_LOG(VIDEO, "Could not make a shared GL context current");
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true)
+	{
+		m_job_added.wait(lk, [this] { return m_exit || !m_jobs.empty(); });
+		if (m_exit)
+			break;
+
+		Job job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		m_running++;
+		lk.unlock();
+
+		Result result = {job.entry, 0, false};
+		if (current)
+		{
+			result = Run(job);
+			// The render thread may only use the program once the commands building it are done
+			glFinish();
+		}
+
+		lk.lock();
+		m_running--;
+		m_results.push_back(result);
+		m_has_results.store(true, std::memory_order_release);
+		m_result_added.notify_all();
+	}
+	lk.unlock();
+
+	// Some interfaces release whatever context is current on the calling thread
+	context->Shutdown();
+}
+
+static void SetBackgroundProgram(const BackgroundProgramCompiler::Result& result)
+{
+	ProgramShaderCache::PCacheEntry* entry = result.entry;
+	entry->pending = false;
+	if (!result.program)
+		return;
+	entry->shader.glprogid = result.program;
+	entry->shader.initialized = false;
+	entry->in_cache = result.from_binary;
+}
+
+void ProgramShaderCache::RetrieveBackgroundPrograms()
+{
+	std::vector<BackgroundProgramCompiler::Result> results;
+	s_compiler->GetResults(&results);
+	for (const BackgroundProgramCompiler::Result& result : results)
+	{
+		SetBackgroundProgram(result);
+		if (!result.program)
+			continue;
+		if (result.from_binary)
+		{
+			s_program_stats.loaded_in_background++;
+		}
+		else
+		{
+			s_program_stats.built_in_background++;
+			INCSTAT(stats.numPixelShadersCreated);
+		}
+	}
+}
+
+void ProgramShaderCache::WaitForBackgroundProgram(PCacheEntry& entry)
+{
+	const u64 start_us = Common::Timer::GetTimeUs();
+	BackgroundProgramCompiler::Job job;
+	if (s_compiler->Take(&entry, &job))
+	{
+		// Not started yet, quicker to build it here than to wait for every job ahead of it
+		BackgroundProgramCompiler::Result result = BackgroundProgramCompiler::Run(job);
+		SetBackgroundProgram(result);
+		if (result.program && !result.from_binary && s_program_stats.first_draw_seen)
+			s_program_stats.built_while_drawing++;
+	}
+	else
+	{
+		s_program_stats.waited_for_background++;
+		while (entry.pending)
+		{
+			if (!s_compiler->WaitForResult())
+			{
+				entry.pending = false;
+				break;
+			}
+			RetrieveBackgroundPrograms();
+		}
+	}
+	if (s_program_stats.first_draw_seen)
+		s_program_stats.drawing_stall_us += Common::Timer::GetTimeUs() - start_us;
+}
+
+SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
+{
+	if (s_compiler && s_compiler->HasResults())
+		RetrieveBackgroundPrograms();
+
+	PIXEL_SHADER_RENDER_MODE render_mode = (PIXEL_SHADER_RENDER_MODE)uid.puid.GetUidData().render_mode;
+	// Check if shader is already in cache
+	PCacheEntry& newentry = pshaders->GetOrAdd(uid);
+	if (newentry.pending)
+		WaitForBackgroundProgram(newentry);
+	if (newentry.shader.glprogid)
+	{
+		last_entry[render_mode] = &newentry;
+		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
+		return &last_entry[render_mode]->shader;
+	}
+	// Make an entry in the table
+	last_entry[render_mode] = &newentry;
+	newentry.in_cache = 0;
+
+	const u64 start_us = Common::Timer::GetTimeUs();
+	if (!BuildProgram(newentry.shader, uid))
 	{
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
 		return nullptr;
 	}
+	if (s_program_stats.first_draw_seen)
+	{
+		s_program_stats.built_while_drawing++;
+		s_program_stats.drawing_stall_us += Common::Timer::GetTimeUs() - start_us;
+	}
 
 	INCSTAT(stats.numPixelShadersCreated);
 	SETSTAT(stats.numPixelShadersAlive, static_cast<int>(pshaders->size()));
@@ -270,6 +592,13 @@ SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
 
 SHADER* ProgramShaderCache::SetShader(PIXEL_SHADER_RENDER_MODE render_mode, u32 components, u32 primitive_type)
 {
+	if (!s_program_stats.first_draw_seen)
+	{
+		s_program_stats.first_draw_seen = true;
+		NOTICE_LOG(VIDEO, "First program set %u ms after the program cache started",
+			Common::Timer::GetTimeMs() - s_program_stats.init_start_ms);
+	}
+
 	SHADERUID uid;
 	GetShaderId(&uid, render_mode, components, primitive_type);
 	uid.CalculateHash();
@@ -516,6 +845,9 @@ void ProgramShaderCache::GetShaderId(SHADERUID* uid, PIXEL_SHADER_RENDER_MODE re
 
 void ProgramShaderCache::Init()
 {
+	s_program_stats = {};
+	s_program_stats.init_start_ms = Common::Timer::GetTimeMs();
+
 	// We have to get the UBO alignment here because
 	// if we generate a buffer that isn't aligned
 	// then the UBO will fail.
@@ -542,6 +874,15 @@ void ProgramShaderCache::Init()
 		StringFromFormat("%s.ps.OGL", SConfig::GetInstance().GetGameID().c_str())
 	);
 
+	// The workers build programs with this header
+	CreateHeader();
+
+	// Programs are loaded and built on shared contexts where the GL interface has them, the game
+	// starts while that goes on
+	s_compiler = std::make_unique<BackgroundProgramCompiler>();
+	if (!s_compiler->Start(std::max(std::min(cpu_info.num_cores / 2, 4), 1)))
+		s_compiler.reset();
+
 	// Read our shader cache, only if supported
 	if (g_ogl_config.bSupportsGLSLCache)
 	{
@@ -566,11 +907,12 @@ void ProgramShaderCache::Init()
 		SETSTAT(stats.numPixelShadersAlive, pshaders->size());
 	}
 
-	CreateHeader();
-
 	CurrentProgram = 0;
 	last_entry.fill(nullptr);
-	if (g_ActiveConfig.bCompileShaderOnStartup)
+	// Programs used in earlier sessions, or listed in the profile shipped for the game, are built
+	// before they are needed. Compiling on startup waits for them, otherwise the background compiler
+	// builds them while the game runs.
+	if (s_compiler || g_ActiveConfig.bCompileShaderOnStartup)
 	{
 		size_t shader_count = 0;
 		pshaders->ForEachMostUsedByCategory(gameid,
@@ -584,20 +926,57 @@ void ProgramShaderCache::Init()
 			if ((!uid_data.stereo || g_ActiveConfig.backend_info.bSupportsGeometryShaders)
 				&& (!uid_data.bounding_box || g_ActiveConfig.backend_info.bSupportsBBox))
 			{
-				Host_UpdateTitle(StringFromFormat("Compiling Shaders %zu %% (%zu/%zu)", (shader_count * 100) / total, shader_count, total));
-				CompileShader(item);
+				if (s_compiler)
+				{
+					PCacheEntry& entry = pshaders->GetOrAdd(item);
+					entry.pending = true;
+					s_compiler->Queue({&entry, item, 0, {}});
+				}
+				else
+				{
+					Host_UpdateTitle(StringFromFormat("Compiling Shaders %zu %% (%zu/%zu)", (shader_count * 100) / total, shader_count, total));
+					CompileShader(item);
+				}
 			}
 		},
 			[](PCacheEntry& entry)
 		{
-			return !entry.shader.glprogid;
+			return !entry.shader.glprogid && !entry.pending;
 		}
 		, true);
+
+		if (s_compiler && g_ActiveConfig.bCompileShaderOnStartup)
+		{
+			const size_t total = s_compiler->GetOutstandingCount();
+			while (s_compiler->WaitForResult())
+			{
+				RetrieveBackgroundPrograms();
+				const size_t done = total - s_compiler->GetOutstandingCount();
+				Host_UpdateTitle(StringFromFormat("Compiling Shaders %zu %% (%zu/%zu)", (done * 100) / total, done, total));
+			}
+		}
 	}
+
+	INFO_LOG(VIDEO, "Program cache ready after %u ms, %zu programs left to the background compiler",
+		Common::Timer::GetTimeMs() - s_program_stats.init_start_ms,
+		s_compiler ? s_compiler->GetOutstandingCount() : 0);
 }
 
 void ProgramShaderCache::Shutdown()
 {
+	// Programs still being built are kept, the rest is built again next time
+	if (s_compiler)
+	{
+		s_compiler->Stop();
+		RetrieveBackgroundPrograms();
+		s_compiler.reset();
+	}
+	NOTICE_LOG(VIDEO, "Programs: %u loaded and %u built in the background, %u built while drawing, "
+		"%u waits for the background compiler, %.1f ms of drawing stalled",
+		s_program_stats.loaded_in_background, s_program_stats.built_in_background,
+		s_program_stats.built_while_drawing, s_program_stats.waited_for_background,
+		s_program_stats.drawing_stall_us / 1000.0);
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache)
 	{
@@ -796,22 +1175,20 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 	GLint binary_size = value_size - sizeof(GLenum);
 
 	PCacheEntry& entry = pshaders->GetOrAdd(key);
+	if (entry.pending)
+		return;
 	entry.in_cache = 1;
-	entry.shader.glprogid = glCreateProgram();
-	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
-
-	GLint success;
-	glGetProgramiv(entry.shader.glprogid, GL_LINK_STATUS, &success);
-
-	if (success)
+	if (s_compiler)
 	{
-		entry.shader.SetProgramVariables();
-	}
-	else
-	{
-		glDeleteProgram(entry.shader.glprogid);
-		entry.shader.glprogid = 0;
+		// Uploaded by the workers in parallel
+		entry.pending = true;
+		s_compiler->Queue({&entry, key, *prog_format, std::vector<u8>(binary, binary + binary_size)});
+		return;
 	}
+
+	entry.shader.glprogid = LoadProgramBinary(*prog_format, binary, binary_size);
+	if (entry.shader.glprogid)
+		entry.shader.SetProgramVariables();
 }
 
 
@@ -92,6 +92,8 @@ public:
 	{
 		SHADER shader;
 		bool in_cache;
+		// Queued for the background compiler, its program shows up in shader once it is done
+		bool pending = false;
 
 		void Destroy()
 		{
@@ -124,6 +126,9 @@ private:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	static void RetrieveBackgroundPrograms();
+	static void WaitForBackgroundProgram(PCacheEntry& entry);
+
 	static PCache* pshaders;
 	static std::array<PCacheEntry*, PIXEL_SHADER_RENDER_MODE::PSRM_DEPTH_ONLY + 1> last_entry;
 	static std::array<SHADERUID, PIXEL_SHADER_RENDER_MODE::PSRM_DEPTH_ONLY + 1>  last_uid;
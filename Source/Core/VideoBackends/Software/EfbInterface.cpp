@@ -3,9 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoCommon/BPMemory.h"
@@ -18,6 +21,7 @@ static u8 efb[EFB_WIDTH*EFB_HEIGHT * 6];
 namespace EfbInterface
 {
 u32 perf_values[PQ_NUM_MEMBERS];
+u32 perf_quad_pixels[PQ_NUM_MEMBERS];
 
 static inline u32 GetColorOffset(u16 x, u16 y)
 {
@@ -29,6 +33,13 @@ static inline u32 GetDepthOffset(u16 x, u16 y)
 	return (x + y * EFB_WIDTH) * 3 + DEPTH_BUFFER_START;
 }
 
+// Pixels are three bytes, the fourth one of a 32 bit store belongs to the next pixel, which can be
+// drawn by another thread at the same time
+static inline void StorePixel(u32 *dst, u32 val)
+{
+	memcpy(dst, &val, 3);
+}
+
 static void SetPixelAlphaOnly(u32 offset, u8 a)
 {
 	switch (bpmem.zcontrol.pixel_format)
@@ -44,7 +55,7 @@ static void SetPixelAlphaOnly(u32 offset, u8 a)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xffffffc0;
 		val |= (a32 >> 2) & 0x0000003f;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	default:
@@ -63,7 +74,7 @@ static void SetPixelColorOnly(u32 offset, u8 *rgb)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xff000000;
 		val |= src >> 8;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	case PEControl::RGBA6_Z24:
@@ -74,7 +85,7 @@ static void SetPixelColorOnly(u32 offset, u8 *rgb)
 		val |= (src >> 4) & 0x00000fc0; // blue
 		val |= (src >> 6) & 0x0003f000; // green
 		val |= (src >> 8) & 0x00fc0000; // red
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	case PEControl::RGB565_Z16:
@@ -84,7 +95,7 @@ static void SetPixelColorOnly(u32 offset, u8 *rgb)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xff000000;
 		val |= src >> 8;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	default:
@@ -103,7 +114,7 @@ static void SetPixelAlphaColor(u32 offset, u8 *color)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xff000000;
 		val |= src >> 8;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	case PEControl::RGBA6_Z24:
@@ -115,7 +126,7 @@ static void SetPixelAlphaColor(u32 offset, u8 *color)
 		val |= (src >> 4) & 0x00000fc0; // blue
 		val |= (src >> 6) & 0x0003f000; // green
 		val |= (src >> 8) & 0x00fc0000; // red
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	case PEControl::RGB565_Z16:
@@ -125,7 +136,7 @@ static void SetPixelAlphaColor(u32 offset, u8 *color)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xff000000;
 		val |= src >> 8;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	default:
@@ -180,7 +191,7 @@ static void SetPixelDepth(u32 offset, u32 depth)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xff000000;
 		val |= depth & 0x00ffffff;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	case PEControl::RGB565_Z16:
@@ -189,7 +200,7 @@ static void SetPixelDepth(u32 offset, u32 depth)
 		u32 *dst = (u32*)&efb[offset];
 		u32 val = *dst & 0xff000000;
 		val |= depth & 0x00ffffff;
-		*dst = val;
+		StorePixel(dst, val);
 	}
 	break;
 	default:
@@ -305,8 +316,43 @@ static u32 GetDestinationFactor(u8 *srcClr, u8 *dstClr, BlendMode::BlendFactor m
 	return 0;
 }
 
+#ifdef _M_X86
+FUNCTION_TARGET_SSE41
+static void BlendColorSSE41(u8 *srcClr, u8 *dstClr)
+{
+	u32 srcFactor = GetSourceFactor(srcClr, dstClr, bpmem.blendmode.srcfactor);
+	u32 dstFactor = GetDestinationFactor(srcClr, dstClr, bpmem.blendmode.dstfactor);
+	u32 src, dst;
+	memcpy(&src, srcClr, sizeof(src));
+	memcpy(&dst, dstClr, sizeof(dst));
+
+	// add MSB of factors to make their range 0 -> 256
+	__m128i sf = _mm_cvtepu8_epi16(_mm_cvtsi32_si128(srcFactor));
+	__m128i df = _mm_cvtepu8_epi16(_mm_cvtsi32_si128(dstFactor));
+	sf = _mm_add_epi16(sf, _mm_srli_epi16(sf, 7));
+	df = _mm_add_epi16(df, _mm_srli_epi16(df, 7));
+
+	// src * sf + dst * df for all four channels, at most 510 after the shift
+	const __m128i colors = _mm_unpacklo_epi16(_mm_cvtepu8_epi16(_mm_cvtsi32_si128(src)),
+		_mm_cvtepu8_epi16(_mm_cvtsi32_si128(dst)));
+	__m128i color = _mm_srli_epi32(_mm_madd_epi16(colors, _mm_unpacklo_epi16(sf, df)), 8);
+	color = _mm_packus_epi16(_mm_packs_epi32(color, color), color);
+
+	dst = _mm_cvtsi128_si32(color);
+	memcpy(dstClr, &dst, sizeof(dst));
+}
+#endif
+
 static void BlendColor(u8 *srcClr, u8 *dstClr)
 {
+#ifdef _M_X86
+	if (cpu_info.bSSE4_1)
+	{
+		BlendColorSSE41(srcClr, dstClr);
+		return;
+	}
+#endif
+
 	u32 srcFactor = GetSourceFactor(srcClr, dstClr, bpmem.blendmode.srcfactor);
 	u32 dstFactor = GetDestinationFactor(srcClr, dstClr, bpmem.blendmode.dstfactor);
 
@@ -384,6 +430,18 @@ static void LogicBlend(u32 srcClr, u32* dstClr, BlendMode::LogicOp op)
 
 static void SubtractBlend(u8 *srcClr, u8 *dstClr)
 {
+#ifdef _M_X86
+	if (cpu_info.bSSE4_1)
+	{
+		u32 src, dst;
+		memcpy(&src, srcClr, sizeof(src));
+		memcpy(&dst, dstClr, sizeof(dst));
+		dst = _mm_cvtsi128_si32(_mm_subs_epu8(_mm_cvtsi32_si128(dst), _mm_cvtsi32_si128(src)));
+		memcpy(dstClr, &dst, sizeof(dst));
+		return;
+	}
+#endif
+
 	for (int i = 0; i < 4; i++)
 	{
 		int c = (int)dstClr[i] - (int)srcClr[i];
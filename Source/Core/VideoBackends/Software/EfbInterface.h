@@ -61,16 +61,15 @@ void CopyToXFB(yuv422_packed* xfb_in_ram, u32 fbWidth, u32 fbHeight, const EFBRe
 void BypassXFB(u8* texture, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma);
 
 extern u32 perf_values[PQ_NUM_MEMBERS];
-inline void IncPerfCounterQuadCount(PerfQueryType type)
+extern u32 perf_quad_pixels[PQ_NUM_MEMBERS];
+inline void AddPerfCounterQuadCount(PerfQueryType type, u32 pixels)
 {
 	// NOTE: hardware doesn't process individual pixels but quads instead.
 	// Current software renderer architecture works on pixels though, so
 	// we have this "quad" hack here to only increment the registers on
-	// every fourth rendered pixel
-	static u32 quad[PQ_NUM_MEMBERS];
-	if (++quad[type] != 3)
-		return;
-	quad[type] = 0;
-	++perf_values[type];
+	// every third rendered pixel
+	perf_quad_pixels[type] += pixels;
+	perf_values[type] += perf_quad_pixels[type] / 3;
+	perf_quad_pixels[type] %= 3;
 }
 }
@@ -3,9 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <vector>
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/ThreadPool.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/NativeVertexFormat.h"
 #include "VideoBackends/Software/Rasterizer.h"
@@ -20,32 +26,118 @@ namespace Rasterizer
 {
 static constexpr int BLOCK_SIZE = 2;
 
-static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
+// Batches are binned into tiles of this size to draw them on several threads
+static constexpr int TILE_SIZE = 32;
+static constexpr int TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr int TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+// Everything DrawTriangleFrontFace sets up to draw the pixels of one triangle
+struct Triangle
+{
+	Slope ZSlope;
+	Slope WSlope;
+	Slope ColorSlopes[2][4];
+	Slope TexSlopes[8][3];
+
+	s32 vertex0X;
+	s32 vertex0Y;
+	float vertexOffsetX;
+	float vertexOffsetY;
+
+	// Half-edge constants and deltas in 28.4 fixed point
+	s32 C1, C2, C3;
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+
+	// Bounding rectangle after scissoring, minx and miny are aligned to blocks
+	s32 minx, maxx, miny, maxy;
+};
+
+// The per pixel state of one thread drawing triangles
+struct DrawUnit
+{
+	Tev tev;
+	// The left pixel of a pair, which starts every batch with the state of tev
+	Tev pairTev;
+	RasterBlock rasterBlock;
+	u32 rasterizedPixels;
+	u16 bbox[4];
+
+	// Where the last pixel this unit passed to the TEV comes in the order of a serial draw, and the
+	// TEV state right after the last pixel of the latest tile it finished
+	u64 lastKey;
+	u64 savedKey;
+	Tev savedTev;
+};
+
+// Zfreeze keeps the depth slope of an earlier triangle
+static Slope ZSlope;
 
 static s32 scissorLeft = 0;
 static s32 scissorTop = 0;
 static s32 scissorRight = 0;
 static s32 scissorBottom = 0;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+static Triangle s_triangle;
+static DrawUnit s_unit;
+
+static std::unique_ptr<Common::WorkerGroup> s_workers;
+static std::vector<std::unique_ptr<DrawUnit>> s_worker_units;
+static bool s_binning = false;
+static bool s_pairing = false;
+static std::vector<Triangle> s_triangles;
+static std::vector<u32> s_bins[TILES_X * TILES_Y];
+static std::vector<u32> s_used_tiles;
+static std::atomic<size_t> s_next_tile;
+
+static void InitUnit(DrawUnit *unit)
+{
+	unit->tev.Init();
+	unit->pairTev.Init();
+	unit->savedTev.Init();
+	unit->rasterizedPixels = 0;
+}
 
 void Init()
 {
-	tev.Init();
+	InitUnit(&s_unit);
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
 	ZSlope.dfdx = ZSlope.dfdy = 0.f;
 	ZSlope.f0 = 1.f;
+
+	// SWThreads counts the video thread too, 0 picks num_cores - 1, leaving a core for the CPU thread
+	int threads = g_ActiveConfig.iSWThreads;
+	if (threads <= 0)
+		threads = std::max(cpu_info.num_cores - 1, 1);
+	s_workers.reset();
+	s_worker_units.clear();
+	if (threads > 1)
+	{
+		s_workers = std::make_unique<Common::WorkerGroup>(threads - 1);
+		for (int i = 0; i < threads; i++)
+		{
+			s_worker_units.push_back(std::make_unique<DrawUnit>());
+			InitUnit(s_worker_units.back().get());
+			s_worker_units.back()->tev.BBoxCoords = s_worker_units.back()->bbox;
+			s_worker_units.back()->pairTev.BBoxCoords = s_worker_units.back()->bbox;
+		}
+		INFO_LOG(VIDEO, "Software rasterizer drawing on %d threads", threads);
+	}
+}
+
+void Shutdown()
+{
+	s_workers.reset();
+	s_worker_units.clear();
+	s_triangles.clear();
+	s_triangles.shrink_to_fit();
+	for (auto &bin : s_bins)
+	{
+		bin.clear();
+		bin.shrink_to_fit();
+	}
 }
 
 // Returns approximation of log2(f) in s28.4
@@ -94,32 +186,33 @@ void SetScissor()
 
 void SetTevReg(int reg, int comp, bool konst, s16 color)
 {
-	tev.SetRegColor(reg, comp, konst, color);
+	s_unit.tev.SetRegColor(reg, comp, konst, color);
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+// Sets up tev for a pixel, returns false if the early depth test rejects it
+static bool SetupPixel(const Triangle &tri, DrawUnit &unit, Tev &tev, s32 x, s32 y, s32 xi, s32 yi)
 {
-	INCSTAT(stats.thisFrame.rasterizedPixels);
+	unit.rasterizedPixels++;
 
-	float dx = vertexOffsetX + (float)(x - vertex0X);
-	float dy = vertexOffsetY + (float)(y - vertex0Y);
+	float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+	float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-	s32 z = (s32)MathUtil::Clamp<float>(ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
+	s32 z = (s32)MathUtil::Clamp<float>(tri.ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
 
 	if (!BoundingBox::active && bpmem.UseEarlyDepthTest() && g_ActiveConfig.bZComploc)
 	{
 		// TODO: Test if perf regs are incremented even if test is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+		tev.PerfPixelCounts[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
 		if (bpmem.zmode.testenable)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
-				return;
+				return false;
 		}
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+		tev.PerfPixelCounts[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
 	}
 
-	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+	RasterBlockPixel& pixel = unit.rasterBlock.Pixel[xi][yi];
 
 	tev.Position[0] = x;
 	tev.Position[1] = y;
@@ -130,7 +223,7 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	{
 		for (int comp = 0; comp < 4; comp++)
 		{
-			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+			u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
 			// clamp color value to 0
 			u16 mask = ~(color >> 8);
@@ -149,29 +242,75 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
 
 	for (unsigned int i = 0; i < bpmem.genMode.numindstages.Value(); i++)
 	{
-		tev.IndirectLod[i] = rasterBlock.IndirectLod[i];
-		tev.IndirectLinear[i] = rasterBlock.IndirectLinear[i];
+		tev.IndirectLod[i] = unit.rasterBlock.IndirectLod[i];
+		tev.IndirectLinear[i] = unit.rasterBlock.IndirectLinear[i];
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages.Value(); i++)
 	{
-		tev.TextureLod[i] = rasterBlock.TextureLod[i];
-		tev.TextureLinear[i] = rasterBlock.TextureLinear[i];
+		tev.TextureLod[i] = unit.rasterBlock.TextureLod[i];
+		tev.TextureLinear[i] = unit.rasterBlock.TextureLinear[i];
+	}
+
+	return true;
+}
+
+// Returns whether the pixel got to the TEV
+static bool Draw(const Triangle &tri, DrawUnit &unit, s32 x, s32 y, s32 xi, s32 yi)
+{
+	if (!SetupPixel(tri, unit, unit.tev, x, y, xi, yi))
+		return false;
+
+	unit.tev.Draw();
+	return true;
+}
+
+// Draws the pixels of row yi of a block, two at once if they don't depend on each other. The TEV
+// state is the one of the right pixel afterwards, like after drawing them one after the other.
+static void DrawBlockRow(const Triangle &tri, DrawUnit &unit, u64 blockKey, s32 x, s32 y, s32 yi)
+{
+	static_assert(BLOCK_SIZE == 2, "A row of a block has to be a pair of pixels");
+
+	if (!s_pairing)
+	{
+		for (s32 xi = 0; xi < BLOCK_SIZE; xi++)
+		{
+			if (Draw(tri, unit, x + xi, y, xi, yi))
+				unit.lastKey = blockKey | (yi << 1) | xi;
+		}
+		return;
 	}
 
-	tev.Draw();
+	const bool left = SetupPixel(tri, unit, unit.pairTev, x, y, 0, yi);
+	const bool right = SetupPixel(tri, unit, unit.tev, x + 1, y, 1, yi);
+	if (left && right)
+	{
+		unit.tev.DrawPair(unit.pairTev);
+		unit.lastKey = blockKey | (yi << 1) | 1;
+	}
+	else if (left)
+	{
+		unit.pairTev.Draw();
+		unit.tev.CopyState(unit.pairTev);
+		unit.lastKey = blockKey | (yi << 1);
+	}
+	else if (right)
+	{
+		unit.tev.Draw();
+		unit.lastKey = blockKey | (yi << 1) | 1;
+	}
 }
 
-static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
+static void InitTriangle(Triangle *tri, float X1, float Y1, s32 xi, s32 yi)
 {
-	vertex0X = xi;
-	vertex0Y = yi;
+	tri->vertex0X = xi;
+	tri->vertex0Y = yi;
 
 	// adjust a little less than 0.5
 	const float adjust = 0.495f;
 
-	vertexOffsetX = ((float)xi - X1) + adjust;
-	vertexOffsetY = ((float)yi - Y1) + adjust;
+	tri->vertexOffsetX = ((float)xi - X1) + adjust;
+	tri->vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, float DX12, float DY12, float DY31)
@@ -186,7 +325,7 @@ static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, fl
 	slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock &rasterBlock, s32* lodp, bool* linear, u32 texmap, u32 texcoord)
 {
 	const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	const u8 subTexmap = texmap & 3;
@@ -199,17 +338,17 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
 		sDelta = fabsf(uv0[0] - uv1[0]);
 		tDelta = fabsf(uv0[1] - uv1[1]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+		const float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
 		sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
 		tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -234,7 +373,7 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	*lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(const Triangle &tri, RasterBlock &rasterBlock, s32 blockX, s32 blockY)
 {
 	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
 	{
@@ -242,10 +381,10 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		{
 			RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-			float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-			float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+			float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+			float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-			float invW = 1.0f / WSlope.GetValue(dx, dy);
+			float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
 			pixel.InvW = invW;
 
 			// tex coords
@@ -254,13 +393,13 @@ static void BuildBlock(s32 blockX, s32 blockY)
 				float projection = invW;
 				if (xfmem.texMtxInfo[i].projection)
 				{
-					float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+					float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
 					if (q != 0.0f)
 						projection = invW / q;
 				}
 
-				pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-				pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+				pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+				pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
 			}
 		}
 	}
@@ -273,7 +412,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -285,7 +424,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
 		}
 	}
 }
@@ -302,8 +441,219 @@ static inline void PrepareBlock(s32 blockX, s32 blockY)
 	{
 		x = blockX;
 		y = blockY;
-		BuildBlock(x, y);
+		BuildBlock(s_triangle, s_unit.rasterBlock, x, y);
+	}
+}
+
+// Draws the blocks of tri that start in [x0, x1) x [y0, y1), which have to be aligned to blocks
+static void DrawBlocks(const Triangle &tri, DrawUnit &unit, u64 key, s32 x0, s32 x1, s32 y0, s32 y1)
+{
+	const s32 C1 = tri.C1, C2 = tri.C2, C3 = tri.C3;
+	const s32 DX12 = tri.DX12, DX23 = tri.DX23, DX31 = tri.DX31;
+	const s32 DY12 = tri.DY12, DY23 = tri.DY23, DY31 = tri.DY31;
+
+	// Fixed-pos32 deltas
+	const s32 FDX12 = DX12 * 16;
+	const s32 FDX23 = DX23 * 16;
+	const s32 FDX31 = DX31 * 16;
+
+	const s32 FDY12 = DY12 * 16;
+	const s32 FDY23 = DY23 * 16;
+	const s32 FDY31 = DY31 * 16;
+
+	// Loop through blocks
+	for (s32 y = y0; y < y1; y += BLOCK_SIZE)
+	{
+		for (s32 x = x0; x < x1; x += BLOCK_SIZE)
+		{
+			// Corners of block
+			s32 bx0 = x << 4;
+			s32 bx1 = (x + BLOCK_SIZE - 1) << 4;
+			s32 by0 = y << 4;
+			s32 by1 = (y + BLOCK_SIZE - 1) << 4;
+
+			// Evaluate half-space functions
+			bool a00 = C1 + DX12 * by0 - DY12 * bx0 > 0;
+			bool a10 = C1 + DX12 * by0 - DY12 * bx1 > 0;
+			bool a01 = C1 + DX12 * by1 - DY12 * bx0 > 0;
+			bool a11 = C1 + DX12 * by1 - DY12 * bx1 > 0;
+			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+			bool b00 = C2 + DX23 * by0 - DY23 * bx0 > 0;
+			bool b10 = C2 + DX23 * by0 - DY23 * bx1 > 0;
+			bool b01 = C2 + DX23 * by1 - DY23 * bx0 > 0;
+			bool b11 = C2 + DX23 * by1 - DY23 * bx1 > 0;
+			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+			bool c00 = C3 + DX31 * by0 - DY31 * bx0 > 0;
+			bool c10 = C3 + DX31 * by0 - DY31 * bx1 > 0;
+			bool c01 = C3 + DX31 * by1 - DY31 * bx0 > 0;
+			bool c11 = C3 + DX31 * by1 - DY31 * bx1 > 0;
+			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+			// Skip block when outside an edge
+			if (a == 0x0 || b == 0x0 || c == 0x0)
+				continue;
+
+			BuildBlock(tri, unit.rasterBlock, x, y);
+
+			const u64 blockKey = key | (static_cast<u64>(y * EFB_WIDTH + x) << 2);
+
+			// Accept whole block when totally covered
+			if (a == 0xF && b == 0xF && c == 0xF)
+			{
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+					DrawBlockRow(tri, unit, blockKey, x, y + iy, iy);
+			}
+			else // Partially covered block
+			{
+				s32 CY1 = C1 + DX12 * by0 - DY12 * bx0;
+				s32 CY2 = C2 + DX23 * by0 - DY23 * bx0;
+				s32 CY3 = C3 + DX31 * by0 - DY31 * bx0;
+
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+				{
+					s32 CX1 = CY1;
+					s32 CX2 = CY2;
+					s32 CX3 = CY3;
+
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+					{
+						if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+						{
+							if (Draw(tri, unit, x + ix, y + iy, ix, iy))
+								unit.lastKey = blockKey | (iy << 1) | ix;
+						}
+
+						CX1 -= FDY12;
+						CX2 -= FDY23;
+						CX3 -= FDY31;
+					}
+
+					CY1 += FDX12;
+					CY2 += FDX23;
+					CY3 += FDX31;
+				}
+			}
+		}
+	}
+}
+
+static void BinTriangle(const Triangle &tri)
+{
+	const u32 index = static_cast<u32>(s_triangles.size());
+	s_triangles.push_back(tri);
+
+	for (s32 ty = tri.miny / TILE_SIZE; ty <= (tri.maxy - 1) / TILE_SIZE; ty++)
+	{
+		for (s32 tx = tri.minx / TILE_SIZE; tx <= (tri.maxx - 1) / TILE_SIZE; tx++)
+		{
+			std::vector<u32> &bin = s_bins[ty * TILES_X + tx];
+			if (bin.empty())
+				s_used_tiles.push_back(ty * TILES_X + tx);
+			bin.push_back(index);
+		}
+	}
+}
+
+// Draws every triangle of a tile in the order they were submitted, so each pixel sees the same
+// sequence of EFB reads and writes as with a serial draw
+static void DrawTile(DrawUnit &unit, u32 tile)
+{
+	const s32 tx0 = (tile % TILES_X) * TILE_SIZE;
+	const s32 ty0 = (tile / TILES_X) * TILE_SIZE;
+
+	unit.lastKey = 0;
+	for (u32 index : s_bins[tile])
+	{
+		const Triangle &tri = s_triangles[index];
+		DrawBlocks(tri, unit, static_cast<u64>(index + 1) << 32,
+			std::max(tri.minx, tx0), std::min(tri.maxx, tx0 + TILE_SIZE),
+			std::max(tri.miny, ty0), std::min(tri.maxy, ty0 + TILE_SIZE));
+	}
+
+	if (unit.lastKey > unit.savedKey)
+	{
+		unit.savedKey = unit.lastKey;
+		unit.savedTev.CopyState(unit.tev);
+	}
+}
+
+void BeginBatch()
+{
+	// Pixels of different tiles are drawn in any order, that only works if they don't depend on
+	// each other through the TEV registers. Bounding box mode and the debug dumps stay serial.
+	const bool orderIndependent = !BoundingBox::active && !g_ActiveConfig.bDumpTevStages &&
+		!g_ActiveConfig.bDumpTevTextureFetches && !Tev::ReadsPreviousPixel();
+	s_binning = s_workers && orderIndependent;
+
+	// The same goes for the two pixels in a row of a block, whose combiners run at once then. The
+	// registers such pixels read are the same for all of them, so the state is copied once here.
+	s_pairing = cpu_info.bSSE4_1 && orderIndependent;
+	if (s_pairing)
+		s_unit.pairTev.CopyState(s_unit.tev);
+}
+
+void EndBatch()
+{
+	if (!s_triangles.empty())
+	{
+		// Biggest bins first, so that the threads run out of work at about the same time
+		std::sort(s_used_tiles.begin(), s_used_tiles.end(), [](u32 a, u32 b) {
+			return s_bins[a].size() > s_bins[b].size();
+		});
+
+		const size_t units = std::min(s_worker_units.size(), s_used_tiles.size());
+		for (size_t i = 0; i < units; i++)
+		{
+			DrawUnit &unit = *s_worker_units[i];
+			unit.tev.CopyState(s_unit.tev);
+			unit.pairTev.CopyState(s_unit.tev);
+			memcpy(unit.bbox, BoundingBox::coords, sizeof(unit.bbox));
+			unit.savedKey = 0;
+		}
+
+		s_next_tile.store(0);
+		s_workers->Run(units, [](size_t i) {
+			DrawUnit &unit = *s_worker_units[i];
+			size_t tile;
+			while ((tile = s_next_tile.fetch_add(1)) < s_used_tiles.size())
+				DrawTile(unit, s_used_tiles[tile]);
+		});
+
+		// Carry on with the state of the pixel a serial draw would have finished with
+		const DrawUnit *last = nullptr;
+		for (size_t i = 0; i < units; i++)
+		{
+			DrawUnit &unit = *s_worker_units[i];
+			if (unit.savedKey && (!last || unit.savedKey > last->savedKey))
+				last = &unit;
+
+			BoundingBox::coords[BoundingBox::LEFT] = std::min(unit.bbox[BoundingBox::LEFT], BoundingBox::coords[BoundingBox::LEFT]);
+			BoundingBox::coords[BoundingBox::RIGHT] = std::max(unit.bbox[BoundingBox::RIGHT], BoundingBox::coords[BoundingBox::RIGHT]);
+			BoundingBox::coords[BoundingBox::TOP] = std::min(unit.bbox[BoundingBox::TOP], BoundingBox::coords[BoundingBox::TOP]);
+			BoundingBox::coords[BoundingBox::BOTTOM] = std::max(unit.bbox[BoundingBox::BOTTOM], BoundingBox::coords[BoundingBox::BOTTOM]);
+
+			unit.tev.FlushCounters();
+			unit.pairTev.FlushCounters();
+			ADDSTAT(stats.thisFrame.rasterizedPixels, unit.rasterizedPixels);
+			unit.rasterizedPixels = 0;
+		}
+		if (last)
+			s_unit.tev.CopyState(last->savedTev);
+
+		for (u32 tile : s_used_tiles)
+			s_bins[tile].clear();
+		s_used_tiles.clear();
+		s_triangles.clear();
 	}
+
+	s_binning = false;
+	s_pairing = false;
+	s_unit.tev.FlushCounters();
+	s_unit.pairTev.FlushCounters();
+	ADDSTAT(stats.thisFrame.rasterizedPixels, s_unit.rasterizedPixels);
+	s_unit.rasterizedPixels = 0;
 }
 
 void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
@@ -355,6 +705,9 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	if (minx >= maxx || miny >= maxy)
 		return;
 
+	// Binned triangles are copied, so set up the serial one in place
+	Triangle &tri = s_triangle;
+
 	// Setup slopes
 	float fltx1 = v0->screenPosition.x;
 	float flty1 = v0->screenPosition.y;
@@ -363,10 +716,10 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	float fltdy12 = flty1 - v1->screenPosition.y;
 	float fltdy31 = v2->screenPosition.y - flty1;
 
-	InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+	InitTriangle(&tri, fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
 
 	float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w};
-	InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	InitSlope(&tri.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
 	// TODO: The zfreeze emulation is not quite correct, yet!
 	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
@@ -374,17 +727,18 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
 	if (!bpmem.genMode.zfreeze || !g_ActiveConfig.bZFreeze)
 		InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	tri.ZSlope = ZSlope;
 
 	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
 	{
 		for (int comp = 0; comp < 4; comp++)
-			InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
+			InitSlope(&tri.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
 	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
 	{
 		for (int comp = 0; comp < 3; comp++)
-			InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+			InitSlope(&tri.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
 	// Half-edge constants
@@ -397,89 +751,28 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) C2++;
 	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) C3++;
 
+	tri.C1 = C1;
+	tri.C2 = C2;
+	tri.C3 = C3;
+	tri.DX12 = DX12;
+	tri.DX23 = DX23;
+	tri.DX31 = DX31;
+	tri.DY12 = DY12;
+	tri.DY23 = DY23;
+	tri.DY31 = DY31;
+
 	if (!BoundingBox::active)
 	{
 		// Start in corner of 8x8 block
-		minx &= ~(BLOCK_SIZE - 1);
-		miny &= ~(BLOCK_SIZE - 1);
-		// Loop through blocks
-		for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
-		{
-			for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
-			{
-				// Corners of block
-				s32 x0 = x << 4;
-				s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-				s32 y0 = y << 4;
-				s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-				// Evaluate half-space functions
-				bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-				bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-				bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-				bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-				int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-				bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-				bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-				bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-				bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-				int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-				bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-				bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-				bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-				bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-				int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-				// Skip block when outside an edge
-				if (a == 0x0 || b == 0x0 || c == 0x0)
-					continue;
-
-				BuildBlock(x, y);
-
-				// Accept whole block when totally covered
-				if (a == 0xF && b == 0xF && c == 0xF)
-				{
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-					{
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							Draw(x + ix, y + iy, ix, iy);
-						}
-					}
-				}
-				else // Partially covered block
-				{
-					s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-					s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-					s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
-
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-					{
-						s32 CX1 = CY1;
-						s32 CX2 = CY2;
-						s32 CX3 = CY3;
-
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-							{
-								Draw(x + ix, y + iy, ix, iy);
-							}
-
-							CX1 -= FDY12;
-							CX2 -= FDY23;
-							CX3 -= FDY31;
-						}
-
-						CY1 += FDX12;
-						CY2 += FDX23;
-						CY3 += FDX31;
-					}
-				}
-			}
-		}
+		tri.minx = minx & ~(BLOCK_SIZE - 1);
+		tri.miny = miny & ~(BLOCK_SIZE - 1);
+		tri.maxx = maxx;
+		tri.maxy = maxy;
+
+		if (s_binning)
+			BinTriangle(tri);
+		else
+			DrawBlocks(tri, s_unit, 0, tri.minx, tri.maxx, tri.miny, tri.maxy);
 	}
 	else
 	{
@@ -533,7 +826,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(tri, s_unit, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (y >= BoundingBox::coords[BoundingBox::TOP])
 						break;
@@ -573,7 +866,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				if (CY1 > 0 && CY2 > 0 && CY3 > 0)
 				{
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(tri, s_unit, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (x >= BoundingBox::coords[BoundingBox::LEFT])
 						break;
@@ -613,7 +906,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(tri, s_unit, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
 						break;
@@ -654,7 +947,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(tri, s_unit, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (x <= BoundingBox::coords[BoundingBox::RIGHT])
 						break;
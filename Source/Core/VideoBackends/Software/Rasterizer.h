@@ -11,6 +11,12 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
+
+// Triangles drawn between these two calls share the same state. When the TEV setup allows it they
+// are binned into screen tiles and only drawn in EndBatch, with the tiles spread across threads.
+void BeginBatch();
+void EndBatch();
 
 void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2);
 
@@ -24,7 +30,7 @@ struct Slope
 	float dfdy;
 	float f0;
 
-	float GetValue(float dx, float dy)
+	float GetValue(float dx, float dy) const
 	{
 		return f0 + (dfdx * dx) + (dfdy * dy);
 	}
@@ -98,6 +98,8 @@ void SWVertexLoader::vFlush(bool useDstAlpha)
 		Rasterizer::SetTevReg(i, Tev::ALP_C, true, kcolors[i * 4 + 3]);
 	}
 
+	Rasterizer::BeginBatch();
+
 	for (u32 i = 0; i < IndexGenerator::GetIndexLen(); i++)
 	{
 		u16 index = LocalIBuffer[i];
@@ -134,6 +136,8 @@ void SWVertexLoader::vFlush(bool useDstAlpha)
 		INCSTAT(stats.thisFrame.numVerticesLoaded)
 	}
 
+	Rasterizer::EndBatch();
+
 	DebugUtil::OnObjectEnd();
 }
 
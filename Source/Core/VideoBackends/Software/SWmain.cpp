@@ -222,6 +222,7 @@ void VideoSoftware::Shutdown()
 	// Do our OSD callbacks
 	OSD::DoCallbacks(OSD::CallbackType::Shutdown);
 
+	Rasterizer::Shutdown();
 	SWOGLWindow::Shutdown();
 }
 
@@ -3,9 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <cmath>
+#include <cstring>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Tev.h"
@@ -25,6 +28,11 @@
 
 void Tev::Init()
 {
+	memset(PerfPixelCounts, 0, sizeof(PerfPixelCounts));
+	PixelsIn = 0;
+	PixelsOut = 0;
+	BBoxCoords = BoundingBox::coords;
+
 	FixedConstants[0] = 0;
 	FixedConstants[1] = 32;
 	FixedConstants[2] = 64;
@@ -124,6 +132,10 @@ void Tev::Init()
 	m_ScaleRShiftLUT[1] = 0;
 	m_ScaleRShiftLUT[2] = 0;
 	m_ScaleRShiftLUT[3] = 1;
+
+#ifdef _M_X86
+	InitCombinerConstants();
+#endif
 }
 
 static inline s16 Clamp255(s16 in)
@@ -391,6 +403,250 @@ static inline s32 WrapIndirectCoord(s32 coord, int wrapMode)
 	}
 }
 
+void Tev::DrawCombiners(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac)
+{
+	InputRegType inputs[4];
+	for (int i = 0; i < 3; i++)
+	{
+		inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
+		inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
+		inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
+		inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+	}
+	inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
+	inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
+	inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
+	inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+
+	if (cc.bias != 3)
+		DrawColorRegular(cc, inputs);
+	else
+		DrawColorCompare(cc, inputs);
+
+	if (cc.clamp)
+	{
+		Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+		Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+		Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+	}
+	else
+	{
+		Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+		Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+		Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+	}
+
+	if (ac.bias != 3)
+		DrawAlphaRegular(ac, inputs);
+	else
+		DrawAlphaCompare(ac, inputs);
+
+	if (ac.clamp)
+		Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+	else
+		Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+}
+
+#ifdef _M_X86
+// What the vector combiners need for one of the 64 modes in bits 16 to 21 of a combiner (bias, op,
+// clamp and shift), with only the lanes of that combiner filled in and the others zero, so that
+// the color and alpha entries of a stage can be or'ed together
+struct CombinerConstants
+{
+	alignas(16) s32 scale[4];
+	alignas(16) s32 round[4];
+	alignas(16) s32 negateBefore[4];
+	alignas(16) s32 negateAfter[4];
+	alignas(16) s32 bias[4];
+	alignas(16) s32 halve[4];
+	alignas(16) s16 clampMin[8];
+	alignas(16) s16 clampMax[8];
+};
+
+static CombinerConstants s_colorConstants[64];
+static CombinerConstants s_alphaConstants[64];
+
+void Tev::InitCombinerConstants()
+{
+	memset(s_colorConstants, 0, sizeof(s_colorConstants));
+	memset(s_alphaConstants, 0, sizeof(s_alphaConstants));
+
+	for (u32 mode = 0; mode < 64; mode++)
+	{
+		const u32 bias = mode & 3;
+		const u32 op = (mode >> 2) & 1;
+		const u32 clamp = (mode >> 3) & 1;
+		const u32 shift = mode >> 4;
+
+		for (int i = ALP_C; i <= RED_C; i++)
+		{
+			CombinerConstants &constants = (i == ALP_C) ? s_alphaConstants[mode] : s_colorConstants[mode];
+			constants.scale[i] = 1 << m_ScaleLShiftLUT[shift];
+			constants.bias[i] = m_BiasLUT[bias];
+			constants.halve[i] = m_ScaleRShiftLUT[shift] ? -1 : 0;
+			constants.clampMin[i] = clamp ? 0 : -1024;
+			constants.clampMax[i] = clamp ? 255 : 1023;
+
+			// Alpha is rounded for the opposite shift and negated before the division by 256
+			if (i == ALP_C)
+			{
+				constants.round[i] = (shift != 3) ? 0 : op ? 127 : 128;
+				constants.negateBefore[i] = op ? -1 : 0;
+			}
+			else
+			{
+				constants.round[i] = (shift == 3) ? 0 : op ? 127 : 128;
+				constants.negateAfter[i] = op ? -1 : 0;
+			}
+		}
+	}
+}
+
+FUNCTION_TARGET_SSE41
+static inline __m128i LoadConstants(const s32 *color, const s32 *alpha)
+{
+	return _mm_or_si128(_mm_load_si128((const __m128i*)color), _mm_load_si128((const __m128i*)alpha));
+}
+
+// The constants of both combiners of a stage, except for the clamping
+struct StageConstants
+{
+	__m128i scale;
+	__m128i round;
+	__m128i negateBefore;
+	__m128i negateAfter;
+	__m128i bias;
+	__m128i halve;
+};
+
+FUNCTION_TARGET_SSE41
+static inline StageConstants LoadStageConstants(const CombinerConstants &cs, const CombinerConstants &as)
+{
+	StageConstants constants;
+	constants.scale = LoadConstants(cs.scale, as.scale);
+	constants.round = LoadConstants(cs.round, as.round);
+	constants.negateBefore = LoadConstants(cs.negateBefore, as.negateBefore);
+	constants.negateAfter = LoadConstants(cs.negateAfter, as.negateAfter);
+	constants.bias = LoadConstants(cs.bias, as.bias);
+	constants.halve = LoadConstants(cs.halve, as.halve);
+	return constants;
+}
+
+// The results of four lanes truncated to 16 bits, from a and b and the weights 256 - c and c
+// interleaved, and d extended to 32 bits
+FUNCTION_TARGET_SSE41
+static inline __m128i CombineLanes(__m128i ab, __m128i weights, __m128i d, const StageConstants &constants)
+{
+	// a * (256 - c) + b * c
+	__m128i temp = _mm_madd_epi16(ab, weights);
+	temp = _mm_add_epi32(_mm_mullo_epi32(temp, constants.scale), constants.round);
+
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, constants.negateBefore), constants.negateBefore);
+	temp = _mm_srai_epi32(temp, 8);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, constants.negateAfter), constants.negateAfter);
+
+	__m128i result = _mm_add_epi32(d, constants.bias);
+	result = _mm_add_epi32(_mm_mullo_epi32(result, constants.scale), temp);
+	result = _mm_blendv_epi8(result, _mm_srai_epi32(result, 1), constants.halve);
+
+	// Truncate to 16 bits like the register store, the clamping comes after that
+	return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+}
+
+void Tev::GatherInputs(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac, s16 *a, s16 *b, s16 *c, s16 *d)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		a[BLU_C + i] = *m_ColorInputLUT[cc.a][i];
+		b[BLU_C + i] = *m_ColorInputLUT[cc.b][i];
+		c[BLU_C + i] = *m_ColorInputLUT[cc.c][i];
+		d[BLU_C + i] = *m_ColorInputLUT[cc.d][i];
+	}
+	a[ALP_C] = *m_AlphaInputLUT[ac.a];
+	b[ALP_C] = *m_AlphaInputLUT[ac.b];
+	c[ALP_C] = *m_AlphaInputLUT[ac.c];
+	d[ALP_C] = *m_AlphaInputLUT[ac.d];
+}
+
+void Tev::StoreOutputs(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac, const s16 *out)
+{
+	Reg[cc.dest][BLU_C] = out[BLU_C];
+	Reg[cc.dest][GRN_C] = out[GRN_C];
+	Reg[cc.dest][RED_C] = out[RED_C];
+	Reg[ac.dest][ALP_C] = out[ALP_C];
+}
+
+// Does the same as DrawCombiners for a stage where neither combiner is a compare, with the alpha
+// channel in the first lane and blue, green and red in the others, like in the registers.
+FUNCTION_TARGET_SSE41
+void Tev::DrawRegularSSE41(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac)
+{
+	alignas(8) s16 a[4], b[4], c[4], d[4];
+	GatherInputs(cc, ac, a, b, c, d);
+
+	const CombinerConstants &cs = s_colorConstants[(cc.hex >> 16) & 63];
+	const CombinerConstants &as = s_alphaConstants[(ac.hex >> 16) & 63];
+
+	// a, b and c are 8 bit unsigned inputs and d is 11 bit signed, as in InputRegType
+	const __m128i byteMask = _mm_set1_epi16(0xFF);
+	const __m128i va = _mm_and_si128(_mm_loadl_epi64((const __m128i*)a), byteMask);
+	const __m128i vb = _mm_and_si128(_mm_loadl_epi64((const __m128i*)b), byteMask);
+	__m128i vc = _mm_and_si128(_mm_loadl_epi64((const __m128i*)c), byteMask);
+	const __m128i vd = _mm_srai_epi16(_mm_slli_epi16(_mm_loadl_epi64((const __m128i*)d), 5), 5);
+
+	vc = _mm_add_epi16(vc, _mm_srli_epi16(vc, 7));
+	const __m128i weights = _mm_unpacklo_epi16(_mm_sub_epi16(_mm_set1_epi16(256), vc), vc);
+	const __m128i result = CombineLanes(_mm_unpacklo_epi16(va, vb), weights, _mm_cvtepi16_epi32(vd),
+		LoadStageConstants(cs, as));
+
+	__m128i output = _mm_packs_epi32(result, result);
+	output = _mm_max_epi16(output, LoadConstants((const s32*)cs.clampMin, (const s32*)as.clampMin));
+	output = _mm_min_epi16(output, LoadConstants((const s32*)cs.clampMax, (const s32*)as.clampMax));
+
+	alignas(8) s16 out[4];
+	_mm_storel_epi64((__m128i*)out, output);
+	StoreOutputs(cc, ac, out);
+}
+
+// The same for first and this pixel at once, with the channels of first in the lower four lanes
+FUNCTION_TARGET_SSE41
+void Tev::DrawRegularPairSSE41(Tev &first, TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac)
+{
+	alignas(16) s16 a[8], b[8], c[8], d[8];
+	first.GatherInputs(cc, ac, a, b, c, d);
+	GatherInputs(cc, ac, a + 4, b + 4, c + 4, d + 4);
+
+	const CombinerConstants &cs = s_colorConstants[(cc.hex >> 16) & 63];
+	const CombinerConstants &as = s_alphaConstants[(ac.hex >> 16) & 63];
+	const StageConstants constants = LoadStageConstants(cs, as);
+
+	const __m128i byteMask = _mm_set1_epi16(0xFF);
+	const __m128i va = _mm_and_si128(_mm_load_si128((const __m128i*)a), byteMask);
+	const __m128i vb = _mm_and_si128(_mm_load_si128((const __m128i*)b), byteMask);
+	__m128i vc = _mm_and_si128(_mm_load_si128((const __m128i*)c), byteMask);
+	const __m128i vd = _mm_srai_epi16(_mm_slli_epi16(_mm_load_si128((const __m128i*)d), 5), 5);
+
+	vc = _mm_add_epi16(vc, _mm_srli_epi16(vc, 7));
+	const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), vc);
+	const __m128i low = CombineLanes(_mm_unpacklo_epi16(va, vb), _mm_unpacklo_epi16(inverse, vc),
+		_mm_cvtepi16_epi32(vd), constants);
+	const __m128i high = CombineLanes(_mm_unpackhi_epi16(va, vb), _mm_unpackhi_epi16(inverse, vc),
+		_mm_cvtepi16_epi32(_mm_srli_si128(vd, 8)), constants);
+
+	// The clamp constants only fill the lower four lanes
+	const __m128i clampMin = LoadConstants((const s32*)cs.clampMin, (const s32*)as.clampMin);
+	const __m128i clampMax = LoadConstants((const s32*)cs.clampMax, (const s32*)as.clampMax);
+	__m128i output = _mm_packs_epi32(low, high);
+	output = _mm_max_epi16(output, _mm_unpacklo_epi64(clampMin, clampMin));
+	output = _mm_min_epi16(output, _mm_unpacklo_epi64(clampMax, clampMax));
+
+	alignas(16) s16 out[8];
+	_mm_store_si128((__m128i*)out, output);
+	first.StoreOutputs(cc, ac, out);
+	StoreOutputs(cc, ac, out + 4);
+}
+#endif
+
 void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
 {
 	TevStageIndirect &indirect = bpmem.tevind[stageNum];
@@ -506,13 +762,8 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
 	}
 }
 
-void Tev::Draw()
+void Tev::SampleIndirect()
 {
-	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
-	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
-
-	INCSTAT(stats.thisFrame.tevPixelsIn);
-
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages.Value(); stageNum++)
 	{
 		int stageNum2 = stageNum >> 1;
@@ -541,97 +792,77 @@ void Tev::Draw()
 		}
 #endif
 	}
+}
 
-	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
-	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum & 1;
-		TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
-		TevKSel &kSel = bpmem.tevksel[stageNum2];
-
-		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
-		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+void Tev::SetupStage(unsigned int stageNum)
+{
+	int stageNum2 = stageNum >> 1;
+	int stageOdd = stageNum & 1;
+	TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
+	TevKSel &kSel = bpmem.tevksel[stageNum2];
+	TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
 
-		int texcoordSel = order.getTexCoord(stageOdd);
-		int texmap = order.getTexMap(stageOdd);
+	int texcoordSel = order.getTexCoord(stageOdd);
+	int texmap = order.getTexMap(stageOdd);
 
-		Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+	Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
 
-		// sample texture
-		if (order.getEnable(stageOdd))
-		{
-			// RGBA
-			u8 texel[4];
+	// sample texture
+	if (order.getEnable(stageOdd))
+	{
+		// RGBA
+		u8 texel[4];
 
-			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+		TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
 
 #if ALLOW_TEV_DUMPS
-			if (g_ActiveConfig.bDumpTevTextureFetches)
-				DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
+		if (g_ActiveConfig.bDumpTevTextureFetches)
+			DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
 #endif
 
-			int swaptable = ac.tswap * 2;
+		int swaptable = ac.tswap * 2;
 
-			TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
-		}
+		TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
+		TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
+		swaptable++;
+		TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
+		TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+	}
 
-		// set konst for this stage
-		int kc = kSel.getKC(stageOdd);
-		int ka = kSel.getKA(stageOdd);
-		StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-		StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-		StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-		StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+	// set konst for this stage
+	int kc = kSel.getKC(stageOdd);
+	int ka = kSel.getKA(stageOdd);
+	StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
+	StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
+	StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
+	StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
 
-		// set color
-		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+	// set color
+	SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+}
 
-		// combine inputs
-		InputRegType inputs[4];
-		for (int i = 0; i < 3; i++)
-		{
-			inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-			inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-			inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-			inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
-		}
-		inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-		inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-		inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-		inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+void Tev::Draw()
+{
+	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
+	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-		if (cc.bias != 3)
-			DrawColorRegular(cc, inputs);
-		else
-			DrawColorCompare(cc, inputs);
+	PixelsIn++;
 
-		if (cc.clamp)
-		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-		}
-		else
-		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-		}
+	SampleIndirect();
 
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac, inputs);
-		else
-			DrawAlphaCompare(ac, inputs);
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
+	{
+		SetupStage(stageNum);
 
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+		// combine inputs
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+#ifdef _M_X86
+		if (cpu_info.bSSE4_1 && cc.bias != 3 && ac.bias != 3)
+			DrawRegularSSE41(cc, ac);
 		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+#endif
+			DrawCombiners(cc, ac);
 
 #if ALLOW_TEV_DUMPS
 		if (g_ActiveConfig.bDumpTevStages)
@@ -642,6 +873,46 @@ void Tev::Draw()
 #endif
 	}
 
+	WriteOutput();
+}
+
+void Tev::DrawPair(Tev &first)
+{
+	_assert_(first.Position[0] >= 0 && first.Position[0] < EFB_WIDTH);
+	_assert_(first.Position[1] >= 0 && first.Position[1] < EFB_HEIGHT);
+	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
+	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+
+	first.PixelsIn++;
+	PixelsIn++;
+
+	first.SampleIndirect();
+	SampleIndirect();
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
+	{
+		first.SetupStage(stageNum);
+		SetupStage(stageNum);
+
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+#ifdef _M_X86
+		if (cpu_info.bSSE4_1 && cc.bias != 3 && ac.bias != 3)
+		{
+			DrawRegularPairSSE41(first, cc, ac);
+			continue;
+		}
+#endif
+		first.DrawCombiners(cc, ac);
+		DrawCombiners(cc, ac);
+	}
+
+	first.WriteOutput();
+	WriteOutput();
+}
+
+void Tev::WriteOutput()
+{
 	// convert to 8 bits per component
 	// the results of the last tev stage are put onto the screen,
 	// regardless of the used destination register - TODO: Verify!
@@ -763,19 +1034,19 @@ void Tev::Draw()
 		if (late_ztest && bpmem.zmode.testenable)
 		{
 			// TODO: Check against hw if these values get incremented even if depth testing is disabled
-			EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+			PerfPixelCounts[PQ_ZCOMP_INPUT]++;
 
 			if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
 				return;
 
-			EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+			PerfPixelCounts[PQ_ZCOMP_OUTPUT]++;
 		}
 	}
 	// branchless bounding box update
-	BoundingBox::coords[BoundingBox::LEFT] = std::min((u16)Position[0], BoundingBox::coords[BoundingBox::LEFT]);
-	BoundingBox::coords[BoundingBox::RIGHT] = std::max((u16)Position[0], BoundingBox::coords[BoundingBox::RIGHT]);
-	BoundingBox::coords[BoundingBox::TOP] = std::min((u16)Position[1], BoundingBox::coords[BoundingBox::TOP]);
-	BoundingBox::coords[BoundingBox::BOTTOM] = std::max((u16)Position[1], BoundingBox::coords[BoundingBox::BOTTOM]);
+	BBoxCoords[BoundingBox::LEFT] = std::min((u16)Position[0], BBoxCoords[BoundingBox::LEFT]);
+	BBoxCoords[BoundingBox::RIGHT] = std::max((u16)Position[0], BBoxCoords[BoundingBox::RIGHT]);
+	BBoxCoords[BoundingBox::TOP] = std::min((u16)Position[1], BBoxCoords[BoundingBox::TOP]);
+	BBoxCoords[BoundingBox::BOTTOM] = std::max((u16)Position[1], BBoxCoords[BoundingBox::BOTTOM]);
 
 	// if we are only calculating the bounding box,
 	// there's no need to actually draw anything
@@ -802,8 +1073,8 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(stats.thisFrame.tevPixelsOut);
-	EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+	PixelsOut++;
+	PerfPixelCounts[PQ_BLEND_INPUT]++;
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
 }
@@ -820,3 +1091,90 @@ void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 	}
 }
 
+void Tev::CopyState(const Tev &other)
+{
+	memcpy(Reg, other.Reg, sizeof(Reg));
+	memcpy(KonstantColors, other.KonstantColors, sizeof(KonstantColors));
+	memcpy(TexColor, other.TexColor, sizeof(TexColor));
+	memcpy(RasColor, other.RasColor, sizeof(RasColor));
+	memcpy(StageKonst, other.StageKonst, sizeof(StageKonst));
+	memcpy(IndirectTex, other.IndirectTex, sizeof(IndirectTex));
+	AlphaBump = other.AlphaBump;
+	TexCoord = other.TexCoord;
+}
+
+void Tev::FlushCounters()
+{
+	for (int i = 0; i < PQ_NUM_MEMBERS; i++)
+	{
+		if (PerfPixelCounts[i])
+			EfbInterface::AddPerfCounterQuadCount(static_cast<PerfQueryType>(i), PerfPixelCounts[i]);
+		PerfPixelCounts[i] = 0;
+	}
+
+	ADDSTAT(stats.thisFrame.tevPixelsIn, PixelsIn);
+	ADDSTAT(stats.thisFrame.tevPixelsOut, PixelsOut);
+	PixelsIn = 0;
+	PixelsOut = 0;
+}
+
+bool Tev::ReadsPreviousPixel()
+{
+	// The texture coordinates are left over from the last stage of the previous pixel
+	if (bpmem.tevind[0].fb_addprev)
+		return true;
+
+	// Registers and the texture color that any stage writes
+	u32 writtenColor = 0;
+	u32 writtenAlpha = 0;
+	bool writtenTex = false;
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
+	{
+		writtenColor |= 1 << bpmem.combiners[stageNum].colorC.dest;
+		writtenAlpha |= 1 << bpmem.combiners[stageNum].alphaC.dest;
+		writtenTex |= bpmem.tevorders[stageNum >> 1].getEnable(stageNum & 1) != 0;
+	}
+
+	// ... and the ones that were written already for the current pixel when a stage reads them
+	u32 doneColor = 0;
+	u32 doneAlpha = 0;
+	bool doneTex = false;
+	auto stale_color = [&](u32 input) {
+		if (input < TEVCOLORARG_TEXC)
+		{
+			u32 reg = 1 << (input >> 1);
+			if (input & 1)
+				return (writtenAlpha & reg) && !(doneAlpha & reg);
+			return (writtenColor & reg) && !(doneColor & reg);
+		}
+		if (input == TEVCOLORARG_TEXC || input == TEVCOLORARG_TEXA)
+			return writtenTex && !doneTex;
+		return false;
+	};
+	auto stale_alpha = [&](u32 input) {
+		if (input < TEVALPHAARG_TEXA)
+			return (writtenAlpha & (1 << input)) && !(doneAlpha & (1 << input));
+		if (input == TEVALPHAARG_TEXA)
+			return writtenTex && !doneTex;
+		return false;
+	};
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
+	{
+		const TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		const TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+
+		if (bpmem.tevorders[stageNum >> 1].getEnable(stageNum & 1))
+			doneTex = true;
+
+		if (stale_color(cc.a) || stale_color(cc.b) || stale_color(cc.c) || stale_color(cc.d))
+			return true;
+		if (stale_alpha(ac.a) || stale_alpha(ac.b) || stale_alpha(ac.c) || stale_alpha(ac.d))
+			return true;
+
+		doneColor |= 1 << cc.dest;
+		doneAlpha |= 1 << ac.dest;
+	}
+
+	return false;
+}
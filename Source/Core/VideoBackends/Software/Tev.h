@@ -5,6 +5,7 @@
 #pragma once
 
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class Tev
 {
@@ -64,8 +65,25 @@ class Tev
 	void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 
+	// Both combiners of a stage including the clamping, reading the inputs from the registers
+	void DrawCombiners(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac);
+#ifdef _M_X86
+	// All four channels at once, for stages without compare modes
+	void InitCombinerConstants();
+	void GatherInputs(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac, s16 *a, s16 *b, s16 *c, s16 *d);
+	void StoreOutputs(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac, const s16 *out);
+	void DrawRegularSSE41(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac);
+	void DrawRegularPairSSE41(Tev &first, TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac);
+#endif
+
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
+	// The parts of Draw: sampling the indirect textures, everything a stage does before its
+	// combiners and the alpha test, fog, depth test and blending of the result
+	void SampleIndirect();
+	void SetupStage(unsigned int stageNum);
+	void WriteOutput();
+
 public:
 	s32 Position[3];
 	u8 Color[2][4]; // must be RGBA for correct swap table ordering
@@ -83,9 +101,34 @@ public:
 		RED_C
 	};
 
+	// Pixels are counted per unit and only added to the global counters by FlushCounters(), so that
+	// several units can draw different parts of the EFB at the same time.
+	u32 PerfPixelCounts[PQ_NUM_MEMBERS];
+	u32 PixelsIn;
+	u32 PixelsOut;
+
+	// Bounding box this unit extends, BoundingBox::coords unless set otherwise
+	u16 *BBoxCoords;
+
 	void Init();
 
 	void Draw();
 
+	// Draws first and then this pixel, running the combiners of both at once. Only allowed when
+	// ReadsPreviousPixel() is false and both started from the same state.
+	void DrawPair(Tev &first);
+
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
+
+	// Copies the register and texture colors and everything else a pixel can leave behind for the
+	// next one, but not the counters
+	void CopyState(const Tev &other);
+
+	void FlushCounters();
+
+	// True if a stage can read a value that the previous pixel left in the registers, which is the
+	// case when a register or the texture color is read before the stage that writes it, or when
+	// the first stage adds to the texture coordinates. Pixels only give the same result in any
+	// order when this is false.
+	static bool ReadsPreviousPixel();
 };
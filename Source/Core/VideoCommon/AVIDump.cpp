@@ -6,8 +6,16 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -20,6 +28,7 @@ extern "C" {
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/SystemTimers.h"
@@ -59,6 +68,31 @@ static int s_file_index = 0;
 static int s_savestate_index = 0;
 static int s_last_savestate_index = 0;
 
+// A frame copied out of the renderer's readback buffer, waiting for the encoder thread
+struct QueuedFrame
+{
+	std::vector<u8> data;
+	int width;
+	int height;
+	AVIDump::Frame state;
+};
+
+static std::thread s_encoder_thread;
+static std::mutex s_queue_mutex;
+static std::condition_variable s_queue_changed;
+static std::deque<QueuedFrame> s_queue;
+// Buffers of frames the encoder is done with, so that AddFrame doesn't allocate every frame
+static std::vector<std::vector<u8>> s_free_buffers;
+static size_t s_queue_limit = 1;
+static bool s_encoder_running = false;
+static AVIDump::EncoderStats s_stats;
+
+static u64 MicrosecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
 static void InitAVCodec()
 {
 	static bool first_run = true;
@@ -93,6 +127,18 @@ bool AVIDump::Start(int w, int h, bool fromBGRA)
 	    g_replayComm->current.endFrame <= g_playbackStatus->currentPlaybackFrame)
 		return false;
 #endif
+	if (!OpenDump(w, h, fromBGRA))
+		return false;
+
+	s_stats = {};
+	s_queue_limit = std::max(g_Config.iDumpQueueFrames, 1);
+	s_encoder_running = true;
+	s_encoder_thread = std::thread(EncoderThread);
+	return true;
+}
+
+bool AVIDump::OpenDump(int w, int h, bool fromBGRA)
+{
 	s_pix_fmt = fromBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
 
 	s_width = w;
@@ -212,6 +258,10 @@ bool AVIDump::CreateVideoFile()
 	if (output_format->flags & AVFMT_GLOBALHEADER)
 		s_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
+	// 0 lets the encoder pick a thread count for the machine
+	s_codec_context->thread_count = std::max(g_Config.iDumpEncoderThreads, 0);
+	s_codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	if (avcodec_open2(s_codec_context, codec, nullptr) < 0)
 	{
 		ERROR_LOG(VIDEO, "Could not open codec");
@@ -320,6 +370,80 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
 	    g_replayComm->current.endFrame <= g_playbackStatus->currentPlaybackFrame)
 		return;
 #endif
+	if (!s_encoder_running)
+		return;
+
+	std::vector<u8> buffer;
+	{
+		std::unique_lock<std::mutex> lk(s_queue_mutex);
+		if (s_queue.size() >= s_queue_limit)
+		{
+			// The encoder is behind, wait for it instead of dropping frames
+			auto start = std::chrono::steady_clock::now();
+			s_queue_changed.wait(lk, [] { return s_queue.size() < s_queue_limit; });
+			s_stats.stalls++;
+			s_stats.total_stall_us += MicrosecondsSince(start);
+		}
+		if (!s_free_buffers.empty())
+		{
+			buffer = std::move(s_free_buffers.back());
+			s_free_buffers.pop_back();
+		}
+	}
+
+	// The stride is negative for frames that are upside down, the copy is always top down
+	const size_t row_size = static_cast<size_t>(std::max(width, 0)) * 4;
+	buffer.resize(row_size * std::max(height, 0));
+	for (int y = 0; y < height; y++)
+		memcpy(&buffer[y * row_size], data + static_cast<ptrdiff_t>(y) * stride, row_size);
+
+	{
+		std::lock_guard<std::mutex> lk(s_queue_mutex);
+		s_queue.push_back(QueuedFrame{std::move(buffer), width, height, state});
+		s_stats.max_queue_depth = std::max(s_stats.max_queue_depth, static_cast<u32>(s_queue.size()));
+	}
+	s_queue_changed.notify_all();
+}
+
+void AVIDump::EncoderThread()
+{
+	Common::SetCurrentThreadName("Frame dump encoder");
+
+	std::unique_lock<std::mutex> lk(s_queue_mutex);
+	while (true)
+	{
+		s_queue_changed.wait(lk, [] { return !s_queue.empty() || !s_encoder_running; });
+		// Stop() only ends the thread once every queued frame is written
+		if (s_queue.empty())
+			break;
+
+		QueuedFrame frame = std::move(s_queue.front());
+		s_queue.pop_front();
+		lk.unlock();
+		s_queue_changed.notify_all();
+
+		auto start = std::chrono::steady_clock::now();
+		EncodeFrame(frame.data.data(), frame.width, frame.height, frame.width * 4, frame.state);
+		const u64 encode_us = MicrosecondsSince(start);
+
+		lk.lock();
+		s_stats.frames++;
+		s_stats.total_encode_us += encode_us;
+		s_stats.max_encode_us = std::max(s_stats.max_encode_us, encode_us);
+		s_free_buffers.push_back(std::move(frame.data));
+	}
+}
+
+AVIDump::EncoderStats AVIDump::GetEncoderStats()
+{
+	std::lock_guard<std::mutex> lk(s_queue_mutex);
+	EncoderStats stats = s_stats;
+	stats.queue_depth = static_cast<u32>(s_queue.size());
+	return stats;
+}
+
+void AVIDump::EncodeFrame(const u8* data, int width, int height, int stride, const Frame& state)
+{
 	// Assume that the timing is valid, if the savestate id of the new frame
 	// doesn't match the last one.
 	if (state.savestate_index != s_last_savestate_index)
@@ -329,6 +453,9 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
 	}
 
 	CheckResolution(width, height);
+	if (!s_codec_context)
+		return;
+
 	s_src_frame->data[0] = const_cast<u8*>(data);
 	s_src_frame->linesize[0] = stride;
 	s_src_frame->format = s_pix_fmt;
@@ -378,9 +505,12 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
 		s_last_pts = pts_in_ticks;
 		error = SendFrameAndReceivePacket(s_codec_context, &pkt, s_scaled_frame, &got_packet);
 	}
-	if (!error && got_packet)
+	// Threaded encoders can have several packets ready at once
+	while (!error && got_packet)
 	{
 		WritePacket(pkt);
+		PreparePacket(&pkt);
+		error = ReceivePacket(s_codec_context, &pkt, &got_packet);
 	}
 	if (error)
 		ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
@@ -390,11 +520,18 @@ static void HandleDelayedPackets()
 {
 	AVPacket pkt;
 
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+	// Makes the encoder hand out the frames it still holds, threaded encoders keep several
+	avcodec_send_frame(s_codec_context, nullptr);
+#endif
+
 	while (true)
 	{
 		PreparePacket(&pkt);
 		int got_packet;
 		int error = ReceivePacket(s_codec_context, &pkt, &got_packet);
+		if (error == AVERROR_EOF)
+			break;
 		if (error)
 		{
 			ERROR_LOG(VIDEO, "Error while stopping video: %d", error);
@@ -410,10 +547,36 @@ static void HandleDelayedPackets()
 
 void AVIDump::Stop()
 {
-	HandleDelayedPackets();
-	av_write_trailer(s_format_context);
-	CloseVideoFile();
+	{
+		std::lock_guard<std::mutex> lk(s_queue_mutex);
+		s_encoder_running = false;
+	}
+	s_queue_changed.notify_all();
+	if (s_encoder_thread.joinable())
+		s_encoder_thread.join();
+	s_free_buffers.clear();
+
+	FinishDump();
 	s_file_index = 0;
+
+	if (s_stats.frames)
+	{
+		NOTICE_LOG(VIDEO, "Frame dump encoder: %llu frames, %.2f ms average and %.2f ms worst encode time, "
+			"queue depth up to %u of %u, waited %llu times for %.2f ms in total",
+			(unsigned long long)s_stats.frames, s_stats.total_encode_us / 1000.0 / s_stats.frames,
+			s_stats.max_encode_us / 1000.0, s_stats.max_queue_depth, (u32)s_queue_limit,
+			(unsigned long long)s_stats.stalls, s_stats.total_stall_us / 1000.0);
+	}
+}
+
+void AVIDump::FinishDump()
+{
+	if (s_codec_context)
+	{
+		HandleDelayedPackets();
+		av_write_trailer(s_format_context);
+	}
+	CloseVideoFile();
 	NOTICE_LOG(VIDEO, "Stopping frame dump");
 	OSD::AddMessage("Stopped dumping frames");
 }
@@ -454,9 +617,9 @@ void AVIDump::CheckResolution(int width, int height)
 	if ((width != s_width || height != s_height) && (width > 0 && height > 0))
 	{
 		int temp_file_index = s_file_index;
-		Stop();
+		FinishDump();
 		s_file_index = temp_file_index + 1;
-		Start(width, height);
+		OpenDump(width, height, s_pix_fmt == AV_PIX_FMT_BGRA);
 	}
 }
 
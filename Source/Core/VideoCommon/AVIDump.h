@@ -6,13 +6,10 @@
 
 #include "Common/CommonTypes.h"
 
+// AddFrame only copies the frame into a queue, the color conversion and encoding happen on a
+// thread of its own. AddFrame waits when the queue is full, so no frame is dropped.
 class AVIDump
 {
-private:
-	static bool CreateVideoFile();
-	static void CloseVideoFile();
-	static void CheckResolution(int width, int height);
-
 public:
 	struct Frame
 	{
@@ -22,6 +19,28 @@ public:
 		int savestate_index = 0;
 	};
 
+	struct EncoderStats
+	{
+		u64 frames = 0;
+		u32 queue_depth = 0;
+		u32 max_queue_depth = 0;
+		u64 total_encode_us = 0;
+		u64 max_encode_us = 0;
+		// AddFrame calls that had to wait for the encoder, and how long they waited in total
+		u64 stalls = 0;
+		u64 total_stall_us = 0;
+	};
+
+private:
+	static bool CreateVideoFile();
+	static void CloseVideoFile();
+	static bool OpenDump(int w, int h, bool fromBGRA);
+	static void FinishDump();
+	static void CheckResolution(int width, int height);
+	static void EncodeFrame(const u8* data, int width, int height, int stride, const Frame& state);
+	static void EncoderThread();
+
+public:
 	static bool Start(int w, int h, bool fromBGRA = false);
 	static void AddFrame(const u8* data, int width, int height, int stride, const Frame& state);
 	static void Stop();
@@ -29,7 +48,9 @@ public:
 
 #if defined(HAVE_LIBAV) || defined(_WIN32)
 	static Frame FetchState(u64 ticks);
+	static EncoderStats GetEncoderStats();
 #else
 	static Frame FetchState(u64 ticks) { return{}; }
+	static EncoderStats GetEncoderStats() { return{}; }
 #endif
 };
@@ -0,0 +1,309 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+#include <xxhash.h>
+
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "VideoCommon/AsyncTextureScaler.h"
+#include "VideoCommon/TextureScalerCommon.h"
+
+namespace
+{
+constexpr u32 FILE_MAGIC = 0x43535444; // "DTSC"
+constexpr u32 FILE_VERSION = 1;
+// Textures are at most 1024x1024, down to 1x1 that makes 11 levels
+constexpr u32 MAX_LEVELS = 11;
+// A game loads a few hundred textures at most at once, anything beyond waits for the next load
+constexpr size_t MAX_QUEUED_JOBS = 256;
+// Scaled textures nobody picked up yet, the oldest are dropped beyond this
+constexpr size_t MAX_FINISHED_BYTES = 256 * 1024 * 1024;
+
+struct FileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 levels;
+};
+
+struct LevelHeader
+{
+	u32 width;
+	u32 height;
+	u32 expanded_width;
+};
+
+size_t GetTextureBytes(const AsyncTextureScaler::Texture& texture)
+{
+	size_t bytes = 0;
+	for (const AsyncTextureScaler::Level& level : texture)
+		bytes += level.data.size() * sizeof(u32);
+	return bytes;
+}
+}
+
+AsyncTextureScaler::AsyncTextureScaler(const std::string& cache_dir, int threads)
+	: m_cache_dir(cache_dir)
+{
+	m_scaler = std::make_unique<TextureScaler>(threads);
+	if (!m_cache_dir.empty() && !File::CreateFullPath(m_cache_dir))
+	{
+		WARN_LOG(VIDEO, "Could not create the scaled texture cache in %s", m_cache_dir.c_str());
+		m_cache_dir.clear();
+	}
+	m_thread = std::thread(&AsyncTextureScaler::WorkerThread, this);
+}
+
+AsyncTextureScaler::~AsyncTextureScaler()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_exit = true;
+		m_jobs.clear();
+	}
+	m_jobs_changed.notify_one();
+	m_thread.join();
+}
+
+u64 AsyncTextureScaler::GetKey(const Texture& source, const Settings& settings)
+{
+	u64 key = static_cast<u64>(settings.type) | (static_cast<u64>(settings.factor) << 8) |
+		(static_cast<u64>(settings.deposterize) << 16);
+	for (const Level& level : source)
+	{
+		const u64 seed = key ^ ((static_cast<u64>(level.width) << 32) | level.height);
+		key = XXH64(level.data.data(), level.data.size() * sizeof(u32), 0, seed);
+	}
+	return key ? key : 1;
+}
+
+bool AsyncTextureScaler::Fetch(u64 key, const Texture& source, const Settings& settings, bool wait,
+                               Texture* scaled)
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		auto finished = m_finished.find(key);
+		if (finished != m_finished.end())
+		{
+			*scaled = std::move(finished->second);
+			m_finished.erase(finished);
+			return true;
+		}
+
+		if (!wait)
+		{
+			if (m_pending.count(key) || m_jobs.size() >= MAX_QUEUED_JOBS)
+				return false;
+			m_pending.insert(key);
+			m_jobs.push_back({key, settings, source});
+			m_jobs_changed.notify_one();
+			return false;
+		}
+	}
+
+	// Whoever claims a key in m_pending processes it, so the scaling thread and this one never
+	// write the same file. A queued job is taken over, one being scaled is waited for.
+	{
+		std::unique_lock<std::mutex> lk(m_mutex);
+		while (true)
+		{
+			auto finished = m_finished.find(key);
+			if (finished != m_finished.end())
+			{
+				*scaled = std::move(finished->second);
+				m_finished.erase(finished);
+				return true;
+			}
+			if (m_pending.insert(key).second)
+				break;
+
+			auto queued = std::find_if(m_jobs.begin(), m_jobs.end(), [key](const Job& job) { return job.key == key; });
+			if (queued != m_jobs.end())
+			{
+				m_jobs.erase(queued);
+				break;
+			}
+			m_job_finished.wait(lk);
+		}
+	}
+
+	*scaled = Process({key, settings, source});
+
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_pending.erase(key);
+	return true;
+}
+
+bool AsyncTextureScaler::IsReady(u64 key)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	return m_finished.count(key) != 0;
+}
+
+void AsyncTextureScaler::Clear()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	for (const Job& job : m_jobs)
+		m_pending.erase(job.key);
+	m_jobs.clear();
+	m_finished.clear();
+	m_finished_order.clear();
+}
+
+void AsyncTextureScaler::WorkerThread()
+{
+	Common::SetCurrentThreadName("Texture scaler");
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true)
+	{
+		m_jobs_changed.wait(lk, [this] { return m_exit || !m_jobs.empty(); });
+		if (m_exit)
+			break;
+
+		Job job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		lk.unlock();
+		Texture scaled = Process(job);
+		lk.lock();
+
+		m_pending.erase(job.key);
+		m_finished[job.key] = std::move(scaled);
+		m_finished_order.push_back(job.key);
+		m_job_finished.notify_all();
+
+		size_t finished_bytes = 0;
+		for (const auto& finished : m_finished)
+			finished_bytes += GetTextureBytes(finished.second);
+		while (finished_bytes > MAX_FINISHED_BYTES && !m_finished_order.empty())
+		{
+			auto oldest = m_finished.find(m_finished_order.front());
+			m_finished_order.pop_front();
+			if (oldest == m_finished.end())
+				continue;
+			finished_bytes -= GetTextureBytes(oldest->second);
+			m_finished.erase(oldest);
+		}
+	}
+}
+
+AsyncTextureScaler::Texture AsyncTextureScaler::Process(const Job& job)
+{
+	Texture scaled;
+	if (LoadFromDisk(job.key, &scaled))
+		return scaled;
+
+	std::lock_guard<std::mutex> lk(m_scaler_mutex);
+	for (const Level& level : job.source)
+	{
+		// Scale does not touch its input, it only takes a non-const pointer
+		u32* data = m_scaler->Scale(const_cast<u32*>(level.data.data()), level.expanded_width,
+		                            level.height, job.settings.type, job.settings.factor,
+		                            job.settings.deposterize);
+		const u32 factor = static_cast<u32>(job.settings.factor);
+		const u32 expanded_width = level.expanded_width * factor;
+		const u32 height = level.height * factor;
+		scaled.push_back({level.width * factor, height, expanded_width,
+		                  std::vector<u32>(data, data + expanded_width * height)});
+	}
+	SaveToDisk(job.key, scaled);
+	return scaled;
+}
+
+bool AsyncTextureScaler::LoadFromDisk(u64 key, Texture* texture)
+{
+	if (m_cache_dir.empty())
+		return false;
+
+	const std::string path = GetPath(key);
+	File::IOFile file(path, "rb");
+	if (!file)
+		return false;
+
+	u64 remaining = file.GetSize();
+	FileHeader header;
+	if (remaining < sizeof(header) || !file.ReadArray(&header, 1) || header.magic != FILE_MAGIC ||
+		header.version != FILE_VERSION)
+	{
+		return false;
+	}
+	remaining -= sizeof(header);
+
+	// The level count comes from the file, a broken one must not make us allocate whatever it says
+	if (header.levels == 0 || header.levels > MAX_LEVELS ||
+		static_cast<u64>(header.levels) * sizeof(LevelHeader) > remaining)
+	{
+		WARN_LOG(VIDEO, "Removing broken scaled texture %s", path.c_str());
+		file.Close();
+		File::Delete(path);
+		return false;
+	}
+
+	texture->resize(header.levels);
+	for (Level& level : *texture)
+	{
+		LevelHeader level_header;
+		if (remaining < sizeof(level_header) || !file.ReadArray(&level_header, 1))
+			break;
+		remaining -= sizeof(level_header);
+		const u64 bytes = static_cast<u64>(level_header.expanded_width) * level_header.height * sizeof(u32);
+		if (level_header.width > level_header.expanded_width || bytes > remaining)
+			break;
+
+		level.width = level_header.width;
+		level.height = level_header.height;
+		level.expanded_width = level_header.expanded_width;
+		level.data.resize(level_header.expanded_width * level_header.height);
+		if (!file.ReadArray(level.data.data(), level.data.size()))
+			break;
+		remaining -= bytes;
+	}
+
+	if (!file || remaining != 0 || texture->back().data.empty())
+	{
+		WARN_LOG(VIDEO, "Removing broken scaled texture %s", path.c_str());
+		file.Close();
+		File::Delete(path);
+		texture->clear();
+		return false;
+	}
+	return true;
+}
+
+void AsyncTextureScaler::SaveToDisk(u64 key, const Texture& texture)
+{
+	if (m_cache_dir.empty())
+		return;
+
+	// Written under another name first, so a crash never leaves half a texture behind
+	const std::string path = GetPath(key);
+	const std::string temp_path = path + ".tmp";
+	File::IOFile file(temp_path, "wb");
+	const FileHeader header = {FILE_MAGIC, FILE_VERSION, static_cast<u32>(texture.size())};
+	bool good = file.WriteArray(&header, 1);
+	for (const Level& level : texture)
+	{
+		const LevelHeader level_header = {level.width, level.height, level.expanded_width};
+		good = good && file.WriteArray(&level_header, 1) &&
+			file.WriteArray(level.data.data(), level.data.size());
+	}
+	file.Close();
+
+	if (!good || !File::Rename(temp_path, path))
+	{
+		WARN_LOG(VIDEO, "Could not write scaled texture %s", path.c_str());
+		File::Delete(temp_path);
+	}
+}
+
+std::string AsyncTextureScaler::GetPath(u64 key) const
+{
+	return m_cache_dir + StringFromFormat("%016" PRIx64 ".bin", key);
+}
@@ -0,0 +1,89 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+class TextureScaler;
+
+// Runs the texture scaler on a thread of its own, so the texture cache can use a texture at its
+// native size while the scaled version is made, instead of stalling the video thread on xBRZ.
+// Scaled textures are also kept in the user cache directory, keyed by the decoded texture and the
+// scaler settings, so the next session loads them from disk instead of scaling them again.
+class AsyncTextureScaler
+{
+public:
+	struct Level
+	{
+		u32 width;
+		u32 height;
+		u32 expanded_width; // row length of data
+		std::vector<u32> data; // RGBA, expanded_width * height texels
+	};
+	using Texture = std::vector<Level>;
+
+	struct Settings
+	{
+		int type;
+		int factor;
+		bool deposterize;
+	};
+
+	// cache_dir may be empty to keep scaled textures in memory only. threads counts the scaling
+	// thread too, large textures are split across them by rows.
+	AsyncTextureScaler(const std::string& cache_dir, int threads);
+	~AsyncTextureScaler();
+
+	// Key of a decoded texture under the given settings, never 0
+	static u64 GetKey(const Texture& source, const Settings& settings);
+
+	// Hands out the scaled texture and returns true once it is done. Otherwise queues source to be
+	// scaled, unless it already is, and returns false. With wait set the texture is scaled or loaded
+	// on the calling thread instead, or waited for when the scaling thread is already on it.
+	bool Fetch(u64 key, const Texture& source, const Settings& settings, bool wait, Texture* scaled);
+	// True once Fetch would hand out the scaled texture
+	bool IsReady(u64 key);
+	// Drops every queued and finished texture
+	void Clear();
+
+private:
+	struct Job
+	{
+		u64 key;
+		Settings settings;
+		Texture source;
+	};
+
+	void WorkerThread();
+	Texture Process(const Job& job);
+	bool LoadFromDisk(u64 key, Texture* texture);
+	void SaveToDisk(u64 key, const Texture& texture);
+	std::string GetPath(u64 key) const;
+
+	std::string m_cache_dir;
+	std::unique_ptr<TextureScaler> m_scaler;
+	// Held while m_scaler is busy, Fetch with wait set shares it with the scaling thread
+	std::mutex m_scaler_mutex;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_jobs_changed;
+	std::condition_variable m_job_finished;
+	std::deque<Job> m_jobs;
+	std::unordered_set<u64> m_pending; // queued or being scaled
+	std::unordered_map<u64, Texture> m_finished;
+	std::deque<u64> m_finished_order;
+	bool m_exit = false;
+};
@@ -253,14 +253,15 @@ void BPWritten(const BPCmd& bp)
 		srcRect.bottom = (int)(bpmem.copyTexSrcXY.y + bpmem.copyTexSrcWH.y + 1);
 		UPE_Copy PE_copy = bpmem.triggerEFBCopy;
 
-		// Check if we are to copy from the EFB or draw to the XFB
+		// Check if we are to copy from the EFB or draw to the XFB. Resimulated frames only do the
+		// guest RAM side of their EFB copies, the EFB is still cleared for the frame after them.
 		if (PE_copy.copy_to_xfb == 0)
 		{
 			// bpmem.zcontrol.pixel_format to PEControl::Z24 is when the game wants to copy from ZBuffer (Zbuffer uses 24-bit Format)
 			bool is_depth_copy = bpmem.zcontrol.pixel_format == PEControl::Z24;
 			g_texture_cache->CopyRenderTargetToTexture(destAddr, PE_copy.tp_realFormat(), destStride,
 				is_depth_copy, srcRect,
-				!!PE_copy.intensity_fmt, !!PE_copy.half_scale);
+				!!PE_copy.intensity_fmt, !!PE_copy.half_scale, Fifo::SkipResimulatedCopy());
 		}
 		else
 		{
@@ -288,7 +289,8 @@ void BPWritten(const BPCmd& bp)
 
 			DEBUG_LOG(VIDEO, "RenderToXFB: destAddr: %08x | srcRect {%d %d %d %d} | fbWidth: %u | fbStride: %u | fbHeight: %u",
 				destAddr, srcRect.left, srcRect.top, srcRect.right, srcRect.bottom, bpmem.copyTexSrcWH.x + 1, destStride, height);
-			g_renderer->RenderToXFB(destAddr, srcRect, destStride, height, s_gammaLUT[PE_copy.gamma]);
+			if (!Fifo::SkipResimulatedXFBCopy())
+				g_renderer->RenderToXFB(destAddr, srcRect, destStride, height, s_gammaLUT[PE_copy.gamma]);
 		}
 
 		// Clear the rectangular region after copying it.
@@ -0,0 +1,26 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Display lists that are called over and over with the same contents are decoded once: the register
+// loads they contain are kept as a list of commands and the vertices they draw are kept converted.
+// Calling such a list again replays the register loads in order and copies the converted vertices
+// straight into the vertex manager. Every draw checks that its vertex loader, matrix index and the
+// indexed vertex array data it read are still the same, and converts the vertices again if not.
+namespace DLCache
+{
+void Init();
+void Shutdown();
+void Clear();
+
+// Drops lists that haven't been called for a while, called once per frame
+void ProgressiveCleanup();
+
+// Runs the display list g_VideoData points at from the cache. Returns false without touching
+// anything if the list has to be interpreted instead.
+bool HandleDisplayList(u32 address, u32 size, u32 *cycles);
+}
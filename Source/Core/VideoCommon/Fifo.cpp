@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <atomic>
 #include <cstring>
 
@@ -16,11 +17,13 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
+#include "Core/HW/GPFifo.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/Host.h"
 
 #include "VideoCommon/AsyncRequests.h"
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
@@ -74,6 +77,29 @@ static std::atomic<int> s_sync_ticks;
 static bool s_syncing_suspended;
 static Common::Event s_sync_wakeup_event;
 
+// Where in the FIFO resimulated frames start or end, offset bytes into the chunk at address
+struct ResimulationMark
+{
+	u32 address;
+	u32 offset;
+	bool resimulating;
+	// In deterministic GPU thread mode, where the mark ended up in s_video_buffer
+	u32 buffer_offset;
+};
+
+// Written by the CPU thread and read by the GPU thread. Should the GPU fall this many marks behind,
+// the frames resimulated meanwhile are drawn as usual. In deterministic GPU thread mode the CPU
+// thread reads the FIFO, so it also locates the marks in s_video_buffer as it copies their chunks.
+static std::array<ResimulationMark, 4> s_resim_marks;
+static std::atomic<u32> s_resim_marks_written;
+static std::atomic<u32> s_resim_marks_located;
+static std::atomic<u32> s_resim_marks_read;
+static bool s_cpu_resimulating;
+static bool s_skipping_draws;
+static std::atomic<u64> s_skipped_draws;
+static std::atomic<u64> s_skipped_copies;
+static std::atomic<u64> s_skipped_xfb_copies;
+
 void DoState(PointerWrap& p)
 {
 	p.DoArray(s_video_buffer, FIFO_SIZE);
@@ -85,6 +111,11 @@ void DoState(PointerWrap& p)
 	{
 		// We're good and paused, right?
 		s_video_buffer_seen_ptr = s_video_buffer_pp_read_ptr = s_video_buffer_read_ptr;
+
+		// Marks located in the old buffer contents take effect right away
+		const u32 located = s_resim_marks_located.load(std::memory_order_relaxed);
+		for (u32 i = s_resim_marks_read.load(std::memory_order_relaxed); i != located; i++)
+			s_resim_marks[i % s_resim_marks.size()].buffer_offset = static_cast<u32>(s_video_buffer_read_ptr - s_video_buffer);
 	}
 
 	p.Do(s_sync_ticks);
@@ -119,6 +150,15 @@ void Init()
 	if (SConfig::GetInstance().bCPUThread)
 		s_gpu_mainloop.Prepare();
 	s_sync_ticks.store(0);
+
+	s_resim_marks_written.store(0);
+	s_resim_marks_located.store(0);
+	s_resim_marks_read.store(0);
+	s_cpu_resimulating = false;
+	s_skipping_draws = false;
+	s_skipped_draws.store(0);
+	s_skipped_copies.store(0);
+	s_skipped_xfb_copies.store(0);
 }
 
 void Shutdown()
@@ -182,6 +222,11 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 			size_t size = write_ptr - s_video_buffer_pp_read_ptr;
 
 			memmove(s_video_buffer, s_video_buffer_pp_read_ptr, size);
+			// The GPU is done up to here, so the marks it hasn't reached yet are past it
+			const u32 moved = static_cast<u32>(s_video_buffer_pp_read_ptr - s_video_buffer);
+			const u32 located = s_resim_marks_located.load(std::memory_order_relaxed);
+			for (u32 i = s_resim_marks_read.load(std::memory_order_relaxed); i != located; i++)
+				s_resim_marks[i % s_resim_marks.size()].buffer_offset -= moved;
 			// This change always decreases the pointers.  We write seen_ptr
 			// after write_ptr here, and read it before in RunGpuLoop, so
 			// 'write_ptr > seen_ptr' there cannot become spuriously true.
@@ -243,6 +288,19 @@ static void ReadDataFromFifo(u32 readPtr)
 	s_video_buffer_write_ptr += len;
 }
 
+// Pins the marks in the chunk at chunk_address to where the chunk is copied in s_video_buffer
+static void LocateResimulationMarks(u32 chunk_address, u8* chunk_ptr)
+{
+	u32 located = s_resim_marks_located.load(std::memory_order_relaxed);
+	while (located != s_resim_marks_written.load(std::memory_order_relaxed) &&
+		s_resim_marks[located % s_resim_marks.size()].address == chunk_address)
+	{
+		ResimulationMark& mark = s_resim_marks[located % s_resim_marks.size()];
+		mark.buffer_offset = static_cast<u32>(chunk_ptr - s_video_buffer) + mark.offset;
+		s_resim_marks_located.store(++located, std::memory_order_release);
+	}
+}
+
 // The deterministic_gpu_thread version.
 static void ReadDataFromFifoOnCPU(u32 readPtr)
 {
@@ -272,6 +330,7 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 			return;
 		}
 	}
+	LocateResimulationMarks(readPtr, write_ptr);
 	Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
 	DataReader fifo_reader(s_video_buffer_pp_read_ptr, write_ptr + len);
 	s_video_buffer_pp_read_ptr = OpcodeDecoder::Run<true>(fifo_reader, nullptr);
@@ -279,6 +338,148 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 	s_video_buffer_write_ptr = write_ptr + len;
 }
 
+void SetResimulating(bool resimulating)
+{
+	if (resimulating == s_cpu_resimulating)
+		return;
+	s_cpu_resimulating = resimulating;
+
+	// A start is only marked when its end will fit too
+	const u32 written = s_resim_marks_written.load(std::memory_order_relaxed);
+	const u32 free_marks = static_cast<u32>(s_resim_marks.size()) -
+		(written - s_resim_marks_read.load(std::memory_order_acquire));
+	if (free_marks < (resimulating ? 2u : 1u))
+		return;
+
+	// The next byte the game writes, past what the gather pipe holds since the last burst
+	const SCPFifoStruct& fifo = CommandProcessor::fifo;
+	u32 address = fifo.CPWritePointer;
+	for (u32 i = 0; i < GPFifo::m_gatherPipeCount / GPFifo::GATHER_PIPE_SIZE; i++)
+		address = address == fifo.CPEnd ? fifo.CPBase : address + GPFifo::GATHER_PIPE_SIZE;
+
+	ResimulationMark& mark = s_resim_marks[written % s_resim_marks.size()];
+	mark.address = address;
+	mark.offset = GPFifo::m_gatherPipeCount % GPFifo::GATHER_PIPE_SIZE;
+	mark.resimulating = resimulating;
+	s_resim_marks_written.store(written + 1, std::memory_order_release);
+}
+
+// What is drawn reaches the guest through EFB copies to RAM, bounding boxes and performance
+// queries, so draws and EFB copies are only skipped when none of those is in use
+static bool CanSkipResimulatedEFB()
+{
+	return s_skipping_draws && g_ActiveConfig.bSkipEFBCopyToRam && !g_ActiveConfig.bLastStoryEFBToRam &&
+		!BoundingBox::active && !g_ActiveConfig.bPerfQueriesEnable;
+}
+
+bool SkipResimulatedDraw()
+{
+	if (!CanSkipResimulatedEFB())
+		return false;
+	s_skipped_draws++;
+	return true;
+}
+
+bool SkipResimulatedCopy()
+{
+	if (!CanSkipResimulatedEFB())
+		return false;
+	s_skipped_copies++;
+	return true;
+}
+
+bool SkipResimulatedXFBCopy()
+{
+	if (!s_skipping_draws || g_ActiveConfig.RealXFBEnabled())
+		return false;
+	s_skipped_xfb_copies++;
+	return true;
+}
+
+ResimulationStats GetResimulationStats()
+{
+	return {s_skipped_draws.load(), s_skipped_copies.load(), s_skipped_xfb_copies.load()};
+}
+
+// Decodes what was read from the FIFO up to write_ptr, the last 32 bytes of it being the chunk at
+// chunk_address. The commands before a mark in that chunk are decoded before the mark is applied.
+static u8* RunOpcodeDecoder(u32 chunk_address, u8* write_ptr, u32* cycles)
+{
+	u8* read_ptr = s_video_buffer_read_ptr;
+	u32 read = s_resim_marks_read.load(std::memory_order_relaxed);
+	while (read != s_resim_marks_written.load(std::memory_order_acquire) &&
+		s_resim_marks[read % s_resim_marks.size()].address == chunk_address)
+	{
+		const ResimulationMark& mark = s_resim_marks[read % s_resim_marks.size()];
+		u32 mark_cycles = 0;
+		g_VideoData.SetReadPosition(read_ptr, write_ptr - 32 + mark.offset);
+		read_ptr = OpcodeDecoder::Run(g_VideoData, &mark_cycles);
+		if (cycles)
+			*cycles += mark_cycles;
+
+		s_skipping_draws = mark.resimulating;
+		s_resim_marks_read.store(++read, std::memory_order_release);
+	}
+
+	u32 rest_cycles = 0;
+	g_VideoData.SetReadPosition(read_ptr, write_ptr);
+	read_ptr = OpcodeDecoder::Run(g_VideoData, &rest_cycles);
+	if (cycles)
+		*cycles += rest_cycles;
+	return read_ptr;
+}
+
+// The deterministic GPU thread version, the marks were located in s_video_buffer by the CPU thread
+static u8* RunDeterministicOpcodeDecoder(u8* write_ptr)
+{
+	u8* read_ptr = s_video_buffer_read_ptr;
+	u32 read = s_resim_marks_read.load(std::memory_order_relaxed);
+	while (read != s_resim_marks_located.load(std::memory_order_acquire) &&
+		s_resim_marks[read % s_resim_marks.size()].buffer_offset <= static_cast<u32>(write_ptr - s_video_buffer))
+	{
+		const ResimulationMark& mark = s_resim_marks[read % s_resim_marks.size()];
+		g_VideoData.SetReadPosition(read_ptr, s_video_buffer + mark.buffer_offset);
+		read_ptr = OpcodeDecoder::Run<false>(g_VideoData, nullptr);
+
+		s_skipping_draws = mark.resimulating;
+		s_resim_marks_read.store(++read, std::memory_order_release);
+	}
+
+	g_VideoData.SetReadPosition(read_ptr, write_ptr);
+	return OpcodeDecoder::Run<false>(g_VideoData, nullptr);
+}
+
+// Once the FIFO is drained the next chunk read is the one at the read pointer. Marks placed
+// elsewhere, because the game moved or unlinked the FIFO meanwhile, will never be reached and
+// would leave draws skipped for good.
+static void DropStaleResimulationMarks()
+{
+	const SCPFifoStruct& fifo = CommandProcessor::fifo;
+	if (s_use_deterministic_gpu_thread)
+	{
+		// Only the CPU thread locates marks, so stale ones are located at the end of what was read
+		// and stop the skipping once the GPU thread gets there
+		u32 located = s_resim_marks_located.load(std::memory_order_relaxed);
+		while (fifo.CPReadWriteDistance == 0 && located != s_resim_marks_written.load(std::memory_order_relaxed) &&
+			s_resim_marks[located % s_resim_marks.size()].address != fifo.CPReadPointer)
+		{
+			ResimulationMark& mark = s_resim_marks[located % s_resim_marks.size()];
+			mark.buffer_offset = static_cast<u32>(s_video_buffer_write_ptr.load() - s_video_buffer);
+			mark.resimulating = false;
+			s_resim_marks_located.store(++located, std::memory_order_release);
+		}
+		return;
+	}
+
+	u32 read = s_resim_marks_read.load(std::memory_order_relaxed);
+	while (fifo.CPReadWriteDistance == 0 && read != s_resim_marks_written.load(std::memory_order_acquire) &&
+		s_resim_marks[read % s_resim_marks.size()].address != fifo.CPReadPointer)
+	{
+		s_skipping_draws = false;
+		s_resim_marks_read.store(++read, std::memory_order_release);
+	}
+}
+
 void ResetVideoBuffer()
 {
 	s_video_buffer_read_ptr = s_video_buffer;
@@ -316,8 +517,7 @@ void RunGpuLoop()
 			// See comment in SyncGPU
 			if (write_ptr > seen_ptr)
 			{
-				g_VideoData.SetReadPosition(s_video_buffer_read_ptr, write_ptr);
-				s_video_buffer_read_ptr = OpcodeDecoder::Run<false>(g_VideoData, nullptr);
+				s_video_buffer_read_ptr = RunDeterministicOpcodeDecoder(write_ptr);
 				s_video_buffer_seen_ptr = write_ptr;
 			}
 		}
@@ -351,8 +551,7 @@ void RunGpuLoop()
 					fifo.CPReadWriteDistance - 32);
 
 				u8* write_ptr = s_video_buffer_write_ptr;
-				g_VideoData.SetReadPosition(s_video_buffer_read_ptr, write_ptr);
-				s_video_buffer_read_ptr = OpcodeDecoder::Run(g_VideoData, &cyclesExecuted);
+				s_video_buffer_read_ptr = RunOpcodeDecoder(fifo.CPReadPointer, write_ptr, &cyclesExecuted);
 
 				Common::AtomicStore(fifo.CPReadPointer, readPtr);
 				Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
@@ -377,6 +576,8 @@ void RunGpuLoop()
 				AsyncRequests::GetInstance()->PullEvents();
 			}
 
+			DropStaleResimulationMarks();
+
 			// fast skip remaining GPU time if fifo is empty
 			if (s_sync_ticks.load() > 0)
 			{
@@ -462,8 +663,7 @@ static int RunGpuOnCpu(int ticks)
 			}
 			ReadDataFromFifo(fifo.CPReadPointer);
 			u32 cycles = 0;
-			g_VideoData.SetReadPosition(s_video_buffer_read_ptr, s_video_buffer_write_ptr);
-				s_video_buffer_read_ptr = OpcodeDecoder::Run(g_VideoData, &cycles);
+			s_video_buffer_read_ptr = RunOpcodeDecoder(fifo.CPReadPointer, s_video_buffer_write_ptr, &cycles);
 			available_ticks -= cycles;
 		}
 
@@ -475,6 +675,8 @@ static int RunGpuOnCpu(int ticks)
 		fifo.CPReadWriteDistance -= 32;
 	}
 
+	DropStaleResimulationMarks();
+
 	CommandProcessor::SetCPStatusFromGPU();
 
 	if (reset_simd_state)
@@ -517,6 +719,8 @@ void UpdateWantDeterminism(bool want)
 	if (s_use_deterministic_gpu_thread != gpu_thread)
 	{
 		s_use_deterministic_gpu_thread = gpu_thread;
+		// Marks not yet located in one mode are located in the other
+		s_resim_marks_located.store(s_resim_marks_read.load());
 		if (gpu_thread)
 		{
 			// These haven't been updated in non-deterministic mode.
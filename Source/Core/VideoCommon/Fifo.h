@@ -39,6 +39,27 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr = true);
 void PushFifoAuxBuffer(const void* ptr, size_t size);
 void* PopFifoAuxBuffer(size_t size);
 
+// Rollback runs frames again only for the game state they leave behind, what they draw is never
+// shown. The CPU thread marks where the commands of those frames start and end in the FIFO, and the
+// GPU thread runs the commands in between without the work only the host sees. XFB copies are
+// skipped unless real XFB is on. Draws and the VRAM side of EFB copies are only skipped while EFB
+// copies stay out of RAM and neither bounding box nor performance queries are in use. Skipped EFB
+// copies still zero their guest RAM and invalidate the textures they overlap, so the guest sees
+// the same GPU either way.
+struct ResimulationStats
+{
+	u64 skipped_draws;
+	u64 skipped_copies;
+	u64 skipped_xfb_copies;
+};
+
+void SetResimulating(bool resimulating); // Must be called from the CPU thread.
+// Called by the GPU for every draw and copy that may be skipped, counting what is skipped
+bool SkipResimulatedDraw();
+bool SkipResimulatedCopy();
+bool SkipResimulatedXFBCopy();
+ResimulationStats GetResimulationStats();
+
 void FlushGpu();
 void RunGpu();
 void GpuMaySleep();
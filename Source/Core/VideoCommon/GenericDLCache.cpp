@@ -1,52 +1,616 @@
-// Copyright (C) 2003-2009 Dolphin Project.
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
 
-// This program is free software: you can redistribute it and/or modify
-// it under the terms of the GNU General Public License as published by
-// the Free Software Foundation, version 2.0.
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <xxhash.h>
 
-// This program is distributed in the hope that it will be useful,
-// but WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-// GNU General Public License 2.0 for more details.
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Core/HW/Memmap.h"
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
 
-// A copy of the GPL 2.0 should have been included with the program.
-// If not, see http://www.gnu.org/licenses/
+namespace DLCache
+{
+// Lists that weren't called for this many frames are dropped
+static const u32 MAX_IDLE_FRAMES = 60;
+// A draw that had to be converted again this many times in a row, like a skinned model whose
+// vertex arrays are rewritten every frame, stops being cached
+static const u8 MAX_DRAW_MISSES = 4;
+static const size_t MAX_CACHED_VERTEX_BYTES = 32 * 1024 * 1024;
+
+enum CommandType : u8
+{
+	COMMAND_CP,
+	COMMAND_XF,
+	COMMAND_INDEXED_XF,
+	COMMAND_BP,
+	COMMAND_DRAW,
+};
+
+struct Command
+{
+	CommandType type;
+	// CP register, indexed XF array or draw command byte
+	u8 sub_cmd;
+	// Where the command's data starts in the list
+	u32 offset;
+	// Register value, XF transfer header or index of the draw
+	u32 value;
+};
 
-// Official SVN repository and contact information can be found at
-// http://code.google.com/p/dolphin-emu/
+// The part of an indexed vertex array a draw read from
+struct ArrayRange
+{
+	u32 array;
+	u32 base;
+	u32 stride;
+	u32 start;
+	u32 size;
+	u64 hash;
+};
+
+struct Draw
+{
+	u32 count = 0;
+	// Null while there are no converted vertices for the draw
+	VertexLoaderBase *loader = nullptr;
+	u32 native_count = 0;
+	// Without a matrix index in the vertex data every vertex gets the one from CP. It is patched into
+	// the converted vertices when it changes, games set it between calls of the same list.
+	bool posmtx_from_cp = false;
+	u32 posmtx = 0;
+	u8 misses = 0;
+	bool disabled = false;
+	std::vector<ArrayRange> arrays;
+	std::vector<u8> vertices;
+};
 
-// TODO: Handle cache-is-full condition :p
+struct CachedDisplayList
+{
+	u32 address = 0;
+	u32 size = 0;
+	u64 vertex_state = 0;
+	u64 content_hash = 0;
+	u32 calls = 0;
+	u32 last_frame = 0;
+	u32 cycles = 0;
+	bool compiled = false;
+	bool uncacheable = false;
+	std::vector<Command> commands;
+	std::vector<Draw> draws;
+};
 
+// Where the indices of an indexed attribute sit in a raw vertex
+struct IndexedAttribute
+{
+	u32 array;
+	u32 offset;
+	u32 index_size;
+	u32 indices;
+	// Bytes read from the array per index
+	u32 element_size;
+};
 
-#include "Common.h"
-#include "DLCache.h"
+static std::unordered_map<u64, CachedDisplayList> s_cache;
+static size_t s_cached_vertex_bytes;
+static u32 s_frame;
+static u64 s_replayed_draws;
+static u64 s_converted_draws;
 
-namespace DLCache
+static const u32 s_component_sizes[8] = {1, 1, 2, 2, 4, 0, 0, 0};
+static const u32 s_color_sizes[8] = {2, 3, 4, 2, 3, 4, 0, 0};
+
+// Returns the size of a raw vertex, or 0 if the format is invalid
+static u32 GetIndexedAttributes(const TVtxDesc &desc, const VAT &vat, std::vector<IndexedAttribute> *attributes)
+{
+	const u32 tex_elements[8] = {vat.g0.Tex0CoordElements, vat.g1.Tex1CoordElements, vat.g1.Tex2CoordElements,
+	                             vat.g1.Tex3CoordElements, vat.g1.Tex4CoordElements, vat.g2.Tex5CoordElements,
+	                             vat.g2.Tex6CoordElements, vat.g2.Tex7CoordElements};
+	const u32 tex_formats[8] = {vat.g0.Tex0CoordFormat, vat.g1.Tex1CoordFormat, vat.g1.Tex2CoordFormat,
+	                            vat.g1.Tex3CoordFormat, vat.g1.Tex4CoordFormat, vat.g2.Tex5CoordFormat,
+	                            vat.g2.Tex6CoordFormat, vat.g2.Tex7CoordFormat};
+
+	// Matrix indices come first, one byte each
+	u32 offset = 0;
+	for (int i = 0; i < 9; i++)
+		offset += (desc.Hex >> i) & 1;
+
+	for (int i = 0; i < 12; i++)
+	{
+		u32 type = desc.GetVertexArrayStatus(i);
+		if (type == NOT_PRESENT)
+			continue;
+
+		u32 size;
+		u32 indices = 1;
+		if (i == ARRAY_POSITION)
+		{
+			size = (vat.g0.PosElements ? 3 : 2) * s_component_sizes[vat.g0.PosFormat];
+		}
+		else if (i == ARRAY_NORMAL)
+		{
+			size = (vat.g0.NormalElements ? 9 : 3) * s_component_sizes[vat.g0.NormalFormat];
+			if (vat.g0.NormalElements && vat.g0.NormalIndex3)
+				indices = 3;
+		}
+		else if (i == ARRAY_COLOR || i == ARRAY_COLOR2)
+		{
+			size = s_color_sizes[i == ARRAY_COLOR ? vat.g0.Color0Comp : vat.g0.Color1Comp];
+		}
+		else
+		{
+			size = (tex_elements[i - ARRAY_TEXCOORD0] ? 2 : 1) * s_component_sizes[tex_formats[i - ARRAY_TEXCOORD0]];
+		}
+
+		if (size == 0)
+			return 0;
+
+		if (type == DIRECT)
+		{
+			offset += size;
+			continue;
+		}
+
+		u32 index_size = type == INDEX8 ? 1 : 2;
+		attributes->push_back({(u32)i, offset, index_size, indices, size});
+		offset += index_size * indices;
+	}
+
+	return offset;
+}
+
+// Remembers which parts of the indexed vertex arrays the draw read. Returns false if they can't be
+// tracked.
+static bool RecordArrays(Draw &draw, const VertexLoaderParameters &parameters, u32 vertex_size)
 {
+	std::vector<IndexedAttribute> attributes;
+	if (GetIndexedAttributes(*parameters.VtxDesc, *parameters.VtxAttr, &attributes) != vertex_size)
+		return false;
+
+	draw.arrays.clear();
+	for (const IndexedAttribute &attribute : attributes)
+	{
+		const u32 all_ones = attribute.index_size == 1 ? 0xFF : 0xFFFF;
+		u32 min_index = all_ones;
+		u32 max_index = 0;
+		bool used = false;
+		const u8 *src = parameters.source + attribute.offset;
+		for (int v = 0; v < parameters.count; v++, src += vertex_size)
+		{
+			for (u32 k = 0; k < attribute.indices; k++)
+			{
+				u32 index = attribute.index_size == 1 ? src[k] : Common::swap16(src + k * 2);
+				// The vertex is skipped, its position isn't used
+				if (attribute.array == ARRAY_POSITION && index == all_ones)
+					continue;
+
+				min_index = std::min(min_index, index);
+				max_index = std::max(max_index, index);
+				used = true;
+			}
+		}
+
+		if (!used)
+			continue;
+
+		ArrayRange range;
+		range.array = attribute.array;
+		range.base = g_main_cp_state.array_bases[attribute.array];
+		range.stride = g_main_cp_state.array_strides[attribute.array];
+		range.start = min_index * range.stride;
+		range.size = max_index * range.stride + attribute.element_size - range.start;
+		const u8 *data = Memory::GetPointer(range.base);
+		if (!data)
+			return false;
+
+		range.hash = XXH64(data + range.start, range.size, 0);
+		draw.arrays.push_back(range);
+	}
+
+	return true;
+}
+
+static bool ArraysUnchanged(const Draw &draw)
+{
+	for (const ArrayRange &range : draw.arrays)
+	{
+		if (g_main_cp_state.array_bases[range.array] != range.base ||
+		    g_main_cp_state.array_strides[range.array] != range.stride)
+		{
+			return false;
+		}
+
+		const u8 *data = Memory::GetPointer(range.base);
+		if (!data || XXH64(data + range.start, range.size, 0) != range.hash)
+			return false;
+	}
+
+	return true;
+}
+
+static void FreeVertices(Draw &draw)
+{
+	s_cached_vertex_bytes -= draw.vertices.size();
+	draw.vertices = std::vector<u8>();
+	draw.arrays.clear();
+	draw.loader = nullptr;
+}
+
+// Keeps the vertices loader just converted for the draw
+static void RecordDraw(Draw &draw, const VertexLoaderParameters &parameters, VertexLoaderBase *loader, u32 writesize)
+{
+	FreeVertices(draw);
+	if (parameters.skip_draw || loader->m_native_stride <= 0 ||
+	    s_cached_vertex_bytes + writesize > MAX_CACHED_VERTEX_BYTES)
+	{
+		return;
+	}
+
+	if (!RecordArrays(draw, parameters, loader->m_VertexSize))
+	{
+		draw.disabled = true;
+		return;
+	}
+
+	draw.loader = loader;
+	draw.native_count = writesize / loader->m_native_stride;
+	draw.posmtx_from_cp = !parameters.VtxDesc->PosMatIdx;
+	draw.posmtx = g_main_cp_state.matrix_index_a.PosNormalMtxIdx;
+	draw.vertices.assign(parameters.destination, parameters.destination + writesize);
+	s_cached_vertex_bytes += writesize;
+}
+
+static void ResetList(CachedDisplayList &dl)
+{
+	for (Draw &draw : dl.draws)
+		FreeVertices(draw);
+	dl = CachedDisplayList();
+}
+
+// Same setup OpcodeDecoder::Run does for a draw
+static void SetupDraw(VertexLoaderParameters &parameters, u8 cmd_byte, u32 count, u8 *source, size_t distance)
+{
+	u32 vtx_attr_group = cmd_byte & GX_VAT_MASK;
+	parameters.count = count;
+	parameters.buf_size = distance;
+	parameters.primitive = (cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
+	parameters.vtx_attr_group = vtx_attr_group;
+	parameters.needloaderrefresh = (g_main_cp_state.attr_dirty & (1u << vtx_attr_group)) != 0;
+	parameters.skip_draw = xfmem.viewport.wd == 0.0f
+		|| xfmem.viewport.ht == 0.0f
+		|| (bpmem.scissorBR.x + 1 - bpmem.scissorTL.x) == 0
+		|| (bpmem.scissorBR.y + 1 - bpmem.scissorTL.y) == 0
+		|| Fifo::SkipResimulatedDraw();
+	parameters.VtxDesc = &g_main_cp_state.vtx_desc;
+	parameters.VtxAttr = &g_main_cp_state.vtx_attr[vtx_attr_group];
+	parameters.source = source;
+	parameters.destination = nullptr;
+	g_main_cp_state.attr_dirty &= ~(1 << vtx_attr_group);
+}
+
+// A command that runs past the end of the list isn't run, like the interpreter does with the end of
+// a list. The list can't be cached then.
+static bool CutOff(CachedDisplayList &dl, size_t size)
+{
+	if (g_VideoData.size() >= size)
+		return false;
+
+	dl.uncacheable = true;
+	return true;
+}
+
+// Interprets the list like OpcodeDecoder::Run while recording what it does. Nested lists and
+// unknown opcodes make the list uncacheable, the rest of it is handed to the interpreter then.
+static void Compile(CachedDisplayList &dl, u32 *cycles)
+{
+	u8 *start = g_VideoData.GetReadPosition();
+	u32 total_cycles = 0;
+	while (g_VideoData.size() && !dl.uncacheable)
+	{
+		u8 *opcode_start = g_VideoData.GetReadPosition();
+		u8 cmd_byte = g_VideoData.Read<u8>();
+		switch (cmd_byte)
+		{
+		case GX_NOP:
+		case GX_UNKNOWN_RESET:
+		case GX_CMD_UNKNOWN_METRICS:
+		case GX_CMD_INVL_VC:
+			total_cycles += GX_NOP_CYCLES;
+			continue;
+
+		case GX_LOAD_CP_REG:
+		{
+			if (CutOff(dl, GX_LOAD_CP_REG_SIZE))
+				continue;
+			u8 sub_cmd = g_VideoData.Read<u8>();
+			u32 value = g_VideoData.Read<u32>();
+			dl.commands.push_back({COMMAND_CP, sub_cmd, 0, value});
+			LoadCPReg<false>(sub_cmd, value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			total_cycles += GX_LOAD_CP_REG_CYCLES;
+			continue;
+		}
+
+		case GX_LOAD_XF_REG:
+		{
+			if (CutOff(dl, GX_LOAD_XF_REG_SIZE))
+				continue;
+			u32 cmd2 = g_VideoData.Read<u32>();
+			u32 transfer_size = ((cmd2 >> 16) & 15) + 1;
+			if (CutOff(dl, transfer_size * sizeof(u32)))
+				continue;
+			dl.commands.push_back({COMMAND_XF, 0, (u32)(g_VideoData.GetReadPosition() - start), cmd2});
+			LoadXFReg(transfer_size, cmd2 & 0xFFFF);
+			INCSTAT(stats.thisFrame.numXFLoads);
+			total_cycles += GX_LOAD_XF_REG_BASE_CYCLES + GX_LOAD_XF_REG_TRANSFER_CYCLES * transfer_size;
+			continue;
+		}
+
+		case GX_LOAD_INDX_A:
+		case GX_LOAD_INDX_B:
+		case GX_LOAD_INDX_C:
+		case GX_LOAD_INDX_D:
+		{
+			if (CutOff(dl, GX_LOAD_INDX_SIZE))
+				continue;
+			u32 value = g_VideoData.Read<u32>();
+			u8 ref_array = (cmd_byte >> 3) + 8;
+			dl.commands.push_back({COMMAND_INDEXED_XF, ref_array, 0, value});
+			LoadIndexedXF(value, ref_array);
+			total_cycles += GX_LOAD_INDX_CYCLES;
+			continue;
+		}
+
+		case GX_LOAD_BP_REG:
+		{
+			if (CutOff(dl, GX_LOAD_BP_REG_SIZE))
+				continue;
+			u32 value = g_VideoData.Read<u32>();
+			dl.commands.push_back({COMMAND_BP, 0, 0, value});
+			LoadBPReg(value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			total_cycles += GX_LOAD_BP_REG_CYCLES;
+			continue;
+		}
+		}
+
+		if ((cmd_byte & GX_DRAW_PRIMITIVES) == 0x80)
+		{
+			if (CutOff(dl, GX_DRAW_PRIMITIVES_SIZE))
+				continue;
+			u32 count = g_VideoData.Read<u16>();
+			if (count == 0)
+			{
+				total_cycles += GX_NOP_CYCLES;
+				continue;
+			}
+
+			VertexLoaderParameters parameters;
+			SetupDraw(parameters, cmd_byte, count, g_VideoData.GetReadPosition(), g_VideoData.size());
+			VertexLoaderBase *loader = VertexLoaderManager::GetVertexLoader(parameters);
+			parameters.needloaderrefresh = false;
+			u32 readsize = 0;
+			u32 writesize = 0;
+			if (!VertexLoaderManager::ConvertVertices(parameters, readsize, writesize))
+			{
+				// The list ends in the middle of the draw, the interpreter stops there too
+				dl.uncacheable = true;
+				break;
+			}
+
+			g_VideoData.ReadSkip(readsize);
+			g_vertex_manager->IncCurrentBufferPointer(writesize);
+			total_cycles += GX_NOP_CYCLES + GX_DRAW_PRIMITIVES_CYCLES * count;
+
+			dl.commands.push_back({COMMAND_DRAW, cmd_byte, (u32)(parameters.source - start), (u32)dl.draws.size()});
+			dl.draws.emplace_back();
+			dl.draws.back().count = count;
+			RecordDraw(dl.draws.back(), parameters, loader, writesize);
+			continue;
+		}
+
+		dl.uncacheable = true;
+		g_VideoData.SetReadPosition(opcode_start, g_VideoData.GetEnd());
+		u32 remaining_cycles = 0;
+		OpcodeDecoder::Run<false, true>(g_VideoData, &remaining_cycles);
+		total_cycles += remaining_cycles;
+	}
+
+	if (dl.uncacheable)
+	{
+		for (Draw &draw : dl.draws)
+			FreeVertices(draw);
+		dl.commands.clear();
+		dl.draws.clear();
+	}
+
+	dl.compiled = true;
+	dl.cycles = total_cycles;
+	*cycles = total_cycles;
+}
+
+// Returns false if the draw didn't fit in what is left of the list
+static bool ReplayDraw(Draw &draw, u8 cmd_byte, u8 *source, u8 *end)
+{
+	VertexLoaderParameters parameters;
+	SetupDraw(parameters, cmd_byte, draw.count, source, end - source);
+	VertexLoaderBase *loader = VertexLoaderManager::GetVertexLoader(parameters);
+	parameters.needloaderrefresh = false;
+
+	if (!parameters.skip_draw && draw.loader == loader && ArraysUnchanged(draw))
+	{
+		u32 posmtx = g_main_cp_state.matrix_index_a.PosNormalMtxIdx;
+		if (draw.posmtx_from_cp && draw.posmtx != posmtx)
+		{
+			const u32 stride = loader->m_native_stride;
+			const u32 offset = loader->m_native_vtx_decl.posmtx.offset;
+			for (u32 i = 0; i < draw.native_count; i++)
+				std::memcpy(&draw.vertices[i * stride + offset], &posmtx, sizeof(u32));
+			draw.posmtx = posmtx;
+		}
+
+		VertexLoaderManager::AppendConvertedVertices(loader, parameters.primitive, draw.count, draw.vertices.data(),
+		                                             draw.native_count);
+		draw.misses = 0;
+		s_replayed_draws++;
+		return true;
+	}
+
+	u32 readsize = 0;
+	u32 writesize = 0;
+	if (!VertexLoaderManager::ConvertVertices(parameters, readsize, writesize))
+		return false;
+
+	g_vertex_manager->IncCurrentBufferPointer(writesize);
+	if (parameters.skip_draw || draw.disabled)
+		return true;
+
+	s_converted_draws++;
+	if (++draw.misses >= MAX_DRAW_MISSES)
+	{
+		FreeVertices(draw);
+		draw.disabled = true;
+		return true;
+	}
+
+	RecordDraw(draw, parameters, loader, writesize);
+	return true;
+}
+
+static void Replay(CachedDisplayList &dl)
+{
+	u8 *start = g_VideoData.GetReadPosition();
+	u8 *end = g_VideoData.GetEnd();
+	for (const Command &command : dl.commands)
+	{
+		switch (command.type)
+		{
+		case COMMAND_CP:
+			LoadCPReg<false>(command.sub_cmd, command.value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			break;
+
+		case COMMAND_XF:
+			// XF loads read their data from g_VideoData
+			g_VideoData.SetReadPosition(start + command.offset, end);
+			LoadXFReg(((command.value >> 16) & 15) + 1, command.value & 0xFFFF);
+			INCSTAT(stats.thisFrame.numXFLoads);
+			break;
+
+		case COMMAND_INDEXED_XF:
+			LoadIndexedXF(command.value, command.sub_cmd);
+			break;
+
+		case COMMAND_BP:
+			LoadBPReg(command.value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+
+		case COMMAND_DRAW:
+			if (!ReplayDraw(dl.draws[command.value], command.sub_cmd, start + command.offset, end))
+				return;
+			break;
+		}
+	}
+}
 
 void Init()
 {
+	Clear();
 }
 
 void Shutdown()
 {
+	INFO_LOG(VIDEO, "Display list cache: %zu lists, %zu vertex bytes, %llu draws replayed, %llu converted again",
+	         s_cache.size(), s_cached_vertex_bytes, (unsigned long long)s_replayed_draws,
+	         (unsigned long long)s_converted_draws);
+	Clear();
 }
 
-void Clear() 
+void Clear()
 {
+	s_cache.clear();
+	s_cached_vertex_bytes = 0;
+	s_replayed_draws = 0;
+	s_converted_draws = 0;
 }
 
 void ProgressiveCleanup()
 {
+	s_frame++;
+	for (auto it = s_cache.begin(); it != s_cache.end();)
+	{
+		if (s_frame - it->second.last_frame > MAX_IDLE_FRAMES)
+		{
+			ResetList(it->second);
+			it = s_cache.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
 }
-}  // namespace
 
-// NOTE - outside the namespace on purpose.
-bool HandleDisplayList(u32 address, u32 size)
+bool HandleDisplayList(u32 address, u32 size, u32 *cycles)
 {
-	return false;
-}
+	if (!g_ActiveConfig.bDisplayListCache || g_bRecordFifoData || BoundingBox::active || size == 0)
+		return false;
 
-void IncrementCheckContextId()
-{
+	// The converted vertices depend on the vertex format the list starts with, a list drawn with
+	// different formats gets an entry for each
+	u64 vertex_state =
+	    XXH64(g_main_cp_state.vtx_attr, sizeof(g_main_cp_state.vtx_attr), g_main_cp_state.vtx_desc.Hex);
+	u64 content_hash = XXH64(g_VideoData.GetReadPosition(), size, 0);
+	u64 key = vertex_state ^ (((u64)address << 32) | size);
+
+	CachedDisplayList &dl = s_cache[key];
+	if (dl.calls == 0 || dl.address != address || dl.size != size || dl.vertex_state != vertex_state ||
+	    dl.content_hash != content_hash)
+	{
+		// Only lists that are called again unchanged are worth keeping
+		ResetList(dl);
+		dl.address = address;
+		dl.size = size;
+		dl.vertex_state = vertex_state;
+		dl.content_hash = content_hash;
+		dl.calls = 1;
+		dl.last_frame = s_frame;
+		return false;
+	}
+
+	dl.calls++;
+	dl.last_frame = s_frame;
+	if (dl.uncacheable)
+		return false;
+
+	if (!dl.compiled)
+	{
+		Compile(dl, cycles);
+		return true;
+	}
+
+	Replay(dl);
+	*cycles = dl.cycles;
+	INCSTAT(stats.thisFrame.numDListsCached);
+	return true;
 }
+} // namespace DLCache
@@ -38,6 +38,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
 
@@ -374,13 +375,23 @@ public:
 		std::string profile_filename = StringFromFormat("%s%s.usage",
 			File::GetUserPath(D_SHADERUIDCACHE_IDX).c_str(),
 			filename.c_str());
+		// Profiles shipped in Sys seed the first session of a game, they are written like any other
+		// per game profile
+		std::string seed_profile_filename = StringFromFormat("%s" SHADERUIDCACHE_DIR DIR_SEP "%s.usage",
+			File::GetSysDirectory().c_str(),
+			filename.c_str());
 		bool profile_exists = File::Exists(profile_filename);
+		bool seed_profile_exists = File::Exists(seed_profile_filename);
 		bool global_profile_exists = File::Exists(global_profile_filename);
 		ObjectUsageProfiler<Tobj, TCaterogry, TInfo, TobjHasher>* output = new ObjectUsageProfiler<Tobj, TCaterogry, TInfo, TobjHasher>(version);
 		if (profile_exists)
 		{
 			output->ReadFromFile(profile_filename);
 		}
+		else if (seed_profile_exists)
+		{
+			output->ReadFromFile(seed_profile_filename);
+		}
 		else if (global_profile_exists)
 		{
 			output->ReadFromFile(global_profile_filename, true);
@@ -21,6 +21,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/Statistics.h"
@@ -62,7 +63,9 @@ __forceinline u32 InterpretDisplayList(u32 address, u32 size)
 
 		// temporarily swap dl and non-dl (small "hack" for the stats)
 		Statistics::SwapDL();
-		OpcodeDecoder::Run<false, false>(g_VideoData, &cycles);
+		// Commands cut off by the end of the list aren't run
+		if (!DLCache::HandleDisplayList(address, size, &cycles))
+			OpcodeDecoder::Run<false, true>(g_VideoData, &cycles);
 		INCSTAT(stats.thisFrame.numDListsCalled);
 		// un-swap
 		Statistics::SwapDL();
@@ -81,7 +84,7 @@ __forceinline void InterpretDisplayListPreprocess(u32 address, u32 size)
 	if (startAddress != nullptr)
 	{
 		DataReader dlist_reader(startAddress, startAddress + size);
-		OpcodeDecoder::Run<true, false>(dlist_reader, nullptr);
+		OpcodeDecoder::Run<true, true>(dlist_reader, nullptr);
 	}
 }
 
@@ -298,7 +301,8 @@ u8* Run(DataReader& reader, u32* cycles)
 					parameters.skip_draw = xfmem.viewport.wd == 0.0f
 						|| xfmem.viewport.ht == 0.0f
 						|| (bpmem.scissorBR.x + 1 - bpmem.scissorTL.x) == 0
-						|| (bpmem.scissorBR.y + 1 - bpmem.scissorTL.y) == 0;
+						|| (bpmem.scissorBR.y + 1 - bpmem.scissorTL.y) == 0
+						|| (!is_preprocess && Fifo::SkipResimulatedDraw());
 					parameters.VtxDesc = &state.vtx_desc;
 					parameters.VtxAttr = &state.vtx_attr[vtx_attr_group];
 					parameters.source = reader.GetReadPosition();
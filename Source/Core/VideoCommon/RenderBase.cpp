@@ -53,6 +53,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/DLCache.h"
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/GeometryShaderManager.h"
@@ -871,6 +872,7 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
 		m_fps_counter.Update();
 
 	frameCount++;
+	DLCache::ProgressiveCleanup();
 	GFX_DEBUGGER_PAUSE_AT(NEXT_FRAME, true);
 
 	// Begin new frame
@@ -56,6 +56,7 @@ std::string Statistics::ToString()
 	str += StringFromFormat("dshaders alive: %i\n", stats.numDomainShadersAlive);
 	str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
+	str += StringFromFormat("dlists from cache: %i\n", stats.thisFrame.numDListsCached);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
@@ -49,6 +49,7 @@ struct Statistics
 		int numDrawCalls;
 
 		int numDListsCalled;
+		int numDListsCached;
 
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
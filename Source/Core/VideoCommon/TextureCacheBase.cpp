@@ -8,6 +8,8 @@
 #include <utility>
 
 #include "Common/Align.h"
+#include "Common/CommonPaths.h"
+#include "Common/CPUDetect.h"
 #include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
@@ -17,6 +19,7 @@
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/AsyncTextureScaler.h"
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/HiresTextures.h"
@@ -24,7 +27,7 @@
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/SamplerCommon.h"
 #include "VideoCommon/TextureCacheBase.h"
-#include "VideoCommon/TextureScalerCommon.h"
+#include "VideoCommon/TextureHasher.h"
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/TextureUtil.h"
 #include "VideoCommon/VideoCommon.h"
@@ -60,7 +63,7 @@ TextureCacheBase::TextureCacheBase()
 	SetHash64Function();
 	texture_pool_memory_usage = 0;
 	UnbindTextures();
-	m_scaler = std::make_unique<TextureScaler>();
+	m_hasher = std::make_unique<TextureHasher>(g_ActiveConfig.iTextureHashThreads);
 }
 
 void TextureCacheBase::Invalidate()
@@ -74,6 +77,8 @@ void TextureCacheBase::Invalidate()
 	}
 	textures_by_address.clear();
 	textures_by_hash.clear();
+	if (m_scaler)
+		m_scaler->Clear();
 }
 
 TextureCacheBase::~TextureCacheBase()
@@ -93,6 +98,7 @@ TextureCacheBase::~TextureCacheBase()
 		TextureCacheBase::temp = nullptr;
 	}
 	m_scaler.reset();
+	m_hasher.reset();
 }
 
 void TextureCacheBase::OnConfigChanged(VideoConfig& config)
@@ -119,6 +125,10 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 		
 	}
 
+	// Made again on the next scaled texture, with or without the disk cache
+	if (config.bTexScalingCache != backup_config.scaling_cache)
+		m_scaler.reset();
+
 	if ((config.iStereoMode > 0) != backup_config.stereo_3d ||
 		config.bStereoEFBMonoDepth != backup_config.efb_mono_depth)
 	{
@@ -142,6 +152,7 @@ void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
 	backup_config.scaling_factor = config.iTexScalingFactor;
 	backup_config.scaling_mode = config.iTexScalingType;
 	backup_config.scaling_deposterize = config.bTexDeposterize;
+	backup_config.scaling_cache = config.bTexScalingCache;
 	backup_config.gpu_texture_decoding = config.bEnableGPUTextureDecoding;
 }
 
@@ -557,11 +568,15 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 		FifoRecorder::GetInstance().UseMemory(address, texture_size + additional_mips_size, MemoryUpdate::TEXTURE_MAP);
 
 	// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)	
-	tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	const u32 samples = g_ActiveConfig.iSafeTextureCache_ColorSamples;
+	if (from_tmem)
+		tex_hash = m_hasher->Hash(src_data, static_cast<u32>(src_data - texMem), texture_size, samples, false);
+	else
+		tex_hash = m_hasher->Hash(src_data, address, texture_size, samples);
 	u32 palette_size = std::min(TexDecoder_GetPaletteSize(texformat), TMEM_SIZE - tlutaddr);
 	if (isPaletteTexture)
 	{
-		tlut_hash = GetHash64(&texMem[tlutaddr], palette_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+		tlut_hash = m_hasher->Hash(&texMem[tlutaddr], tlutaddr, palette_size, samples, false);
 		full_hash = tex_hash ^ tlut_hash;
 	}
 	else
@@ -640,6 +655,12 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 			if (entry->hash == (full_hash) && entry->format == full_format && entry->native_levels >= tex_levels &&
 				entry->native_width == nativeW && entry->native_height == nativeH)
 			{
+				// The scaled version is done, replace the native one with it below
+				if (entry->scale_key && GetScaler().IsReady(entry->scale_key))
+				{
+					iter = InvalidateTexture(iter);
+					continue;
+				}
 				entry = DoPartialTextureUpdates(iter->second, tlutaddr, tlutfmt, palette_size);
 				return ReturnEntry(stage, entry);
 			}
@@ -686,6 +707,14 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 			if (entry->format == full_format && entry->native_levels >= tex_levels &&
 				entry->native_width == nativeW && entry->native_height == nativeH)
 			{
+				if (entry->scale_key && GetScaler().IsReady(entry->scale_key))
+				{
+					TexAddrCache::iterator addr_iter = GetTexCacheIter(entry);
+					if (addr_iter == oldest_entry)
+						temp_frameCount = 0x7fffffff;
+					InvalidateTexture(addr_iter);
+					break;
+				}
 				entry = DoPartialTextureUpdates(hash_iter->second, tlutaddr, tlutfmt, palette_size);
 				return ReturnEntry(stage, entry);
 			}
@@ -758,6 +787,53 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 		g_texture_cache->SupportsGPUTextureDecode(static_cast<TextureFormat>(texformat),
 			static_cast<TlutFormat>(tlutfmt)) && !(from_tmem && texformat == GX_TF_RGBA8);
 
+	// Scaled textures are decoded before the entry is made, the scaled version is looked up by the
+	// decoded texels. Until the scaler is done with it, the entry holds the native texture.
+	AsyncTextureScaler::Texture scale_source;
+	AsyncTextureScaler::Texture scaled;
+	u64 scale_key = 0;
+	if (use_scaling)
+	{
+		const u8* level_src_data = src_data;
+		const u8* ptr_even = nullptr;
+		const u8* ptr_odd = nullptr;
+		if (from_tmem)
+		{
+			ptr_even = &texMem[bpmem.tex[stage / 4].texImage1[stage % 4].tmem_even * TMEM_LINE_SIZE + texture_size];
+			ptr_odd = &texMem[bpmem.tex[stage / 4].texImage2[stage % 4].tmem_odd * TMEM_LINE_SIZE];
+		}
+		for (u32 level = 0; level != texLevels; ++level)
+		{
+			const u32 mip_width = TextureUtil::CalculateLevelSize(width, level);
+			const u32 mip_height = TextureUtil::CalculateLevelSize(height, level);
+			const u32 expanded_mip_width = Common::AlignUpSizePow2(mip_width, bsw);
+			const u32 expanded_mip_height = Common::AlignUpSizePow2(mip_height, bsh);
+			const u8*& mip_src_data = (from_tmem && level != 0)
+				? ((level % 2) ? ptr_odd : ptr_even)
+				: level_src_data;
+			u32* texels = reinterpret_cast<u32*>(TextureCacheBase::temp);
+			if (level == 0 && texformat == GX_TF_RGBA8 && from_tmem)
+			{
+				TexDecoder_DecodeRGBA8FromTmem(texels, src_data, ptr_odd, expanded_mip_width, expanded_mip_height);
+			}
+			else
+			{
+				TexDecoder_Decode(TextureCacheBase::temp, mip_src_data, expanded_mip_width,
+					expanded_mip_height, texformat, tlutaddr,
+					static_cast<TlutFormat>(tlutfmt), true, false);
+			}
+			mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
+			scale_source.push_back({mip_width, mip_height, expanded_mip_width,
+				std::vector<u32>(texels, texels + expanded_mip_width * mip_height)});
+		}
+
+		const AsyncTextureScaler::Settings settings = {
+			g_ActiveConfig.iTexScalingType, g_ActiveConfig.iTexScalingFactor, g_ActiveConfig.bTexDeposterize};
+		scale_key = AsyncTextureScaler::GetKey(scale_source, settings);
+		if (GetScaler().Fetch(scale_key, scale_source, settings, !g_ActiveConfig.bTexScalingAsync, &scaled))
+			scale_key = 0;
+	}
+
 	// create the entry/texture
 	TCacheEntryConfig config;
 	config.width = width;
@@ -768,9 +844,12 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	
 	if (use_scaling)
 	{
-		config.width *= g_ActiveConfig.iTexScalingFactor;
-		config.height *= g_ActiveConfig.iTexScalingFactor;
 		config.pcformat = PC_TEX_FMT_RGBA32;
+		if (!scaled.empty())
+		{
+			config.width = scaled[0].width;
+			config.height = scaled[0].height;
+		}
 	}
 	TCacheEntryBase* entry = AllocateTexture(config);
 	GFX_DEBUGGER_PAUSE_AT(NEXT_NEW_TEXTURE, true);
@@ -784,8 +863,9 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 
 	entry->SetGeneralParameters(address, texture_size, full_format);
 	entry->SetDimensions(nativeW, nativeH, tex_levels);
-	entry->SetHiresParams(!!hires_tex, basename, use_scaling, !!hires_tex && hires_tex->emissive_in_color);
+	entry->SetHiresParams(!!hires_tex, basename, !scaled.empty(), !!hires_tex && hires_tex->emissive_in_color);
 	entry->SetHashes(full_hash, tex_hash);
+	entry->scale_key = scale_key;
 	entry->is_efb_copy = false;
 
 	// load texture
@@ -814,6 +894,17 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 			}
 		}
 	}
+	else if (use_scaling)
+	{
+		const AsyncTextureScaler::Texture& levels = scaled.empty() ? scale_source : scaled;
+		for (u32 level = 0; level != levels.size(); ++level)
+		{
+			entry->Load(reinterpret_cast<const u8*>(levels[level].data.data()), levels[level].width,
+				levels[level].height, levels[level].expanded_width, level);
+			if (g_ActiveConfig.bDumpTextures)
+				DumpTexture(entry, basename, level);
+		}
+	}
 	else
 	{
 		const u8* ptr_even = NULL;
@@ -835,9 +926,6 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 		if (!decode_on_gpu)
 		{
 			u8* texturedata = TextureCacheBase::temp;
-			u32 twidth = width;
-			u32 theight = height;
-			u32 texpandedWidth = expandedWidth;
 			if (texformat == GX_TF_RGBA8 && from_tmem)
 			{
 				TexDecoder_DecodeRGBA8FromTmem(reinterpret_cast<u32*>(texturedata),
@@ -851,14 +939,7 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 					PC_TEX_FMT_RGBA32 == config.pcformat,
 					config.pcformat >= PC_TEX_FMT_DXT1);
 			}
-			if (use_scaling)
-			{
-				texturedata = reinterpret_cast<u8*>(m_scaler->Scale((u32*)texturedata, expandedWidth, height));
-				twidth *= g_ActiveConfig.iTexScalingFactor;
-				theight *= g_ActiveConfig.iTexScalingFactor;
-				texpandedWidth *= g_ActiveConfig.iTexScalingFactor;
-			}
-			entry->Load(texturedata, twidth, theight, texpandedWidth, 0);
+			entry->Load(texturedata, width, height, expandedWidth, 0);
 		}
 		if (g_ActiveConfig.bDumpTextures)
 		{
@@ -888,22 +969,12 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 			else
 			{
 				u8* texturedata = TextureCacheBase::temp;
-				u32 twidth = mip_width;
-				u32 theight = mip_height;
-				u32 texpandedWidth = expanded_mip_width;
 				TexDecoder_Decode(texturedata, mip_src_data, expanded_mip_width,
 					expanded_mip_height, texformat, tlutaddr,
 					static_cast<TlutFormat>(tlutfmt),
 					PC_TEX_FMT_RGBA32 == config.pcformat,
 					config.pcformat >= PC_TEX_FMT_DXT1);
-				if (use_scaling)
-				{
-					texturedata = reinterpret_cast<u8*>(m_scaler->Scale((u32*)texturedata, expandedWidth, height));
-					twidth *= g_ActiveConfig.iTexScalingFactor;
-					theight *= g_ActiveConfig.iTexScalingFactor;
-					texpandedWidth *= g_ActiveConfig.iTexScalingFactor;
-				}
-				entry->Load(texturedata, twidth, theight, texpandedWidth, level);
+				entry->Load(texturedata, mip_width, mip_height, expanded_mip_width, level);
 			}
 			mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
 
@@ -919,7 +990,7 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 }
 
 void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32 dstStride, bool is_depth_copy,
-	const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf)
+	const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf, bool ram_only)
 {
 	// Emulation methods:
 	// 
@@ -1288,10 +1359,11 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 		copy_to_ram = copy_to_ram || ((tex_w == 64 || tex_w == 128 || tex_w == 256) && !isIntensity && tex_h != 1 && (dstFormat == 6 || dstFormat == 32));
 	}
 
-	bool copy_to_vram = true;
+	// A copy nothing was drawn for leaves no texture behind, only its zeroed memory
+	bool copy_to_vram = !ram_only;
 	// Only apply triggered post-processing on specific formats, to avoid false positives.
 	// Skip depth copies, single-channel textures (basically RGB565/RGB5A3/RGBA8 only)
-	if (g_ActiveConfig.backend_info.bSupportsPostProcessing && g_renderer->GetPostProcessor())
+	if (copy_to_vram && g_ActiveConfig.backend_info.bSupportsPostProcessing && g_renderer->GetPostProcessor())
 	{
 		if (!is_depth_copy && !isIntensity && dstFormat >= 4 && dstFormat <= 6)
 		{
@@ -1434,6 +1506,7 @@ void TextureCacheBase::DisposeTexture(TCacheEntryBase* entry)
 	entry->DestroyAllReferences();
 
 	entry->frameCount = FRAMECOUNT_INVALID;
+	entry->scale_key = 0;
 
 	texture_pool.emplace(entry->config, entry);
 }
@@ -1453,6 +1526,22 @@ TextureCacheBase::FindMatchingTextureFromPool(const TCacheEntryConfig& config)
 	return matching_iter != range.second ? matching_iter : texture_pool.end();
 }
 
+AsyncTextureScaler& TextureCacheBase::GetScaler()
+{
+	if (!m_scaler)
+	{
+		std::string cache_dir;
+		if (g_ActiveConfig.bTexScalingCache)
+		{
+			cache_dir = File::GetUserPath(D_CACHE_IDX) + "ScaledTextures" DIR_SEP +
+				SConfig::GetInstance().GetGameID() + DIR_SEP;
+		}
+		// Leaves the other half of the cores to the emulation
+		m_scaler = std::make_unique<AsyncTextureScaler>(cache_dir, std::max(cpu_info.num_cores / 2, 1));
+	}
+	return *m_scaler;
+}
+
 TextureCacheBase::TexAddrCache::iterator TextureCacheBase::GetTexCacheIter(TextureCacheBase::TCacheEntryBase* entry)
 {
 	auto iter_range = textures_by_address.equal_range(entry->addr);
@@ -1533,28 +1622,14 @@ void TextureCacheBase::TCacheEntryBase::SetEfbCopy(u32 stride)
 u64 TextureCacheBase::TCacheEntryBase::CalculateHash() const
 {
 	u8* ptr = Memory::GetPointer(addr);
+	TextureHasher& hasher = *g_texture_cache->m_hasher;
 	if (memory_stride == BytesPerRow())
 	{
-		return GetHash64(ptr, size_in_bytes, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+		return hasher.Hash(ptr, addr, size_in_bytes, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 	}
 	else
 	{
-		u32 blocks = NumBlocksY();
-		u64 temp_hash = size_in_bytes;
-
-		u32 samples_per_row = 0;
-		if (g_ActiveConfig.iSafeTextureCache_ColorSamples != 0)
-		{
-			// Hash at least 4 samples per row to avoid hashing in a bad pattern, like just on the left side of the efb copy
-			samples_per_row = std::max(g_ActiveConfig.iSafeTextureCache_ColorSamples / blocks, 4u);
-		}
-
-		for (u32 i = 0; i < blocks; i++)
-		{
-			// Multiply by a prime number to mix the hash up a bit. This prevents identical blocks from canceling each other out
-			temp_hash = (temp_hash * 397) ^ GetHash64(ptr, BytesPerRow(), samples_per_row);
-			ptr += memory_stride;
-		}
-		return temp_hash;
+		return hasher.HashStrided(ptr, BytesPerRow(), memory_stride, NumBlocksY(), size_in_bytes,
+		                          g_ActiveConfig.iSafeTextureCache_ColorSamples);
 	}
 }
@@ -19,7 +19,8 @@
 #include "VideoCommon/VideoCommon.h"
 
 struct VideoConfig;
-class TextureScaler;
+class AsyncTextureScaler;
+class TextureHasher;
 
 enum TextureCacheParams
 {
@@ -131,6 +132,8 @@ public:
 		s32 frameCount = {};
 		u64 hash = {};
 		u64 base_hash = {};
+		// Key of the scaled version while it is still being made, the entry holds the native texture until then
+		u64 scale_key = {};
 
 		// Keep an iterator to the entry in textures_by_hash, so it does not need to be searched when removing the cache entry
 		std::multimap<u64, TCacheEntryBase*>::iterator textures_by_hash_iter;
@@ -263,8 +266,10 @@ public:
 	TCacheEntryBase* Load(const u32 stage);
 	void UnbindTextures();
 	virtual void BindTextures();
+	// With ram_only, only zeroes the copy in guest RAM and invalidates the textures it overlaps
 	void CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32 dstStride,
-		bool is_depth_copy, const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf);
+		bool is_depth_copy, const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf,
+		bool ram_only = false);
 	u8* GetTemporalBuffer()
 	{
 		return temp;
@@ -292,6 +297,7 @@ private:
 	TCacheEntryBase* DoPartialTextureUpdates(TCacheEntryBase* entry_to_update, u32 tlutaddr, u32 tlutfmt, u32 palette_size);
 	TextureCacheBase::TCacheEntryBase* ApplyPaletteToEntry(TCacheEntryBase* entry, u32 tlutaddr, u32 tlutfmt, u32 palette_size);
 	void DumpTexture(TCacheEntryBase* entry, std::string basename, u32 level);
+	AsyncTextureScaler& GetScaler();
 
 	TexPool::iterator FindMatchingTextureFromPool(const TCacheEntryConfig& config);
 	TexAddrCache::iterator GetTexCacheIter(TCacheEntryBase* entry);
@@ -323,10 +329,12 @@ private:
 		s32 scaling_mode;
 		s32 scaling_factor;
 		bool scaling_deposterize;
+		bool scaling_cache;
 		bool gpu_texture_decoding;
 	};
 	BackupConfig backup_config = {};
-	std::unique_ptr<TextureScaler> m_scaler;
+	std::unique_ptr<AsyncTextureScaler> m_scaler;
+	std::unique_ptr<TextureHasher> m_hasher;
 };
 
 extern std::unique_ptr<TextureCacheBase> g_texture_cache;
\ No newline at end of file
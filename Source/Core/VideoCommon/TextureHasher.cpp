@@ -0,0 +1,157 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include <xxhash.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/ThreadPool.h"
+#include "Core/HW/Memmap.h"
+#include "VideoCommon/TextureHasher.h"
+
+namespace
+{
+constexpr u32 PAGE_SIZE = Memory::DIRTY_PAGE_SIZE;
+// Below this many bytes to hash, waking the workers costs more than it saves
+constexpr u32 PARALLEL_THRESHOLD = 256 * 1024;
+// Bytes handed to a worker at a time
+constexpr u32 SLICE_SIZE = 16 * PAGE_SIZE;
+}
+
+TextureHasher::TextureHasher(int threads)
+{
+	// Hashing runs into the memory bandwidth long before every core is busy
+	if (threads <= 0)
+		threads = std::min(cpu_info.num_cores, 4);
+	if (threads > 1)
+	{
+		m_workers = std::make_unique<Common::WorkerGroup>(threads - 1);
+		INFO_LOG(VIDEO, "Hashing large textures on %d threads", threads);
+	}
+	m_page_hashes.resize(Memory::DIRTY_PAGE_COUNT, {0, 0});
+}
+
+TextureHasher::~TextureHasher()
+{
+}
+
+u64 TextureHasher::Hash(const u8* src, u32 address, u32 size, u32 samples, bool in_ram)
+{
+	if (samples != 0)
+		return GetHash64(src, size, samples);
+
+	const u64 end = static_cast<u64>(address) + size;
+	const bool use_cache = in_ram && Memory::IsDirtyPageTrackingEnabled() && end <= Memory::RAM_SIZE;
+	// Taken before hashing, writes racing the hashing are tagged with this epoch or a later one
+	const u32 epoch = use_cache ? Memory::GetDirtyPageEpoch() : 0;
+
+	// With page hashes kept, pieces end at the page boundaries of the address, so a page hashes the
+	// same for every texture covering it. Otherwise they are cut from the start of the texture, so
+	// the same data hashes the same wherever it is, as the texture cache expects when it looks for
+	// textures to reuse by hash alone.
+	const u32 skew = use_cache ? address % PAGE_SIZE : 0;
+	const u32 first_page = address / PAGE_SIZE;
+	const u32 num_pieces = size ? static_cast<u32>((static_cast<u64>(skew) + size - 1) / PAGE_SIZE + 1) : 0;
+	m_piece_hashes.resize(num_pieces);
+	m_pending.clear();
+
+	auto piece_range = [&](u32 piece, u32* offset, u32* length) {
+		const u64 piece_start = std::max<u64>(static_cast<u64>(piece) * PAGE_SIZE, skew) - skew;
+		const u64 piece_end = std::min<u64>(static_cast<u64>(piece + 1) * PAGE_SIZE - skew, size);
+		*offset = static_cast<u32>(piece_start);
+		*length = static_cast<u32>(piece_end - piece_start);
+	};
+
+	for (u32 i = 0; i < num_pieces; i++)
+	{
+		u32 offset, length;
+		piece_range(i, &offset, &length);
+		if (use_cache && length == PAGE_SIZE)
+		{
+			// Still good if the page was not written in or after the epoch the hash was taken in
+			const PageHash& cached = m_page_hashes[first_page + i];
+			if (cached.epoch != 0 &&
+			    !Memory::WasPageWrittenSince((first_page + i) * PAGE_SIZE, cached.epoch - 1))
+			{
+				m_piece_hashes[i] = cached.hash;
+				m_stats.pages_reused++;
+				continue;
+			}
+		}
+		m_pending.push_back(i);
+	}
+
+	// Every piece and page entry is only touched by one slice
+	auto hash_piece = [&](u32 piece) {
+		u32 offset, length;
+		piece_range(piece, &offset, &length);
+		const u64 hash = GetHash64(src + offset, length, 0);
+		m_piece_hashes[piece] = hash;
+		if (use_cache && length == PAGE_SIZE)
+			m_page_hashes[first_page + piece] = {hash, epoch};
+	};
+
+	const size_t pending = m_pending.size();
+	if (m_workers && pending * PAGE_SIZE >= PARALLEL_THRESHOLD)
+	{
+		const size_t per_slice = SLICE_SIZE / PAGE_SIZE;
+		m_workers->Run((pending + per_slice - 1) / per_slice, [&](size_t slice) {
+			const size_t last = std::min(pending, (slice + 1) * per_slice);
+			for (size_t i = slice * per_slice; i < last; i++)
+				hash_piece(m_pending[i]);
+		});
+		m_stats.parallel_hashes++;
+	}
+	else
+	{
+		for (u32 piece : m_pending)
+			hash_piece(piece);
+	}
+	m_stats.pages_hashed += pending;
+
+	return XXH64(m_piece_hashes.data(), num_pieces * sizeof(u64), 0, size);
+}
+
+u64 TextureHasher::HashStrided(const u8* src, u32 row_size, u32 stride, u32 rows, u32 total_size, u32 samples)
+{
+	u32 samples_per_row = 0;
+	if (samples != 0)
+	{
+		// Hash at least 4 samples per row to avoid hashing in a bad pattern, like just on the left side of the efb copy
+		samples_per_row = std::max(samples / rows, 4u);
+	}
+
+	m_piece_hashes.resize(rows);
+	auto hash_row = [&](u32 row) {
+		const u8* ptr = src + static_cast<size_t>(row) * stride;
+		m_piece_hashes[row] = GetHash64(ptr, row_size, samples_per_row);
+	};
+
+	if (m_workers && samples == 0 && static_cast<u64>(row_size) * rows >= PARALLEL_THRESHOLD)
+	{
+		const u32 per_slice = std::max(SLICE_SIZE / row_size, 1u);
+		m_workers->Run((rows + per_slice - 1) / per_slice, [&](size_t slice) {
+			const u32 last = std::min<u32>(rows, static_cast<u32>(slice + 1) * per_slice);
+			for (u32 row = static_cast<u32>(slice) * per_slice; row < last; row++)
+				hash_row(row);
+		});
+		m_stats.parallel_hashes++;
+	}
+	else
+	{
+		for (u32 row = 0; row < rows; row++)
+			hash_row(row);
+	}
+
+	u64 temp_hash = total_size;
+	for (u32 row = 0; row < rows; row++)
+	{
+		// Multiply by a prime number to mix the hash up a bit. This prevents identical blocks from canceling each other out
+		temp_hash = (temp_hash * 397) ^ m_piece_hashes[row];
+	}
+	return temp_hash;
+}
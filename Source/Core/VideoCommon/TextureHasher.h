@@ -0,0 +1,61 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+class WorkerGroup;
+}
+
+// Hashes textures for the texture cache. Sampled hashes (samples != 0) are left to GetHash64, full
+// hashes are the XXH64 of the GetHash64 hashes of every 4 KiB piece of the texture:
+// - large textures have their pieces hashed in parallel
+// - while dirty page tracking is on (rollback netplay), pieces are the pages of guest memory the
+//   texture covers instead. The hash of a whole page is kept together with the write epoch it was
+//   taken in, and reused as long as the page was not written since. The same data then only hashes
+//   the same at addresses with the same offset into a page.
+// Both the texture and the EFB copy paths have to go through the same hasher, since EFB copies
+// are looked up by the hash of the memory they were written to.
+class TextureHasher
+{
+public:
+	struct Stats
+	{
+		u64 pages_hashed = 0;
+		u64 pages_reused = 0;
+		u64 parallel_hashes = 0;
+	};
+
+	// threads counts the calling thread too, 0 picks one from the number of cores
+	explicit TextureHasher(int threads);
+	~TextureHasher();
+
+	// Hash of size bytes of texture data. address is the physical address the data was read from,
+	// page hashes are only reused for data in main RAM. Data from TMEM passes its TMEM offset.
+	u64 Hash(const u8* src, u32 address, u32 size, u32 samples, bool in_ram = true);
+	// Hash of rows of row_size bytes, stride bytes apart, like EFB copies with a padded stride
+	u64 HashStrided(const u8* src, u32 row_size, u32 stride, u32 rows, u32 total_size, u32 samples);
+
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = Stats(); }
+
+private:
+	struct PageHash
+	{
+		u64 hash;
+		u32 epoch; // 0 if there is no hash for the page
+	};
+
+	std::unique_ptr<Common::WorkerGroup> m_workers;
+	std::vector<PageHash> m_page_hashes;
+	std::vector<u64> m_piece_hashes;
+	std::vector<u32> m_pending;
+	Stats m_stats;
+};
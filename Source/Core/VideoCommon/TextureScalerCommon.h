@@ -20,15 +20,23 @@
 #include "Common/CommonTypes.h"
 #include "Common/MemoryUtil.h"
 
+#include <functional>
+#include <memory>
 #include <vector>
 
+namespace Common
+{
+class WorkerGroup;
+}
+
 class TextureScaler
 {
 public:
-	TextureScaler();
+	// threads counts the calling thread too, large textures are split across them by rows
+	explicit TextureScaler(int threads = 1);
 	~TextureScaler();
 
-	u32* Scale(u32* data, int width, int height);
+	u32* Scale(u32* data, int width, int height, int type, int factor, bool deposterize);
 
 	enum
 	{
@@ -36,6 +44,8 @@ public:
 	};
 
 private:
+	// Calls func on slices of the rows [lower, upper), on the worker threads when there are enough
+	void Loop(const std::function<void(int, int)>& func, int lower, int upper);
 
 	void ScaleXBRZ(int factor, u32* source, u32* dest, int width, int height);
 	void ScaleBilinear(int factor, u32* source, u32* dest, int width, int height);
@@ -57,4 +67,5 @@ private:
 	// maximum is (100 MB total for a 512 by 512 texture with scaling factor 5 and hybrid scaling)
 	// of course, scaling factor 5 is totally silly anyway
 	Common::SimpleBuf<u32> bufInput, bufDeposter, bufOutput, bufTmp1, bufTmp2, bufTmp3;
+	std::unique_ptr<Common::WorkerGroup> m_workers;
 };
@@ -3,17 +3,21 @@
 // Refer to the license.txt file included.
 // Modified for Ishiiruka by Tino
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 
+#include "Common/FileUtil.h"
 #include "Common/ThreadPool.h"
 #include "Common/StringUtil.h"
 
+#include "VideoCommon/DLCache.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -70,6 +74,55 @@ struct codeentry
 };
 }
 
+// Raw vertex data seen by each loader while dumping loaders, so they can be benchmarked on real
+// streams. Only the start of every stream is kept.
+struct CapturedStream
+{
+	u32 strides[12];
+	u32 vertex_size;
+	std::vector<u8> data;
+};
+static std::map<VertexLoaderUID, CapturedStream> s_captured_streams;
+static const size_t MAX_CAPTURED_BYTES_PER_LOADER = 256 * 1024;
+static const u32 CAPTURED_STREAMS_MAGIC = 0x58545647; // "GVTX"
+static const u32 CAPTURED_STREAMS_VERSION = 1;
+
+static void CaptureVertices(const VertexLoaderParameters &parameters, u32 vertex_size)
+{
+	if (vertex_size == 0)
+		return;
+	CapturedStream &stream = s_captured_streams[VertexLoaderUID(*parameters.VtxDesc, *parameters.VtxAttr)];
+	if (stream.data.empty())
+	{
+		memcpy(stream.strides, g_main_cp_state.array_strides, sizeof(stream.strides));
+		stream.vertex_size = vertex_size;
+	}
+	size_t size = std::min<size_t>(parameters.count * vertex_size, MAX_CAPTURED_BYTES_PER_LOADER - stream.data.size());
+	size -= size % vertex_size;
+	stream.data.insert(stream.data.end(), parameters.source, parameters.source + size);
+}
+
+// G_<gameid>_vtx.bin: magic, version and stream count, then for every stream the loader uid words,
+// the array strides, the raw vertex size, the data size and the data itself.
+static void DumpCapturedStreams()
+{
+	std::string filename = StringFromFormat("%sG_%s_vtx.bin", File::GetUserPath(D_DUMP_IDX).c_str(), last_game_code.c_str());
+	File::IOFile file(filename, "wb");
+	const u32 header[3] = { CAPTURED_STREAMS_MAGIC, CAPTURED_STREAMS_VERSION, (u32)s_captured_streams.size() };
+	file.WriteArray(header, 3);
+	for (const auto &stream : s_captured_streams)
+	{
+		u32 uid[4];
+		for (u32 i = 0; i < 4; i++)
+			uid[i] = stream.first.GetElement(i);
+		const u32 sizes[2] = { stream.second.vertex_size, (u32)stream.second.data.size() };
+		file.WriteArray(uid, 4);
+		file.WriteArray(stream.second.strides, 12);
+		file.WriteArray(sizes, 2);
+		file.WriteBytes(stream.second.data.data(), stream.second.data.size());
+	}
+}
+
 static std::string To_HexString(u32 in)
 {
 	char hexString[2 * sizeof(u32) + 8];
@@ -135,7 +188,7 @@ static void DumpLoadersCode()
 		sourcecode.append(iter->name);
 		sourcecode.append("\n// num_verts= ");
 		sourcecode.append(std::to_string(iter->num_verts));
-		sourcecode.append("#if _M_SSE >= 0x301\n");
+		sourcecode.append("\n#if _M_SSE >= 0x301\n");
 		sourcecode.append("\tif (cpu_info.bSSSE3)\n");
 		sourcecode.append("\t{\n");
 		sourcecode.append("\t\tpvlmap[");
@@ -194,8 +247,14 @@ void Init()
 
 void Shutdown()
 {
+	// The display list cache points at the loaders, backends that don't run CleanupShared shut
+	// the loaders down too
+	DLCache::Clear();
 	if (s_vertex_loader_map.size() > 0 && g_ActiveConfig.bDumpVertexLoaders)
 		DumpLoadersCode();
+	if (s_captured_streams.size() > 0)
+		DumpCapturedStreams();
+	s_captured_streams.clear();
 	s_vertex_loader_map.clear();
 	s_native_vertex_map.clear();
 }
@@ -275,7 +334,7 @@ inline void UpdateLoader(const VertexLoaderParameters &parameters)
 	g_main_cp_state.last_id = parameters.vtx_attr_group;
 }
 
-bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize)
+VertexLoaderBase* GetVertexLoader(const VertexLoaderParameters &parameters)
 {
 	if (parameters.needloaderrefresh)
 	{
@@ -286,6 +345,12 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	{
 		loader = loader->GetFallback();
 	}
+	return loader;
+}
+
+bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize)
+{
+	auto loader = GetVertexLoader(parameters);
 	readsize = parameters.count * loader->m_VertexSize;
 	if (parameters.buf_size < readsize)
 		return false;
@@ -305,6 +370,8 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	g_current_components = loader->m_native_components;
 	g_vertex_manager->PrepareForAdditionalData(parameters.primitive, parameters.count, loader->m_native_stride);
 	parameters.destination = g_vertex_manager->GetCurrentBufferPointer();
+	if (g_ActiveConfig.bDumpVertexLoaders)
+		CaptureVertices(parameters, loader->m_VertexSize);
 	s32 finalcount = loader->RunVertices(parameters);
 	writesize = loader->m_native_stride * finalcount;
 	IndexGenerator::AddIndices(parameters.primitive, finalcount);
@@ -313,6 +380,25 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	return true;
 }
 
+void AppendConvertedVertices(VertexLoaderBase *loader, int primitive, u32 count, const u8 *vertices, u32 native_count)
+{
+	NativeVertexFormat *nativefmt = loader->m_native_vertex_format;
+	if (s_current_vtx_fmt != nullptr && s_current_vtx_fmt != nativefmt)
+	{
+		g_vertex_manager->Flush();
+	}
+	s_current_vtx_fmt = nativefmt;
+	g_current_components = loader->m_native_components;
+	g_vertex_manager->PrepareForAdditionalData(primitive, count, loader->m_native_stride);
+	u32 size = loader->m_native_stride * native_count;
+	memcpy(g_vertex_manager->GetCurrentBufferPointer(), vertices, size);
+	g_vertex_manager->IncCurrentBufferPointer(size);
+	loader->m_numLoadedVertices += count;
+	IndexGenerator::AddIndices(primitive, native_count);
+	ADDSTAT(stats.thisFrame.numPrims, native_count);
+	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+}
+
 int GetVertexSize(const VertexLoaderParameters &parameters)
 {
 	if (parameters.needloaderrefresh)
@@ -24,6 +24,12 @@ int GetVertexSize(const VertexLoaderParameters &parameters);
 
 bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize);
 
+// The loader ConvertVertices would use for these parameters
+VertexLoaderBase* GetVertexLoader(const VertexLoaderParameters &parameters);
+
+// Appends vertices that loader converted earlier, without running it again
+void AppendConvertedVertices(VertexLoaderBase *loader, int primitive, u32 count, const u8 *vertices, u32 native_count);
+
 void GetVertexSizeAndComponents(const VertexLoaderParameters &parameters, u32 &vertexsize, u32 &components);
 
 // For debugging
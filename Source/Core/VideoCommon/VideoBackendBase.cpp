@@ -10,6 +10,7 @@
 #include "VideoBackends/DX11/VideoBackend.h"
 #include "VideoBackends/D3D12/VideoBackend.h"
 #endif
+#include "VideoBackends/Null/VideoBackend.h"
 #include "VideoBackends/OGL/VideoBackend.h"
 #include "VideoBackends/Software/VideoBackend.h"
 #include "VideoBackends/Vulkan/VideoBackend.h"
@@ -67,7 +68,7 @@ static bool PlatformSupportsVulkan()
 
 void VideoBackendBase::PopulateList()
 {
-	// D3D11 > D3D12 > D3D9 > OGL > VULKAN > SW
+	// D3D11 > D3D12 > D3D9 > OGL > VULKAN > SW > NULL
 #ifdef _WIN32
 	if (IsWindowsVistaOrGreater())
 	{
@@ -110,6 +111,9 @@ void VideoBackendBase::PopulateList()
 	// Disable software video backend as is currently not working
 	//g_available_video_backends.push_back(std::make_unique<SW::VideoSoftware>());
 
+	// Draws nothing, only for running replays headless as fast as possible
+	g_available_video_backends.push_back(std::make_unique<Null::VideoBackend>());
+
 	for (auto& backend : g_available_video_backends)
 	{
 		if (backend)
@@ -51,6 +51,8 @@ VideoConfig::VideoConfig()
 	bTexDeposterize = false;
 	iTexScalingType = 0;
 	iTexScalingFactor = 2;
+	bTexScalingAsync = true;
+	bTexScalingCache = true;
 	backend_info.bSupportsMultithreading = false;
 	backend_info.bSupportsInternalResolutionFrameDumps = false;
 	bEnableValidationLayer = false;
@@ -89,6 +91,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("UseXFB", &bUseXFB, 0);
 	settings->Get("UseRealXFB", &bUseRealXFB, 0);
 	settings->Get("SafeTextureCacheColorSamples", &iSafeTextureCache_ColorSamples, 128);
+	settings->Get("TextureHashThreads", &iTextureHashThreads, 0);
 #ifdef IS_PLAYBACK
 	settings->Get("ShowFPS", &bShowFPS, false);
 	settings->Get("ShowNetPlayPing", &bShowNetPlayPing, false);
@@ -119,6 +122,8 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("DumpCodec", &sDumpCodec, "");
 	settings->Get("DumpPath", &sDumpPath, "");
 	settings->Get("BitrateKbps", &iBitrateKbps, 2500);
+	settings->Get("DumpQueueFrames", &iDumpQueueFrames, 8);
+	settings->Get("DumpEncoderThreads", &iDumpEncoderThreads, 0);
 	settings->Get("InternalResolutionFrameDumps", &bInternalResolutionFrameDumps, 0);
 	settings->Get("EnablePixelLighting", &bEnablePixelLighting, 0);
 	settings->Get("ForcedLighting", &bForcedLighting, 0);
@@ -157,6 +162,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("SWDumpObjects", &bDumpObjects, false);
 	settings->Get("SWDumpTevStages", &bDumpTevStages, false);
 	settings->Get("SWDumpTevTexFetches", &bDumpTevTextureFetches, false);
+	settings->Get("SWThreads", &iSWThreads, 0);
 	settings->Get("SWDrawStart", &drawStart, 0);
 	settings->Get("SWDrawEnd", &drawEnd, 100000);
 
@@ -175,6 +181,8 @@ void VideoConfig::Load(const std::string& ini_file)
 	enhancements->Get("UseScalingFilter", &bUseScalingFilter, true);
 	enhancements->Get("TextureScalingType", &iTexScalingType, 0);
 	enhancements->Get("TextureScalingFactor", &iTexScalingFactor, 2);
+	enhancements->Get("TextureScalingAsync", &bTexScalingAsync, true);
+	enhancements->Get("TextureScalingCache", &bTexScalingCache, true);
 	enhancements->Get("UseDePosterize", &bTexDeposterize, true);
 	enhancements->Get("Tessellation", &bTessellation, 0);
 	enhancements->Get("TessellationEarlyCulling", &bTessellationEarlyCulling, 0);
@@ -212,6 +220,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("LastStoryEFBToRam", &bLastStoryEFBToRam, false);
 	hacks->Get("ForceLogicOpBlend", &bForceLogicOpBlend, false);
 	hacks->Get("VertexRounding", &bVertexRounding, false);
+	hacks->Get("DisplayListCache", &bDisplayListCache, true);
 	
 
 	// hacks which are disabled by default
@@ -353,6 +362,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Hacks", "BoundingBoxMode", iBBoxMode);
 	CHECK_SETTING("Video_Hacks", "LastStoryEFBToRam", bLastStoryEFBToRam);
 	CHECK_SETTING("Video_Hacks", "VertexRounding", bVertexRounding);
+	CHECK_SETTING("Video_Hacks", "DisplayListCache", bDisplayListCache);
 
 	CHECK_SETTING("Video", "ProjectionHack", iPhackvalue[0]);
 	CHECK_SETTING("Video", "PH_SZNear", iPhackvalue[1]);
@@ -453,6 +463,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("UseXFB", bUseXFB);
 	settings->Set("UseRealXFB", bUseRealXFB);
 	settings->Set("SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
+	settings->Set("TextureHashThreads", iTextureHashThreads);
 	settings->Set("ShowFPS", bShowFPS);
 	settings->Set("ShowNetPlayPing", bShowNetPlayPing);
 	settings->Set("ShowNetPlayMessages", bShowNetPlayMessages);
@@ -479,6 +490,8 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("DumpCodec", sDumpCodec);
 	settings->Set("DumpPath", sDumpPath);
 	settings->Set("BitrateKbps", iBitrateKbps);
+	settings->Set("DumpQueueFrames", iDumpQueueFrames);
+	settings->Set("DumpEncoderThreads", iDumpEncoderThreads);
 	settings->Set("EnablePixelLighting", bEnablePixelLighting);
 	settings->Set("ForcedLighting", bForcedLighting);
 	settings->Set("ForcePhongShading", bForcePhongShading);
@@ -510,6 +523,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("SWDumpObjects", bDumpObjects);
 	settings->Set("SWDumpTevStages", bDumpTevStages);
 	settings->Set("SWDumpTevTexFetches", bDumpTevTextureFetches);
+	settings->Set("SWThreads", iSWThreads);
 	settings->Set("SWDrawStart", drawStart);
 	settings->Set("SWDrawEnd", drawEnd);
 
@@ -528,6 +542,8 @@ void VideoConfig::Save(const std::string& ini_file)
 	enhancements->Set("UseScalingFilter", bUseScalingFilter);
 	enhancements->Set("TextureScalingType", iTexScalingType);
 	enhancements->Set("TextureScalingFactor", iTexScalingFactor);
+	enhancements->Set("TextureScalingAsync", bTexScalingAsync);
+	enhancements->Set("TextureScalingCache", bTexScalingCache);
 	enhancements->Set("UseDePosterize", bTexDeposterize);
 	enhancements->Set("Tessellation", bTessellation);
 	enhancements->Set("TessellationEarlyCulling", bTessellationEarlyCulling);
@@ -561,6 +577,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("LastStoryEFBToRam", bLastStoryEFBToRam);
 	hacks->Set("ForceLogicOpBlend", bForceLogicOpBlend);
 	hacks->Set("VertexRounding", bVertexRounding);
+	hacks->Set("DisplayListCache", bDisplayListCache);
 
 
 	iniFile.Save(ini_file);
@@ -118,6 +118,8 @@ struct VideoConfig final
 	bool bTexDeposterize;
 	int iTexScalingType;
 	int iTexScalingFactor;
+	bool bTexScalingAsync;
+	bool bTexScalingCache;
 	bool bTessellation;
 	bool bTessellationEarlyCulling;
 	int iTessellationDistance;
@@ -161,6 +163,8 @@ struct VideoConfig final
 	bool bFreeLook;
 	bool bBorderlessFullscreen;
 	int iBitrateKbps;
+	int iDumpQueueFrames;
+	int iDumpEncoderThreads;
 	bool bCompileShaderOnStartup;
 
 
@@ -177,7 +181,9 @@ struct VideoConfig final
 	bool bEFBEmulateFormatChanges;
 	bool bSkipEFBCopyToRam;
 	bool bCopyEFBScaled;
+	bool bDisplayListCache;
 	int iSafeTextureCache_ColorSamples;
+	int iTextureHashThreads; // threads hashing large textures including the video thread, 0 for auto
 	int iPhackvalue[4];
 	std::string sPhackvalue[2];
 	float fAspectRatioHackW, fAspectRatioHackH;
@@ -225,6 +231,7 @@ struct VideoConfig final
 	bool bDumpObjects;
 	bool bDumpTevStages;
 	bool bDumpTevTextureFetches;
+	int iSWThreads; // drawing threads including the video thread, 0 for num_cores - 1
 
 	bool bEnableValidationLayer;
 
@@ -659,10 +659,8 @@ inline void decodeDXTBlock(u32 *dst, const DXT1Block *src, u32 pitch)
 	}
 }
 
-inline void decodeDXTBlockRGBA(u32 *dst, const DXT1Block *src, u32 pitch)
+inline void getDXTColorsRGBA(u32 *colors, const DXT1Block *src)
 {
-	// S3TC Decoder (Note: GCN decodes differently from PC so we can't use native support)
-	// Needs more speed.
 	u16 c1 = Common::swap16(src->color1);
 	u16 c2 = Common::swap16(src->color2);
 	u32 blue1 = Convert5To8(c1 & 0x1F);
@@ -671,7 +669,6 @@ inline void decodeDXTBlockRGBA(u32 *dst, const DXT1Block *src, u32 pitch)
 	u32 green2 = Convert6To8((c2 >> 5) & 0x3F);
 	u32 red1 = Convert5To8((c1 >> 11) & 0x1F);
 	u32 red2 = Convert5To8((c2 >> 11) & 0x1F);
-	u32 colors[4];
 	colors[0] = makeRGBA(red1, green1, blue1, 255);
 	colors[1] = makeRGBA(red2, green2, blue2, 255);
 	if (c1 > c2)
@@ -689,6 +686,14 @@ inline void decodeDXTBlockRGBA(u32 *dst, const DXT1Block *src, u32 pitch)
 			(blue1 + blue2 + 1) / 2, 255);
 		colors[3] = makeRGBA(red2, green2, blue2, 0);  // Color2 but transparent
 	}
+}
+
+inline void decodeDXTBlockRGBA(u32 *dst, const DXT1Block *src, u32 pitch)
+{
+	// S3TC Decoder (Note: GCN decodes differently from PC so we can't use native support)
+	// Needs more speed.
+	u32 colors[4];
+	getDXTColorsRGBA(colors, src);
 
 	for (u32 y = 0; y < 4; y++)
 	{
@@ -799,12 +804,19 @@ PC_TexFormat GetPC_TexFormat(u32 texformat, TlutFormat tlutfmt, bool compressed_
 	return fmt;
 }
 
+static bool TexDecoder_Decode_AVX2(u32 * dst, const u8 * src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool bgra);
+
 //switch endianness, unswizzle
 static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool compressed_supported)
 {
 	const u32 Wsteps4 = (width + 3) / 4;
 	const u32 Wsteps8 = (width + 7) / 8;
 
+	// CMPR stays compressed when the backend can sample DXT
+	if (cpu_info.bAVX2 && !(texformat == GX_TF_CMPR && compressed_supported) &&
+		TexDecoder_Decode_AVX2((u32*)dst, src, width, height, texformat, tlutaddr, tlutfmt, true))
+		return PC_TEX_FMT_BGRA32;
+
 	switch (texformat)
 	{
 	case GX_TF_C4:
@@ -1057,6 +1069,331 @@ static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, u32 width, u3
 
 
 
+// AVX2 versions of the formats that show up most, 8 texels a register. They produce exactly the
+// same output as the SSE2/SSSE3 code below. The texture width is a multiple of the block width.
+// They write RGBA, or BGRA for the formats TexDecoder_Decode_real writes as BGRA32.
+
+// Paletted textures smaller than this are left to the code below, converting the whole palette
+// up front costs more than it saves on them
+static const u32 AVX2_MIN_PALETTE_TEXELS = 1024;
+
+static inline u32 swapRB(u32 color)
+{
+	return (color & 0xFF00FF00) | ((color >> 16) & 0xFF) | ((color & 0xFF) << 16);
+}
+
+// The RGBA (or BGRA) colors of the first count palette entries. Entries that would be read from
+// past the end of TMEM are black.
+static void decodeTlutRGBA(u32 *palette, u32 tlutaddr, TlutFormat tlutfmt, u32 count, bool bgra)
+{
+	const u32 in_tmem = tlutaddr < TMEM_SIZE ? std::min(count, (TMEM_SIZE - tlutaddr) / 2) : 0;
+	const u16* tlut = (u16*)(texMem + tlutaddr);
+	for (u32 i = 0; i < in_tmem; i++)
+	{
+		if (tlutfmt == GX_TL_RGB5A3)
+			palette[i] = decode5A3RGBA(Common::swap16(tlut[i]));
+		else if (tlutfmt == GX_TL_IA8)
+			palette[i] = decodeIA8Swapped(tlut[i]);
+		else
+			palette[i] = decode565RGBA(Common::swap16(tlut[i]));
+		if (bgra)
+			palette[i] = swapRB(palette[i]);
+	}
+	for (u32 i = in_tmem; i < count; i++)
+		palette[i] = 0;
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeI4_AVX2(u32 *dst, const u8 *src, u32 width, u32 height)
+{
+	const u32 Wsteps8 = (width + 7) / 8;
+	const __m256i kMask_x0f = _mm256_set1_epi8(0x0f);
+	// Two rows of 8 texels come out as 16 bytes, texels 0-3 of a row go to the low lane and 4-7 to
+	// the high one
+	const __m256i row0 = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+		4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+	const __m256i row1 = _mm256_add_epi8(row0, _mm256_set1_epi8(8));
+	for (u32 y = 0; y < height; y += 8)
+		for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+			for (u32 iy = 0, xStep = 4 * yStep; iy < 8; iy += 2, xStep++)
+			{
+				const __m256i in = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+				const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 4), kMask_x0f);
+				const __m256i lo = _mm256_and_si256(in, kMask_x0f);
+				// One nibble per byte, in texel order, then Convert4To8
+				const __m256i i4 = _mm256_unpacklo_epi8(hi, lo);
+				const __m256i i8 = _mm256_or_si256(i4, _mm256_slli_epi16(i4, 4));
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_shuffle_epi8(i8, row0));
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy + 1) * width + x), _mm256_shuffle_epi8(i8, row1));
+			}
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeI8_AVX2(u32 *dst, const u8 *src, u32 width, u32 height)
+{
+	const u32 Wsteps8 = (width + 7) / 8;
+	const __m256i expand = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+		4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+			for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+			{
+				const __m256i in = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_shuffle_epi8(in, expand));
+			}
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeIA8_AVX2(u32 *dst, const u8 *src, u32 width, u32 height)
+{
+	const u32 Wsteps4 = (width + 3) / 4;
+	// (A I) -> (I I I A), for the first and the second row of the 16 bytes in each lane
+	const __m256i row0 = _mm256_setr_epi8(1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6,
+		1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6);
+	const __m256i row1 = _mm256_add_epi8(row0, _mm256_set1_epi8(8));
+	for (u32 y = 0; y < height; y += 4)
+	{
+		u32 x = 0;
+		u32 yStep = (y / 4) * Wsteps4;
+		// Two blocks side by side make a row of 8 texels
+		for (; x + 8 <= width; x += 8, yStep += 2)
+		{
+			const u8* src2 = src + 32 * yStep;
+			for (u32 iy = 0; iy < 4; iy += 2)
+			{
+				const __m256i in = _mm256_inserti128_si256(
+					_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src2 + 8 * iy))),
+					_mm_loadu_si128((const __m128i*)(src2 + 32 + 8 * iy)), 1);
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_shuffle_epi8(in, row0));
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy + 1) * width + x), _mm256_shuffle_epi8(in, row1));
+			}
+		}
+		if (x < width)
+		{
+			const u8* src2 = src + 32 * yStep;
+			for (u32 iy = 0; iy < 4; iy++)
+			{
+				const __m128i in = _mm_loadl_epi64((const __m128i*)(src2 + 8 * iy));
+				_mm_storeu_si128((__m128i*)(dst + (y + iy) * width + x),
+					_mm_shuffle_epi8(in, _mm256_castsi256_si128(row0)));
+			}
+		}
+	}
+}
+
+// 8 RGB5A3 texels, one in the low half of each 32-bit lane, to RGBA
+FUNCTION_TARGET_AVX2
+static inline __m256i decodeRGB5A3x8_AVX2(__m256i val)
+{
+	const __m256i kMask_x1f = _mm256_set1_epi32(0x1f);
+	const __m256i kMask_x0f = _mm256_set1_epi32(0x0f);
+	const __m256i kMask_x07 = _mm256_set1_epi32(0x07);
+
+	// RGB555, alpha = 0xFF
+	const __m256i r5 = _mm256_and_si256(_mm256_srli_epi32(val, 10), kMask_x1f);
+	const __m256i g5 = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x1f);
+	const __m256i b5 = _mm256_and_si256(val, kMask_x1f);
+	const __m256i r58 = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+	const __m256i g58 = _mm256_or_si256(_mm256_slli_epi32(g5, 3), _mm256_srli_epi32(g5, 2));
+	const __m256i b58 = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+	const __m256i rgb555 = _mm256_or_si256(
+		_mm256_or_si256(r58, _mm256_slli_epi32(g58, 8)),
+		_mm256_or_si256(_mm256_slli_epi32(b58, 16), _mm256_set1_epi32(0xFF000000)));
+
+	// RGB4A3
+	const __m256i r4 = _mm256_and_si256(_mm256_srli_epi32(val, 8), kMask_x0f);
+	const __m256i g4 = _mm256_and_si256(_mm256_srli_epi32(val, 4), kMask_x0f);
+	const __m256i b4 = _mm256_and_si256(val, kMask_x0f);
+	const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(val, 12), kMask_x07);
+	const __m256i rgb4 = _mm256_or_si256(
+		_mm256_or_si256(r4, _mm256_slli_epi32(g4, 8)), _mm256_slli_epi32(b4, 16));
+	const __m256i a38 = _mm256_or_si256(
+		_mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)), _mm256_srli_epi32(a3, 1));
+	const __m256i rgb4a3 = _mm256_or_si256(
+		_mm256_or_si256(rgb4, _mm256_slli_epi32(rgb4, 4)), _mm256_slli_epi32(a38, 24));
+
+	// The top bit picks the format
+	const __m256i is555 = _mm256_srai_epi32(_mm256_slli_epi32(val, 16), 31);
+	return _mm256_blendv_epi8(rgb4a3, rgb555, is555);
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeRGB5A3_AVX2(u32 *dst, const u8 *src, u32 width, u32 height, bool bgra)
+{
+	const u32 Wsteps4 = (width + 3) / 4;
+	const __m128i kMaskSwap16 = _mm_set_epi32(0x0E0F0C0DL, 0x0A0B0809L, 0x06070405L, 0x02030001L);
+	// Swaps red and blue for BGRA, leaves the texels alone for RGBA
+	const __m256i kOrder = bgra ?
+		_mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15) :
+		_mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+			0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	for (u32 y = 0; y < height; y += 4)
+	{
+		u32 x = 0;
+		u32 yStep = (y / 4) * Wsteps4;
+		// Two blocks side by side make a row of 8 texels
+		for (; x + 8 <= width; x += 8, yStep += 2)
+		{
+			const u8* src2 = src + 32 * yStep;
+			for (u32 iy = 0; iy < 4; iy++)
+			{
+				const __m128i in = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(src2 + 8 * iy)),
+					_mm_loadl_epi64((const __m128i*)(src2 + 32 + 8 * iy)));
+				const __m256i val = _mm256_cvtepu16_epi32(_mm_shuffle_epi8(in, kMaskSwap16));
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					_mm256_shuffle_epi8(decodeRGB5A3x8_AVX2(val), kOrder));
+			}
+		}
+		if (x < width)
+		{
+			// Two rows of the last block at a time
+			const u8* src2 = src + 32 * yStep;
+			for (u32 iy = 0; iy < 4; iy += 2)
+			{
+				const __m128i in = _mm_loadu_si128((const __m128i*)(src2 + 8 * iy));
+				const __m256i rgba = _mm256_shuffle_epi8(
+					decodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm_shuffle_epi8(in, kMaskSwap16))), kOrder);
+				_mm_storeu_si128((__m128i*)(dst + (y + iy) * width + x), _mm256_castsi256_si128(rgba));
+				_mm_storeu_si128((__m128i*)(dst + (y + iy + 1) * width + x), _mm256_extracti128_si256(rgba, 1));
+			}
+		}
+	}
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeC4_AVX2(u32 *dst, const u8 *src, u32 width, u32 height, u32 tlutaddr, TlutFormat tlutfmt, bool bgra)
+{
+	alignas(32) u32 palette[16];
+	decodeTlutRGBA(palette, tlutaddr, tlutfmt, 16, bgra);
+	// The palette fits in two registers, indices 0-7 and 8-15
+	const __m256i pal_lo = _mm256_load_si256((const __m256i*)palette);
+	const __m256i pal_hi = _mm256_load_si256((const __m256i*)(palette + 8));
+	const __m256i kSeven = _mm256_set1_epi32(7);
+	const __m128i kMask_x0f = _mm_set1_epi8(0x0f);
+
+	const u32 Wsteps8 = (width + 7) / 8;
+	for (u32 y = 0; y < height; y += 8)
+		for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+			for (u32 iy = 0, xStep = 4 * yStep; iy < 8; iy += 2, xStep++)
+			{
+				// Two rows of 8 indices, a nibble each
+				const __m128i in = _mm_loadl_epi64((const __m128i*)(src + 8 * xStep));
+				const __m128i indices = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(in, 4), kMask_x0f),
+					_mm_and_si128(in, kMask_x0f));
+				for (u32 row = 0; row < 2; row++)
+				{
+					const __m256i index = _mm256_cvtepu8_epi32(row ? _mm_srli_si128(indices, 8) : indices);
+					const __m256i rgba = _mm256_blendv_epi8(_mm256_permutevar8x32_epi32(pal_lo, index),
+						_mm256_permutevar8x32_epi32(pal_hi, index), _mm256_cmpgt_epi32(index, kSeven));
+					_mm256_storeu_si256((__m256i*)(dst + (y + iy + row) * width + x), rgba);
+				}
+			}
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeC8_AVX2(u32 *dst, const u8 *src, u32 width, u32 height, u32 tlutaddr, TlutFormat tlutfmt, bool bgra)
+{
+	alignas(32) u32 palette[256];
+	decodeTlutRGBA(palette, tlutaddr, tlutfmt, 256, bgra);
+
+	const u32 Wsteps8 = (width + 7) / 8;
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+			for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+			{
+				const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					_mm256_i32gather_epi32((const int*)palette, index, 4));
+			}
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeCMPR_AVX2(u32 *dst, const u8 *src, u32 width, u32 height, bool bgra)
+{
+	// Each row of two DXT blocks side by side looks its texels up in the 4 colors of the left block
+	// (0-3) and of the right one (4-7). The 2-bit indices of a row are in one byte of each block,
+	// leftmost texel in the top bits.
+	const __m256i shifts = _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0);
+	const __m256i right = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+	const __m256i kMask_x03 = _mm256_set1_epi32(3);
+
+	const u32 Wsteps8 = (width + 7) / 8;
+	for (u32 y = 0; y < height; y += 8)
+		for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+		{
+			const DXT1Block* blocks = (const DXT1Block*)src + 4 * yStep;
+			for (u32 z = 0; z < 2; z++)
+			{
+				const DXT1Block& left = blocks[2 * z];
+				const DXT1Block& right_block = blocks[2 * z + 1];
+				alignas(32) u32 colors[8];
+				getDXTColorsRGBA(colors, &left);
+				getDXTColorsRGBA(colors + 4, &right_block);
+				if (bgra)
+				{
+					for (u32& color : colors)
+						color = swapRB(color);
+				}
+				const __m256i palette = _mm256_load_si256((const __m256i*)colors);
+				const __m256i lines = _mm256_setr_epi32(left.indices, left.indices, left.indices, left.indices,
+					right_block.indices, right_block.indices, right_block.indices, right_block.indices);
+
+				__m256i row_shifts = shifts;
+				for (u32 iy = 0; iy < 4; iy++)
+				{
+					const __m256i index = _mm256_or_si256(
+						_mm256_and_si256(_mm256_srlv_epi32(lines, row_shifts), kMask_x03), right);
+					_mm256_storeu_si256((__m256i*)(dst + (y + z * 4 + iy) * width + x),
+						_mm256_permutevar8x32_epi32(palette, index));
+					row_shifts = _mm256_add_epi32(row_shifts, _mm256_set1_epi32(8));
+				}
+			}
+		}
+}
+
+// Returns false for the formats without an AVX2 version. With bgra, only the formats
+// TexDecoder_Decode_real writes as BGRA32 are decoded, it keeps the others in smaller formats.
+static bool TexDecoder_Decode_AVX2(u32 * dst, const u8 * src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool bgra)
+{
+	switch (texformat)
+	{
+	case GX_TF_I4:
+		if (bgra)
+			return false;
+		TexDecoder_DecodeI4_AVX2(dst, src, width, height);
+		return true;
+	case GX_TF_I8:
+		if (bgra)
+			return false;
+		TexDecoder_DecodeI8_AVX2(dst, src, width, height);
+		return true;
+	case GX_TF_IA8:
+		if (bgra)
+			return false;
+		TexDecoder_DecodeIA8_AVX2(dst, src, width, height);
+		return true;
+	case GX_TF_RGB5A3:
+		TexDecoder_DecodeRGB5A3_AVX2(dst, src, width, height, bgra);
+		return true;
+	case GX_TF_C4:
+		if (width * height < AVX2_MIN_PALETTE_TEXELS || (bgra && tlutfmt != GX_TL_RGB5A3))
+			return false;
+		TexDecoder_DecodeC4_AVX2(dst, src, width, height, tlutaddr, tlutfmt, bgra);
+		return true;
+	case GX_TF_C8:
+		if (width * height < AVX2_MIN_PALETTE_TEXELS || (bgra && tlutfmt != GX_TL_RGB5A3))
+			return false;
+		TexDecoder_DecodeC8_AVX2(dst, src, width, height, tlutaddr, tlutfmt, bgra);
+		return true;
+	case GX_TF_CMPR:
+		TexDecoder_DecodeCMPR_AVX2(dst, src, width, height, bgra);
+		return true;
+	default:
+		return false;
+	}
+}
+
 // JSD 01/06/11:
 // TODO: we really should ensure BOTH the source and destination addresses are aligned to 16-byte boundaries to
 // squeeze out a little more performance. _mm_loadu_si128/_mm_storeu_si128 is slower than _mm_load_si128/_mm_store_si128
@@ -1067,6 +1404,9 @@ static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, u32 width, u3
 
 static PC_TexFormat TexDecoder_Decode_RGBA(u32 * dst, const u8 * src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt)
 {
+	if (cpu_info.bAVX2 && TexDecoder_Decode_AVX2(dst, src, width, height, texformat, tlutaddr, tlutfmt, false))
+		return PC_TEX_FMT_RGBA32;
+
 	const u32 Wsteps4 = (width + 3) / 4;
 	const u32 Wsteps8 = (width + 7) / 8;
 
@@ -0,0 +1,165 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/DeltaCopy.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+
+namespace
+{
+using DeltaCopyFunc = std::function<size_t(u8*, const u8*, size_t)>;
+
+std::vector<std::pair<const char*, DeltaCopyFunc>> GetImplementations()
+{
+  std::vector<std::pair<const char*, DeltaCopyFunc>> impls;
+  impls.emplace_back("Generic", Common::DeltaCopyGeneric);
+#ifdef _M_X86
+  impls.emplace_back("SSE2", Common::DeltaCopySSE2);
+  if (cpu_info.bAVX2)
+    impls.emplace_back("AVX2", Common::DeltaCopyAVX2);
+#endif
+  return impls;
+}
+
+// Simulates a few frames worth of writes by scattering small changes over the image
+void MutateImage(std::vector<u8>* image, std::mt19937* rng, size_t num_writes)
+{
+  std::uniform_int_distribution<size_t> offset_dist(0, image->size() - 16);
+  for (size_t i = 0; i < num_writes; i++)
+  {
+    size_t offset = offset_dist(*rng);
+    for (size_t j = 0; j < 16; j++)
+      (*image)[offset + j] ^= static_cast<u8>((*rng)() | 1);
+  }
+}
+}
+
+TEST(DeltaCopy, MatchesMemcpy)
+{
+  std::mt19937 rng(1234);
+  for (const auto& impl : GetImplementations())
+  {
+    // Odd sizes and offsets exercise the partial trailing chunk and unaligned loads
+    for (size_t size : {0, 1, 63, 64, 65, 1000, 4096, 4099})
+    {
+      std::vector<u8> src(size + 3);
+      for (u8& b : src)
+        b = static_cast<u8>(rng());
+      std::vector<u8> dst = src;
+      MutateImage(&dst, &rng, size / 128);
+      if (size > 0)
+        dst[size + 2] ^= 0xFF;
+
+      std::vector<u8> expected = dst;
+      std::copy(src.begin() + 3, src.end(), expected.begin() + 3);
+      expected.resize(size + 3);
+      dst.resize(size + 3);
+
+      impl.second(dst.data() + 3, src.data() + 3, size);
+      EXPECT_EQ(expected, dst) << impl.first << " size " << size;
+    }
+  }
+}
+
+TEST(DeltaCopy, OnlyWritesChangedChunks)
+{
+  for (const auto& impl : GetImplementations())
+  {
+    std::vector<u8> src(64 * 16 + 10, 0xAA);
+    std::vector<u8> dst = src;
+
+    EXPECT_EQ(0u, impl.second(dst.data(), src.data(), src.size())) << impl.first;
+
+    dst[5] = 0;
+    dst[64 * 3 + 63] = 0;
+    dst[64 * 3 + 1] = 0;
+    dst[64 * 16 + 2] = 0;
+    EXPECT_EQ(64u * 2 + 10, impl.second(dst.data(), src.data(), src.size())) << impl.first;
+    EXPECT_EQ(src, dst) << impl.first;
+  }
+}
+
+// Replays a sequence of RAM images the way rollback does: the newest image plays the role of live
+// RAM and the image from N frames earlier is restored over it. Set DELTA_COPY_RAM_DUMPS to a folder
+// of raw MEM1 dumps (e.g. from the memory view's Dump MRAM, one per frame, sorted by file name) to
+// benchmark real data, otherwise synthetic images are used.
+// Run with --gtest_also_run_disabled_tests.
+TEST(DeltaCopy, DISABLED_RollbackRestoreBenchmark)
+{
+  std::vector<std::vector<u8>> images;
+  const char* dump_dir = getenv("DELTA_COPY_RAM_DUMPS");
+  if (dump_dir)
+  {
+    std::vector<std::string> files = DoFileSearch({""}, {dump_dir}, false);
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files)
+    {
+      std::string contents;
+      if (!File::ReadFileToString(file, contents) || contents.empty())
+        continue;
+      if (!images.empty() && contents.size() != images[0].size())
+        continue;
+      images.emplace_back(contents.begin(), contents.end());
+    }
+  }
+
+  if (images.size() < 2)
+  {
+    std::mt19937 rng(5678);
+    images.emplace_back(0x01800000);
+    for (u8& b : images.back())
+      b = static_cast<u8>(rng());
+    for (int frame = 1; frame < 16; frame++)
+    {
+      images.push_back(images.back());
+      MutateImage(&images.back(), &rng, 2000);
+    }
+  }
+
+  // Plain memcpy is what a restore did before, keep it as the baseline
+  auto impls = GetImplementations();
+  impls.emplace(impls.begin(), "memcpy", [](u8* dst, const u8* src, size_t size) {
+    memcpy(dst, src, size);
+    return size;
+  });
+
+  const size_t image_size = images[0].size();
+  std::vector<u8> ram(image_size);
+  for (const auto& impl : impls)
+  {
+    for (size_t depth = 1; depth <= 7 && depth < images.size(); depth++)
+    {
+      u64 total_ns = 0;
+      u64 total_written = 0;
+      u64 restores = 0;
+      for (size_t i = depth; i < images.size(); i++)
+      {
+        std::copy(images[i].begin(), images[i].begin() + image_size, ram.begin());
+
+        auto start = std::chrono::high_resolution_clock::now();
+        total_written += impl.second(ram.data(), images[i - depth].data(), image_size);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        restores++;
+      }
+
+      printf("%-8s depth %zu: %10llu ns/restore, %10llu bytes written/restore (of %zu)\n",
+             impl.first, depth, (unsigned long long)(total_ns / restores),
+             (unsigned long long)(total_written / restores), image_size);
+    }
+  }
+}
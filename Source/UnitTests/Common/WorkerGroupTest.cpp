@@ -0,0 +1,42 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ThreadPool.h"
+
+// Jobs run back to back, each with its own slices. Every slice has to run exactly once, and while
+// its job is running, as the job's state is gone once Run returns.
+TEST(WorkerGroup, RunsEverySliceOfItsOwnJob)
+{
+  Common::WorkerGroup group(3);
+  std::atomic<int> current_job{-1};
+  int stale_slices = 0;
+
+  for (int job = 0; job < 20000; job++)
+  {
+    const size_t count = 2 + job % 7;
+    auto runs = std::make_unique<std::atomic<int>[]>(count);
+    for (size_t i = 0; i < count; i++)
+      runs[i] = 0;
+
+    current_job = job;
+    std::atomic<int> stale{0};
+    group.Run(count, [&, job](size_t i) {
+      if (current_job.load() != job)
+        stale++;
+      runs[i]++;
+    });
+    current_job = -1;
+
+    stale_slices += stale.load();
+    for (size_t i = 0; i < count; i++)
+      ASSERT_EQ(1, runs[i].load()) << "job " << job << " slice " << i;
+  }
+  EXPECT_EQ(0, stale_slices);
+}
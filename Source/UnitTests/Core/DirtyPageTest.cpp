@@ -0,0 +1,120 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <random>
+#include <thread>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemTools.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace
+{
+constexpr u32 TRACKED_START = 0x80000000;
+constexpr u32 TRACKED_PAGES = 256;
+
+class DirtyPageTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    Core::DeclareAsCPUThread();
+    SConfig::Init();
+    SConfig::GetInstance().bFastmem = true;
+    PowerPC::Init(PowerPC::CORE_INTERPRETER);
+    Memory::Init();
+    EMM::InstallExceptionHandler();
+    m_tracking = Memory::EnableDirtyPageTracking(
+        {{TRACKED_START, TRACKED_PAGES * Memory::DIRTY_PAGE_SIZE}});
+  }
+
+  void TearDown() override
+  {
+    Memory::DisableDirtyPageTracking();
+    EMM::UninstallExceptionHandler();
+    Memory::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Core::UndeclareAsCPUThread();
+  }
+
+  static u32 PageAddress(u32 page) { return TRACKED_START + page * Memory::DIRTY_PAGE_SIZE; }
+
+  static void WritePage(u32 page)
+  {
+    volatile u8* ptr = Memory::m_pRAM + (PageAddress(page) & Memory::RAM_MASK);
+    *ptr = *ptr + 1;
+  }
+
+  bool m_tracking = false;
+};
+}  // namespace
+
+TEST_F(DirtyPageTest, TagsWritesWithTheirEpoch)
+{
+  if (!m_tracking)
+    return;
+
+  u32 closed = Memory::AdvanceDirtyPageEpoch();
+  EXPECT_FALSE(Memory::WasPageWrittenSince(PageAddress(3), closed));
+
+  WritePage(3);
+  EXPECT_TRUE(Memory::WasPageWrittenSince(PageAddress(3), closed));
+  EXPECT_FALSE(Memory::WasPageWrittenSince(PageAddress(4), closed));
+
+  // The page is protected again once the epoch is closed
+  u32 next = Memory::AdvanceDirtyPageEpoch();
+  EXPECT_FALSE(Memory::WasPageWrittenSince(PageAddress(3), next));
+  WritePage(3);
+  EXPECT_TRUE(Memory::WasPageWrittenSince(PageAddress(3), next));
+}
+
+// Other threads write RAM while the CPU thread closes epochs. No write may be left out of the
+// epoch it happened in, or a savestate taken after it would skip the page.
+TEST_F(DirtyPageTest, WritesFromOtherThreadsSurviveEpochAdvances)
+{
+  if (!m_tracking)
+    return;
+
+  // Oldest epoch each page must still report a write since
+  std::array<std::atomic<u32>, TRACKED_PAGES> required{};
+  std::atomic<bool> done{false};
+
+  std::thread writer([&] {
+    std::mt19937 rng(1);
+    for (int i = 0; i < 200000; i++)
+    {
+      u32 page = rng() % TRACKED_PAGES;
+      u32 epoch = Memory::GetDirtyPageEpoch();
+      WritePage(page);
+      required[page] = epoch;
+    }
+    done = true;
+  });
+
+  while (!done)
+    Memory::AdvanceDirtyPageEpoch();
+  writer.join();
+
+  // A write made during epoch e happened after e - 1 was closed
+  for (u32 page = 0; page < TRACKED_PAGES; page++)
+  {
+    if (required[page] != 0)
+      EXPECT_TRUE(Memory::WasPageWrittenSince(PageAddress(page), required[page] - 1)) << page;
+  }
+
+  // And every page that was written is tracked again from the next epoch on
+  u32 closed = Memory::AdvanceDirtyPageEpoch();
+  for (u32 page = 0; page < TRACKED_PAGES; page++)
+    EXPECT_FALSE(Memory::WasPageWrittenSince(PageAddress(page), closed)) << page;
+  WritePage(7);
+  EXPECT_TRUE(Memory::WasPageWrittenSince(PageAddress(7), closed));
+}
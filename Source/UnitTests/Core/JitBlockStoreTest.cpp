@@ -0,0 +1,73 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/JitCommon/JitBlockStore.h"
+
+namespace
+{
+// Fills buffer with a block of consecutive instructions starting at address
+u32 MakeBlock(PPCAnalyst::CodeBuffer* buffer, u32 address, const std::vector<u32>& instructions)
+{
+  for (u32 i = 0; i < instructions.size(); i++)
+  {
+    buffer->codebuffer[i].address = address + i * 4;
+    buffer->codebuffer[i].inst.hex = instructions[i];
+  }
+  return static_cast<u32>(instructions.size());
+}
+}
+
+TEST(JitBlockStore, BlocksAreOfferedInTheNextSession)
+{
+  const std::string temp_dir = File::CreateTempDir();
+  const std::string path = temp_dir + DIR_SEP "GALE01.bin";
+  PPCAnalyst::CodeBuffer buffer(16);
+  const std::vector<u32> code = {0x38600001, 0x38800002, 0x4e800020};
+
+  {
+    JitBlockStore store;
+    store.Load(path, 1);
+    EXPECT_FALSE(store.HasPending());
+    store.Record(buffer, MakeBlock(&buffer, 0x80003000, code));
+    // Compiled again after the cache was cleared, still one block
+    store.Record(buffer, MakeBlock(&buffer, 0x80003000, code));
+    store.Record(buffer, MakeBlock(&buffer, 0x80004000, code));
+    store.Save();
+  }
+
+  const u64 hash = JitBlockStore::HashBlock(buffer, MakeBlock(&buffer, 0x80004000, code));
+  EXPECT_NE(hash, JitBlockStore::HashBlock(buffer, MakeBlock(&buffer, 0x80003000, code)));
+
+  JitBlockStore store;
+  store.Load(path, 1);
+  ASSERT_TRUE(store.HasPending());
+  std::vector<u32> offered;
+  store.Prewarm([&](const JitBlockStore::Entry& entry) {
+    offered.push_back(entry.address);
+    EXPECT_EQ(code[0], entry.first_instruction);
+    if (entry.address != 0x80004000)
+      return JitBlockStore::PrewarmResult::Compiled;
+    EXPECT_EQ(hash, entry.hash);
+    return JitBlockStore::PrewarmResult::Mismatch;
+  });
+  EXPECT_EQ((std::vector<u32>{0x80003000, 0x80004000}), offered);
+  // The block that did not match waits for a later pass
+  EXPECT_TRUE(store.HasPending());
+
+  // Blocks saved under other JIT settings are not offered
+  JitBlockStore other;
+  other.Load(path, 2);
+  EXPECT_FALSE(other.HasPending());
+
+  File::DeleteDirRecursively(temp_dir);
+}
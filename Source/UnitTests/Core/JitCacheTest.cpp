@@ -0,0 +1,217 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+namespace
+{
+std::vector<int> GetList(const JitBlockListMap& map, u32 key)
+{
+  std::vector<int> list;
+  map.ForEach(key, [&](int block_num) { list.push_back(block_num); });
+  std::sort(list.begin(), list.end());
+  return list;
+}
+
+std::vector<int> GetList(const std::multimap<u32, int>& map, u32 key)
+{
+  std::vector<int> list;
+  auto range = map.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it)
+    list.push_back(it->second);
+  std::sort(list.begin(), list.end());
+  return list;
+}
+
+// A block as far as linking and invalidating go
+struct Block
+{
+  u32 address;
+  u32 size;  // bytes
+  std::vector<u32> exits;
+};
+
+// Game code packed in a few megabytes, blocks of a few instructions branching to blocks nearby.
+// Gecko codes rewrite instructions all over the code and clear the cache lines they wrote to.
+struct Workload
+{
+  std::vector<Block> blocks;
+  std::vector<u32> invalidations;  // 32 byte lines
+};
+
+Workload MakeWorkload(u32 seed)
+{
+  std::mt19937 rng(seed);
+  Workload workload;
+  u32 address = 0x3000;
+  for (int i = 0; i < 20000; i++)
+  {
+    Block block;
+    block.address = address;
+    block.size = 4 * (1 + rng() % 24);
+    address += block.size + 4 * (rng() % 8);
+    for (u32 exit = 0; exit < 1 + rng() % 2; exit++)
+      block.exits.push_back(0x3000 + (block.address - 0x3000 + rng() % 0x4000) % 0x400000 / 4 * 4);
+    workload.blocks.push_back(block);
+  }
+  for (int i = 0; i < 5000; i++)
+    workload.invalidations.push_back((0x3000 + rng() % (address - 0x3000)) & ~31u);
+  return workload;
+}
+
+// The containers JitBaseBlockCache used before JitBlockListMap, doing the same work
+double RunTreeMaps(const Workload& workload)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  std::multimap<u32, int> links_to;
+  std::map<std::pair<u32, u32>, u32> block_map;
+  std::vector<bool> valid(workload.blocks.size());
+  size_t work = 0;
+  for (size_t i = 0; i < workload.blocks.size(); i++)
+  {
+    const Block& b = workload.blocks[i];
+    block_map[std::make_pair(b.address + b.size - 1, b.address)] = static_cast<u32>(i);
+    for (u32 exit : b.exits)
+      links_to.emplace(exit, static_cast<int>(i));
+    auto range = links_to.equal_range(b.address);
+    for (auto it = range.first; it != range.second; ++it)
+      work += it->second;
+    valid[i] = true;
+  }
+  for (u32 line : workload.invalidations)
+  {
+    auto it1 = block_map.lower_bound(std::make_pair(line, 0)), it2 = it1;
+    while (it2 != block_map.end() && it2->first.second < line + 32)
+    {
+      const Block& b = workload.blocks[it2->second];
+      auto range = links_to.equal_range(b.address);
+      for (auto it = range.first; it != range.second; ++it)
+        work += it->second;
+      links_to.erase(b.address);
+      valid[it2->second] = false;
+      ++it2;
+    }
+    block_map.erase(it1, it2);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  EXPECT_NE(0u, work);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+double RunListMaps(const Workload& workload)
+{
+  const u32 page_shift = 8;
+  auto start = std::chrono::high_resolution_clock::now();
+  JitBlockListMap links_to;
+  JitBlockListMap block_pages;
+  std::vector<bool> valid(workload.blocks.size());
+  std::vector<int> to_destroy;
+  size_t work = 0;
+  for (size_t i = 0; i < workload.blocks.size(); i++)
+  {
+    const Block& b = workload.blocks[i];
+    for (u32 page = b.address >> page_shift; page <= (b.address + b.size - 1) >> page_shift; page++)
+      block_pages.Add(page, static_cast<int>(i));
+    for (u32 exit : b.exits)
+      links_to.Add(exit, static_cast<int>(i));
+    links_to.ForEach(b.address, [&](int source) { work += source; });
+    valid[i] = true;
+  }
+  for (u32 line : workload.invalidations)
+  {
+    to_destroy.clear();
+    block_pages.ForEach(line >> page_shift, [&](int block_num) {
+      const Block& b = workload.blocks[block_num];
+      if (b.address < line + 32 && b.address + b.size > line)
+        to_destroy.push_back(block_num);
+    });
+    for (int block_num : to_destroy)
+    {
+      const Block& b = workload.blocks[block_num];
+      for (u32 page = b.address >> page_shift; page <= (b.address + b.size - 1) >> page_shift; page++)
+        block_pages.Remove(page, block_num);
+      links_to.ForEach(b.address, [&](int source) { work += source; });
+      links_to.Erase(b.address);
+      valid[block_num] = false;
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  EXPECT_NE(0u, work);
+  return std::chrono::duration<double>(end - start).count();
+}
+}
+
+TEST(JitBlockListMap, MatchesMultimap)
+{
+  std::mt19937 rng(1234);
+  JitBlockListMap map;
+  std::multimap<u32, int> expected;
+  // Few enough keys that they are erased and added again, through several rehashes
+  for (int i = 0; i < 100000; i++)
+  {
+    const u32 key = (rng() % 2000) * 4;
+    const int block_num = static_cast<int>(rng() % 50);
+    switch (rng() % 4)
+    {
+    case 0:
+    case 1:
+      map.Add(key, block_num);
+      expected.emplace(key, block_num);
+      break;
+    case 2:
+    {
+      map.Remove(key, block_num);
+      auto range = expected.equal_range(key);
+      auto it = std::find_if(range.first, range.second,
+                             [&](const std::pair<const u32, int>& e) { return e.second == block_num; });
+      if (it != range.second)
+        expected.erase(it);
+      break;
+    }
+    case 3:
+      if (rng() % 8 == 0)
+      {
+        map.Erase(key);
+        expected.erase(key);
+      }
+      break;
+    }
+    ASSERT_EQ(GetList(expected, key), GetList(map, key)) << "key " << key << " at " << i;
+  }
+
+  for (u32 key = 0; key < 2000 * 4; key += 4)
+    EXPECT_EQ(GetList(expected, key), GetList(map, key)) << "key " << key;
+
+  map.Clear();
+  EXPECT_TRUE(GetList(map, 0).empty());
+  map.Add(0, 7);
+  EXPECT_EQ(std::vector<int>{7}, GetList(map, 0));
+}
+
+TEST(JitBlockListMap, DISABLED_LinkAndInvalidateBenchmark)
+{
+  const Workload workload = MakeWorkload(42);
+  const int repeats = 20;
+  double tree_seconds = 0;
+  double list_seconds = 0;
+  for (int r = 0; r < repeats; r++)
+  {
+    tree_seconds += RunTreeMaps(workload);
+    list_seconds += RunListMaps(workload);
+  }
+  printf("%zu blocks, %zu invalidated lines: std::map %.2f ms, JitBlockListMap %.2f ms\n",
+         workload.blocks.size(), workload.invalidations.size(), tree_seconds * 1000 / repeats,
+         list_seconds * 1000 / repeats);
+}
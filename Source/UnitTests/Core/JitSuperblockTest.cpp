@@ -0,0 +1,164 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <ostream>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/GPFifo.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/ProcessorInterface.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "VideoCommon/CommandProcessor.h"
+
+namespace
+{
+constexpr u32 BLOCK_A = 0x80003000;
+constexpr u32 BLOCK_B = 0x80003100;
+constexpr u32 SPIN = 0x80003200;
+constexpr u32 FIFO_BASE = 0x00200000;
+constexpr u32 FIFO_SIZE = 0x10000;
+
+constexpr u32 LIS_R4_GATHER_PIPE = 0x3C80CC01;  // lis r4, 0xCC01
+constexpr u32 STW_R3_GATHER_PIPE = 0x90648000;  // stw r3, -0x8000(r4), to 0xCC008000
+constexpr u32 ADDI_R3 = 0x38630001;             // addi r3, r3, 1
+constexpr u32 LOOP_COUNT = 3000;                // three times it takes for a block to be hot
+
+// Short slices end at many different instructions of the loop
+constexpr s64 SLICE_CYCLES = 97;
+
+u32 B(u32 from, u32 to)
+{
+  return 0x48000000 | ((to - from) & 0x03FFFFFC);
+}
+
+u32 BDNZ(u32 from, u32 to)
+{
+  return 0x42000000 | ((to - from) & 0xFFFC);
+}
+
+CoreTiming::EventType* s_slice_event;
+
+void EndSlice(u64, s64 cycles_late)
+{
+  CoreTiming::ScheduleEvent(SLICE_CYCLES - cycles_late, s_slice_event);
+}
+
+// What the guest and the gather pipe look like when a slice ends
+struct SliceEnd
+{
+  u32 pc;
+  int downcount;
+  u32 pmc1;
+  u32 pmc2;
+  u32 gather_pipe_count;
+  u32 fifo_write_pointer;
+
+  bool operator==(const SliceEnd& other) const
+  {
+    return pc == other.pc && downcount == other.downcount && pmc1 == other.pmc1 &&
+           pmc2 == other.pmc2 && gather_pipe_count == other.gather_pipe_count &&
+           fifo_write_pointer == other.fifo_write_pointer;
+  }
+};
+
+std::ostream& operator<<(std::ostream& os, const SliceEnd& end)
+{
+  return os << std::hex << "pc " << end.pc << std::dec << " downcount " << end.downcount
+            << " pmc1 " << end.pmc1 << " pmc2 " << end.pmc2 << " gather pipe "
+            << end.gather_pipe_count << " fifo " << std::hex << end.fifo_write_pointer;
+}
+
+void Write(u32 address, const std::vector<u32>& code)
+{
+  for (u32 inst : code)
+  {
+    Memory::Write_U32(inst, address);
+    address += 4;
+  }
+}
+
+// Runs a loop of two blocks writing to the gather pipe, which the JIT makes a superblock of once
+// it is hot if superblocks are enabled
+std::vector<SliceEnd> RunLoop(bool superblocks)
+{
+  Core::DeclareAsCPUThread();
+  SConfig::Init();
+  SConfig::GetInstance().bCPUThread = false;
+  SConfig::GetInstance().bFastmem = false;
+  SConfig::GetInstance().bJITSuperblocks = superblocks;
+  CoreTiming::Init();
+  Memory::Init();
+  GPFifo::Init();
+  CommandProcessor::Init();
+  PowerPC::Init(PowerPC::CORE_JIT64);
+
+  UReg_MSR msr(MSR);
+  msr.IR = 1;
+  msr.DR = 1;
+  MSR = msr.Hex;
+  // Count cycles and loads and stores, which the JIT does where blocks exit
+  MMCR0.PMC1SELECT = 1;
+  MMCR0.PMC2SELECT = 11;
+  ProcessorInterface::Fifo_CPUBase = FIFO_BASE;
+  ProcessorInterface::Fifo_CPUEnd = FIFO_BASE + FIFO_SIZE - GPFifo::GATHER_PIPE_SIZE;
+  ProcessorInterface::Fifo_CPUWritePointer = FIFO_BASE;
+
+  std::vector<u32> block_a{LIS_R4_GATHER_PIPE};
+  for (int i = 0; i < 5; i++)
+    block_a.insert(block_a.end(), {STW_R3_GATHER_PIPE, ADDI_R3});
+  block_a.push_back(B(BLOCK_A + 4 * static_cast<u32>(block_a.size()), BLOCK_B));
+  Write(BLOCK_A, block_a);
+
+  std::vector<u32> block_b{LIS_R4_GATHER_PIPE};
+  for (int i = 0; i < 3; i++)
+    block_b.insert(block_b.end(), {STW_R3_GATHER_PIPE, ADDI_R3});
+  block_b.push_back(BDNZ(BLOCK_B + 4 * static_cast<u32>(block_b.size()), BLOCK_A));
+  block_b.push_back(B(BLOCK_B + 4 * static_cast<u32>(block_b.size()), SPIN));
+  Write(BLOCK_B, block_b);
+  Write(SPIN, {B(SPIN, SPIN)});
+
+  s_slice_event = CoreTiming::RegisterEvent("TestSlice", EndSlice);
+  CoreTiming::ScheduleEvent(SLICE_CYCLES, s_slice_event);
+  CTR = LOOP_COUNT;
+  PC = BLOCK_A;
+
+  // The CPU is not running, so the JIT returns at the end of every slice
+  std::vector<SliceEnd> ends;
+  while (PC != SPIN && ends.size() < 100000)
+  {
+    PowerPC::SingleStep();
+    ends.push_back({PC, PowerPC::ppcState.downcount, PowerPC::ppcState.spr[SPR_PMC1],
+                    PowerPC::ppcState.spr[SPR_PMC2], GPFifo::m_gatherPipeCount,
+                    ProcessorInterface::Fifo_CPUWritePointer});
+  }
+
+  PowerPC::Shutdown();
+  Memory::Shutdown();
+  CoreTiming::Shutdown();
+  SConfig::Shutdown();
+  Core::UndeclareAsCPUThread();
+  return ends;
+}
+}  // namespace
+
+// A superblock has to leave the guest, the gather pipe and the performance monitor as the blocks
+// it replaces do, wherever a slice ends
+TEST(JitSuperblock, MatchesLinkedBlocks)
+{
+  const std::vector<SliceEnd> linked = RunLoop(false);
+  const std::vector<SliceEnd> superblock = RunLoop(true);
+
+  ASSERT_FALSE(linked.empty());
+  EXPECT_EQ(SPIN, linked.back().pc);
+  ASSERT_EQ(linked.size(), superblock.size());
+  for (size_t i = 0; i < linked.size(); i++)
+    ASSERT_EQ(linked[i], superblock[i]) << "slice " << i;
+}
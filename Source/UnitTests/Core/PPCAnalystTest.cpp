@@ -0,0 +1,259 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace
+{
+constexpr u32 CODE_START = 0x80003000;
+
+constexpr u32 ADDI_R3 = 0x38630001;  // addi r3, r3, 1
+constexpr u32 BLR = 0x4E800020;
+
+u32 B(u32 from, u32 to)
+{
+  return 0x48000000 | ((to - from) & 0x03FFFFFC);
+}
+
+u32 BL(u32 from, u32 to)
+{
+  return B(from, to) | 1;
+}
+
+// beq cr0, to
+u32 BEQ(u32 from, u32 to)
+{
+  return 0x41820000 | ((to - from) & 0xFFFC);
+}
+
+class PPCAnalystTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    Core::DeclareAsCPUThread();
+    SConfig::Init();
+    PowerPC::Init(PowerPC::CORE_INTERPRETER);
+    Memory::Init();
+    UReg_MSR msr(MSR);
+    msr.IR = 1;
+    msr.DR = 1;
+    MSR = msr.Hex;
+    m_block.m_stats = &m_stats;
+    m_block.m_gpa = &m_gpa;
+    m_block.m_fpa = &m_fpa;
+  }
+
+  void TearDown() override
+  {
+    Memory::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Core::UndeclareAsCPUThread();
+  }
+
+  void Write(u32 address, std::vector<u32> code)
+  {
+    for (u32 inst : code)
+    {
+      Memory::Write_U32(inst, address);
+      address += 4;
+    }
+  }
+
+  u32 Analyze(bool trace)
+  {
+    if (trace)
+      m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE);
+    else
+      m_analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE);
+    m_analyzer.Analyze(CODE_START, &m_block, &m_buffer, m_buffer.GetSize());
+    return m_block.m_num_instructions;
+  }
+
+  const PPCAnalyst::CodeOp& Op(u32 index) const { return m_buffer.codebuffer[index]; }
+
+  PPCAnalyst::PPCAnalyzer m_analyzer;
+  PPCAnalyst::CodeBuffer m_buffer{64};
+  PPCAnalyst::CodeBlock m_block{};
+  PPCAnalyst::BlockStats m_stats{};
+  PPCAnalyst::BlockRegStats m_gpa{};
+  PPCAnalyst::BlockRegStats m_fpa{};
+};
+}  // namespace
+
+TEST_F(PPCAnalystTest, BlockEndsAtBranchWithoutTrace)
+{
+  Write(CODE_START, {ADDI_R3, B(CODE_START + 4, CODE_START + 0x10)});
+  Write(CODE_START + 0x10, {ADDI_R3, BLR});
+
+  EXPECT_EQ(2u, Analyze(false));
+  EXPECT_FALSE(Op(1).isFollowedBranch);
+  EXPECT_TRUE(Op(1).canEndBlock);
+}
+
+TEST_F(PPCAnalystTest, TraceFollowsUnconditionalBranch)
+{
+  Write(CODE_START, {ADDI_R3, B(CODE_START + 4, CODE_START + 0x10)});
+  Write(CODE_START + 0x10, {ADDI_R3, BLR});
+
+  ASSERT_EQ(4u, Analyze(true));
+  EXPECT_TRUE(Op(1).isFollowedBranch);
+  EXPECT_EQ(CODE_START + 0x10, Op(1).branchTo);
+  EXPECT_FALSE(Op(1).canEndBlock);
+  EXPECT_EQ(CODE_START + 0x10, Op(2).address);
+  EXPECT_EQ(CODE_START + 0x14, Op(3).address);
+  // The blr of the code the block started in ends it
+  EXPECT_FALSE(Op(3).isFollowedBranch);
+  EXPECT_FALSE(m_block.m_broken);
+}
+
+TEST_F(PPCAnalystTest, TraceFollowsCallAndItsReturn)
+{
+  Write(CODE_START, {BL(CODE_START, CODE_START + 0x100), ADDI_R3, BLR});
+  Write(CODE_START + 0x100, {ADDI_R3, BLR});
+
+  ASSERT_EQ(5u, Analyze(true));
+  EXPECT_TRUE(Op(0).isFollowedBranch);
+  EXPECT_EQ(CODE_START + 0x100, Op(0).branchTo);
+  EXPECT_FALSE(Op(0).canEndBlock);
+
+  // The return is followed back to the caller, but can still leave when LR was changed
+  EXPECT_TRUE(Op(2).isFollowedBranch);
+  EXPECT_EQ(CODE_START + 4, Op(2).branchTo);
+  EXPECT_TRUE(Op(2).canEndBlock);
+
+  EXPECT_EQ(CODE_START + 4, Op(3).address);
+  EXPECT_FALSE(Op(4).isFollowedBranch);
+}
+
+TEST_F(PPCAnalystTest, TraceAsksPredicateForConditionalBranch)
+{
+  Write(CODE_START, {ADDI_R3, BEQ(CODE_START + 4, CODE_START + 0x20), BLR});
+  Write(CODE_START + 0x20, {ADDI_R3, BLR});
+
+  std::vector<std::pair<u32, bool>> asked;
+  bool answer = false;
+  m_analyzer.SetFollowPredicate([&](u32 destination, bool conditional) {
+    asked.emplace_back(destination, conditional);
+    return answer;
+  });
+
+  // Not followed, the block ends at the conditional branch
+  EXPECT_EQ(2u, Analyze(true));
+  EXPECT_FALSE(Op(1).isFollowedBranch);
+  ASSERT_EQ(1u, asked.size());
+  EXPECT_EQ(CODE_START + 0x20, asked[0].first);
+  EXPECT_TRUE(asked[0].second);
+
+  // Followed, the branch leaves through a side exit when it goes the other way
+  answer = true;
+  ASSERT_EQ(4u, Analyze(true));
+  EXPECT_TRUE(Op(1).isFollowedBranch);
+  EXPECT_EQ(CODE_START + 0x20, Op(1).branchTo);
+  EXPECT_TRUE(Op(1).canEndBlock);
+  EXPECT_EQ(CODE_START + 0x20, Op(2).address);
+}
+
+TEST_F(PPCAnalystTest, TraceAsksPredicateForUnconditionalBranch)
+{
+  Write(CODE_START, {ADDI_R3, B(CODE_START + 4, CODE_START + 0x10)});
+  Write(CODE_START + 0x10, {ADDI_R3, BLR});
+
+  std::vector<std::pair<u32, bool>> asked;
+  m_analyzer.SetFollowPredicate([&](u32 destination, bool conditional) {
+    asked.emplace_back(destination, conditional);
+    return false;
+  });
+
+  // Hooked code or another superblock at the target keeps the branch a block link
+  EXPECT_EQ(2u, Analyze(true));
+  EXPECT_FALSE(Op(1).isFollowedBranch);
+  ASSERT_EQ(1u, asked.size());
+  EXPECT_FALSE(asked[0].second);
+}
+
+TEST_F(PPCAnalystTest, TraceLeavesLoopsToBlockLinks)
+{
+  Write(CODE_START, {ADDI_R3, ADDI_R3, B(CODE_START + 8, CODE_START)});
+
+  EXPECT_EQ(3u, Analyze(true));
+  EXPECT_FALSE(Op(2).isFollowedBranch);
+  EXPECT_TRUE(Op(2).canEndBlock);
+}
+
+TEST_F(PPCAnalystTest, TraceStopsAfterEightBranches)
+{
+  // A chain of branches, each jumping over one word
+  std::vector<u32> code;
+  for (u32 i = 0; i < 12; i++)
+  {
+    const u32 address = CODE_START + i * 8;
+    code.push_back(B(address, address + 8));
+    code.push_back(0);
+  }
+  Write(CODE_START, code);
+
+  ASSERT_EQ(9u, Analyze(true));
+  for (u32 i = 0; i < 8; i++)
+  {
+    EXPECT_TRUE(Op(i).isFollowedBranch) << i;
+    EXPECT_EQ(CODE_START + i * 8, Op(i).address) << i;
+  }
+  EXPECT_FALSE(Op(8).isFollowedBranch);
+}
+
+TEST_F(PPCAnalystTest, TraceStopsAtCallDepth)
+{
+  // Each routine calls the next one, five deep
+  for (u32 i = 0; i < 5; i++)
+  {
+    const u32 address = CODE_START + i * 0x100;
+    Write(address, {BL(address, address + 0x100), BLR});
+  }
+  Write(CODE_START + 0x500, {BLR});
+
+  // Four calls are followed, the fifth ends the block
+  ASSERT_EQ(5u, Analyze(true));
+  for (u32 i = 0; i < 4; i++)
+    EXPECT_TRUE(Op(i).isFollowedBranch) << i;
+  EXPECT_FALSE(Op(4).isFollowedBranch);
+  EXPECT_EQ(CODE_START + 0x400, Op(4).address);
+}
+
+TEST_F(PPCAnalystTest, PeekLeavesInstructionCacheAlone)
+{
+  Write(CODE_START, {ADDI_R3, BLR});
+  HID0.ICE = 1;
+  PowerPC::ppcState.iCache.Reset();
+  const u32 set = (CODE_START >> 5) & 0x7f;
+
+  m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_PEEK);
+  EXPECT_EQ(2u, Analyze(false));
+  EXPECT_EQ(ADDI_R3, Op(0).inst.hex);
+  EXPECT_EQ(0u, PowerPC::ppcState.iCache.valid[set]);
+
+  // Reading it the usual way loads the line
+  m_analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_PEEK);
+  EXPECT_EQ(2u, Analyze(false));
+  EXPECT_NE(0u, PowerPC::ppcState.iCache.valid[set]);
+
+  // Now the line is there, peeking reads it from the cache
+  Memory::Write_U32(BLR, CODE_START);
+  m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_PEEK);
+  Analyze(false);
+  EXPECT_EQ(ADDI_R3, Op(0).inst.hex);
+  HID0.ICE = 0;
+}
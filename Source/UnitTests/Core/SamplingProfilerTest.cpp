@@ -0,0 +1,212 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/SamplingProfiler.h"
+
+namespace
+{
+// Routines 0x100 bytes long, named after their address
+std::string Symbolize(u32 address)
+{
+  switch (address & ~0xFFu)
+  {
+  case 0x80001000:
+    return "main";
+  case 0x80002000:
+    return "update physics";
+  case 0x80003000:
+    return "leaf";
+  default:
+    return "unknown";
+  }
+}
+
+// Reads the fields of a protobuf message, nested messages are kept as their bytes
+struct Field
+{
+  u32 number;
+  u64 value;
+  std::string bytes;
+};
+
+u64 ReadVarint(const std::string& data, size_t* pos)
+{
+  u64 value = 0;
+  for (int shift = 0; *pos < data.size(); shift += 7)
+  {
+    const u8 byte = static_cast<u8>(data[(*pos)++]);
+    value |= static_cast<u64>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  return value;
+}
+
+std::vector<Field> ReadFields(const std::string& data)
+{
+  std::vector<Field> fields;
+  size_t pos = 0;
+  while (pos < data.size())
+  {
+    const u64 key = ReadVarint(data, &pos);
+    Field field = {static_cast<u32>(key >> 3), 0, ""};
+    if ((key & 7) == 0)
+    {
+      field.value = ReadVarint(data, &pos);
+    }
+    else
+    {
+      EXPECT_EQ(2u, key & 7);
+      const u64 size = ReadVarint(data, &pos);
+      field.bytes = data.substr(pos, size);
+      pos += size;
+    }
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+const SamplingProfiler::Stacks STACKS = {
+    // In a leaf routine called from physics, with LR its caller
+    {{0x80003010, 0x80002024, 0x80001048}, 5},
+    // In physics after it called the leaf, LR points back into physics itself
+    {{0x80002030, 0x80002024, 0x80001048}, 3},
+    // In main, with LR the return address main saved, into code without a symbol
+    {{0x80001050, 0x80004004, 0x80004004}, 2},
+};
+}
+
+TEST(SamplingProfiler, Folded)
+{
+  EXPECT_EQ("main;update_physics 3\n"
+            "main;update_physics;leaf 5\n"
+            "unknown;main 2\n",
+            SamplingProfiler::ToFolded({STACKS, {}}, Symbolize));
+}
+
+TEST(SamplingProfiler, Pprof)
+{
+  const std::string profile = SamplingProfiler::ToPprof({STACKS, {}}, Symbolize, 1000);
+  std::vector<std::string> strings;
+  std::map<u64, u64> location_function;
+  std::map<u64, u64> function_name;
+  std::vector<Field> samples;
+  u64 period = 0;
+  for (const Field& field : ReadFields(profile))
+  {
+    switch (field.number)
+    {
+    case 2:
+      samples.push_back(field);
+      break;
+    case 4:
+    {
+      u64 id = 0;
+      u64 function = 0;
+      for (const Field& location_field : ReadFields(field.bytes))
+      {
+        if (location_field.number == 1)
+          id = location_field.value;
+        if (location_field.number == 4)
+          function = ReadFields(location_field.bytes)[0].value;
+      }
+      location_function[id] = function;
+      break;
+    }
+    case 5:
+    {
+      const std::vector<Field> function = ReadFields(field.bytes);
+      function_name[function[0].value] = function[1].value;
+      break;
+    }
+    case 6:
+      strings.push_back(field.bytes);
+      break;
+    case 12:
+      period = field.value;
+      break;
+    }
+  }
+
+  ASSERT_FALSE(strings.empty());
+  EXPECT_EQ("", strings[0]);
+  EXPECT_EQ(1000u, period);
+  ASSERT_EQ(3u, samples.size());
+
+  u64 total_samples = 0;
+  u64 total_time = 0;
+  for (const Field& sample : samples)
+  {
+    std::vector<std::string> names;
+    std::vector<u64> values;
+    for (const Field& field : ReadFields(sample.bytes))
+    {
+      size_t pos = 0;
+      while (pos < field.bytes.size())
+      {
+        const u64 value = ReadVarint(field.bytes, &pos);
+        if (field.number == 1)
+          names.push_back(strings[function_name[location_function[value]]]);
+        else
+          values.push_back(value);
+      }
+    }
+    ASSERT_EQ(2u, values.size());
+    total_samples += values[0];
+    total_time += values[1];
+    if (values[0] == 5)
+      EXPECT_EQ((std::vector<std::string>{"leaf", "update physics", "main"}), names);
+  }
+  EXPECT_EQ(10u, total_samples);
+  EXPECT_EQ(10000u, total_time);
+}
+
+TEST(SamplingProfiler, ResimulatedFolded)
+{
+  const SamplingProfiler::Stacks resimulated = {{{0x80003010, 0x80002024, 0x80001048}, 4}};
+  EXPECT_EQ("[resimulated];main;update_physics;leaf 4\n"
+            "main;update_physics 3\n"
+            "main;update_physics;leaf 5\n"
+            "unknown;main 2\n",
+            SamplingProfiler::ToFolded({STACKS, resimulated}, Symbolize));
+}
+
+TEST(SamplingProfiler, ResimulatedPprofLabel)
+{
+  const SamplingProfiler::Stacks resimulated = {{{0x80003010, 0x80002024, 0x80001048}, 4}};
+  const std::string profile = SamplingProfiler::ToPprof({STACKS, resimulated}, Symbolize, 1000);
+  std::vector<std::string> strings;
+  std::vector<Field> samples;
+  for (const Field& field : ReadFields(profile))
+  {
+    if (field.number == 2)
+      samples.push_back(field);
+    if (field.number == 6)
+      strings.push_back(field.bytes);
+  }
+  ASSERT_EQ(4u, samples.size());
+
+  u64 labeled = 0;
+  for (const Field& sample : samples)
+  {
+    for (const Field& field : ReadFields(sample.bytes))
+    {
+      if (field.number != 3)
+        continue;
+      const std::vector<Field> label = ReadFields(field.bytes);
+      ASSERT_EQ(2u, label.size());
+      EXPECT_EQ("rollback", strings.at(label[0].value));
+      EXPECT_EQ("resimulated", strings.at(label[1].value));
+      labeled++;
+    }
+  }
+  EXPECT_EQ(1u, labeled);
+}
@@ -0,0 +1,472 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <SlippiLib/SlippiGame.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+class ReplayBuilder
+{
+public:
+  // fill_mask is applied to the random payload bytes, a small one makes the replay compressible
+  explicit ReplayBuilder(u8 fill_mask = 0xFF) : m_fill_mask(fill_mask)
+  {
+    m_events.push_back(0);
+    m_data = {Slippi::EVENT_PAYLOAD_SIZES, 16,   Slippi::EVENT_GAME_INIT,         0x01, 0x40,
+              Slippi::EVENT_PRE_FRAME_UPDATE,  0x00, 58, Slippi::EVENT_POST_FRAME_UPDATE, 0x00,
+              33,   Slippi::EVENT_FRAME_START, 0x00, 8,  Slippi::EVENT_GAME_END,          0x00,
+              1};
+
+    // Version 3.7.0 with ports 1 and 2 in use
+    std::vector<u8> init(320, 0);
+    init[0] = 3;
+    init[1] = 7;
+    for (int i = 0; i < 4; i++)
+      init[4 + (24 + 9 * i) * 4 + 1] = i < 2 ? 0 : 3;
+    AddEvent(Slippi::EVENT_GAME_INIT, 320, init);
+  }
+
+  // Two players and a follower for the second one, like an Ice Climbers game
+  void AddFrame(s32 frame)
+  {
+    AddEvent(Slippi::EVENT_FRAME_START, 8, Header(frame));
+    AddEvent(Slippi::EVENT_PRE_FRAME_UPDATE, 58, Header(frame, 0, 0));
+    AddEvent(Slippi::EVENT_PRE_FRAME_UPDATE, 58, Header(frame, 1, 0));
+    AddEvent(Slippi::EVENT_PRE_FRAME_UPDATE, 58, Header(frame, 1, 1));
+    AddEvent(Slippi::EVENT_POST_FRAME_UPDATE, 33, Header(frame, 0, 0));
+    AddEvent(Slippi::EVENT_POST_FRAME_UPDATE, 33, Header(frame, 1, 0));
+  }
+
+  void Finish() { AddEvent(Slippi::EVENT_GAME_END, 1, {2}); }
+
+  std::string Write(const std::string& dir) const
+  {
+    std::string path = dir + DIR_SEP "test.slp";
+    File::WriteStringToFile(std::string(m_data.begin(), m_data.end()), path);
+    return path;
+  }
+
+  // Writes the events the way a replay with compression enabled stores them
+  std::string WriteCompressed(const std::string& dir, u32 frames_per_block) const
+  {
+    std::vector<u8> stream;
+    Slippi::CompressedBlockWriter writer(frames_per_block);
+    for (size_t i = 0; i < m_events.size(); i++)
+    {
+      size_t end = i + 1 < m_events.size() ? m_events[i + 1] : m_data.size();
+      writer.AddEvent(&m_data[m_events[i]], end - m_events[i], stream);
+    }
+    writer.Finish(stream);
+
+    u32 size = writer.StreamSize();
+    std::vector<u8> file = {'{', 'U', 4,   'r', 'a', 'w', 'z', '[',
+                            '$', 'U', '#', 'l', static_cast<u8>(size >> 24),
+                            static_cast<u8>(size >> 16), static_cast<u8>(size >> 8), static_cast<u8>(size)};
+    file.insert(file.end(), stream.begin(), stream.end());
+    file.insert(file.end(), {'U', 8, 'm', 'e', 't', 'a', 'd', 'a', 't', 'a', '{', '}', '}'});
+
+    std::string path = dir + DIR_SEP "test_compressed.slp";
+    File::WriteStringToFile(std::string(file.begin(), file.end()), path);
+    return path;
+  }
+
+private:
+  std::vector<u8> Header(s32 frame, int port = -1, int follower = 0)
+  {
+    std::vector<u8> header = {static_cast<u8>(frame >> 24), static_cast<u8>(frame >> 16),
+                              static_cast<u8>(frame >> 8), static_cast<u8>(frame)};
+    if (port >= 0)
+    {
+      header.push_back(static_cast<u8>(port));
+      header.push_back(static_cast<u8>(follower));
+    }
+    return header;
+  }
+
+  void AddEvent(u8 command, size_t size, const std::vector<u8>& header)
+  {
+    m_events.push_back(m_data.size());
+    m_data.push_back(command);
+    m_data.insert(m_data.end(), header.begin(), header.end());
+    for (size_t i = header.size(); i < size; i++)
+      m_data.push_back(static_cast<u8>(m_rng()) & m_fill_mask);
+  }
+
+  std::vector<u8> m_data;
+  std::vector<size_t> m_events;
+  u8 m_fill_mask;
+  std::mt19937 m_rng{42};
+};
+
+ReplayBuilder BuildEvents(s32 last_frame, bool with_rollback, u8 fill_mask = 0xFF)
+{
+  ReplayBuilder builder(fill_mask);
+  s32 frame = Slippi::GAME_FIRST_FRAME;
+  for (; frame <= last_frame; frame++)
+  {
+    builder.AddFrame(frame);
+
+    // Replay a few frames every so often the way a rollback game records them
+    if (with_rollback && frame > 0 && frame % 97 == 0)
+    {
+      for (s32 replayed = frame - 3; replayed <= frame; replayed++)
+        builder.AddFrame(replayed);
+    }
+  }
+  builder.Finish();
+  return builder;
+}
+
+std::string BuildReplay(const std::string& dir, s32 last_frame, bool with_rollback)
+{
+  return BuildEvents(last_frame, with_rollback).Write(dir);
+}
+
+bool SameBits(float a, float b)
+{
+  return memcmp(&a, &b, sizeof(float)) == 0;
+}
+}
+
+TEST(SlippiFrameStore, MatchesBufferedParse)
+{
+  std::string dir = File::CreateTempDir();
+  std::string path = BuildReplay(dir, 1000, true);
+
+  auto buffered = Slippi::SlippiGame::FromFile(path);
+  auto mapped = Slippi::SlippiGame::FromFile(path, Slippi::ParseMode::Mapped);
+  ASSERT_TRUE(buffered && mapped);
+  ASSERT_EQ(buffered->GetLatestIndex(), mapped->GetLatestIndex());
+
+  const Slippi::FrameStore& store = mapped->GetFrameStore();
+  for (u32 pos = 0;; pos++)
+  {
+    Slippi::FrameData* frame = buffered->GetFrameAt(pos);
+    if (!frame)
+    {
+      EXPECT_EQ(pos, store.Size());
+      break;
+    }
+
+    ASSERT_LT(pos, store.Size());
+    EXPECT_EQ(frame->frame, store.frame[pos]);
+    EXPECT_EQ(frame->randomSeed, store.randomSeed[pos]);
+    EXPECT_EQ(frame->inputsFullyFetched, store.inputsFullyFetched[pos] != 0);
+
+    for (u8 port = 0; port < 4; port++)
+    {
+      for (int follower = 0; follower < 2; follower++)
+      {
+        auto& source = follower ? frame->followers : frame->players;
+        const Slippi::PlayerColumns& columns = store.players[Slippi::FrameStore::Slot(port, follower != 0)];
+        ASSERT_EQ(source.count(port) != 0, columns.present[pos] != 0) << pos;
+        if (!source.count(port))
+          continue;
+
+        const Slippi::PlayerFrameData& p = source[port];
+        EXPECT_EQ(p.randomSeed, columns.randomSeed[pos]);
+        EXPECT_EQ(p.buttons, columns.buttons[pos]);
+        EXPECT_EQ(p.animation, columns.animation[pos]);
+        EXPECT_TRUE(SameBits(p.locationX, columns.locationX[pos]));
+        EXPECT_TRUE(SameBits(p.joystickY, columns.joystickY[pos]));
+        EXPECT_TRUE(SameBits(p.percent, columns.percent[pos]));
+        EXPECT_EQ(p.joystickYRaw, columns.joystickYRaw[pos]);
+      }
+    }
+  }
+
+  // Lookups by number land on the latest replay of a frame
+  for (s32 frame = Slippi::GAME_FIRST_FRAME; frame <= 1000; frame++)
+    EXPECT_EQ(buffered->GetFrame(frame)->numSinceStart, static_cast<u32>(store.PosOfFrame(frame)));
+  EXPECT_EQ(-1, store.PosOfFrame(1001));
+
+  File::DeleteDirRecursively(dir);
+}
+
+TEST(SlippiFrameStore, CompressedReplayMatches)
+{
+  std::string dir = File::CreateTempDir();
+  for (u8 fill_mask : {0x03, 0xFF})
+  {
+    ReplayBuilder builder = BuildEvents(1000, true, fill_mask);
+    std::string path = builder.Write(dir);
+    std::string compressed_path = builder.WriteCompressed(dir, 50);
+    if (fill_mask != 0xFF)
+      EXPECT_LT(File::GetSize(compressed_path) * 2, File::GetSize(path));
+
+    auto plain = Slippi::SlippiGame::FromFile(path, Slippi::ParseMode::Mapped);
+    auto mapped = Slippi::SlippiGame::FromFile(compressed_path, Slippi::ParseMode::Mapped);
+    auto buffered = Slippi::SlippiGame::FromFile(compressed_path);
+    ASSERT_TRUE(plain && mapped && buffered);
+    EXPECT_FALSE(plain->IsCompressed());
+    EXPECT_TRUE(mapped->IsCompressed());
+    EXPECT_TRUE(buffered->IsCompressed());
+    ASSERT_EQ(plain->GetLatestIndex(), mapped->GetLatestIndex());
+    ASSERT_EQ(plain->GetLatestIndex(), buffered->GetLatestIndex());
+
+    // Jump around so the mapped game has to switch between blocks
+    std::mt19937 rng(7);
+    for (int i = 0; i < 2000; i++)
+    {
+      s32 frame = Slippi::GAME_FIRST_FRAME + static_cast<s32>(rng() % 1124);
+      const Slippi::FrameIndexEntry* expected = plain->GetFrameEntry(frame);
+      const Slippi::FrameIndexEntry* entry = mapped->GetFrameEntry(frame);
+      ASSERT_TRUE(expected && entry);
+      EXPECT_EQ(expected->numSinceStart, entry->numSinceStart);
+      EXPECT_EQ(expected->randomSeed, entry->randomSeed);
+
+      for (u8 port = 0; port < 2; port++)
+      {
+        Slippi::PlayerFrameData a, b;
+        ASSERT_TRUE(plain->GetPlayerFrame(expected, port, false, &a));
+        ASSERT_TRUE(mapped->GetPlayerFrame(entry, port, false, &b));
+        EXPECT_EQ(a.buttons, b.buttons);
+        EXPECT_EQ(a.animation, b.animation);
+        EXPECT_TRUE(SameBits(a.locationX, b.locationX));
+        EXPECT_EQ(a.internalCharacterId, b.internalCharacterId);
+
+        Slippi::PlayerFrameData& c = buffered->GetFrame(frame)->players[port];
+        EXPECT_EQ(a.buttons, c.buttons);
+        EXPECT_TRUE(SameBits(a.joystickX, c.joystickX));
+      }
+    }
+  }
+
+  File::DeleteDirRecursively(dir);
+}
+
+// Blocks are cut before framesPerBlock frames when asked to and at the game end, so a replay read
+// while it is written doesn't trail the game by a whole block
+TEST(SlippiFrameStore, CompressedBlocksEndEarly)
+{
+  auto frame_start = [](s32 frame) {
+    std::vector<u8> event(9, 0);
+    event[0] = Slippi::EVENT_FRAME_START;
+    event[1] = static_cast<u8>(frame >> 24);
+    event[2] = static_cast<u8>(frame >> 16);
+    event[3] = static_cast<u8>(frame >> 8);
+    event[4] = static_cast<u8>(frame);
+    return event;
+  };
+
+  std::vector<u8> stream;
+  Slippi::CompressedBlockWriter writer(300);
+  for (s32 frame = Slippi::GAME_FIRST_FRAME; frame < Slippi::GAME_FIRST_FRAME + 10; frame++)
+    writer.AddEvent(frame_start(frame).data(), 9, stream);
+  EXPECT_TRUE(writer.BlockIndex().empty());
+
+  writer.EndBlockAtNextFrame();
+  writer.AddEvent(frame_start(Slippi::GAME_FIRST_FRAME + 10).data(), 9, stream);
+  ASSERT_EQ(2u, writer.BlockIndex().size());
+  EXPECT_EQ(Slippi::GAME_FIRST_FRAME, writer.BlockIndex()[1]);
+
+  // The next frame goes on in the same block
+  writer.AddEvent(frame_start(Slippi::GAME_FIRST_FRAME + 11).data(), 9, stream);
+  EXPECT_EQ(2u, writer.BlockIndex().size());
+
+  const u8 game_end[] = {Slippi::EVENT_GAME_END, 2};
+  writer.AddEvent(game_end, sizeof(game_end), stream);
+  ASSERT_EQ(4u, writer.BlockIndex().size());
+  EXPECT_EQ(Slippi::GAME_FIRST_FRAME + 10, writer.BlockIndex()[3]);
+  EXPECT_EQ(stream.size(), writer.StreamSize());
+
+  writer.Finish(stream);
+  EXPECT_EQ(4u, writer.BlockIndex().size());
+  EXPECT_EQ(stream.size(), writer.StreamSize());
+}
+
+// A replay being mirrored or played live grows while it is read, the mapped game picks up the new
+// frames on its next lookup and the entries it handed out before keep working
+TEST(SlippiFrameStore, MappedReplayGrows)
+{
+  std::string dir = File::CreateTempDir();
+  std::string path = BuildReplay(dir, 600, true);
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(path, contents));
+  auto buffered = Slippi::SlippiGame::FromFile(path);
+  ASSERT_TRUE(buffered);
+  // The buffered game reads the file as it is asked for frames, let it see all of it before the cut
+  const s32 full_latest = buffered->GetLatestIndex();
+
+  // Cut in the middle of an event
+  const size_t cut = contents.size() / 2 + 7;
+  ASSERT_TRUE(File::WriteStringToFile(contents.substr(0, cut), path));
+  auto mapped = Slippi::SlippiGame::FromFile(path, Slippi::ParseMode::Mapped);
+  ASSERT_TRUE(mapped);
+  const s32 partial_latest = mapped->GetLatestIndex();
+  EXPECT_LT(partial_latest, full_latest);
+  EXPECT_FALSE(mapped->IsProcessingComplete());
+
+  const s32 early_frame = Slippi::GAME_FIRST_FRAME + 10;
+  const Slippi::FrameIndexEntry* early = mapped->GetFrameEntry(early_frame);
+  ASSERT_TRUE(early);
+
+  // Nothing new, nothing changes
+  EXPECT_EQ(partial_latest, mapped->GetLatestIndex());
+
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file.write(contents.data() + cut, contents.size() - cut);
+  }
+  EXPECT_EQ(full_latest, mapped->GetLatestIndex());
+
+  for (s32 frame : {early_frame, partial_latest, 600})
+  {
+    const Slippi::FrameIndexEntry* entry = frame == early_frame ? early : mapped->GetFrameEntry(frame);
+    ASSERT_TRUE(entry) << frame;
+    for (u8 port = 0; port < 2; port++)
+    {
+      Slippi::PlayerFrameData p;
+      ASSERT_TRUE(mapped->GetPlayerFrame(entry, port, false, &p)) << frame;
+      Slippi::PlayerFrameData& expected = buffered->GetFrame(frame)->players[port];
+      EXPECT_EQ(expected.buttons, p.buttons) << frame;
+      EXPECT_TRUE(SameBits(expected.locationX, p.locationX)) << frame;
+    }
+  }
+
+  mapped.reset();
+  File::DeleteDirRecursively(dir);
+}
+
+// Reads of a growing replay end anywhere, also between the updates of the players of a frame. The
+// frame store has to pick up the players that arrive with the next read.
+TEST(SlippiFrameStore, StoreOfGrowingReplayMatches)
+{
+  std::string dir = File::CreateTempDir();
+  std::string path = BuildReplay(dir, 300, true);
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(path, contents));
+  auto complete = Slippi::SlippiGame::FromFile(path, Slippi::ParseMode::Mapped);
+  ASSERT_TRUE(complete);
+  const Slippi::FrameStore& expected = complete->GetFrameStore();
+
+  // Odd chunk sizes so the reads end at every kind of event
+  size_t written = contents.size() / 3;
+  ASSERT_TRUE(File::WriteStringToFile(contents.substr(0, written), path));
+  auto growing = Slippi::SlippiGame::FromFile(path, Slippi::ParseMode::Mapped);
+  ASSERT_TRUE(growing);
+  growing->GetFrameStore();
+  while (written < contents.size())
+  {
+    const size_t chunk = std::min<size_t>(contents.size() - written, 37);
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::app);
+      file.write(contents.data() + written, chunk);
+    }
+    written += chunk;
+    growing->GetFrameStore();
+  }
+
+  const Slippi::FrameStore& store = growing->GetFrameStore();
+  ASSERT_EQ(expected.Size(), store.Size());
+  for (size_t pos = 0; pos < store.Size(); pos++)
+  {
+    EXPECT_EQ(expected.frame[pos], store.frame[pos]) << pos;
+    EXPECT_EQ(expected.inputsFullyFetched[pos], store.inputsFullyFetched[pos]) << pos;
+    for (int slot = 0; slot < Slippi::FrameStore::SLOT_COUNT; slot++)
+    {
+      const Slippi::PlayerColumns& want = expected.players[slot];
+      const Slippi::PlayerColumns& got = store.players[slot];
+      ASSERT_EQ(want.present[pos], got.present[pos]) << pos << " " << slot;
+      EXPECT_EQ(want.buttons[pos], got.buttons[pos]) << pos << " " << slot;
+      EXPECT_EQ(want.internalCharacterId[pos], got.internalCharacterId[pos]) << pos << " " << slot;
+      EXPECT_TRUE(SameBits(want.locationX[pos], got.locationX[pos])) << pos << " " << slot;
+    }
+  }
+
+  growing.reset();
+  complete.reset();
+  File::DeleteDirRecursively(dir);
+}
+
+// Walks every frame of a 20k frame replay the way playback does, once through the FrameData hash
+// maps and once through the frame store. Run with --gtest_also_run_disabled_tests.
+TEST(SlippiFrameStore, DISABLED_PlaybackWalkBenchmark)
+{
+  const s32 last_frame = 20000 + Slippi::GAME_FIRST_FRAME;
+  std::string dir = File::CreateTempDir();
+  std::string path = BuildReplay(dir, last_frame, false);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  auto buffered = Slippi::SlippiGame::FromFile(path);
+  buffered->GetLatestIndex();
+  auto buffered_loaded = std::chrono::high_resolution_clock::now();
+  auto mapped = Slippi::SlippiGame::FromFile(path, Slippi::ParseMode::Mapped);
+  const Slippi::FrameStore& store = mapped->GetFrameStore();
+  auto mapped_loaded = std::chrono::high_resolution_clock::now();
+
+  const int passes = 20;
+  u64 old_sum = 0;
+  auto old_start = std::chrono::high_resolution_clock::now();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (s32 frame = Slippi::GAME_FIRST_FRAME; frame <= last_frame; frame++)
+    {
+      Slippi::FrameData* data = buffered->GetFrame(frame);
+      old_sum += data->randomSeed;
+      for (u8 port = 0; port < 4; port++)
+      {
+        for (int follower = 0; follower < 2; follower++)
+        {
+          auto& source = follower ? data->followers : data->players;
+          if (!source.count(port))
+            continue;
+          const Slippi::PlayerFrameData& p = source[port];
+          old_sum += p.buttons + p.animation + static_cast<u64>(p.joystickX * 100);
+        }
+      }
+    }
+  }
+  auto old_end = std::chrono::high_resolution_clock::now();
+
+  u64 new_sum = 0;
+  auto new_start = std::chrono::high_resolution_clock::now();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (s32 frame = Slippi::GAME_FIRST_FRAME; frame <= last_frame; frame++)
+    {
+      s32 pos = store.PosOfFrame(frame);
+      new_sum += store.randomSeed[pos];
+      for (int slot = 0; slot < Slippi::FrameStore::SLOT_COUNT; slot++)
+      {
+        const Slippi::PlayerColumns& p = store.players[slot];
+        if (!p.present[pos])
+          continue;
+        new_sum += p.buttons[pos] + p.animation[pos] + static_cast<u64>(p.joystickX[pos] * 100);
+      }
+    }
+  }
+  auto new_end = std::chrono::high_resolution_clock::now();
+  EXPECT_EQ(old_sum, new_sum);
+
+  auto ms = [](auto a, auto b) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000.0;
+  };
+  auto ns_per_frame = [&](auto a, auto b) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() /
+           static_cast<double>(passes * (last_frame - Slippi::GAME_FIRST_FRAME + 1));
+  };
+  printf("load: buffered %.2f ms, mapped + frame store %.2f ms\n", ms(start, buffered_loaded),
+         ms(buffered_loaded, mapped_loaded));
+  printf("walk: hash maps %.1f ns/frame, frame store %.1f ns/frame\n", ns_per_frame(old_start, old_end),
+         ns_per_frame(new_start, new_end));
+
+  File::DeleteDirRecursively(dir);
+}
@@ -0,0 +1,107 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/Slippi/SlippiResimulation.h"
+
+TEST(SlippiResimulation, ResimulatesUpToTheLatestFrame)
+{
+  SlippiResimulation resim;
+  resim.Reset();
+  for (s32 frame = 1; frame <= 10; frame++)
+  {
+    resim.NewFrame(frame, frame * 1000);
+    resim.CaptureState(frame, frame * 1000 + 10);
+    EXPECT_FALSE(resim.IsResimulating());
+  }
+
+  // Inputs for frame 10 were mispredicted back to frame 7, frames 7 to 9 are run again
+  resim.LoadState(7, 10100);
+  EXPECT_TRUE(resim.IsResimulating());
+  resim.CaptureState(7, 10200);
+  resim.CaptureState(8, 10300);
+  resim.CaptureState(9, 10400);
+  EXPECT_TRUE(resim.IsResimulating());
+  resim.CaptureState(10, 10500);
+  EXPECT_FALSE(resim.IsResimulating());
+
+  SlippiResimulation::Stats stats = resim.GetStats();
+  EXPECT_EQ(1u, stats.rollbacks);
+  EXPECT_EQ(3u, stats.frames);
+  EXPECT_EQ(400u, stats.hostTimeUs);
+  EXPECT_EQ(400u, stats.maxRollbackUs);
+}
+
+TEST(SlippiResimulation, EndsAtTheNextFrame)
+{
+  SlippiResimulation resim;
+  resim.Reset();
+  resim.NewFrame(20, 0);
+
+  // Loading the current frame, or a later one, is not a rollback
+  resim.LoadState(20, 100);
+  EXPECT_FALSE(resim.IsResimulating());
+
+  resim.LoadState(18, 200);
+  resim.CaptureState(18, 300);
+  EXPECT_TRUE(resim.IsResimulating());
+  // The capture of frame 20 never came
+  resim.NewFrame(21, 500);
+  EXPECT_FALSE(resim.IsResimulating());
+
+  resim.LoadState(19, 1000);
+  resim.CaptureState(21, 1100);
+  EXPECT_FALSE(resim.IsResimulating());
+
+  SlippiResimulation::Stats stats = resim.GetStats();
+  EXPECT_EQ(2u, stats.rollbacks);
+  EXPECT_EQ(4u, stats.frames);
+  EXPECT_EQ(400u, stats.hostTimeUs);
+  EXPECT_EQ(300u, stats.maxRollbackUs);
+
+  resim.Reset();
+  EXPECT_EQ(0u, resim.GetStats().rollbacks);
+}
+
+TEST(SlippiResimulation, ComparisonAlternatesSkipping)
+{
+  SlippiResimulation resim;
+  resim.Reset(true, true);
+  resim.NewFrame(30, 0);
+
+  // Rollbacks of 2, 3 and 4 frames, drawn, skipped and drawn again
+  const bool expected_skipping[] = {false, true, false};
+  for (s32 i = 0; i < 3; i++)
+  {
+    const u64 start = 1000 * (i + 1);
+    resim.LoadState(28 - i, start);
+    EXPECT_TRUE(resim.IsResimulating());
+    EXPECT_EQ(expected_skipping[i], resim.IsSkippingDraws()) << i;
+    resim.CaptureState(30, start + 100 * (i + 1));
+    EXPECT_FALSE(resim.IsSkippingDraws());
+  }
+
+  SlippiResimulation::Stats drawn = resim.GetStats(false);
+  SlippiResimulation::Stats skipped = resim.GetStats(true);
+  EXPECT_EQ(2u, drawn.rollbacks);
+  EXPECT_EQ(6u, drawn.frames);
+  EXPECT_EQ(400u, drawn.hostTimeUs);
+  EXPECT_EQ(1u, skipped.rollbacks);
+  EXPECT_EQ(3u, skipped.frames);
+  EXPECT_EQ(200u, skipped.hostTimeUs);
+  EXPECT_EQ(3u, resim.GetStats().rollbacks);
+  EXPECT_EQ(300u, resim.GetStats().maxRollbackUs);
+
+  // Without a comparison the setting decides
+  resim.Reset(true, false);
+  resim.NewFrame(10, 0);
+  resim.LoadState(8, 100);
+  EXPECT_TRUE(resim.IsSkippingDraws());
+  resim.Reset(false, false);
+  resim.NewFrame(10, 0);
+  resim.LoadState(8, 100);
+  EXPECT_FALSE(resim.IsSkippingDraws());
+}
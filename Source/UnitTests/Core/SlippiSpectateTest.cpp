@@ -0,0 +1,201 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Slippi/SlippiSpectate.h"
+#include "base64.hpp"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+constexpr u16 TEST_PORT = 53741;
+
+struct Spectator
+{
+  ENetPeer* peer = nullptr;
+  bool connected = false;
+  bool requested = false;
+  bool ended = false;
+  u64 next_cursor = 0;
+  bool has_cursor = false;
+  bool cursor_error = false;
+  size_t game_packets = 0;
+  std::string data;
+};
+
+void HandlePacket(Spectator* spectator, const ENetPacket* packet)
+{
+  json message =
+      json::parse(std::string(reinterpret_cast<const char*>(packet->data), packet->dataLength), nullptr, false);
+  if (message.is_discarded() || !message["type"].is_string())
+    return;
+
+  std::string type = message["type"];
+  if (type == "connect_reply" || type == "menu_event")
+    return;
+
+  // Every message has to carry on exactly where the previous one left off
+  u64 cursor = message["cursor"];
+  if (spectator->has_cursor && cursor != spectator->next_cursor)
+    spectator->cursor_error = true;
+  spectator->next_cursor = message["next_cursor"];
+  spectator->has_cursor = true;
+
+  if (type == "game_event")
+  {
+    std::string payload;
+    base64::Base64::Decode(message["payload"], payload);
+    spectator->data += payload;
+    spectator->game_packets++;
+  }
+  else if (type == "end_game")
+  {
+    spectator->ended = true;
+  }
+}
+
+void Service(ENetHost* host, std::vector<Spectator>* spectators)
+{
+  ENetEvent event;
+  while (enet_host_service(host, &event, 0) > 0)
+  {
+    for (Spectator& spectator : *spectators)
+    {
+      if (spectator.peer != event.peer)
+        continue;
+
+      if (event.type == ENET_EVENT_TYPE_CONNECT)
+        spectator.connected = true;
+      else if (event.type == ENET_EVENT_TYPE_RECEIVE)
+        HandlePacket(&spectator, event.packet);
+    }
+
+    if (event.type == ENET_EVENT_TYPE_RECEIVE)
+      enet_packet_destroy(event.packet);
+  }
+
+  for (Spectator& spectator : *spectators)
+  {
+    if (spectator.connected && !spectator.requested)
+    {
+      std::string request = "{\"type\":\"connect_request\",\"cursor\":0}";
+      enet_peer_send(spectator.peer, 0,
+                     enet_packet_create(request.data(), request.size(), ENET_PACKET_FLAG_RELIABLE));
+      spectator.requested = true;
+    }
+  }
+}
+
+void Connect(ENetHost* host, std::vector<Spectator>* spectators, size_t first, size_t count)
+{
+  ENetAddress address;
+  enet_address_set_host(&address, "127.0.0.1");
+  address.port = TEST_PORT;
+  for (size_t i = first; i < first + count; i++)
+    (*spectators)[i].peer = enet_host_connect(host, &address, 2, 0);
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    Service(host, spectators);
+    bool all_requested = true;
+    for (size_t i = first; i < first + count; i++)
+      all_requested &= (*spectators)[i].requested;
+    if (all_requested)
+      return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+std::vector<u8> MakeEvent(u8 command, size_t size, u32 seed)
+{
+  std::vector<u8> event(size);
+  event[0] = command;
+  for (size_t i = 1; i < size; i++)
+    event[i] = static_cast<u8>(seed * 31 + i);
+  return event;
+}
+}
+
+// Half of the spectators watch from the start, the other half join mid game and have to catch up
+// on everything sent so far. All of them have to end up with the exact stream the game wrote.
+TEST(SlippiSpectate, ManySpectatorsStress)
+{
+  SConfig::Init();
+  SConfig::GetInstance().m_enableSpectator = true;
+  SConfig::GetInstance().m_spectator_local_port = TEST_PORT;
+  SlippiSpectateServer* server = SlippiSpectateServer::getInstance();
+
+  ASSERT_EQ(0, enet_initialize());
+  const size_t spectator_count = 24;
+  ENetHost* host = enet_host_create(nullptr, spectator_count, 2, 0, 0);
+  ASSERT_NE(nullptr, host);
+
+  std::vector<Spectator> spectators(spectator_count);
+  Connect(host, &spectators, 0, spectator_count / 2);
+
+  std::string written;
+  auto write = [&](const std::vector<u8>& event) {
+    server->write(const_cast<u8*>(event.data()), static_cast<u32>(event.size()));
+    written.append(event.begin(), event.end());
+  };
+
+  server->startGame();
+  write(MakeEvent(0x36, 321, 0));
+  const u32 frames = 1200;
+  for (u32 frame = 0; frame < frames; frame++)
+  {
+    write(MakeEvent(0x3A, 13, frame));
+    for (u32 player = 0; player < 4; player++)
+      write(MakeEvent(0x37, 65, frame + player));
+    for (u32 player = 0; player < 4; player++)
+      write(MakeEvent(0x38, 81, frame + player));
+    write(MakeEvent(0x3C, 9, frame));
+
+    if (frame == frames / 2)
+      Connect(host, &spectators, spectator_count / 2, spectator_count - spectator_count / 2);
+
+    Service(host, &spectators);
+    if (frame % 8 == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  write(MakeEvent(0x39, 3, 0));
+  server->endGame();
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    Service(host, &spectators);
+    bool all_ended = true;
+    for (const Spectator& spectator : spectators)
+      all_ended &= spectator.ended;
+    if (all_ended)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  for (size_t i = 0; i < spectator_count; i++)
+  {
+    const Spectator& spectator = spectators[i];
+    EXPECT_TRUE(spectator.ended) << i;
+    EXPECT_FALSE(spectator.cursor_error) << i;
+    EXPECT_TRUE(spectator.data == written) << i;
+  }
+
+  // Catching up on the first half of the game should not take a packet per frame
+  EXPECT_LT(spectators.back().game_packets, spectators.front().game_packets - frames / 4);
+
+  for (Spectator& spectator : spectators)
+    enet_peer_disconnect_now(spectator.peer, 0);
+  enet_host_destroy(host);
+  enet_deinitialize();
+}
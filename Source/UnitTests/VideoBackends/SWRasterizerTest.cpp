@@ -0,0 +1,235 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+struct Frame
+{
+  std::vector<u32> color;
+  std::vector<u32> depth;
+  std::vector<u32> perf;
+  u16 bbox[4];
+};
+
+// One TEV stage passing the rasterized color through, alpha blended and depth tested, so the result
+// of every pixel depends on the order of the triangles covering it
+void SetupState()
+{
+  memset(&bpmem, 0, sizeof(bpmem));
+  bpmem.genMode.numcolchans = 1;
+  bpmem.genMode.numtevstages = 0;
+
+  bpmem.combiners[0].colorC.d = TEVCOLORARG_RASC;
+  bpmem.combiners[0].colorC.a = TEVCOLORARG_ZERO;
+  bpmem.combiners[0].colorC.b = TEVCOLORARG_ZERO;
+  bpmem.combiners[0].colorC.c = TEVCOLORARG_ZERO;
+  bpmem.combiners[0].colorC.clamp = 1;
+  bpmem.combiners[0].alphaC.d = TEVALPHAARG_RASA;
+  bpmem.combiners[0].alphaC.a = TEVALPHAARG_ZERO;
+  bpmem.combiners[0].alphaC.b = TEVALPHAARG_ZERO;
+  bpmem.combiners[0].alphaC.c = TEVALPHAARG_ZERO;
+  bpmem.combiners[0].alphaC.clamp = 1;
+  bpmem.tevksel[0].swap1 = 0;
+  bpmem.tevksel[0].swap2 = 1;
+  bpmem.tevksel[1].swap1 = 2;
+  bpmem.tevksel[1].swap2 = 3;
+
+  bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+  bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+
+  bpmem.blendmode.blendenable = 1;
+  bpmem.blendmode.colorupdate = 1;
+  bpmem.blendmode.alphaupdate = 1;
+  bpmem.blendmode.srcfactor = BlendMode::SRCALPHA;
+  bpmem.blendmode.dstfactor = BlendMode::INVSRCALPHA;
+
+  bpmem.zmode.testenable = 1;
+  bpmem.zmode.updateenable = 1;
+  bpmem.zmode.func = ZMode::LEQUAL;
+  bpmem.zcontrol.pixel_format = PEControl::RGBA6_Z24;
+
+  // The whole EFB
+  bpmem.scissorOffset.x = 171;
+  bpmem.scissorOffset.y = 171;
+  bpmem.scissorTL.x = 342;
+  bpmem.scissorTL.y = 342;
+  bpmem.scissorBR.x = 341 + EFB_WIDTH;
+  bpmem.scissorBR.y = 341 + EFB_HEIGHT;
+
+  g_ActiveConfig.bZComploc = true;
+  g_ActiveConfig.bZFreeze = true;
+  g_ActiveConfig.bDumpTevStages = false;
+  g_ActiveConfig.bDumpTevTextureFetches = false;
+  BoundingBox::active = false;
+}
+
+std::vector<OutputVertexData> MakeTriangles(int count)
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> x(-40.0f, EFB_WIDTH + 40.0f);
+  std::uniform_real_distribution<float> y(-40.0f, EFB_HEIGHT + 40.0f);
+  std::uniform_real_distribution<float> z(0.0f, 16777215.0f);
+
+  std::vector<OutputVertexData> vertices(count * 3);
+  for (int i = 0; i < count; i++)
+  {
+    // Mostly small triangles and a few large ones that cross many tiles
+    const float size = (i % 16 == 0) ? 400.0f : 30.0f;
+    const float cx = x(rng);
+    const float cy = y(rng);
+    for (int v = 0; v < 3; v++)
+    {
+      OutputVertexData& vertex = vertices[i * 3 + v];
+      vertex.screenPosition.x = cx + (static_cast<float>(rng() % 1000) / 1000.0f - 0.5f) * size;
+      vertex.screenPosition.y = cy + (static_cast<float>(rng() % 1000) / 1000.0f - 0.5f) * size;
+      vertex.screenPosition.z = z(rng);
+      vertex.projectedPosition.w = 1.0f;
+      for (u8& component : vertex.color[0])
+        component = static_cast<u8>(rng());
+    }
+  }
+  return vertices;
+}
+
+Frame Draw(int threads, std::vector<OutputVertexData>& vertices, int batch_size,
+           bool early_ztest)
+{
+  SetupState();
+  bpmem.zcontrol.early_ztest = early_ztest;
+  g_ActiveConfig.iSWThreads = threads;
+  Rasterizer::Init();
+  Rasterizer::SetScissor();
+  for (int reg = 0; reg < 4; reg++)
+  {
+    for (int comp = 0; comp < 4; comp++)
+    {
+      Rasterizer::SetTevReg(reg, comp, false, 0);
+      Rasterizer::SetTevReg(reg, comp, true, 0);
+    }
+  }
+
+  u8 clear_color[4] = {0, 0, 0, 0};
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+    {
+      EfbInterface::SetColor(x, y, clear_color);
+      EfbInterface::SetDepth(x, y, 0xFFFFFF);
+    }
+  }
+  memset(EfbInterface::perf_values, 0, sizeof(EfbInterface::perf_values));
+  memset(EfbInterface::perf_quad_pixels, 0, sizeof(EfbInterface::perf_quad_pixels));
+  BoundingBox::coords[BoundingBox::LEFT] = EFB_WIDTH;
+  BoundingBox::coords[BoundingBox::RIGHT] = 0;
+  BoundingBox::coords[BoundingBox::TOP] = EFB_HEIGHT;
+  BoundingBox::coords[BoundingBox::BOTTOM] = 0;
+
+  const size_t count = vertices.size() / 3;
+  for (size_t first = 0; first < count; first += batch_size)
+  {
+    Rasterizer::BeginBatch();
+    for (size_t i = first; i < count && i < first + batch_size; i++)
+    {
+      Rasterizer::DrawTriangleFrontFace(&vertices[i * 3], &vertices[i * 3 + 1],
+                                        &vertices[i * 3 + 2]);
+    }
+    Rasterizer::EndBatch();
+  }
+  Rasterizer::Shutdown();
+
+  Frame frame;
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+    {
+      u32 color;
+      EfbInterface::GetColor(x, y, reinterpret_cast<u8*>(&color));
+      frame.color.push_back(color);
+      frame.depth.push_back(EfbInterface::GetDepth(x, y));
+    }
+  }
+  frame.perf.assign(EfbInterface::perf_values, EfbInterface::perf_values + PQ_NUM_MEMBERS);
+  memcpy(frame.bbox, BoundingBox::coords, sizeof(frame.bbox));
+  return frame;
+}
+}
+
+// Without SSE4.1 the pixels are drawn one by one, with it the two of each row of a block at once
+TEST(SWRasterizer, TiledMatchesSerial)
+{
+  std::vector<OutputVertexData> vertices = MakeTriangles(2000);
+  for (bool early_ztest : {false, true})
+  {
+    const bool had_sse41 = cpu_info.bSSE4_1;
+    cpu_info.bSSE4_1 = false;
+    const Frame serial = Draw(1, vertices, 2000, early_ztest);
+    cpu_info.bSSE4_1 = had_sse41;
+    ASSERT_NE(serial.perf[PQ_BLEND_INPUT], 0u);
+
+    for (int threads : {1, 2, 4, 7})
+    {
+      for (int batch_size : {1, 97, 2000})
+      {
+        const Frame tiled = Draw(threads, vertices, batch_size, early_ztest);
+        EXPECT_TRUE(tiled.color == serial.color) << threads << " threads, batches of " << batch_size;
+        EXPECT_TRUE(tiled.depth == serial.depth) << threads << " threads, batches of " << batch_size;
+        EXPECT_EQ(serial.perf, tiled.perf);
+        EXPECT_EQ(0, memcmp(serial.bbox, tiled.bbox, sizeof(serial.bbox)));
+      }
+    }
+  }
+}
+
+TEST(SWRasterizer, StagesReadingThePreviousPixel)
+{
+  SetupState();
+  EXPECT_FALSE(Tev::ReadsPreviousPixel());
+
+  // c0 is read before the stage that writes it, so it comes from the previous pixel
+  bpmem.genMode.numtevstages = 1;
+  bpmem.combiners[0].colorC.a = TEVCOLORARG_C0;
+  bpmem.combiners[1] = bpmem.combiners[0];
+  bpmem.combiners[1].colorC.a = TEVCOLORARG_ZERO;
+  bpmem.combiners[1].colorC.dest = 1;
+  EXPECT_TRUE(Tev::ReadsPreviousPixel());
+
+  // Written first, read afterwards
+  std::swap(bpmem.combiners[0], bpmem.combiners[1]);
+  EXPECT_FALSE(Tev::ReadsPreviousPixel());
+
+  // A constant register that no stage writes
+  bpmem.combiners[1].alphaC.a = TEVALPHAARG_A2;
+  EXPECT_FALSE(Tev::ReadsPreviousPixel());
+
+  // The texture color of a stage without a texture is the one of the last stage that had one
+  bpmem.combiners[0].colorC.b = TEVCOLORARG_TEXC;
+  bpmem.tevorders[0].enable1 = 1;
+  EXPECT_TRUE(Tev::ReadsPreviousPixel());
+  bpmem.tevorders[0].enable0 = 1;
+  EXPECT_FALSE(Tev::ReadsPreviousPixel());
+
+  // Indirect texture coordinates the first stage adds to are the last ones of the previous pixel
+  bpmem.tevind[0].fb_addprev = 1;
+  EXPECT_TRUE(Tev::ReadsPreviousPixel());
+  bpmem.tevind[0].fb_addprev = 0;
+  bpmem.tevind[1].fb_addprev = 1;
+  EXPECT_FALSE(Tev::ReadsPreviousPixel());
+}
@@ -0,0 +1,204 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+constexpr u16 PIXELS_PER_CONFIG = 256;
+
+// Random stages and blending, without textures, fog and depth testing
+void RandomizeState(std::mt19937& rng, PEControl::PixelFormat format)
+{
+  memset(&bpmem, 0, sizeof(bpmem));
+  bpmem.genMode.numcolchans = 2;
+  bpmem.genMode.numtevstages = rng() % 16;
+  for (auto& combiner : bpmem.combiners)
+  {
+    combiner.colorC.hex = rng() & 0xFFFFFF;
+    combiner.alphaC.hex = rng() & 0xFFFFFF;
+  }
+  for (auto& order : bpmem.tevorders)
+  {
+    order.hex = rng();
+    order.enable0 = 0;
+    order.enable1 = 0;
+  }
+  for (auto& ksel : bpmem.tevksel)
+    ksel.hex = rng();
+
+  bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+  bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+
+  bpmem.blendmode.hex = rng();
+  bpmem.blendmode.colorupdate = 1;
+  bpmem.blendmode.alphaupdate = 1;
+  bpmem.dstalpha.hex = rng();
+  bpmem.zcontrol.pixel_format = format;
+
+  g_ActiveConfig.bZComploc = true;
+  g_ActiveConfig.bDumpTevStages = false;
+  g_ActiveConfig.bDumpTevTextureFetches = false;
+  BoundingBox::active = false;
+}
+
+// Rerolls the register inputs that would come from the previous pixel, the ones a stage reads
+// before the stage writing them, so the pixels can be drawn in any order
+void MakeOrderIndependent(std::mt19937& rng)
+{
+  u32 written_color = 0;
+  u32 written_alpha = 0;
+  for (u32 stage = 0; stage <= bpmem.genMode.numtevstages; stage++)
+  {
+    written_color |= 1 << bpmem.combiners[stage].colorC.dest;
+    written_alpha |= 1 << bpmem.combiners[stage].alphaC.dest;
+  }
+
+  u32 done_color = 0;
+  u32 done_alpha = 0;
+  const auto stale = [&](u32 reg, bool alpha) {
+    const u32 written = alpha ? written_alpha : written_color;
+    const u32 done = alpha ? done_alpha : done_color;
+    return (written & (1 << reg)) && !(done & (1 << reg));
+  };
+  const auto color_input = [&]() {
+    u32 input;
+    do
+      input = rng() % 16;
+    while (input < TEVCOLORARG_TEXC && stale(input >> 1, input & 1));
+    return input;
+  };
+  const auto alpha_input = [&]() {
+    u32 input;
+    do
+      input = rng() % 8;
+    while (input < TEVALPHAARG_TEXA && stale(input, true));
+    return input;
+  };
+
+  for (u32 stage = 0; stage <= bpmem.genMode.numtevstages; stage++)
+  {
+    TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stage].colorC;
+    TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stage].alphaC;
+    cc.a = color_input();
+    cc.b = color_input();
+    cc.c = color_input();
+    cc.d = color_input();
+    ac.a = alpha_input();
+    ac.b = alpha_input();
+    ac.c = alpha_input();
+    ac.d = alpha_input();
+    done_color |= 1 << cc.dest;
+    done_alpha |= 1 << ac.dest;
+  }
+}
+
+// Draws a row of pixels, in pairs if pairs is set
+std::vector<u32> DrawPixels(u32 seed, bool sse41, bool pairs = false)
+{
+  const bool had_sse41 = cpu_info.bSSE4_1;
+  cpu_info.bSSE4_1 = sse41;
+
+  std::mt19937 rng(seed);
+  for (u16 x = 0; x < PIXELS_PER_CONFIG; x++)
+  {
+    u32 color = rng();
+    EfbInterface::SetColor(x, 0, reinterpret_cast<u8*>(&color));
+  }
+
+  Tev tev;
+  tev.Init();
+  for (int reg = 0; reg < 4; reg++)
+  {
+    for (int comp = 0; comp < 4; comp++)
+    {
+      tev.SetRegColor(reg, comp, false, static_cast<s16>(rng() % 2048) - 1024);
+      tev.SetRegColor(reg, comp, true, static_cast<s16>(rng() % 256));
+    }
+  }
+
+  Tev first;
+  first.Init();
+  first.CopyState(tev);
+
+  for (u16 x = 0; x < PIXELS_PER_CONFIG; x++)
+  {
+    Tev& pixel = (pairs && x % 2 == 0) ? first : tev;
+    pixel.Position[0] = x;
+    pixel.Position[1] = 0;
+    pixel.Position[2] = 0;
+    for (auto& channel : pixel.Color)
+    {
+      for (u8& component : channel)
+        component = static_cast<u8>(rng());
+    }
+    if (!pairs)
+      tev.Draw();
+    else if (x % 2 == 1)
+      tev.DrawPair(first);
+  }
+
+  std::vector<u32> colors(PIXELS_PER_CONFIG);
+  for (u16 x = 0; x < PIXELS_PER_CONFIG; x++)
+    EfbInterface::GetColor(x, 0, reinterpret_cast<u8*>(&colors[x]));
+
+  cpu_info.bSSE4_1 = had_sse41;
+  return colors;
+}
+}
+
+// The registers are left unclamped and out of the 8 bit range by many stages, and the following
+// pixels read them, so any difference in the combiners shows up in the EFB sooner or later.
+TEST(SWTev, VectorCombinersMatchScalar)
+{
+  if (!cpu_info.bSSE4_1)
+    return;
+
+  std::mt19937 rng(5678);
+  for (int config = 0; config < 2000; config++)
+  {
+    // RGB8 keeps all the color bits, RGBA6 keeps alpha
+    const PEControl::PixelFormat format = (config & 1) ? PEControl::RGBA6_Z24 : PEControl::RGB8_Z24;
+    RandomizeState(rng, format);
+    const u32 seed = rng();
+
+    const std::vector<u32> scalar = DrawPixels(seed, false);
+    const std::vector<u32> vector = DrawPixels(seed, true);
+    ASSERT_TRUE(scalar == vector) << "config " << config << ", blend mode " << std::hex
+                                  << bpmem.blendmode.hex;
+  }
+}
+
+// Pairs of pixels have the combiners of both run at once, which has to give the same as drawing
+// one after the other when no stage reads what the previous pixel left in the registers
+TEST(SWTev, PairsMatchSinglePixels)
+{
+  std::mt19937 rng(8765);
+  for (int config = 0; config < 2000; config++)
+  {
+    const PEControl::PixelFormat format = (config & 1) ? PEControl::RGBA6_Z24 : PEControl::RGB8_Z24;
+    RandomizeState(rng, format);
+    MakeOrderIndependent(rng);
+    ASSERT_FALSE(Tev::ReadsPreviousPixel());
+    const u32 seed = rng();
+
+    const std::vector<u32> single = DrawPixels(seed, false);
+    ASSERT_TRUE(single == DrawPixels(seed, false, true)) << "config " << config;
+    if (cpu_info.bSSE4_1)
+      ASSERT_TRUE(single == DrawPixels(seed, true, true)) << "config " << config;
+  }
+}
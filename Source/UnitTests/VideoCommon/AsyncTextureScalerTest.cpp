@@ -0,0 +1,109 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/AsyncTextureScaler.h"
+#include "VideoCommon/TextureScalerCommon.h"
+
+namespace
+{
+// Smooth gradients with a few hard edges, so the edge detecting scalers have work to do
+std::vector<u32> MakeTexture(int width, int height, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u32> texels(width * height);
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      const u32 base = ((x * 4) & 0xFF) | (((y * 4) & 0xFF) << 8) | 0xFF000000;
+      texels[y * width + x] = (rng() % 8 == 0) ? rng() : base;
+    }
+  }
+  return texels;
+}
+
+AsyncTextureScaler::Texture MakeLevels(u32 seed)
+{
+  AsyncTextureScaler::Texture texture;
+  for (u32 size : {64u, 32u, 16u, 8u})
+  {
+    AsyncTextureScaler::Level level = {size, size, size, MakeTexture(size, size, seed + size)};
+    texture.push_back(level);
+  }
+  return texture;
+}
+}
+
+TEST(TextureScaler, ThreadedMatchesSerial)
+{
+  TextureScaler serial(1);
+  TextureScaler threaded(4);
+
+  // Tall enough to be split into many slices, with a height that does not divide evenly
+  const int width = 96;
+  const int height = 203;
+  const std::vector<u32> source = MakeTexture(width, height, 1234);
+  for (int type = TextureScaler::XBRZ; type <= TextureScaler::DDT_SHARP; type++)
+  {
+    for (int factor : {2, 3})
+    {
+      for (bool deposterize : {false, true})
+      {
+        std::vector<u32> input(source);
+        const u32* scaled = serial.Scale(input.data(), width, height, type, factor, deposterize);
+        const std::vector<u32> expected(scaled, scaled + width * height * factor * factor);
+        scaled = threaded.Scale(input.data(), width, height, type, factor, deposterize);
+        const std::vector<u32> result(scaled, scaled + width * height * factor * factor);
+        EXPECT_TRUE(expected == result) << "type " << type << ", factor " << factor
+                                        << ", deposterize " << deposterize;
+      }
+    }
+  }
+}
+
+TEST(AsyncTextureScaler, ScaledTexturesAreCached)
+{
+  const std::string cache_dir = File::CreateTempDir() + DIR_SEP;
+  const AsyncTextureScaler::Texture source = MakeLevels(42);
+  const AsyncTextureScaler::Settings settings = {TextureScaler::XBRZ, 2, false};
+  const u64 key = AsyncTextureScaler::GetKey(source, settings);
+  EXPECT_NE(key, AsyncTextureScaler::GetKey(source, {TextureScaler::XBRZ, 3, false}));
+  EXPECT_NE(key, AsyncTextureScaler::GetKey(MakeLevels(43), settings));
+
+  AsyncTextureScaler::Texture scaled;
+  {
+    AsyncTextureScaler scaler(cache_dir, 2);
+    ASSERT_TRUE(scaler.Fetch(key, source, settings, true, &scaled));
+    ASSERT_EQ(source.size(), scaled.size());
+    for (size_t level = 0; level < source.size(); level++)
+    {
+      EXPECT_EQ(source[level].width * 2, scaled[level].width);
+      EXPECT_EQ(source[level].height * 2, scaled[level].height);
+      EXPECT_EQ(scaled[level].expanded_width * scaled[level].height, scaled[level].data.size());
+    }
+  }
+
+  // A new session gets the same texture back, from the disk this time
+  AsyncTextureScaler scaler(cache_dir, 2);
+  AsyncTextureScaler::Texture loaded;
+  EXPECT_FALSE(scaler.Fetch(key, source, settings, false, &loaded));
+  while (!scaler.IsReady(key))
+    std::this_thread::yield();
+  ASSERT_TRUE(scaler.Fetch(key, source, settings, false, &loaded));
+  ASSERT_EQ(scaled.size(), loaded.size());
+  for (size_t level = 0; level < scaled.size(); level++)
+    EXPECT_TRUE(scaled[level].data == loaded[level].data) << "level " << level;
+
+  File::DeleteDirRecursively(cache_dir);
+}
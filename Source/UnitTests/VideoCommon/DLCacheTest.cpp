@@ -0,0 +1,268 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+constexpr u32 LIST_ADDRESS = 0x00100000;
+constexpr u32 ARRAY_ADDRESS = 0x00200000;
+constexpr u32 POSITIONS = 16;
+constexpr u32 POSITION_STRIDE = 12;
+constexpr u8 DRAW_TRIANGLES = 0x80 | (GX_DRAW_TRIANGLES << GX_PRIMITIVE_SHIFT);
+
+class TestNativeVertexFormat : public NativeVertexFormat
+{
+public:
+  explicit TestNativeVertexFormat(const PortableVertexDeclaration& decl) { vtx_decl = decl; }
+  void SetupVertexPointers() override {}
+};
+
+// Keeps everything drawn in one batch, the lists below never make it flush
+class TestVertexManager : public VertexManagerBase
+{
+public:
+  TestVertexManager() : m_vertices(MAXVBUFFERSIZE), m_indices(MAXIBUFFERSIZE) {}
+
+  std::unique_ptr<NativeVertexFormat>
+  CreateNativeVertexFormat(const PortableVertexDeclaration& decl) override
+  {
+    return std::make_unique<TestNativeVertexFormat>(decl);
+  }
+  void PrepareShaders(PrimitiveType, u32, const XFMemory&, const BPMemory&, bool) override {}
+
+  std::vector<u8> Vertices() const
+  {
+    return std::vector<u8>(m_pBaseBufferPointer, m_pCurBufferPointer);
+  }
+  std::vector<u16> Indices() const
+  {
+    return std::vector<u16>(m_indices.data(), m_indices.data() + IndexGenerator::GetIndexLen());
+  }
+
+protected:
+  void ResetBuffer(u32) override
+  {
+    m_pCurBufferPointer = m_pBaseBufferPointer = m_vertices.data();
+    m_pEndBufferPointer = m_pBaseBufferPointer + m_vertices.size();
+    IndexGenerator::Start(m_indices.data());
+  }
+
+private:
+  void vFlush(bool) override { ADD_FAILURE() << "The test lists shouldn't flush"; }
+  u16* GetIndexBuffer() override { return m_indices.data(); }
+
+  std::vector<u8> m_vertices;
+  std::vector<u16> m_indices;
+};
+
+// Big endian, like the GPU reads it
+class ListWriter
+{
+public:
+  void U8(u8 value) { m_data.push_back(value); }
+  void U16(u16 value)
+  {
+    U8(value >> 8);
+    U8(value & 0xFF);
+  }
+  void U32(u32 value)
+  {
+    U16(value >> 16);
+    U16(value & 0xFFFF);
+  }
+  void CP(u8 sub_cmd, u32 value)
+  {
+    U8(GX_LOAD_CP_REG);
+    U8(sub_cmd);
+    U32(value);
+  }
+  // Indexed positions and direct colors
+  void Draw(const std::vector<u8>& indices)
+  {
+    U8(DRAW_TRIANGLES);
+    U16(static_cast<u16>(indices.size()));
+    for (u8 index : indices)
+    {
+      U8(index);
+      U32(0x10203000 | index);
+    }
+  }
+  const std::vector<u8>& Data() const { return m_data; }
+
+private:
+  std::vector<u8> m_data;
+};
+
+void WritePosition(u32 index, float value)
+{
+  for (u32 component = 0; component < 3; component++)
+  {
+    u32 bits;
+    const float f = value + component;
+    std::memcpy(&bits, &f, sizeof(bits));
+    Memory::Write_U32(bits, ARRAY_ADDRESS + index * POSITION_STRIDE + component * 4);
+  }
+}
+
+// What the vertex manager got from a run of calls
+struct Output
+{
+  std::vector<u8> vertices;
+  std::vector<u16> indices;
+  u32 cycles = 0;
+  int cached_calls = 0;
+};
+
+// Something the guest does between two calls of the list
+using Step = void (*)();
+
+class DLCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SConfig::Init();
+    Memory::Init();
+    IndexGenerator::Init();
+    OpcodeDecoder::Init();
+    std::memset(&g_main_cp_state, 0, sizeof(g_main_cp_state));
+    g_main_cp_state.vtx_desc.Position = INDEX8;
+    g_main_cp_state.vtx_desc.Color0 = DIRECT;
+    g_main_cp_state.vtx_attr[0].g0.PosElements = 1;
+    g_main_cp_state.vtx_attr[0].g0.PosFormat = FORMAT_FLOAT;
+    g_main_cp_state.vtx_attr[0].g0.Color0Elements = 1;
+    g_main_cp_state.vtx_attr[0].g0.Color0Comp = 5;  // RGBA8888
+    xfmem.viewport.wd = 320.0f;
+    xfmem.viewport.ht = -240.0f;
+  }
+
+  void TearDown() override
+  {
+    g_ActiveConfig.bDisplayListCache = false;
+    Memory::Shutdown();
+    SConfig::Shutdown();
+  }
+
+  // Calls the list once for every step, running the step after the call
+  static Output Run(const std::vector<u8>& list, u32 size, const std::vector<Step>& steps,
+                    bool cache)
+  {
+    g_ActiveConfig.bDisplayListCache = cache;
+    g_vertex_manager = std::make_unique<TestVertexManager>();
+    VertexLoaderManager::Init();
+    DLCache::Init();
+    const CPState start_state = g_main_cp_state;
+    for (u32 i = 0; i < POSITIONS; i++)
+      WritePosition(i, 10.0f * i);
+    for (size_t i = 0; i < list.size(); i++)
+      Memory::Write_U8(list[i], LIST_ADDRESS + static_cast<u32>(i));
+
+    ListWriter call;
+    call.U8(GX_CMD_CALL_DL);
+    call.U32(LIST_ADDRESS);
+    call.U32(size);
+    std::memset(&stats, 0, sizeof(stats));
+
+    Output output;
+    for (Step step : steps)
+    {
+      DataReader reader(const_cast<u8*>(call.Data().data()),
+                        const_cast<u8*>(call.Data().data()) + call.Data().size());
+      u32 cycles = 0;
+      OpcodeDecoder::Run<false, true>(reader, &cycles);
+      output.cycles += cycles;
+      if (step)
+        step();
+    }
+    output.cached_calls = stats.thisFrame.numDListsCached;
+
+    const auto* vertex_manager = static_cast<TestVertexManager*>(g_vertex_manager.get());
+    output.vertices = vertex_manager->Vertices();
+    output.indices = vertex_manager->Indices();
+
+    VertexLoaderManager::Shutdown();
+    DLCache::Shutdown();
+    g_vertex_manager.reset();
+    g_main_cp_state = start_state;
+    return output;
+  }
+
+  static void ExpectSame(const Output& uncached, const Output& cached)
+  {
+    EXPECT_EQ(uncached.cycles, cached.cycles);
+    EXPECT_TRUE(uncached.vertices == cached.vertices);
+    EXPECT_TRUE(uncached.indices == cached.indices);
+  }
+};
+}  // namespace
+
+// Replayed and converted again draws have to give the vertex manager what the interpreter does,
+// also after the arrays the list reads change
+TEST_F(DLCacheTest, ReplayMatchesInterpreter)
+{
+  ListWriter list;
+  list.CP(0xA0 + ARRAY_POSITION, ARRAY_ADDRESS);
+  list.CP(0xB0 + ARRAY_POSITION, POSITION_STRIDE);
+  list.Draw({0, 1, 2, 3, 4, 5});
+  list.U8(GX_NOP);
+  list.Draw({7, 6, 5});
+
+  const std::vector<Step> steps = {
+      nullptr,
+      nullptr,
+      nullptr,
+      // A position the list reads
+      [] { WritePosition(6, -1.0f); },
+      nullptr,
+      // One it doesn't
+      [] { WritePosition(12, -2.0f); },
+      nullptr,
+  };
+
+  const Output uncached = Run(list.Data(), static_cast<u32>(list.Data().size()), steps, false);
+  const Output cached = Run(list.Data(), static_cast<u32>(list.Data().size()), steps, true);
+  EXPECT_EQ(0, uncached.cached_calls);
+  // The first call is interpreted and the second one compiles the list
+  EXPECT_EQ(static_cast<int>(steps.size()) - 2, cached.cached_calls);
+  ExpectSame(uncached, cached);
+  EXPECT_EQ(steps.size() * 9, uncached.indices.size());
+}
+
+// A command cut off by the end of the list isn't run, its data after the list isn't read
+TEST_F(DLCacheTest, CutOffCommandIsNotRun)
+{
+  ListWriter list;
+  list.CP(0xA0 + ARRAY_POSITION, ARRAY_ADDRESS);
+  list.CP(0xB0 + ARRAY_POSITION, POSITION_STRIDE);
+  list.Draw({0, 1, 2});
+  list.CP(0xB0 + ARRAY_TEXCOORD0, 8);
+  const u32 size = static_cast<u32>(list.Data().size()) - 2;
+
+  const Step check = [] { EXPECT_EQ(0u, g_main_cp_state.array_strides[ARRAY_TEXCOORD0]); };
+  const std::vector<Step> steps = {check, check, check};
+  const Output uncached = Run(list.Data(), size, steps, false);
+  const Output cached = Run(list.Data(), size, steps, true);
+  EXPECT_EQ(0, cached.cached_calls);
+  ExpectSame(uncached, cached);
+}
@@ -0,0 +1,262 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+struct Format
+{
+  const char* name;
+  u32 format;
+  TlutFormat tlut_format;
+};
+
+const Format FORMATS[] = {
+    {"I4", GX_TF_I4, GX_TL_IA8},
+    {"I8", GX_TF_I8, GX_TL_IA8},
+    {"IA8", GX_TF_IA8, GX_TL_IA8},
+    {"RGB5A3", GX_TF_RGB5A3, GX_TL_IA8},
+    {"C4 IA8", GX_TF_C4, GX_TL_IA8},
+    {"C4 RGB565", GX_TF_C4, GX_TL_RGB565},
+    {"C4 RGB5A3", GX_TF_C4, GX_TL_RGB5A3},
+    {"C8 IA8", GX_TF_C8, GX_TL_IA8},
+    {"C8 RGB565", GX_TF_C8, GX_TL_RGB565},
+    {"C8 RGB5A3", GX_TF_C8, GX_TL_RGB5A3},
+    {"CMPR", GX_TF_CMPR, GX_TL_IA8},
+};
+
+// Where the palette goes in TMEM
+const u32 TLUT_ADDRESS = 0x80000;
+
+std::vector<u8> MakeData(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+    byte = static_cast<u8>(rng());
+  return data;
+}
+
+// Random palette, with enough of the top bits set and cleared to hit both RGB5A3 variants
+void FillPalette(u32 seed)
+{
+  std::mt19937 rng(seed);
+  for (u32 i = 0; i < 512; i++)
+    texMem[TLUT_ADDRESS + i] = static_cast<u8>(rng());
+}
+
+std::vector<u32> Decode(const u8* src, u32 width, u32 height, const Format& format,
+                       u32 tlut_address = TLUT_ADDRESS)
+{
+  std::vector<u32> dst(width * height);
+  TexDecoder_Decode(reinterpret_cast<u8*>(dst.data()), src, width, height, format.format,
+                    tlut_address, format.tlut_format, true);
+  return dst;
+}
+
+// In whatever format the backends get the texture in, with CMPR decompressed
+std::vector<u32> DecodeNative(const u8* src, u32 width, u32 height, const Format& format,
+                              PC_TexFormat* pc_format)
+{
+  std::vector<u32> dst(width * height);
+  *pc_format = TexDecoder_Decode(reinterpret_cast<u8*>(dst.data()), src, width, height,
+                                 format.format, TLUT_ADDRESS, format.tlut_format, false, false);
+  return dst;
+}
+
+// Decoders to compare, picked through the CPU flags the texture decoder checks
+struct DecoderFlags
+{
+  const char* name;
+  bool ssse3;
+  bool avx2;
+};
+
+class ScopedDecoderFlags
+{
+public:
+  explicit ScopedDecoderFlags(const DecoderFlags& flags)
+      : m_ssse3(cpu_info.bSSSE3), m_avx2(cpu_info.bAVX2)
+  {
+    cpu_info.bSSSE3 = flags.ssse3 && m_ssse3;
+    cpu_info.bAVX2 = flags.avx2 && m_avx2;
+  }
+  ~ScopedDecoderFlags()
+  {
+    cpu_info.bSSSE3 = m_ssse3;
+    cpu_info.bAVX2 = m_avx2;
+  }
+
+private:
+  bool m_ssse3;
+  bool m_avx2;
+};
+}
+
+TEST(TextureDecoder, AVX2MatchesSSE)
+{
+  if (!cpu_info.bAVX2)
+  {
+    printf("Skipping, this CPU does not have AVX2\n");
+    return;
+  }
+
+  // Texture sizes are padded to whole blocks by the texture cache, width 12 leaves half a pair of
+  // 4 texel wide blocks at the end of each row
+  const u32 sizes[][2] = {{8, 8}, {12, 8}, {40, 24}, {64, 64}, {256, 128}, {1024, 8}};
+  u32 seed = 1;
+  for (const Format& format : FORMATS)
+  {
+    const u32 block_width = TexDecoder_GetBlockWidthInTexels(format.format);
+    const u32 block_height = TexDecoder_GetBlockHeightInTexels(format.format);
+    for (const auto& size : sizes)
+    {
+      const u32 width = (size[0] + block_width - 1) / block_width * block_width;
+      const u32 height = (size[1] + block_height - 1) / block_height * block_height;
+      const std::vector<u8> src =
+          MakeData(TexDecoder_GetTextureSizeInBytes(width, height, format.format), seed);
+      FillPalette(seed++);
+
+      std::vector<u32> expected;
+      {
+        ScopedDecoderFlags flags({"SSSE3", true, false});
+        expected = Decode(src.data(), width, height, format);
+      }
+      const std::vector<u32> result = Decode(src.data(), width, height, format);
+      EXPECT_TRUE(expected == result) << format.name << " " << width << "x" << height;
+
+      // The texel decoder works from the same formulas, except for the CMPR colors in between
+      if (format.format == GX_TF_CMPR)
+        continue;
+      const u16* tlut = reinterpret_cast<const u16*>(texMem + TLUT_ADDRESS);
+      for (u32 t = 0; t < height; t++)
+      {
+        for (u32 s = 0; s < width; s++)
+        {
+          u32 texel;
+          TexDecoder_DecodeTexel(reinterpret_cast<u8*>(&texel), src.data(), s, t, width - 1,
+                                 format.format, tlut, format.tlut_format);
+          ASSERT_EQ(texel, result[t * width + s])
+              << format.name << " " << width << "x" << height << " at " << s << "," << t;
+        }
+      }
+    }
+  }
+}
+
+TEST(TextureDecoder, AVX2MatchesSSENative)
+{
+  if (!cpu_info.bAVX2)
+  {
+    printf("Skipping, this CPU does not have AVX2\n");
+    return;
+  }
+
+  const u32 sizes[][2] = {{8, 8}, {40, 24}, {64, 64}, {256, 128}};
+  u32 seed = 100;
+  for (const Format& format : FORMATS)
+  {
+    const u32 block_width = TexDecoder_GetBlockWidthInTexels(format.format);
+    const u32 block_height = TexDecoder_GetBlockHeightInTexels(format.format);
+    for (const auto& size : sizes)
+    {
+      const u32 width = (size[0] + block_width - 1) / block_width * block_width;
+      const u32 height = (size[1] + block_height - 1) / block_height * block_height;
+      const std::vector<u8> src =
+          MakeData(TexDecoder_GetTextureSizeInBytes(width, height, format.format), seed);
+      FillPalette(seed++);
+
+      PC_TexFormat expected_format;
+      std::vector<u32> expected;
+      {
+        ScopedDecoderFlags flags({"SSSE3", true, false});
+        expected = DecodeNative(src.data(), width, height, format, &expected_format);
+      }
+      PC_TexFormat result_format;
+      const std::vector<u32> result =
+          DecodeNative(src.data(), width, height, format, &result_format);
+      EXPECT_EQ(expected_format, result_format) << format.name << " " << width << "x" << height;
+      EXPECT_TRUE(expected == result) << format.name << " " << width << "x" << height;
+    }
+  }
+}
+
+// A palette at the end of TMEM is cut off there, indices past it must not read beyond TMEM
+TEST(TextureDecoder, PaletteAtTheEndOfTMEM)
+{
+  const u32 entries = 16;
+  const u32 tlut_address = TMEM_SIZE - entries * 2;
+  const Format format = {"C8 RGB5A3", GX_TF_C8, GX_TL_RGB5A3};
+  const u32 width = 64;
+  const u32 height = 64;
+  std::vector<u8> src = MakeData(TexDecoder_GetTextureSizeInBytes(width, height, format.format), 7);
+  for (u8& index : src)
+    index %= entries;
+  std::mt19937 rng(7);
+  for (u32 i = 0; i < entries * 2; i++)
+    texMem[tlut_address + i] = static_cast<u8>(rng());
+
+  std::vector<u32> expected;
+  {
+    ScopedDecoderFlags flags({"SSSE3", true, false});
+    expected = Decode(src.data(), width, height, format, tlut_address);
+  }
+  EXPECT_TRUE(expected == Decode(src.data(), width, height, format, tlut_address));
+}
+
+TEST(TextureDecoder, DISABLED_DecodeBenchmark)
+{
+  // Texture data dumped from a game gives more realistic CMPR blocks than random bytes
+  std::vector<u8> data;
+  if (const char* path = getenv("TEXTURE_DECODE_DATA"))
+  {
+    std::string contents;
+    if (File::ReadFileToString(path, contents))
+      data.assign(contents.begin(), contents.end());
+  }
+  const u32 width = 512;
+  const u32 height = 512;
+  if (data.size() < width * height * 4)
+    data = MakeData(width * height * 4, 4321);
+  FillPalette(4321);
+
+  const DecoderFlags decoders[] = {
+      {"SSE2", false, false}, {"SSSE3", true, false}, {"AVX2", true, true}};
+  const int repeats = 100;
+  for (const Format& format : FORMATS)
+  {
+    printf("%-10s", format.name);
+    for (const DecoderFlags& decoder : decoders)
+    {
+      ScopedDecoderFlags flags(decoder);
+      std::vector<u32> dst(width * height);
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int r = 0; r < repeats; r++)
+      {
+        TexDecoder_Decode(reinterpret_cast<u8*>(dst.data()), data.data(), width, height,
+                          format.format, TLUT_ADDRESS, format.tlut_format, true);
+      }
+      auto end = std::chrono::high_resolution_clock::now();
+      const double seconds = std::chrono::duration<double>(end - start).count();
+      // Decoded bytes a second
+      const double mb = static_cast<double>(width) * height * 4 * repeats / (1024 * 1024);
+      printf("  %s %8.1f MB/s", decoder.name, mb / seconds);
+    }
+    printf("\n");
+  }
+}
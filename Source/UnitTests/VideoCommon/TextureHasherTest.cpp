@@ -0,0 +1,252 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemTools.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureHasher.h"
+
+namespace
+{
+struct TextureShape
+{
+  const char* name;
+  u32 width;
+  u32 height;
+  u32 format;
+};
+
+// What Melee keeps hashing: full and half resolution EFB copies, stage backgrounds, character and
+// stage textures and the small UI and effect textures
+const TextureShape MELEE_TEXTURES[] = {
+    {"efb copy 640x528 RGB565", 640, 528, GX_TF_RGB565},
+    {"efb copy 640x528 RGBA8", 640, 528, GX_TF_RGBA8},
+    {"efb copy 320x264 RGB565", 320, 264, GX_TF_RGB565},
+    {"background 512x512 CMPR", 512, 512, GX_TF_CMPR},
+    {"background 256x256 RGBA8", 256, 256, GX_TF_RGBA8},
+    {"model 128x128 CMPR", 128, 128, GX_TF_CMPR},
+    {"model 64x64 RGB5A3", 64, 64, GX_TF_RGB5A3},
+    {"ui 128x64 I8", 128, 64, GX_TF_I8},
+    {"effect 32x32 IA4", 32, 32, GX_TF_IA4},
+    {"palette 64x64 C8", 64, 64, GX_TF_C8},
+};
+
+std::vector<u8> MakeData(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> data(size);
+  for (u8& b : data)
+    b = static_cast<u8>(rng());
+  return data;
+}
+}
+
+TEST(TextureHasher, ThreadedMatchesSerial)
+{
+  TextureHasher serial(1);
+  TextureHasher threaded(4);
+  const std::vector<u8> data = MakeData(2 * 1024 * 1024, 1234);
+
+  // Unaligned starts and ends, with pieces both smaller and larger than the parallel threshold
+  for (u32 address : {0u, 32u, 4064u, 0x12340u})
+  {
+    for (u32 size : {32u, 4096u, 100000u, 675840u, 1048576u})
+    {
+      const u64 hash = serial.Hash(data.data(), address, size, 0, false);
+      EXPECT_EQ(hash, threaded.Hash(data.data(), address, size, 0, false)) << address << " " << size;
+    }
+  }
+  EXPECT_NE(0u, threaded.GetStats().parallel_hashes);
+
+  // Strided EFB copies, one row of blocks per 2560 bytes
+  EXPECT_EQ(serial.HashStrided(data.data(), 2048, 2560, 132, 2560 * 132, 0),
+            threaded.HashStrided(data.data(), 2048, 2560, 132, 2560 * 132, 0));
+
+  // Sampled hashes are left alone
+  EXPECT_EQ(GetHash64(data.data(), 65536, 128), threaded.Hash(data.data(), 0, 65536, 128, false));
+}
+
+TEST(TextureHasher, ChangesAreSeen)
+{
+  TextureHasher hasher(4);
+  std::vector<u8> data = MakeData(1024 * 1024, 4321);
+  const u64 hash = hasher.Hash(data.data(), 0, static_cast<u32>(data.size()), 0, false);
+
+  // Pages hashing the same at different spots must not cancel out
+  std::vector<u8> swapped(data);
+  std::copy(data.begin(), data.begin() + 4096, swapped.begin() + 8192);
+  std::copy(data.begin() + 8192, data.begin() + 12288, swapped.begin());
+  EXPECT_NE(hash, hasher.Hash(swapped.data(), 0, static_cast<u32>(data.size()), 0, false));
+
+  data[700000] ^= 1;
+  EXPECT_NE(hash, hasher.Hash(data.data(), 0, static_cast<u32>(data.size()), 0, false));
+}
+
+// The texture cache reuses textures found by hash alone, wherever they were loaded from
+TEST(TextureHasher, SameDataHashesTheSameAnywhere)
+{
+  TextureHasher hasher(1);
+  const std::vector<u8> data = MakeData(100000, 2468);
+  const u64 hash = hasher.Hash(data.data(), 0x1000, static_cast<u32>(data.size()), 0, false);
+  for (u32 address : {0x20u, 0xFE0u, 0x12340u})
+    EXPECT_EQ(hash, hasher.Hash(data.data(), address, static_cast<u32>(data.size()), 0, false))
+        << address;
+}
+
+namespace
+{
+constexpr u32 TRACKED_START = 0x80000000;
+constexpr u32 TRACKED_SIZE = 1024 * 1024;
+
+// Hashes textures in main RAM with dirty page tracking on, as during rollback netplay
+class TrackedTextureHasherTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    Core::DeclareAsCPUThread();
+    SConfig::Init();
+    SConfig::GetInstance().bFastmem = true;
+    PowerPC::Init(PowerPC::CORE_INTERPRETER);
+    Memory::Init();
+    EMM::InstallExceptionHandler();
+    const std::vector<u8> data = MakeData(TRACKED_SIZE, 1357);
+    std::copy(data.begin(), data.end(), Memory::m_pRAM);
+    m_tracking = Memory::EnableDirtyPageTracking({{TRACKED_START, TRACKED_SIZE}});
+  }
+
+  void TearDown() override
+  {
+    Memory::DisableDirtyPageTracking();
+    EMM::UninstallExceptionHandler();
+    Memory::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Core::UndeclareAsCPUThread();
+  }
+
+  u64 Hash(u32 address, u32 size) { return m_hasher.Hash(Memory::m_pRAM + address, address, size, 0); }
+
+  TextureHasher m_hasher{1};
+  bool m_tracking = false;
+};
+}
+
+TEST_F(TrackedTextureHasherTest, WrittenPagesAreHashedAgain)
+{
+  if (!m_tracking)
+    return;
+
+  // A texture covering 15 whole pages, with a partial page on both ends
+  const u32 address = 0x10020;
+  const u32 size = 16 * Memory::DIRTY_PAGE_SIZE + 0x40;
+  const u64 hash = Hash(address, size);
+  EXPECT_EQ(17u, m_hasher.GetStats().pages_hashed);
+  EXPECT_EQ(0u, m_hasher.GetStats().pages_reused);
+
+  // Nothing was written, only the partial pages are hashed again
+  m_hasher.ResetStats();
+  EXPECT_EQ(hash, Hash(address, size));
+  EXPECT_EQ(15u, m_hasher.GetStats().pages_reused);
+  EXPECT_EQ(2u, m_hasher.GetStats().pages_hashed);
+
+  // Page hashes outlive the epoch they were taken in as long as the page isn't written
+  Memory::AdvanceDirtyPageEpoch();
+  m_hasher.ResetStats();
+  EXPECT_EQ(hash, Hash(address, size));
+  EXPECT_EQ(15u, m_hasher.GetStats().pages_reused);
+
+  // A write through the tracked mapping makes the page hash again
+  volatile u8* page = Memory::m_pRAM + address + 5 * Memory::DIRTY_PAGE_SIZE;
+  *page = *page ^ 0xFF;
+  m_hasher.ResetStats();
+  const u64 written_hash = Hash(address, size);
+  EXPECT_NE(hash, written_hash);
+  EXPECT_EQ(14u, m_hasher.GetStats().pages_reused);
+  EXPECT_EQ(3u, m_hasher.GetStats().pages_hashed);
+
+  // Its new hash was taken in the epoch it was written in, which could have raced the hashing, so
+  // it is hashed once more after that epoch is closed and kept from then on
+  Memory::AdvanceDirtyPageEpoch();
+  m_hasher.ResetStats();
+  EXPECT_EQ(written_hash, Hash(address, size));
+  EXPECT_EQ(14u, m_hasher.GetStats().pages_reused);
+  m_hasher.ResetStats();
+  EXPECT_EQ(written_hash, Hash(address, size));
+  EXPECT_EQ(15u, m_hasher.GetStats().pages_reused);
+
+  // Writing it back hashes as before
+  *page = *page ^ 0xFF;
+  EXPECT_EQ(hash, Hash(address, size));
+}
+
+// Compares full texture hashes through GetHash64 with the page hashes of TextureHasher, on one
+// thread and on four. Set TEXTURE_HASH_DATA to any file, e.g. a RAM dump, to hash its contents
+// instead of random data.
+TEST(TextureHasher, DISABLED_HashBenchmark)
+{
+  std::vector<u8> data;
+  if (const char* path = getenv("TEXTURE_HASH_DATA"))
+  {
+    std::string contents;
+    if (File::ReadFileToString(path, contents))
+      data.assign(contents.begin(), contents.end());
+  }
+  if (data.size() < 4 * 1024 * 1024)
+    data = MakeData(4 * 1024 * 1024, 8765);
+
+  SetHash64Function();
+  TextureHasher serial(1);
+  TextureHasher threaded(4);
+  const int repeats = 200;
+
+  for (const TextureShape& shape : MELEE_TEXTURES)
+  {
+    const u32 size = TexDecoder_GetTextureSizeInBytes(shape.width, shape.height, shape.format);
+    // Spread the textures over the data, so the repeats do not all hit the CPU cache
+    const u32 spots = static_cast<u32>(data.size() / size);
+    auto run = [&](auto&& hash) {
+      u64 sink = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int r = 0; r < repeats; r++)
+      {
+        const u32 address = (r % spots) * size;
+        sink ^= hash(data.data() + address, address);
+      }
+      auto end = std::chrono::high_resolution_clock::now();
+      const double ns = static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+      return std::make_pair(ns / repeats / 1000.0, sink);
+    };
+
+    const auto base = run([&](const u8* src, u32) { return GetHash64(src, size, 0); });
+    const auto one = run([&](const u8* src, u32 address) {
+      return serial.Hash(src, address, size, 0, false);
+    });
+    const auto four = run([&](const u8* src, u32 address) {
+      return threaded.Hash(src, address, size, 0, false);
+    });
+    EXPECT_EQ(one.second, four.second) << shape.name;
+
+    printf("%-26s %7u bytes  GetHash64 %8.2f us  1 thread %8.2f us  4 threads %8.2f us\n", shape.name,
+           size, base.first, one.first, four.first);
+  }
+}
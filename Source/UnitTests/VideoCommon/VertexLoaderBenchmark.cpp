@@ -0,0 +1,242 @@
+// Copyright 2026 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderCompiled.h"
+#include "VideoCommon/VideoConfig.h"
+#ifdef _M_X86_64
+#include "VideoCommon/VertexLoaderX64.h"
+#endif
+
+// include order is important, x64Emitter.h has a TEST member
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+struct Stream
+{
+  u32 uid[4];
+  u32 strides[12];
+  u32 vertex_size;
+  std::vector<u8> data;
+};
+
+// The loader uid keeps the vertex description shifted down by one, with the position matrix index
+// bit moved into the unused top bit of the second VAT word.
+void DecodeUID(const u32* uid, TVtxDesc* desc, VAT* vat)
+{
+  desc->Hex = (static_cast<u64>(uid[0]) << 1) | (uid[2] >> 31);
+  vat->g0.Hex = uid[1];
+  vat->g1.Hex = uid[2] & 0x7FFFFFFFu;
+  vat->g2.Hex = uid[3];
+}
+
+// Reads a G_<gameid>_vtx.bin written by VertexLoaderManager while dumping vertex loaders
+std::vector<Stream> ReadCapture(const std::string& path)
+{
+  std::vector<Stream> streams;
+  std::string contents;
+  if (!File::ReadFileToString(path, contents) || contents.size() < 12)
+    return streams;
+
+  const u8* p = reinterpret_cast<const u8*>(contents.data());
+  const u8* end = p + contents.size();
+  auto read_u32 = [&](u32* value) {
+    if (end - p < 4)
+      return false;
+    memcpy(value, p, 4);
+    p += 4;
+    return true;
+  };
+
+  u32 magic, version, count;
+  read_u32(&magic);
+  read_u32(&version);
+  read_u32(&count);
+  if (magic != 0x58545647 || version != 1)
+    return streams;
+
+  for (u32 i = 0; i < count; i++)
+  {
+    Stream stream;
+    u32 size = 0;
+    bool ok = true;
+    for (u32& word : stream.uid)
+      ok &= read_u32(&word);
+    for (u32& stride : stream.strides)
+      ok &= read_u32(&stride);
+    ok &= read_u32(&stream.vertex_size);
+    ok &= read_u32(&size);
+    if (!ok || static_cast<size_t>(end - p) < size)
+      break;
+    stream.data.assign(p, p + size);
+    p += size;
+    streams.push_back(std::move(stream));
+  }
+  return streams;
+}
+
+// A few formats that are in the precompiled sets, so all three loaders can run them
+std::vector<Stream> MakeSyntheticStreams()
+{
+  static const u32 uids[][4] = {
+      {0x000f0f00u, 0x40a00c09u, 0x00000009u, 0x00000000u},
+      {0x00001100u, 0x4000e007u, 0x00000000u, 0x00000000u},
+      {0x003f0f00u, 0x41201009u, 0x00001209u, 0x00000000u},
+  };
+
+  std::mt19937 rng(4321);
+  std::vector<Stream> streams;
+  for (const auto& uid : uids)
+  {
+    Stream stream;
+    memcpy(stream.uid, uid, sizeof(stream.uid));
+    for (u32& stride : stream.strides)
+      stride = 32;
+
+    TVtxDesc desc;
+    VAT vat;
+    DecodeUID(stream.uid, &desc, &vat);
+    stream.vertex_size = VertexLoader(desc, vat).m_VertexSize;
+    stream.data.resize(stream.vertex_size * 20000);
+    for (u8& b : stream.data)
+      b = static_cast<u8>(rng());
+    streams.push_back(std::move(stream));
+  }
+  return streams;
+}
+
+// Runs every stream through the x64 JIT, the precompiled templated and the generic vertex loader
+// and expects them to write the same vertices. Returns the time each loader took in total.
+void RunStreams(const std::vector<Stream>& streams, int repeats, bool print, std::vector<u64>* total_ns,
+                std::vector<u64>* total_verts)
+{
+  g_ActiveConfig.iBBoxMode = BBoxNone;
+  g_main_cp_state.matrix_index_a.Hex = 0;
+
+  // Indexed attributes read from here, indices go up to 0xFFFF and strides up to 0xFF
+  std::vector<u8> array_data(0x10000 * 0x100 + 0x100);
+  std::mt19937 rng(8765);
+  for (u8& b : array_data)
+    b = static_cast<u8>(rng());
+  for (u8*& base : cached_arraybases)
+    base = array_data.data();
+
+  total_ns->assign(3, 0);
+  total_verts->assign(3, 0);
+  for (const Stream& stream : streams)
+  {
+    TVtxDesc desc;
+    VAT vat;
+    DecodeUID(stream.uid, &desc, &vat);
+    for (int i = 0; i < 12; i++)
+      g_main_cp_state.array_strides[i] = stream.strides[i];
+
+    std::vector<std::pair<const char*, std::unique_ptr<VertexLoaderBase>>> loaders;
+#ifdef _M_X86_64
+    loaders.emplace_back("jit", std::make_unique<VertexLoaderX64>(desc, vat));
+#else
+    loaders.emplace_back("jit", nullptr);
+#endif
+    loaders.emplace_back("templated", std::make_unique<VertexLoaderCompiled>(desc, vat));
+    loaders.emplace_back("generic", std::make_unique<VertexLoader>(desc, vat));
+
+    const VertexLoaderBase* reference = loaders.back().second.get();
+    if (stream.vertex_size == 0 || static_cast<u32>(reference->m_VertexSize) != stream.vertex_size)
+      continue;
+    const int count = static_cast<int>(stream.data.size() / stream.vertex_size);
+    if (count == 0)
+      continue;
+
+    std::vector<u8> source(stream.data);
+    std::vector<u8> output;
+    std::vector<u8> expected;
+
+    if (print)
+      printf("%s (%d vertices)\n", reference->GetName().c_str(), count);
+    // The generic loader runs last, its output is the one the others are held to
+    for (size_t l = loaders.size(); l-- > 0;)
+    {
+      VertexLoaderBase* loader = loaders[l].second.get();
+      if (!loader || !loader->IsInitialized())
+        continue;
+
+      output.assign(count * reference->m_native_stride + 64, 0);
+      VertexLoaderParameters parameters = {};
+      parameters.source = source.data();
+      parameters.destination = output.data();
+      parameters.VtxDesc = &desc;
+      parameters.VtxAttr = &vat;
+      parameters.buf_size = source.size();
+      parameters.primitive = 0;
+      parameters.count = count;
+
+      s32 written = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int r = 0; r < repeats; r++)
+        written = loader->RunVertices(parameters);
+      auto end = std::chrono::high_resolution_clock::now();
+      u64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+      EXPECT_EQ(reference->m_native_stride, loader->m_native_stride) << loaders[l].first;
+      EXPECT_EQ(count, written) << loaders[l].first << " " << reference->GetName();
+      output.resize(written * loader->m_native_stride);
+      if (expected.empty())
+        expected = output;
+      else
+        EXPECT_EQ(expected, output) << loaders[l].first << " " << reference->GetName();
+
+      (*total_ns)[l] += ns;
+      (*total_verts)[l] += static_cast<u64>(count) * repeats;
+      if (print)
+        printf("  %-10s %8.2f ns/vertex\n", loaders[l].first, double(ns) / (double(count) * repeats));
+    }
+  }
+}
+}
+
+// The formats in the precompiled sets come out the same from every loader
+TEST(VertexLoader, LoadersMatch)
+{
+  std::vector<u64> total_ns, total_verts;
+  RunStreams(MakeSyntheticStreams(), 1, false, &total_ns, &total_verts);
+  EXPECT_NE(0u, total_verts[2]);
+}
+
+// Compares the speed of the loaders on the same vertex streams. Set VERTEX_LOADER_CAPTURE to a
+// G_<gameid>_vtx.bin from a "Dump Vertex Loaders" session to run it on real data, the templated
+// loader only runs for formats in a precompiled set.
+TEST(VertexLoader, DISABLED_LoaderBenchmark)
+{
+  std::vector<Stream> streams;
+  if (const char* path = getenv("VERTEX_LOADER_CAPTURE"))
+    streams = ReadCapture(path);
+  if (streams.empty())
+    streams = MakeSyntheticStreams();
+
+  std::vector<u64> total_ns, total_verts;
+  RunStreams(streams, 50, true, &total_ns, &total_verts);
+
+  const char* names[] = {"jit", "templated", "generic"};
+  for (size_t l = 0; l < total_ns.size(); l++)
+  {
+    if (total_verts[l])
+      printf("%-10s %8.2f ns/vertex over %llu vertices\n", names[l], double(total_ns[l]) / total_verts[l],
+             (unsigned long long)total_verts[l]);
+  }
+}
@@ -0,0 +1,155 @@
+#! /usr/bin/env python3
+
+"""
+merge-vertex-loaders.py --game <gameid> [--output-dir dir] [--max-loaders n]
+                        [--min-share fraction] <G_xxx_pvt.cpp...>
+
+Merges the precompiled vertex loader files written by "Dump Vertex Loaders"
+(User/Dump/G_<gameid>_pvt.cpp) over several play sessions into a single set.
+
+The vertex counts of every loader are summed over all inputs and the loaders
+are ranked by how many vertices they converted, so the ones a game actually
+spends its time in come first. Passing the checked-in file for the game as one
+of the inputs keeps the loaders it already has, with their old counts.
+
+Loaders that converted less than --min-share of all vertices and anything past
+--max-loaders are dropped, every one of them is a template instantiation that
+has to be compiled.
+
+Writes G_<gameid>_pvt.h and G_<gameid>_pvt.cpp to --output-dir, by default
+Source/Core/VideoCommon. The set still has to be registered in
+VertexLoaderCompiled.cpp and the build files when it is for a new game.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ENTRY_RE = re.compile(
+    r'pvlmap\[(?P<hash>\d+)\]\s*=\s*TemplatedLoader<\s*(?P<sse>0x301|0)\s*,\s*'
+    r'(?P<conf>0x[0-9a-fA-F]+u\s*,\s*0x[0-9a-fA-F]+u\s*,\s*0x[0-9a-fA-F]+u\s*,\s*0x[0-9a-fA-F]+u)\s*>')
+NAME_RE = re.compile(r'^\s*//\s*(?P<name>[A-Za-z]\S*)\s*$')
+VERTS_RE = re.compile(r'//\s*num_verts=\s*(?P<count>\d+)')
+
+HEADER = '''// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+#pragma once
+#include <map>
+#include "VideoCommon/NativeVertexFormat.h"
+class G_{game}_pvt
+{{
+public:
+\tstatic void Initialize(std::map<u64, TCompiledLoaderFunction> &pvlmap);
+}};
+'''
+
+SOURCE_START = '''// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+// Generated by Tools/merge-vertex-loaders.py from {runs} vertex loader dump(s)
+
+#include "VideoCommon/G_{game}_pvt.h"
+#include "VideoCommon/VertexLoader_Template.h"
+
+void G_{game}_pvt::Initialize(std::map<u64, TCompiledLoaderFunction> &pvlmap)
+{{
+'''
+
+SOURCE_ENTRY = '''\t// {name}
+\t// num_verts= {count}
+#if _M_SSE >= 0x301
+\tif (cpu_info.bSSSE3)
+\t{{
+\t\tpvlmap[{hash}] = TemplatedLoader<0x301, {conf}>;
+\t}}
+\telse
+#endif
+\t{{
+\t\tpvlmap[{hash}] = TemplatedLoader<0, {conf}>;
+\t}}
+'''
+
+
+class Loader:
+    def __init__(self, name, conf):
+        self.name = name
+        self.conf = conf
+        self.count = 0
+
+
+def parse_dump(path, loaders):
+    '''Adds the loaders of one dump to loaders, keyed by their uid hash.'''
+    name = ''
+    count = 0
+    seen = set()
+    with open(path) as f:
+        for line in f:
+            m = VERTS_RE.search(line)
+            if m:
+                count = int(m.group('count'))
+                continue
+            m = NAME_RE.match(line)
+            if m:
+                name = m.group('name')
+                continue
+            m = ENTRY_RE.search(line)
+            if not m:
+                continue
+            # Both the SSSE3 and the plain branch name the same loader
+            h = int(m.group('hash'))
+            if h in seen:
+                continue
+            seen.add(h)
+            conf = ' '.join(m.group('conf').split())
+            entry_name, entry_count = name, count
+            # The comments above an entry belong to it alone
+            name = ''
+            count = 0
+            loader = loaders.setdefault(h, Loader(entry_name, conf))
+            if loader.conf != conf:
+                print('%s: loader %d has a different format than in an earlier dump, skipping it'
+                      % (path, h), file=sys.stderr)
+                continue
+            loader.count += entry_count
+    return len(seen)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Merges dumped vertex loaders into one ranked precompiled set.')
+    parser.add_argument('--game', required=True, help='game id, e.g. GALE01')
+    parser.add_argument('--output-dir', default=os.path.join('Source', 'Core', 'VideoCommon'))
+    parser.add_argument('--max-loaders', type=int, default=128)
+    parser.add_argument('--min-share', type=float, default=0.0005,
+                        help='drop loaders below this fraction of all converted vertices')
+    parser.add_argument('dumps', nargs='+')
+    args = parser.parse_args()
+
+    loaders = {}
+    for path in args.dumps:
+        found = parse_dump(path, loaders)
+        print('%s: %d loaders' % (path, found), file=sys.stderr)
+
+    total = sum(l.count for l in loaders.values())
+    ranked = sorted(loaders.items(), key=lambda item: (-item[1].count, item[0]))
+    kept = [(h, l) for h, l in ranked if total == 0 or l.count >= total * args.min_share]
+    kept = kept[:args.max_loaders]
+    kept_verts = sum(l.count for h, l in kept)
+    print('kept %d of %d loaders, covering %.2f%% of %d vertices'
+          % (len(kept), len(loaders), 100.0 * kept_verts / total if total else 0.0, total),
+          file=sys.stderr)
+
+    base = os.path.join(args.output_dir, 'G_%s_pvt' % args.game)
+    with open(base + '.h', 'w', newline='\n') as f:
+        f.write(HEADER.format(game=args.game))
+    with open(base + '.cpp', 'w', newline='\n') as f:
+        f.write(SOURCE_START.format(game=args.game, runs=len(args.dumps)))
+        for h, l in kept:
+            f.write(SOURCE_ENTRY.format(name=l.name or 'unnamed', count=l.count, hash=h, conf=l.conf))
+        f.write('}\n')
+
+
+if __name__ == '__main__':
+    main()